@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <ctime>
+#include <sys/stat.h>
+
+// Persistent per-directory listing cache for incremental rescans.
+// A directory's entry list only changes when its mtime/ctime change, so an
+// unchanged directory can be walked from the cache without opendir()/readdir().
+// Callers still stat() every entry; only the directory enumeration is skipped.
+class DirListingCache {
+public:
+    struct Entry {
+        long long mtimeSec = 0;
+        long mtimeNsec = 0;
+        long long ctimeSec = 0;
+        long ctimeNsec = 0;
+        time_t listedAt = 0;   // When the listing was taken (racy-mtime guard)
+        time_t lastSeen = 0;   // Last scan that used/refreshed this entry
+        std::vector<std::string> names;
+    };
+
+    // Returns true and fills names if dirSt matches the cached mtime/ctime.
+    bool lookup(const std::string& dir, const struct stat& dirSt, std::vector<std::string>& names);
+
+    // Remember a fresh readdir() result for dir (dirSt = stat of the directory before listing).
+    void store(const std::string& dir, const struct stat& dirSt, const std::vector<std::string>& names);
+
+    // Binary persistence (DIRLISTCACHE_V1). Entries not seen for maxAgeDays are dropped on save.
+    bool save(const std::string& filename, int maxAgeDays = 30);
+    bool load(const std::string& filename);
+
+    void clear();
+    size_t size();
+    bool isLoaded() const { return m_loaded; }
+
+    long long hits() const { return m_hits.load(); }
+    long long misses() const { return m_misses.load(); }
+    void resetCounters() { m_hits = 0; m_misses = 0; }
+
+private:
+    std::unordered_map<std::string, Entry> m_entries;
+    std::mutex m_mutex;
+    std::atomic<long long> m_hits{0};
+    std::atomic<long long> m_misses{0};
+    bool m_loaded = false;
+};
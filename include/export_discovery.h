@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -22,13 +23,16 @@ struct ExportInfo {
 // NFS Export Discovery
 class NFSExportDiscovery {
 public:
-    // List all NFS exports from server
+    // List all NFS exports from server (MOUNT protocol, cached per server)
     static std::vector<ExportInfo> listNFSExports(const std::string& serverHost);
     
+    // Exports of many servers at once - one event loop, no process per server
+    static std::map<std::string, std::vector<ExportInfo>> listNFSExports(const std::vector<std::string>& serverHosts);
+    
     // Check if NFS server is reachable
     static bool isNFSServerAccessible(const std::string& serverHost);
     
-    // Get NFS export info via showmount -e
+    // Parse the output of showmount -e
     static std::vector<ExportInfo> parseShowmountOutput(const std::string& output);
 };
 
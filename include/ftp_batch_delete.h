@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Batched FTP deletes.
+//
+// Instead of one login per file, deletions are grouped per server, ordered by
+// directory and sent as CURLOPT_QUOTE lists of "*DELE <path>" over one pooled
+// control connection (the '*' keeps curl going after a failed DELE). Paths are
+// absolute, no CWD is sent, so curl's idea of the working directory on the
+// pooled connection stays valid.
+//
+// FtpDeleteTranscript pairs every DELE sent with the server's final reply, as
+// seen by the curl debug callback (CURLINFO_HEADER_OUT / CURLINFO_HEADER_IN).
+
+enum class FtpDeleteStatus {
+    Pending,        // Not answered yet (connection lost before the reply)
+    Deleted,        // 2xx
+    Transient,      // 4xx - try again
+    Failed          // 5xx - permission, not found, ...
+};
+
+struct FtpDeleteResult {
+    std::string url;
+    FtpDeleteStatus status = FtpDeleteStatus::Pending;
+    int replyCode = 0;
+    std::string reply;                    // Last reply line, for the log
+    int attempts = 0;
+};
+
+struct FtpDeleteBatch {
+    std::string server;                   // scheme://host:port
+    std::vector<std::string> urls;
+};
+
+// "ftp://host:21/a/b c.txt" -> "/a/b c.txt" (the path DELE gets, unencoded)
+std::string ftpDeletePath(const std::string& url);
+
+// Per server, sorted by path (= grouped by directory), at most batchSize files per batch
+std::vector<FtpDeleteBatch> planFtpDeleteBatches(const std::vector<std::string>& urls, size_t batchSize);
+
+// QUOTE list for one batch
+std::vector<std::string> ftpDeleteCommands(const std::vector<std::string>& urls);
+
+FtpDeleteStatus ftpDeleteStatusFor(int replyCode);
+
+class FtpDeleteTranscript {
+public:
+    // Command line curl sent (CURLINFO_HEADER_OUT)
+    void command(std::string_view data);
+    // Server reply data (CURLINFO_HEADER_IN), may hold several lines
+    void reply(std::string_view data);
+
+    struct Entry {
+        std::string path;
+        int code;
+        std::string text;
+    };
+    const std::vector<Entry>& entries() const { return m_entries; }
+
+private:
+    std::vector<Entry> m_entries;
+    std::string m_pendingPath;
+    bool m_pending = false;
+};
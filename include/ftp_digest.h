@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "ftp_listing.h"
+
+// Server-side FTP checksums.
+//
+// Instead of downloading a file to hash it, ask the server: HASH
+// (draft-bryan-ftpext-hash, selected with OPTS HASH, ranges via RANG) or the
+// older XMD5/XSHA1/XSHA256/XSHA512/XCRC commands (ProFTPD mod_digest,
+// FileZilla Server, vsftpd forks; optional start/end positions). The
+// commands are sent as CURLOPT_QUOTE on a NOBODY request; the reply is read
+// from the header callback.
+
+enum class FtpDigestAlgo { None, MD5, SHA1, SHA256, SHA512, CRC32 };
+
+struct FtpDigestPlan {
+    FtpDigestAlgo algo = FtpDigestAlgo::None;
+    std::vector<std::string> commands;    // QUOTE commands, in order
+    explicit operator bool() const { return algo != FtpDigestAlgo::None; }
+};
+
+// Pick a command for path (relative to the login directory, unencoded).
+// Preference: MD5 (identical to a downloaded MD5), SHA-256, SHA-1, SHA-512;
+// CRC32 only with allowCrc - it is too weak to declare files identical.
+// start/end select the byte range [start, end); start < 0 hashes the whole file.
+FtpDigestPlan planFtpDigest(const FtpServerFeatures& features, const std::string& path,
+                            long long start = -1, long long end = -1, bool allowCrc = false);
+
+// Extract the digest for algo from the server reply (last 2xx line carrying a
+// hex token of the right length). Returns lower-case hex.
+bool parseFtpDigestReply(const std::string& reply, FtpDigestAlgo algo, std::string& hex);
+
+const char* ftpDigestName(FtpDigestAlgo algo);
+
+// Key used in duplicate groups: plain hex for MD5 (matches downloaded hashes),
+// "<name>:<hex>" otherwise so digests of different algorithms never match.
+std::string ftpDigestKey(FtpDigestAlgo algo, const std::string& hex);
@@ -0,0 +1,129 @@
+#pragma once
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+// Pool of reusable libcurl easy handles for FTP (std-only port of the Qt FtpConnectionPool).
+//
+// An easy handle keeps its control connection open after curl_easy_perform(), so
+// handing the same handle back to the next transfer for the same server+user
+// skips TCP connect, USER/PASS and (FTPS) the TLS handshake. Idle handles are
+// preferably returned to the thread that used them last, checked for a dead
+// control socket before reuse and closed after an idle timeout. The number of
+// handles per server+user is capped (ftpMaxConnections, or a lower per-server
+// budget); acquire() blocks until one is released.
+class FtpHandlePool {
+public:
+    struct Stats {
+        uint64_t acquires = 0;
+        uint64_t handlesCreated = 0;
+        uint64_t handlesReused = 0;
+        uint64_t transfers = 0;
+        uint64_t connectionsReused = 0;   // Transfers that did not open a new connection
+        uint64_t healthCheckFailures = 0;
+        uint64_t idleEvictions = 0;
+        size_t idle = 0;
+        size_t inUse = 0;
+
+        double reuseRatio() const { return transfers ? (double)connectionsReused / transfers : 0.0; }
+    };
+
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        CURL* get() const { return m_handle; }
+        explicit operator bool() const { return m_handle != nullptr; }
+
+        // curl_easy_perform() + connection reuse accounting
+        CURLcode perform();
+        // Drop the handle instead of pooling it (e.g. after a protocol error)
+        void markBroken() { m_broken = true; }
+        void release();
+
+    private:
+        friend class FtpHandlePool;
+        FtpHandlePool* m_pool = nullptr;
+        CURL* m_handle = nullptr;
+        std::string m_key;
+        bool m_broken = false;
+    };
+
+    FtpHandlePool() = default;
+    ~FtpHandlePool();
+    FtpHandlePool(const FtpHandlePool&) = delete;
+    FtpHandlePool& operator=(const FtpHandlePool&) = delete;
+
+    void setMaxConnectionsPerServer(int maxConnections);
+    // Per-server budget (server = serverKey()): fewer connections (0 = default) and a
+    // bandwidth share in bytes/s split over those connections (0 = unlimited)
+    void setServerBudget(const std::string& server, int maxConnections, long long maxBytesPerSec);
+    void clearServerBudgets();
+    void setIdleTimeout(std::chrono::seconds timeout) { m_idleTimeout = timeout; }
+    // Off = every released handle is closed instead of pooled (ftpReuseConnections)
+    void setReuseConnections(bool reuse);
+    // Called on every handed-out handle after curl_easy_reset() (timeouts, buffers, share handle)
+    void setHandleSetup(std::function<void(CURL*)> setup);
+
+    // Handle for url's server (scheme://host:port) and user, credentials already set.
+    // Returns an empty lease if curl_easy_init() fails or timeout expires.
+    Lease acquire(const std::string& url, const std::string& username, const std::string& password,
+                  std::chrono::milliseconds timeout = std::chrono::seconds(60));
+
+    void evictIdle();
+    void clear();
+    Stats stats();
+    void resetStats();
+
+    static std::string serverKey(const std::string& url);
+
+private:
+    struct IdleHandle {
+        CURL* handle;
+        std::thread::id lastThread;
+        std::chrono::steady_clock::time_point releasedAt;
+    };
+    struct Server {
+        std::vector<IdleHandle> idle;
+        int inUse = 0;
+    };
+    struct Budget {
+        int maxConnections = 0;
+        long long maxBytesPerSec = 0;
+    };
+
+    void giveBack(const std::string& key, CURL* handle, bool broken);
+    bool isAlive(CURL* handle);
+    int limitForLocked(const std::string& key) const;
+    void evictIdleLocked(std::chrono::steady_clock::time_point now);
+
+    std::mutex m_mutex;
+    std::condition_variable m_released;
+    std::unordered_map<std::string, Server> m_servers;
+    int m_maxPerServer = 8;
+    std::unordered_map<std::string, Budget> m_budgets;
+    std::chrono::seconds m_idleTimeout{60};
+    std::function<void(CURL*)> m_setup;
+    std::atomic<bool> m_reuse{true};
+
+    std::atomic<uint64_t> m_acquires{0};
+    std::atomic<uint64_t> m_created{0};
+    std::atomic<uint64_t> m_reused{0};
+    std::atomic<uint64_t> m_transfers{0};
+    std::atomic<uint64_t> m_connReused{0};
+    std::atomic<uint64_t> m_healthFailures{0};
+    std::atomic<uint64_t> m_idleEvictions{0};
+};
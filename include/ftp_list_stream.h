@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstddef>
+
+// Incremental parser for recursive FTP listings (LIST -R).
+//
+// Fed directly from the curl write callback: complete lines are parsed in
+// place (string_view into curl's buffer), only a line split across two
+// chunks is copied. Understands Unix "ls -l" lines (with or without group,
+// "total N" lines, "./sub:" / "sub:" / "/abs/sub:" headers) and DOS/IIS
+// lines ("01-15-24  03:04PM  <DIR>  name").
+
+enum class FtpListType { File, Dir, Other };
+
+struct FtpListEntry {
+    std::string_view dir;                 // Relative to the listing root, no leading/trailing '/' ("" = root)
+    std::string_view name;
+    long long size = -1;                  // -1 = not reported (directories)
+    FtpListType type = FtpListType::Other;
+};
+
+// Parse a single LIST line (without line ending). dir is left empty.
+// Returns false for lines that are no entry (headers, "total N", banners).
+bool parseFtpListLine(std::string_view line, FtpListEntry& out);
+
+class FtpListRParser {
+public:
+    using EntryCallback = std::function<void(const FtpListEntry&)>;
+
+    // root: the listed directory ("/pub/media/"), used to strip absolute headers
+    explicit FtpListRParser(EntryCallback onEntry, const std::string& root = "");
+
+    void feed(const char* data, size_t len);
+    void finish();                        // Parse a trailing line without '\n'
+
+    size_t lines() const { return m_lines; }
+    size_t headers() const { return m_headers; }
+    size_t files() const { return m_files; }
+    size_t dirs() const { return m_dirs; }
+    size_t rootDirs() const { return m_rootDirs; }
+
+    // No directory header although the root has subdirectories: the server
+    // ignored -R and sent a plain listing of the root only
+    bool recursionIgnored() const { return m_headers == 0 && m_rootDirs > 0; }
+
+private:
+    void processLine(std::string_view line);
+    void enterDirectory(std::string_view header);
+
+    EntryCallback m_onEntry;
+    std::string m_root;                   // Without leading/trailing '/'
+    std::string m_currentDir;
+    std::string m_partial;
+    size_t m_lines = 0, m_headers = 0, m_files = 0, m_dirs = 0, m_rootDirs = 0;
+};
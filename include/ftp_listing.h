@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ctime>
+
+// FTP directory listing helpers (RFC 3659 MLSD/MLST + FEAT).
+// FEAT also reports the checksum commands used by ftp_digest.h.
+//
+// LIST output is meant for humans: no seconds, no year for recent files, no
+// time zone, owner/group columns of varying width. MLSD returns one
+// "fact=value;fact=value; name" line per entry with exact size and a UTC
+// modify timestamp, which is what makes remote hashes cacheable.
+
+struct FtpServerFeatures {
+    bool probed = false;                  // FEAT was sent (false = unknown, use LIST)
+    bool mlsd = false;                    // "MLST ..." advertised => MLSD/MLST available
+    bool size = false;                    // SIZE command
+    bool mdtm = false;                    // MDTM command
+    bool rang = false;                    // RANG (byte range for the next HASH)
+    bool xmd5 = false, xsha1 = false, xsha256 = false, xsha512 = false, xcrc = false;
+    std::vector<std::string> hashAlgorithms; // Listed after HASH, upper case, without '*'
+    std::string hashSelected;             // Algorithm marked '*' (current HASH algorithm)
+    std::vector<std::string> mlstFacts;   // Facts listed after MLST, lower case, without '*'
+    std::vector<std::string> mlstEnabled; // Facts marked '*' (sent by default)
+    std::vector<std::string> features;    // All feature lines, trimmed, original case
+
+    bool hasFact(const std::string& fact) const;
+    bool hasHashAlgorithm(const std::string& algorithm) const;
+    bool factEnabled(const std::string& fact) const;
+};
+
+struct FtpFacts {
+    std::string name;
+    bool isFile = false;
+    bool isDir = false;                   // type=dir (cdir/pdir are reported as neither)
+    long long size = -1;                  // -1 = not reported
+    time_t modify = 0;                    // UTC seconds, 0 = not reported
+    std::string unique;                   // Server-side identity of the object ("" = not reported)
+};
+
+// Parse the multi-line reply to FEAT ("211-Features:\r\n MLST size*;modify*;\r\n211 End").
+FtpServerFeatures parseFeatResponse(const std::string& response);
+
+// Parse one MLSD line (or the entry line of an MLST reply). Returns false for malformed lines.
+bool parseMlsdLine(const std::string& line, FtpFacts& out);
+
+// "YYYYMMDDHHMMSS[.sss]" (always UTC) -> time_t, 0 on error
+time_t parseMlsdTime(const std::string& value);
+
+// OPTS MLST command that enables the facts we use, "" if they are already enabled or unsupported
+std::string mlstOptsCommand(const FtpServerFeatures& features);
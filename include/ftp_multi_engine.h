@@ -0,0 +1,170 @@
+#pragma once
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+// Event-driven FTP transfer engine (non-Qt successor of CurlMultiManager).
+//
+// One event thread drives all transfers through curl_multi_socket_action() and
+// epoll, so hundreds of LIST/RETR transfers are in flight without one OS thread
+// each. Received data is handed to a small pool of worker threads (hashing
+// happens there, never on the event thread); every transfer is pinned to one
+// worker so its chunks are processed in order. A transfer whose worker falls
+// behind is paused (CURL_WRITEFUNC_PAUSE) until its backlog drains.
+//
+// Concurrency is capped per server (scheme://host:port) and globally; excess
+// requests wait in a per-server FIFO inside the engine and are admitted
+// round-robin, so every server with pending work stays busy. A server can get
+// its own budget: fewer connections and a bandwidth share.
+
+struct FtpTransferRequest {
+    std::string url;
+    std::string username;
+    std::string password;
+    bool collectBody = false;            // LIST: keep the response in FtpTransferResult::body
+    long timeoutSec = 0;                 // 0 = no overall timeout
+    std::string range;                   // Optional CURLOPT_RANGE ("0-65535")
+    std::string customRequest;           // Optional CURLOPT_CUSTOMREQUEST (e.g. "LIST -R", "MLSD")
+    std::vector<std::string> quote;      // Optional CURLOPT_QUOTE commands (e.g. "OPTS MLST ...")
+    bool noBody = false;                 // Control commands only (QUOTE), no data transfer
+    bool collectHeaders = false;         // Keep the server replies in FtpTransferResult::headers
+
+    // Called on a worker thread, in order, for every received chunk
+    std::function<void(const char* data, size_t len)> onData;
+};
+
+struct FtpTransferResult {
+    CURLcode code = CURLE_OK;
+    long responseCode = 0;
+    long long bytes = 0;
+    std::string body;                    // Only with collectBody
+    std::string headers;                 // Only with collectHeaders
+    double firstByteSec = 0;             // Start -> first byte (CURLINFO_STARTTRANSFER_TIME)
+    double totalSec = 0;                 // Start -> done (CURLINFO_TOTAL_TIME)
+};
+
+class FtpMultiEngine {
+public:
+    using Completion = std::function<void(FtpTransferResult&)>;
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        uint64_t pauses = 0;
+        long long bytes = 0;
+        int active = 0;
+        int queued = 0;
+    };
+
+    FtpMultiEngine() = default;
+    ~FtpMultiEngine();
+    FtpMultiEngine(const FtpMultiEngine&) = delete;
+    FtpMultiEngine& operator=(const FtpMultiEngine&) = delete;
+
+    // maxPerServer: concurrent transfers per server, maxTotal: over all servers
+    bool start(int workerThreads, int maxPerServer, int maxTotal);
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    // Applied to every easy handle before the request's own options (timeouts, buffers, share handle)
+    void setHandleSetup(std::function<void(CURL*)> setup) { m_setup = std::move(setup); }
+    void setLimits(int maxPerServer, int maxTotal);
+
+    // Budget for one server ("ftp://host:port"): maxConnections below the per-server limit
+    // (0 = default) and maxBytesPerSec split evenly over its connections (0 = unlimited).
+    // Applies to transfers started afterwards.
+    void setServerBudget(const std::string& server, int maxConnections, long long maxBytesPerSec);
+    void clearServerBudgets();
+
+    // Thread-safe. onDone runs on the transfer's worker thread after its last onData call.
+    void submit(FtpTransferRequest request, Completion onDone);
+
+    // Abort everything queued or in flight (completions still fire with CURLE_ABORTED_BY_CALLBACK)
+    void cancelAll();
+
+    // Block until no transfer is queued, running or being completed
+    void waitIdle();
+    // Same with timeout; false if transfers are still outstanding
+    bool waitIdleFor(std::chrono::milliseconds timeout);
+
+    Stats stats();
+
+private:
+    struct Transfer;
+    struct ServerBudget {
+        int maxConnections = 0;
+        long long maxBytesPerSec = 0;
+    };
+    struct Work {
+        std::shared_ptr<Transfer> transfer;
+        std::string chunk;
+        bool done = false;
+    };
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Work> queue;
+    };
+
+    static int socketCallback(CURL* easy, curl_socket_t s, int what, void* userp, void* socketp);
+    static int timerCallback(CURLM* multi, long timeoutMs, void* userp);
+    static size_t writeCallback(char* ptr, size_t size, size_t nmemb, void* userp);
+    static size_t headerCallback(char* ptr, size_t size, size_t nmemb, void* userp);
+
+    void eventLoop();
+    void workerLoop(Worker* worker);
+    void wake();
+    void admitPending();
+    void startTransfer(std::shared_ptr<Transfer> transfer);
+    void finishTransfer(CURL* easy, CURLcode code);
+    void drainCompleted();
+    void enqueueWork(const std::shared_ptr<Transfer>& transfer, Work work);
+    void transferFinishedOnWorker();
+
+    CURLM* m_multi = nullptr;
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+    std::chrono::steady_clock::time_point m_timerDeadline = std::chrono::steady_clock::time_point::max();
+    std::thread m_eventThread;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_cancel{false};
+    std::function<void(CURL*)> m_setup;
+
+    // Shared with submitters / workers
+    std::mutex m_mutex;
+    std::condition_variable m_idleCv;
+    std::deque<std::shared_ptr<Transfer>> m_incoming;
+    std::vector<std::shared_ptr<Transfer>> m_resume;
+    int m_outstanding = 0;               // Submitted but completion not yet run
+    int m_maxPerServer = 8;
+    int m_maxTotal = 256;
+    std::unordered_map<std::string, ServerBudget> m_budgets;
+    std::atomic<uint64_t> m_nextId{0};
+
+    // Event-thread only
+    std::unordered_map<std::string, std::deque<std::shared_ptr<Transfer>>> m_pending;
+    std::unordered_map<std::string, int> m_activePerServer;
+    std::unordered_map<CURL*, std::shared_ptr<Transfer>> m_active;
+    std::vector<CURL*> m_freeHandles;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_completed{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<uint64_t> m_pauses{0};
+    std::atomic<long long> m_bytes{0};
+    std::atomic<int> m_activeCount{0};
+    std::atomic<int> m_queuedCount{0};
+};
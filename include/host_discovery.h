@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// In-process host discovery (no nmap/ping/arp processes, no temp files).
+// ICMP echo requests go out in batches (sendmmsg) over an unprivileged ICMP datagram socket,
+// or a raw socket when only that is permitted; hosts on directly connected Ethernet subnets are
+// asked with ARP requests over AF_PACKET instead (answers even with ICMP filtered). One poll
+// loop receives all replies. Without CAP_NET_RAW and ping_group_range, off-link targets are
+// asked with the (setuid) ping binary instead; if that is missing too, stats.error says so.
+
+struct HostSweepOptions {
+    int timeoutMs = 1000;         // Wait for replies after the last request of a round
+    int attempts = 2;             // Later rounds only ask hosts that did not answer
+    int ratePerSecond = 10000;    // Requests per second, 0 = unlimited
+    bool useArp = true;           // ARP for on-link targets (AF_PACKET, needs CAP_NET_RAW)
+    bool useIcmp = true;
+};
+
+struct SweepHost {
+    std::string ip;
+    std::string mac;              // ARP answers only, "aa:bb:cc:dd:ee:ff"
+    std::string method;           // "arp", "icmp", "ping" (fallback) or "local" (own interface address)
+};
+
+struct HostSweepStats {
+    size_t targets = 0;
+    size_t requests = 0;
+    size_t alive = 0;
+    bool icmpAvailable = false;
+    bool arpAvailable = false;
+    bool pingFallback = false;    // No ICMP socket: off-link targets were asked with the ping binary
+    std::string error;            // Off-link targets could not be asked at all
+    double seconds = 0;
+};
+
+using SweepHostCallback = std::function<void(const SweepHost&)>;
+
+// onHost runs on the calling thread as soon as a host answers, never after cancel was seen
+HostSweepStats sweepHostRange(uint32_t first, uint32_t last, const HostSweepOptions& options,
+                              const SweepHostCallback& onHost, const std::atomic<bool>* cancel = nullptr);
+HostSweepStats sweepHostList(const std::vector<std::string>& hosts, const HostSweepOptions& options,
+                             const SweepHostCallback& onHost, const std::atomic<bool>* cancel = nullptr);
+
+// Live hosts of a subnet ("192.168.1.0/24", shorthand like "10.0" allowed), numerically sorted
+std::vector<std::string> sweepSubnet(const std::string& subnet, const HostSweepOptions& options = HostSweepOptions(),
+                                     const std::atomic<bool>* cancel = nullptr, HostSweepStats* stats = nullptr);
+
+// Single host (name or address) answers ICMP echo (or ARP when on-link) within timeoutMs
+bool icmpPing(const std::string& host, int timeoutMs);
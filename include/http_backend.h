@@ -0,0 +1,80 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include <functional>
+#include <curl/curl.h>
+#include "nfs_async_engine.h"
+
+// Shared part of the HTTP backends of NfsAsyncEngine (WebDAV, S3): one curl multi handle, easy
+// handles reused together with their connection, every pread one range GET. Subclasses build
+// URL and authentication of a request and do listing and deleting with send()/perform().
+class HttpBackend : public NfsBackend {
+public:
+    ~HttpBackend() override;
+
+    bool open(const std::string& path, OpenCallback cb) override;
+    bool pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) override;
+    void close(void* handle) override;
+    bool service(int timeoutMs) override;
+    std::string lastError() const override { return m_lastError; }
+
+protected:
+    struct Request {
+        std::string method = "GET";
+        std::string path;                 // Server path, not encoded
+        std::string query;                // Encoded, without '?'
+        std::vector<std::string> headers; // "Name: value"
+        std::string body;
+    };
+    // code = HTTP status, 0 if the transfer itself failed (m_lastError set)
+    using DoneCallback = std::function<void(long code, std::string&& body)>;
+
+    HttpBackend(const char* tag, int maxConnections);
+
+    virtual std::string requestUrl(const Request& request) const = 0;
+    // Authentication: headers (signatures) and/or curl options (user/password)
+    virtual void authorize(Request& request, CURL* easy) const = 0;
+
+    bool send(Request request, DoneCallback done);
+    long perform(Request request, std::string& body);
+    // Answer without a request, run by the next service()
+    void defer(std::function<void()> callback);
+
+    const char* m_tag;
+    std::string m_lastError;
+
+private:
+    struct Handle {
+        std::string path;
+    };
+    struct Transfer {
+        HttpBackend* owner = nullptr;
+        CURL* easy = nullptr;
+        struct curl_slist* headers = nullptr;
+        std::string path;
+        std::string requestBody;          // Must outlive the transfer (CURLOPT_POSTFIELDS)
+        std::string body;
+        bool isRead = false;
+        uint64_t offset = 0;              // Read
+        size_t count = 0;
+        uint64_t received = 0;            // Body bytes seen (a 200 reply starts at 0, not at offset)
+        bool full = false;                // Server ignored Range and sends the whole file
+        DoneCallback done;
+        ReadCallback readCb;
+    };
+
+    CURL* takeEasy();
+    Transfer* prepare(Request& request);
+    void release(Transfer* transfer, bool reuseHandle);
+    void finish(Transfer* transfer, CURLcode result);
+    static size_t onData(char* data, size_t size, size_t nmemb, void* userp);
+
+    CURLM* m_multi;
+    std::set<Transfer*> m_transfers;
+    std::vector<CURL*> m_idle;
+    std::set<Handle*> m_handles;
+    std::deque<std::function<void()>> m_deferred;
+    bool m_rangeIgnoredLogged = false;
+};
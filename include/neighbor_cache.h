@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <ctime>
+#include <cstdint>
+#include <functional>
+
+// Host discovery cache driven by the kernel's neighbour table.
+// Instead of re-reading /proc/net/arp for every scan, the cache loads the table once
+// (RTM_GETNEIGH dump) and then follows RTM_NEWNEIGH/RTM_DELNEIGH events over rtnetlink.
+// Port-scan results are kept per host with the MAC they were probed with; a host only
+// needs a new probe when it is new, its MAC changed or its entry is older than the TTL.
+
+struct NeighborEntry {
+    std::string ip;
+    std::string mac;              // "aa:bb:cc:dd:ee:ff", empty if not resolved
+    int ifindex = 0;
+    uint16_t state = 0;           // NUD_* bits
+    time_t lastChange = 0;
+};
+
+struct HostServices {
+    std::string ip;
+    std::string mac;              // MAC at probe time
+    std::vector<int> openPorts;
+    time_t probedAt = 0;
+};
+
+class NeighborDiscoveryCache {
+public:
+    NeighborDiscoveryCache() = default;
+    ~NeighborDiscoveryCache();
+
+    // Subscribe to neighbour events and load the current table; false if rtnetlink is unavailable
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    // Reachable neighbours (REACHABLE/STALE/DELAY/PROBE/PERMANENT), optionally limited to first..last (host order)
+    std::vector<NeighborEntry> neighbors(uint32_t first = 0, uint32_t last = 0xffffffff);
+    // Bumped on every neighbour that appears, disappears or changes its MAC
+    uint64_t generation() const { return m_generation.load(); }
+    // Called from the event thread for every such change (removed = gone or failed)
+    void setChangeCallback(std::function<void(const NeighborEntry&, bool removed)> callback);
+
+    // Candidates that need a port probe: unknown, older than ttlSeconds, or MAC changed since the probe
+    std::vector<std::string> hostsToProbe(const std::vector<std::string>& candidates, int ttlSeconds);
+    // Fresh (younger than ttlSeconds) results in first..last
+    std::vector<HostServices> cachedServices(uint32_t first, uint32_t last, int ttlSeconds);
+    void recordServices(const std::string& ip, const std::vector<int>& openPorts, time_t probedAt = 0);
+    void clearServices();
+
+    // Service results persist across restarts (DISCOVERYCACHE_V1 text format)
+    bool save(const std::string& filename);
+    bool load(const std::string& filename);
+
+    // One netlink datagram (dump reply or event); public for tests. Returns false on NLMSG_DONE/ERROR.
+    bool handleMessages(const void* data, size_t length);
+    // Neighbours missing from the following dump are dropped when it completes; public for tests
+    void beginDump();
+
+private:
+    void eventLoop();
+    bool requestDump();
+    void applyNeighbor(const NeighborEntry& entry, bool removed);
+    void finishDump(bool complete);
+
+    std::map<uint32_t, NeighborEntry> m_neighbors;
+    std::map<uint32_t, HostServices> m_services;
+    std::function<void(const NeighborEntry&, bool)> m_changeCallback;
+    std::mutex m_mutex;
+    std::mutex m_lifecycleMutex;    // start()/stop() come from the UI and the scan thread
+    std::set<uint32_t> m_dumpSeen;
+    bool m_dumpActive = false;
+    std::atomic<uint64_t> m_generation{0};
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+    int m_socket = -1;
+    uint32_t m_dumpSeq = 0;
+};
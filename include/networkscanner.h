@@ -15,7 +15,7 @@ public:
     
     // Scan network subnet (e.g., "192.168.1.0/24")
     std::vector<std::string> scanSubnet(const std::string& subnet);
-    // Cancelable scan using child process; honors cancel flag (kill child process if set)
+    // Cancelable scan; honors cancel flag (stops the ICMP/ARP sweep between batches)
     std::vector<std::string> scanSubnetCancelable(const std::string& subnet, std::atomic<bool>* cancel);
     
     // Probe FTP port on host
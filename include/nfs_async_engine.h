@@ -0,0 +1,105 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+// Mount-free NFS scanning: directory walk with READDIRPLUS (names + attributes
+// in one RPC) and MD5 hashing with pipelined preads, many RPCs in flight on
+// one connection, driven by a single-threaded event loop.
+//
+// NfsBackend is the RPC layer: libnfs (createLibnfsBackend, needs HAVE_LIBNFS)
+// or libsmb2 (smbclient.h) in the application, an in-memory server stand-in in
+// the tests. Callbacks run inside service() on the thread driving the engine.
+
+struct NfsDirEntry {
+    std::string name;
+    bool isDir = false;
+    bool isFile = false;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+    std::string md5;                      // Content MD5 the server already knows (S3 single-part ETag)
+};
+
+class NfsBackend {
+public:
+    using DirCallback = std::function<void(int status, std::vector<NfsDirEntry>&& entries)>;
+    using OpenCallback = std::function<void(int status, void* handle)>;
+    using ReadCallback = std::function<void(int status, const char* data, size_t len)>;
+
+    virtual ~NfsBackend() = default;
+
+    // Queue a request; false if it could not be sent (callback is not called then).
+    // Paths are relative to the export root and start with '/'. status < 0 = error.
+    virtual bool readdirplus(const std::string& path, DirCallback cb) = 0;
+    virtual bool open(const std::string& path, OpenCallback cb) = 0;
+    virtual bool pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) = 0;
+    virtual void close(void* handle) = 0;
+    // Wait up to timeoutMs for replies and run their callbacks; false if the connection is gone
+    virtual bool service(int timeoutMs) = 0;
+
+    virtual bool unlink(const std::string& path, std::string& error) = 0;
+    virtual std::string lastError() const { return ""; }
+};
+
+// Mounts server:exportPath in user space (no kernel mount, no root). nullptr + error without libnfs.
+std::unique_ptr<NfsBackend> createLibnfsBackend(const std::string& server, const std::string& exportPath,
+                                                std::string& error);
+bool isLibnfsAvailable();
+
+// "nfs://server/export/dir/file" helpers
+bool isNfsUrl(const std::string& path);
+std::string nfsUrl(const std::string& server, const std::string& path);
+bool parseNfsUrl(const std::string& url, std::string& server, std::string& path);
+
+class NfsAsyncEngine {
+public:
+    struct FileInfo {
+        std::string path;                 // Relative to the export root, starts with '/'
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t inode = 0;
+        std::string md5;                  // See NfsDirEntry::md5
+    };
+
+    struct Stats {
+        uint64_t readdirs = 0;
+        uint64_t opens = 0;
+        uint64_t reads = 0;
+        uint64_t bytes = 0;
+        uint64_t errors = 0;
+        int maxOutstanding = 0;           // Highest number of RPCs in flight
+    };
+
+    // maxOutstanding: RPCs in flight on the connection; readChunk/readAhead: pread size and
+    // preads in flight per file while hashing
+    explicit NfsAsyncEngine(NfsBackend& backend, int maxOutstanding = 64, size_t readChunk = 1024 * 1024,
+                            int readAhead = 4);
+
+    // Breadth-first walk below root (maxDepth levels of subdirectories). onFile/onDir run on the
+    // calling thread. Returns false if the connection failed.
+    bool walk(const std::string& root, int maxDepth, const std::function<void(const FileInfo&)>& onFile,
+              const std::atomic<bool>* stop = nullptr,
+              const std::function<void(const std::string&)>& onDir = nullptr);
+
+    // MD5 of every file; done(file, hex) in completion order, hex empty on errors or when stopped
+    bool hashFiles(const std::vector<FileInfo>& files,
+                   const std::function<void(const FileInfo&, const std::string&)>& done,
+                   const std::atomic<bool>* stop = nullptr);
+
+    Stats stats() const { return m_stats; }
+
+private:
+    void noteSent();
+
+    NfsBackend& m_backend;
+    int m_maxOutstanding;
+    size_t m_readChunk;
+    int m_readAhead;
+    int m_outstanding = 0;
+    Stats m_stats;
+};
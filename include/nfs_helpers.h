@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 
+// Exports of a remote NFS server over the MOUNT protocol (see nfs_mount_rpc.h), cached per server
 std::vector<std::string> listNfsExports(const std::string& server);
 
 // If libnfs is available, we can list directories on the remote export without local mount
@@ -11,7 +12,5 @@ std::vector<std::string> listNfsDirectoryWithLibnfs(const std::string& server, c
 // Helper: check if a command exists in PATH
 bool isCommandAvailable(const std::string& cmd);
 
-// Helper: returns empty vector if showmount is not available or no exports found.
-
 // Parse local /etc/exports and return exported paths (first token of each non-comment line)
 std::vector<std::string> parseLocalExports();
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// NFS export lists over the MOUNT protocol (RFC 1813, MOUNTPROC3_EXPORT) without a showmount
+// process per server. All servers are asked at once from one poll loop: portmapper GETPORT over a
+// single UDP socket, then EXPORT to mountd over UDP (TCP when mountd is registered for TCP only).
+// UDP requests are retransmitted with backoff; a host without portmapper answers with ICMP port
+// unreachable and is done at once instead of waiting for the timeout.
+
+struct NfsExport {
+    std::string path;
+    std::vector<std::string> groups;      // Allowed clients, empty = everyone
+};
+
+struct NfsExportReply {
+    std::string server;
+    bool ok = false;
+    std::vector<NfsExport> exports;
+    std::string error;                    // "timeout", "no portmapper", "mountd not registered", ...
+};
+
+// One reply per server, in the order given; onReply runs on the calling thread as soon as a
+// server is done. portmapPort only differs from 111 in tests.
+std::vector<NfsExportReply> queryNfsExports(const std::vector<std::string>& servers, int timeoutMs = 1500,
+                                            const std::function<void(const NfsExportReply&)>& onReply = nullptr,
+                                            const std::atomic<bool>* cancel = nullptr, uint16_t portmapPort = 111);
+
+// Like queryNfsExports, but answers from a per-server cache for ttlSeconds (failures for at most
+// 30 s) and only asks the servers that are not in it. Thread-safe.
+std::vector<NfsExportReply> cachedNfsExports(const std::vector<std::string>& servers, int ttlSeconds = 300,
+                                             int timeoutMs = 1500, uint16_t portmapPort = 111);
+void clearNfsExportCache();
+
+// XDR body of an EXPORT reply (exportnode list) -> exports
+bool parseMountExportList(const std::string& xdr, std::vector<NfsExport>& exports);
@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// Mass TCP connect scanner on one epoll loop (Linux).
+// Thousands of non-blocking connects are in flight at once, each with its own deadline,
+// instead of one blocking select() per port and one thread per host. New connects are
+// paced by an optional rate limit; results are streamed to callbacks while the scan runs.
+
+// File service ports: FTP, SSH, SMB-NetBIOS, SMB-CIFS, NFS
+inline const std::vector<int> FILE_SERVICE_PORTS = {21, 22, 139, 445, 2049};
+
+struct PortScanOptions {
+    std::vector<int> ports = FILE_SERVICE_PORTS;   // At most 32
+    int timeoutMs = 300;          // Per connect
+    int maxInFlight = 4096;       // Capped by RLIMIT_NOFILE (soft limit is raised if possible)
+    int ratePerSecond = 0;        // New connects per second, 0 = unlimited
+};
+
+struct PortScanHostResult {
+    std::string ip;
+    std::vector<int> openPorts;   // In the order of PortScanOptions::ports
+    bool responded = false;       // Open port or connection refused: the host is up
+};
+
+struct PortScanStats {
+    size_t hosts = 0;
+    size_t probes = 0;
+    size_t open = 0;
+    size_t refused = 0;
+    size_t timedOut = 0;
+    size_t unreachable = 0;
+    double seconds = 0;
+};
+
+using PortScanHostCallback = std::function<void(const PortScanHostResult&)>;
+using PortScanOpenCallback = std::function<void(const std::string& ip, int port)>;
+
+// onHost runs once per host (with or without open ports) as soon as all of its ports are done;
+// onOpen runs for every open port right away. Both run on the calling thread and never after
+// cancel was seen. Invalid addresses are reported as hosts without response.
+PortScanStats massPortScan(const std::vector<std::string>& hosts, const PortScanOptions& options,
+                           const PortScanHostCallback& onHost, const PortScanOpenCallback& onOpen = nullptr,
+                           const std::atomic<bool>* cancel = nullptr);
+
+// Same for the inclusive range first..last (host byte order), generated on the fly
+PortScanStats massPortScanRange(uint32_t first, uint32_t last, const PortScanOptions& options,
+                                const PortScanHostCallback& onHost, const PortScanOpenCallback& onOpen = nullptr,
+                                const std::atomic<bool>* cancel = nullptr);
+
+// Service name for the file service ports ("FTP", "SSH", ...), otherwise the number
+std::string portServiceName(int port);
@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+// Shared bandwidth budget and measured link quality for remote transfers.
+//
+// TokenBucket caps the sum of all remote transfers (FTP hashing, samples,
+// listings); the rate can be changed while transfers run. Callers take bytes
+// after receiving them and sleep off the debt, which stalls the curl write
+// callback and lets TCP flow control slow the sender down.
+//
+// RemoteThroughputTracker keeps per-server estimates (EWMA) of throughput and
+// time to first byte, so timeouts and connection counts can be derived from
+// measurements instead of the old "~10 MB/s" constant.
+
+class TokenBucket {
+public:
+    explicit TokenBucket(double bytesPerSec = 0, double burstSec = 0.25);
+
+    void setRate(double bytesPerSec);     // 0 = unlimited; takes effect immediately
+    double rate() const;
+
+    // Take n bytes; returns how long the caller has to wait (zero within budget).
+    // Tokens may go negative, so one large chunk is paced instead of rejected.
+    std::chrono::microseconds reserve(size_t n);
+    // reserve() + sleep
+    void consume(size_t n);
+
+private:
+    void refillLocked(std::chrono::steady_clock::time_point now);
+
+    mutable std::mutex m_mutex;
+    double m_rate;
+    double m_burstSec;
+    double m_tokens = 0;
+    std::chrono::steady_clock::time_point m_last;
+};
+
+struct RemoteEstimate {
+    double bytesPerSec = 0;               // Per-transfer throughput after the first byte
+    double latencySec = 0;                // Request -> first byte (RETR round trips, PASV, login)
+    int samples = 0;
+};
+
+class RemoteThroughputTracker {
+public:
+    // transferSec: first byte -> last byte; latencySec: start -> first byte
+    void record(const std::string& server, long long bytes, double transferSec, double latencySec);
+
+    bool estimate(const std::string& server, RemoteEstimate& out) const;
+    std::map<std::string, RemoteEstimate> snapshot() const;
+    void clear();
+
+    // Timeout for transferring bytes from server: 3x the expected time plus a margin,
+    // never below minSec, at most maxSec. minSec when nothing was measured yet.
+    // rateCap (bytes/s, 0 = none) bounds the throughput, e.g. the global bandwidth share.
+    int timeoutFor(const std::string& server, long long bytes, int minSec, int maxSec = 6 * 3600,
+                   double rateCap = 0) const;
+
+    // Connections needed to keep server busy with files of typicalBytes: one transfer is
+    // only busy size/throughput out of latency + size/throughput, so 1 + latency*throughput/size
+    // connections hide the round trips. Clamped to [1, maxConnections]; maxConnections if unknown.
+    int suggestedConnections(const std::string& server, long long typicalBytes, int maxConnections) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, RemoteEstimate> m_estimates;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+// Hash plan for size groups that contain remote files.
+//
+// Local files are cheap to read, remote files cost a transfer. The planner
+// decides per remote candidate how it gets its hash, cheapest first:
+// remote hash cache, server-side MD5, head/tail sample (full download only
+// if a size peer's sample is identical), full download. Local members of
+// the group are hashed first; their samples use the same key format as the
+// remote samples, so a remote file that matches no local and no remote
+// peer is ruled out without ever being downloaded.
+//
+// A remote member whose full hash comes without transfer (cache, server
+// digest) has no sample to compare with, so its sampled peers could always
+// match it - in such groups nothing is sampled.
+//
+// A SHA-x digest only matches the same algorithm, so it is used only in groups
+// whose members all live on one server; elsewhere those files are downloaded
+// and hashed as MD5 like their peers.
+
+enum class RemoteHashStep {
+    Skip,           // Sample unique in its size group - no duplicate possible
+    Known,          // Remote hash cache
+    ServerDigest,   // Checksum computed by the server, nothing transferred
+    Sample,         // Head + tail first, full download only on a matching sample
+    Download        // Full transfer, hashed as MD5 (no server digest)
+};
+
+enum class RemoteHashSource {
+    Transfer,       // Only a transfer tells
+    Cached,         // Remote hash cache hit (MD5; a cached "<algo>:<hex>" digest counts as ServerOther)
+    ServerMD5,      // Server offers MD5 - comparable with local hashes
+    ServerOther     // Server offers SHA-x only - comparable with digests of the same server only
+};
+
+struct HashPlanMember {
+    std::string file;
+    bool remote = false;
+    RemoteHashSource source = RemoteHashSource::Transfer;
+    std::string origin;           // Server of a remote file ("ftp://host:port")
+};
+
+struct HashPlanGroup {
+    long long size = 0;
+    std::vector<HashPlanMember> members;
+};
+
+struct RemoteHashPlan {
+    std::map<std::string, RemoteHashStep> steps;   // Remote files only
+    std::set<long long> mixedSizes;                // Local + remote members: local side hashed as MD5
+    std::set<long long> sampledSizes;              // Groups with Sample steps: local members need samples too
+
+    int localFiles = 0;
+    int remoteFiles = 0;
+    int cached = 0;
+    int serverDigests = 0;
+    int sampled = 0;
+    int downloads = 0;
+    int skipped = 0;
+    long long localBytes = 0;
+    long long sampleBytes = 0;       // Head + tail of every Sample step
+    long long downloadBytes = 0;     // Download steps (after applySamples: incl. matching samples)
+    long long pendingBytes = 0;      // Sample steps that may still need a full download
+
+    long long expectedTransferBytes() const { return sampleBytes + downloadBytes; }
+    long long maxTransferBytes() const { return sampleBytes + downloadBytes + pendingBytes; }
+};
+
+// sampleBytes: size of head and tail each; files up to 2 * sampleBytes are downloaded outright.
+// useSamples = false plans a full download for every remote file without cached/server hash.
+RemoteHashPlan planRemoteHashing(const std::vector<HashPlanGroup>& groups, long long sampleBytes, bool useSamples);
+
+// Second stage for one size group once the samples are in: localKeys = samples of the local
+// members, remoteKeys = file -> sample of the Sample steps ("" = sample failed). Each sampled
+// file becomes Download if its key occurs elsewhere in the group, otherwise Skip. If any sample
+// of the group failed, every sampled file is downloaded. Returns the files that need a full download.
+std::vector<std::string> applySamples(RemoteHashPlan& plan, long long size,
+                                      const std::vector<std::string>& localKeys,
+                                      const std::map<std::string, std::string>& remoteKeys);
+
+// One-line summary for logs and the status panel
+std::string describeRemoteHashPlan(const RemoteHashPlan& plan);
@@ -0,0 +1,68 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include "nfs_async_engine.h"
+
+// S3-compatible object storage (MinIO, AWS, Ceph RGW) as a backend of NfsAsyncEngine.
+//
+// Paths are "/bucket/key", "/" lists the buckets. A directory is listed with paginated
+// ListObjectsV2 without delimiter - 1000 keys per request however deep the tree - and the
+// result answers the engine's readdirplus calls for every prefix below it (flat = false: one
+// level per request with delimiter '/', for browsing big buckets). Objects are read with
+// parallel range GETs; requests are path-style and signed with Signature V4.
+//
+// The ETag of a single-part upload is the MD5 of the content: it goes into NfsDirEntry::md5,
+// so candidates can be compared without a download. Multipart ETags ("<md5 of part md5s>-N")
+// are no content MD5 and neither are the ETags of SSE-C/KMS encrypted objects - those look
+// like MD5s, so callers spot-check a bucket before trusting its ETags.
+
+struct S3Credentials {
+    std::string accessKey;                // Empty = anonymous requests
+    std::string secretKey;
+    std::string region = "us-east-1";     // MinIO's default
+};
+
+// "s3://host:port/bucket/key" (http) and "s3s://host:port/bucket/key" (https) helpers
+bool isS3Url(const std::string& path);
+std::string s3Url(bool https, const std::string& host, const std::string& path = "/");
+bool parseS3Url(const std::string& url, bool& https, std::string& host, std::string& path);
+
+struct S3Object {
+    std::string key;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    std::string etag;
+};
+
+struct S3ListPage {
+    std::vector<S3Object> objects;
+    std::vector<std::string> prefixes;    // CommonPrefixes (with delimiter)
+    bool truncated = false;
+    std::string nextToken;
+};
+
+bool parseS3ListObjects(const std::string& xml, S3ListPage& page);
+bool parseS3Buckets(const std::string& xml, std::vector<std::string>& buckets);
+// Error reply -> "Code: Message"
+std::string parseS3Error(const std::string& xml);
+// Lowercase hex MD5 of a single-part ETag, empty for multipart ETags
+std::string s3EtagMd5(const std::string& etag);
+// "2009-10-12T17:50:30.000Z" -> Unix time, 0 if unreadable
+int64_t parseIso8601(const std::string& text);
+// RFC 3986 encoding as Signature V4 wants it ('/' kept in paths, encoded in query values)
+std::string s3UriEncode(const std::string& text, bool keepSlash);
+
+// Signature V4: returns the headers to add ("x-amz-date: ...", "x-amz-content-sha256: ...",
+// "Authorization: ..."). signedHeaders: lowercase name -> value, host included; query: decoded
+// name -> value; amzDate "20130524T000000Z".
+std::vector<std::string> s3SignV4(const S3Credentials& credentials, const std::string& method, const std::string& path,
+                                  const std::map<std::string, std::string>& query,
+                                  const std::map<std::string, std::string>& signedHeaders,
+                                  const std::string& payloadHash, const std::string& amzDate);
+std::string sha256Hex(const std::string& data);
+
+std::unique_ptr<NfsBackend> createS3Backend(bool https, const std::string& host, const S3Credentials& credentials,
+                                            std::string& error, bool flat = true, int maxConnections = 8);
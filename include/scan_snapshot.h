@@ -0,0 +1,146 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+// FileDuper scan snapshot (.fds v2)
+//
+// Binary, mmap-friendly replacement for the FILEDUPER_SCAN_STATE_V1 text format.
+// Layout (all integers little endian, records 8-byte aligned):
+//
+//   SnapshotHeader                     fixed size, magic "FDSNAP02"
+//   SnapshotGroupRecord[groupCount]    size, first file index, file count
+//   SnapshotStringRef[groupCount]      digest column (one hash string per group)
+//   SnapshotStringRef[fileCount]       file column (paths, grouped by group)
+//   meta block                         scan configuration + statistics
+//   string table                       raw bytes referenced by the columns
+//
+// A checksum over everything after the header detects truncated/corrupted files.
+// ScanSnapshotView maps the file and serves groups/paths as string_views, so a
+// multi-million-group result is browsable without deserializing it.
+
+#pragma pack(push, 1)
+struct SnapshotHeader {
+    char magic[8];            // "FDSNAP02"
+    uint32_t version;         // 2
+    uint32_t headerSize;      // sizeof(SnapshotHeader)
+    uint64_t fileSize;
+    uint64_t checksum;        // over bytes [headerSize, fileSize)
+    uint64_t groupsOffset;
+    uint64_t groupCount;
+    uint64_t digestsOffset;
+    uint64_t filesOffset;
+    uint64_t fileCount;
+    uint64_t metaOffset;
+    uint64_t metaSize;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct SnapshotGroupRecord {
+    int64_t size;
+    uint64_t firstFile;
+    uint32_t fileCount;
+    uint32_t reserved;
+};
+
+struct SnapshotStringRef {
+    uint64_t offset;          // relative to string table
+    uint32_t length;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+struct ScanSnapshotGroup {
+    std::string hash;
+    long long size = 0;
+    std::vector<std::string> files;
+};
+
+struct ScanSnapshotMeta {
+    int64_t timestamp = 0;
+    int64_t minFileSize = 0;
+    bool scanHiddenFiles = true;
+    bool followSymlinks = true;
+    std::string hashAlgorithm;
+    std::vector<std::string> localDirs;
+    std::vector<std::string> ftpDirs;
+    int64_t connectedPresetIndex = -1;
+    int64_t totalFiles = 0;
+    int64_t duplicateFiles = 0;
+    int64_t duplicateGroups = 0;
+    int64_t totalSize = 0;
+    int64_t duplicateSize = 0;
+};
+
+// Writes a complete snapshot (temp file + rename). Returns false and sets error on failure.
+bool writeScanSnapshot(const std::string& filename, const ScanSnapshotMeta& meta,
+                       const std::vector<ScanSnapshotGroup>& groups, std::string* error = nullptr);
+
+// Saves snapshots on a background thread so the GUI never blocks on large results.
+class ScanSnapshotWriter {
+public:
+    ~ScanSnapshotWriter();
+
+    // Takes ownership of the data; a still-running previous save is finished first.
+    void saveAsync(const std::string& filename, ScanSnapshotMeta meta, std::vector<ScanSnapshotGroup> groups);
+    bool busy() const { return m_busy.load(); }
+    void wait();
+    std::string lastError();
+
+private:
+    std::thread m_thread;
+    std::atomic<bool> m_busy{false};
+    std::mutex m_errorMutex;
+    std::string m_lastError;
+};
+
+// Read-only mmap view of a snapshot file
+class ScanSnapshotView {
+public:
+    ScanSnapshotView() = default;
+    ~ScanSnapshotView();
+    ScanSnapshotView(const ScanSnapshotView&) = delete;
+    ScanSnapshotView& operator=(const ScanSnapshotView&) = delete;
+
+    bool open(const std::string& filename, bool verifyChecksum = true);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    const std::string& error() const { return m_error; }
+    const std::string& filename() const { return m_filename; }
+
+    const ScanSnapshotMeta& meta() const { return m_meta; }
+    uint64_t groupCount() const { return m_header ? m_header->groupCount : 0; }
+    uint64_t fileCount() const { return m_header ? m_header->fileCount : 0; }
+
+    long long groupSize(uint64_t group) const;
+    uint32_t groupFileCount(uint64_t group) const;
+    std::string_view groupHash(uint64_t group) const;
+    std::string_view groupFile(uint64_t group, uint32_t index) const;
+
+    // Materialize one group (for editing/deleting in the results view)
+    ScanSnapshotGroup loadGroup(uint64_t group) const;
+
+    // Cheap magic check without mapping the file
+    static bool isSnapshotFile(const std::string& filename);
+
+private:
+    std::string_view stringAt(const SnapshotStringRef& ref) const;
+    bool parseMeta();
+
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    const SnapshotHeader* m_header = nullptr;
+    const SnapshotGroupRecord* m_groups = nullptr;
+    const SnapshotStringRef* m_digests = nullptr;
+    const SnapshotStringRef* m_files = nullptr;
+    const char* m_strings = nullptr;
+    ScanSnapshotMeta m_meta;
+    std::string m_error;
+    std::string m_filename;
+};
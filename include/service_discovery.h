@@ -0,0 +1,112 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <ctime>
+#include <cstdint>
+#include <functional>
+
+// Announced file services: multicast DNS-SD browser (RFC 6762/6763) and SSDP listener.
+// NAS boxes announce _smb._tcp, _nfs._tcp, ... on their own; the browser listens passively on
+// 224.0.0.251:5353 and asks actively (PTR queries at start, after 1 s and 3 s, then periodically).
+// SSDP (239.255.255.250:1900) adds UPnP media servers/NAS devices. Hosts found this way need no
+// port sweep. If port 5353 cannot be shared, queries are sent from an ephemeral port and
+// responders answer by unicast (no passive listening then).
+
+// DNS-SD service types of file servers
+inline const std::vector<std::string> FILE_SERVICE_TYPES = {
+    "_smb._tcp", "_nfs._tcp", "_ftp._tcp", "_sftp-ssh._tcp", "_webdav._tcp", "_webdavs._tcp"
+};
+
+struct ServiceDiscoveryOptions {
+    std::vector<std::string> serviceTypes = FILE_SERVICE_TYPES;
+    bool useMdns = true;
+    bool useSsdp = true;
+    int queryIntervalSeconds = 300;   // Active queries after the initial burst, 0 = only the burst
+    std::string mdnsGroup = "224.0.0.251";
+    int mdnsPort = 5353;
+    std::string ssdpGroup = "239.255.255.250";
+    int ssdpPort = 1900;
+    // SSDP devices are only kept if ST/NT or SERVER contains one of these (case-insensitive), empty = all
+    std::vector<std::string> ssdpFilters = {"MediaServer", "NAS", "Storage", "FileServer"};
+};
+
+struct DiscoveredService {
+    std::string ip;
+    std::string hostname;         // SRV target ("nas.local") or SSDP SERVER header
+    std::string name;             // Instance name ("NAS") or SSDP USN
+    std::string serviceType;      // "_smb._tcp" or the SSDP ST/NT
+    int port = 0;
+    std::string path;             // TXT "path" (WebDAV/FTP/NFS) or SSDP LOCATION
+    std::map<std::string, std::string> txt;
+    std::string source;           // "mdns" or "ssdp"
+    time_t expires = 0;
+};
+
+class ServiceDiscoveryBrowser {
+public:
+    ServiceDiscoveryBrowser() = default;
+    ~ServiceDiscoveryBrowser();
+
+    // Opens the sockets and starts the listener thread; false if no socket could be opened
+    bool start(const ServiceDiscoveryOptions& options = ServiceDiscoveryOptions());
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+    // Send a new query burst on the next loop iteration
+    void queryNow() { m_queryNow = true; }
+
+    std::vector<DiscoveredService> services();
+    // Called from the listener thread for every new, changed, expired or withdrawn service
+    void setCallback(std::function<void(const DiscoveredService&, bool removed)> callback);
+
+    // Bound local ports (the passive listeners; ephemeral in unicast fallback)
+    int mdnsLocalPort() const { return m_mdnsLocalPort; }
+    int ssdpLocalPort() const { return m_ssdpLocalPort; }
+
+    // One datagram from 'from'; public for tests
+    void handleMdnsPacket(const uint8_t* data, size_t length, const std::string& from);
+    void handleSsdpPacket(const char* data, size_t length, const std::string& from);
+    static std::vector<uint8_t> buildMdnsQuery(const std::vector<std::string>& serviceTypes);
+
+private:
+    using Events = std::vector<std::pair<DiscoveredService, bool>>;
+    void listenLoop();
+    void sendQueries();
+    void expireServices();
+    void publish(const std::string& key, const DiscoveredService& service, Events& events);
+    void withdraw(const std::string& key, Events& events);
+    void notify(const Events& events);
+
+    // Partially known DNS-SD instances (PTR, SRV, TXT may arrive in separate packets)
+    struct Instance {
+        std::string name;
+        std::string type;
+        std::string host;
+        int port = 0;
+        std::map<std::string, std::string> txt;
+        std::string from;
+        time_t expires = 0;
+    };
+
+    ServiceDiscoveryOptions m_options;
+    std::map<std::string, Instance> m_instances;          // "nas._smb._tcp.local"
+    std::map<std::string, std::string> m_hostAddresses;   // "nas.local" -> "192.168.1.10"
+    std::map<std::string, DiscoveredService> m_services;  // mDNS instance or SSDP USN
+    std::function<void(const DiscoveredService&, bool)> m_callback;
+    std::mutex m_mutex;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopping{false};
+    std::atomic<bool> m_queryNow{false};
+    std::thread m_thread;
+    std::vector<uint32_t> m_interfaces;                   // IPv4 addresses of multicast interfaces
+    int m_mdnsSocket = -1;
+    int m_ssdpSocket = -1;
+    int m_mdnsLocalPort = 0;
+    int m_ssdpLocalPort = 0;
+};
+
+// "SMB", "NFS", "FTP", "SFTP", "WebDAV", otherwise the type itself
+std::string serviceTypeLabel(const std::string& serviceType);
@@ -2,13 +2,32 @@
 #define SFTPCLIENT_H
 
 #include <string>
+#include <memory>
+#include "nfs_async_engine.h"
+#include "ssh_remote_hash.h"
 
-class SftpClient {
-public:
-    SftpClient() {}
-    ~SftpClient() {}
-    
-    bool connectToHost(const std::string& host) { return false; }
-};
+// SFTP over libssh (WITH_LIBSSH) as a backend of NfsAsyncEngine.
+//
+// A synchronous SFTP read waits one round trip per chunk. Here every pread is
+// sent right away with sftp_async_read_begin() and collected later with
+// sftp_async_read(), so the engine keeps a deep window of reads for many files
+// in flight on one SSH session. Directory listings and opens are answered in
+// order between the reads.
+
+// "sftp://host:22/dir/file" helpers
+bool isSftpUrl(const std::string& path);
+std::string sftpUrl(const std::string& host, int port, const std::string& path = "/");
+bool parseSftpUrl(const std::string& url, std::string& host, int& port, std::string& path);
+
+bool isLibsshAvailable();
+
+// Connects and authenticates (password, or the user's keys/agent without one). Unknown host
+// keys are added to known_hosts, changed ones are refused. nullptr + error on failure.
+std::unique_ptr<NfsBackend> createSftpBackend(const std::string& host, int port, const std::string& user,
+                                              const std::string& password, std::string& error);
+
+// Exec channels on one libssh session for the remote hashing (ssh_remote_hash.h)
+std::unique_ptr<SshCommandRunner> createLibsshRunner(const std::string& host, int port, const std::string& user,
+                                                     const std::string& password, std::string& error);
 
 #endif // SFTPCLIENT_H
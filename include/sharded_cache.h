@@ -0,0 +1,243 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// Bounded, lock-striped concurrent cache.
+//
+// Keys are spread over a power-of-two number of shards, each with its own
+// shared_mutex, so lookups from many hashing threads only contend when they
+// land on the same shard. Hits take the shard lock in shared mode and just set
+// the entry's CLOCK reference bit; inserts take it exclusively and evict with
+// the CLOCK (second chance) algorithm until the shard is back under its share
+// of the memory budget.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ShardedCache {
+public:
+    // Estimated heap footprint of one entry (key + value + node overhead)
+    using CostFn = std::function<size_t(const K&, const V&)>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t budget = 0;
+    };
+
+    explicit ShardedCache(size_t maxBytes, size_t shardCount = 64, CostFn cost = nullptr)
+        : m_cost(cost ? std::move(cost) : CostFn(defaultCost)) {
+        size_t shards = 1;
+        while (shards < shardCount) shards <<= 1;
+        m_shardBits = 0;
+        while ((size_t(1) << m_shardBits) < shards) m_shardBits++;
+        m_shards.reserve(shards);
+        for (size_t i = 0; i < shards; i++) m_shards.emplace_back(new Shard());
+        setBudget(maxBytes);
+    }
+
+    ShardedCache(const ShardedCache&) = delete;
+    ShardedCache& operator=(const ShardedCache&) = delete;
+
+    // Copies the value into out and marks the entry as recently used.
+    bool get(const K& key, V& out) {
+        return getIf(key, out, [](const V&) { return true; });
+    }
+
+    // Like get(), but entries rejected by valid() (e.g. expired) count as misses.
+    template <typename Pred>
+    bool getIf(const K& key, V& out, Pred valid) {
+        Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end() || !valid(it->second.value)) {
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        it->second.referenced.store(true, std::memory_order_relaxed);
+        out = it->second.value;
+        shard.hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(const K& key) {
+        Shard& shard = shardFor(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.find(key) != shard.map.end();
+    }
+
+    // Insert or replace.
+    void put(const K& key, V value) {
+        Shard& shard = shardFor(key);
+        size_t cost = m_cost(key, value);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            shard.bytes -= it->second.cost;
+            it->second.value = std::move(value);
+            it->second.cost = cost;
+            it->second.referenced.store(true, std::memory_order_relaxed);
+        } else {
+            it = shard.map.try_emplace(key).first;
+            it->second.value = std::move(value);
+            it->second.cost = cost;
+            it->second.ringIndex = shard.ring.size();
+            shard.ring.push_back(&*it);
+        }
+        shard.bytes += cost;
+        evict(shard, &*it);
+    }
+
+    // Modify an existing entry in place; returns false if the key is not cached.
+    template <typename Fn>
+    bool update(const K& key, Fn fn) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) return false;
+        shard.bytes -= it->second.cost;
+        fn(it->second.value);
+        it->second.cost = m_cost(key, it->second.value);
+        shard.bytes += it->second.cost;
+        evict(shard, &*it);
+        return true;
+    }
+
+    bool erase(const K& key) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) return false;
+        removeEntry(shard, it);
+        return true;
+    }
+
+    void clear() {
+        for (auto& shard : m_shards) {
+            std::unique_lock<std::shared_mutex> lock(shard->mutex);
+            shard->map.clear();
+            shard->ring.clear();
+            shard->hand = 0;
+            shard->bytes = 0;
+        }
+    }
+
+    // Visit all entries (one shard locked at a time, shared).
+    template <typename Fn>
+    void forEach(Fn fn) {
+        for (auto& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            for (const auto& entry : shard->map) fn(entry.first, entry.second.value);
+        }
+    }
+
+    // New total budget; shards over their share are trimmed on their next insert.
+    void setBudget(size_t maxBytes) {
+        m_budget = maxBytes;
+        m_shardBudget.store(std::max<size_t>(1, maxBytes / m_shards.size()), std::memory_order_relaxed);
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (auto& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            total += shard->map.size();
+        }
+        return total;
+    }
+
+    Stats stats() {
+        Stats s;
+        s.budget = m_budget;
+        for (auto& shard : m_shards) {
+            s.hits += shard->hits.load(std::memory_order_relaxed);
+            s.misses += shard->misses.load(std::memory_order_relaxed);
+            s.evictions += shard->evictions.load(std::memory_order_relaxed);
+            std::shared_lock<std::shared_mutex> lock(shard->mutex);
+            s.entries += shard->map.size();
+            s.bytes += shard->bytes;
+        }
+        return s;
+    }
+
+    void resetCounters() {
+        for (auto& shard : m_shards) {
+            shard->hits = 0;
+            shard->misses = 0;
+            shard->evictions = 0;
+        }
+    }
+
+private:
+    struct Entry {
+        V value{};
+        size_t cost = 0;
+        size_t ringIndex = 0;
+        std::atomic<bool> referenced{false};
+    };
+    using Map = std::unordered_map<K, Entry, Hash>;
+    using Node = typename Map::value_type;
+
+    // alignas keeps the per-shard counters of neighbouring shards off the same cache line
+    struct alignas(64) Shard {
+        std::shared_mutex mutex;
+        Map map;
+        std::vector<Node*> ring;   // CLOCK order; unordered_map nodes never move
+        size_t hand = 0;
+        size_t bytes = 0;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> evictions{0};
+    };
+
+    static size_t defaultCost(const K&, const V&) {
+        return sizeof(K) + sizeof(V) + sizeof(Entry) + 4 * sizeof(void*);
+    }
+
+    Shard& shardFor(const K& key) {
+        uint64_t h = Hash()(key);
+        h *= 0x9E3779B97F4A7C15ULL; // Fibonacci mixing: weak std::hash values still spread
+        return *m_shards[m_shardBits ? (h >> (64 - m_shardBits)) : 0];
+    }
+
+    void removeEntry(Shard& shard, typename Map::iterator it) {
+        size_t idx = it->second.ringIndex;
+        Node* last = shard.ring.back();
+        shard.ring[idx] = last;
+        last->second.ringIndex = idx;
+        shard.ring.pop_back();
+        if (shard.hand >= shard.ring.size()) shard.hand = 0;
+        shard.bytes -= it->second.cost;
+        shard.map.erase(it);
+    }
+
+    // CLOCK sweep: referenced entries get a second chance, the rest are evicted.
+    // keep (the entry just written) is never evicted by its own insert.
+    void evict(Shard& shard, Node* keep) {
+        size_t budget = m_shardBudget.load(std::memory_order_relaxed);
+        while (shard.bytes > budget && shard.ring.size() > 1) {
+            if (shard.hand >= shard.ring.size()) shard.hand = 0;
+            Node* node = shard.ring[shard.hand];
+            if (node == keep || node->second.referenced.exchange(false, std::memory_order_relaxed)) {
+                shard.hand++;
+                continue;
+            }
+            removeEntry(shard, shard.map.find(node->first));
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CostFn m_cost;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    unsigned m_shardBits = 0;
+    size_t m_budget = 0;
+    std::atomic<size_t> m_shardBudget{1};
+};
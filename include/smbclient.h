@@ -2,13 +2,27 @@
 #define SMBCLIENT_H
 
 #include <string>
+#include <memory>
+#include "nfs_async_engine.h"
 
-class SmbClient {
-public:
-    SmbClient() {}
-    ~SmbClient() {}
-    
-    bool connectToHost(const std::string& host) { return false; }
-};
+// SMB2/3 in user space with libsmb2 (async API): no cifs mount, no sudo.
+// The backend plugs into NfsAsyncEngine like libnfs does - directory walk with
+// QUERY_DIRECTORY (large output buffers, attributes included) and preads with
+// several credits in flight on one connection.
+
+// "smb://server/share/dir/file" helpers; path is relative to the share, starts with '/'
+bool isSmbUrl(const std::string& path);
+std::string smbUrl(const std::string& server, const std::string& share, const std::string& path = "/");
+bool parseSmbUrl(const std::string& url, std::string& server, std::string& share, std::string& path);
+
+// "//server/share/sub" (cifs mount source of the presets) -> server, share
+bool parseSmbSharePath(const std::string& sharePath, std::string& server, std::string& share);
+
+bool isLibsmb2Available();
+
+// Connects to \\server\share. nullptr + error without libsmb2 (HAVE_LIBSMB2) or on failure.
+std::unique_ptr<NfsBackend> createLibsmb2Backend(const std::string& server, const std::string& share,
+                                                 const std::string& user, const std::string& password,
+                                                 const std::string& domain, std::string& error);
 
 #endif // SMBCLIENT_H
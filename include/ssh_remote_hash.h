@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+
+// Hashing on the server over SSH exec: the file contents never cross the network.
+//
+// Paths go NUL-separated on stdin to `xargs -0 md5sum -z`, results come back
+// as NUL-terminated "hash  path" records and are handed out while the command
+// is still running. Head/tail samples for the prefilter use head -c / tail -c
+// into md5sum per file - the same key as the local and FTP samples
+// (MD5(head) + MD5(tail)). Large lists are split into batches, one exec
+// channel each, all on one session.
+
+// Runs one command with stdin input, streams stdout.
+class SshCommandRunner {
+public:
+    virtual ~SshCommandRunner() = default;
+    // exitStatus: command's exit status, -1 if it could not be run (error set)
+    virtual bool run(const std::string& command, const std::string& input,
+                     const std::function<void(const char* data, size_t len)>& onOutput,
+                     int& exitStatus, std::string& error) = 0;
+};
+
+// System ssh client (BatchMode - keys or agent only), fallback when libssh is not built in
+std::unique_ptr<SshCommandRunner> createSystemSshRunner(const std::string& host, int port, const std::string& user);
+// /bin/sh on this machine (tests, local paths)
+std::unique_ptr<SshCommandRunner> createLocalShellRunner();
+
+// Remote commands (exposed for logging and tests)
+std::string sshDigestCommand();
+std::string sshSampleCommand(long long sampleBytes);
+
+// Splits NUL-terminated records; "hash  path" (digest) or "head tail path" (sample)
+class SshDigestParser {
+public:
+    explicit SshDigestParser(bool samples) : m_samples(samples) {}
+    void feed(const char* data, size_t len, const std::function<void(const std::string& path, const std::string& key)>& onRecord);
+
+private:
+    bool m_samples;
+    std::string m_pending;
+};
+
+// MD5 of every path; done(path, hex) for each one, hex empty if the server could not read it.
+// false = the remote tools are missing or the session broke - paths not reported by then are
+// left to the caller (transfer instead).
+bool sshRemoteDigests(SshCommandRunner& runner, const std::vector<std::string>& paths, size_t batchSize,
+                      const std::function<void(const std::string&, const std::string&)>& done,
+                      const std::atomic<bool>* stop = nullptr);
+
+// Head/tail sample keys (MD5(head) + MD5(tail)), only for files larger than 2 * sampleBytes
+bool sshRemoteSamples(SshCommandRunner& runner, const std::vector<std::string>& paths, long long sampleBytes,
+                      size_t batchSize, const std::function<void(const std::string&, const std::string&)>& done,
+                      const std::atomic<bool>* stop = nullptr);
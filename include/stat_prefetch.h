@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <sys/types.h>
+
+// Latency-hiding metadata prefetch for network filesystems (kernel NFS/SMB mounts).
+// On NFS every stat() is a GETATTR/LOOKUP round trip, so a sequential walk costs
+// RTT x entries. The pool stat()s all entries of one directory concurrently with
+// statx(), the caller waits for the whole batch and gets the results in entry order.
+// Several callers (parallel directory scan) can submit batches at the same time.
+
+struct PrefetchedStat {
+    int error = 0;              // 0 = ok, otherwise errno of statx()
+    mode_t mode = 0;
+    long long size = 0;
+    long long mtime = 0;        // Seconds
+    ino_t inode = 0;
+    dev_t device = 0;
+};
+
+class StatPrefetchPool {
+public:
+    StatPrefetchPool() = default;
+    ~StatPrefetchPool();
+
+    // Start (or resize) the pool; cheap if already running with this size
+    void start(int threads);
+    void stop();
+    int threadCount();
+
+    // statx() every name relative to dir. followSymlinks = false reports the link itself
+    // (like lstat). dontSync = AT_STATX_DONT_SYNC: attributes may come from the client's
+    // attribute cache without revalidation (slightly stale, but no round trip when cached).
+    // Runs inline on the caller when the pool is not started.
+    void statDirectory(const std::string& dir, const std::vector<std::string>& names,
+                       bool followSymlinks, bool dontSync, std::vector<PrefetchedStat>& out);
+
+private:
+    struct Batch;
+    void worker();
+    static void runBatch(Batch& batch);
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::shared_ptr<Batch>> m_queue;
+    std::mutex m_mutex;
+    std::mutex m_startMutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+};
+
+// True for paths on a network filesystem (statfs magic: NFS, SMB/CIFS, FUSE e.g. sshfs/davfs2, ...)
+bool isRemoteFilesystem(const std::string& path);
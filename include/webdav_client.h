@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "nfs_async_engine.h"
+
+// WebDAV over libcurl as a backend of NfsAsyncEngine - no davfs2 mount, no copy of every file
+// in a local cache before it can be read.
+//
+// Listing: PROPFIND Depth: infinity on the first directory asked for; the reply covers the whole
+// subtree and answers the engine's later readdirplus calls without another request. A server
+// that refuses infinite depth (403 propfind-finite-depth, 400, 501) is listed level by level
+// with Depth: 1. getcontentlength / getlastmodified / getetag give size, mtime and a content
+// tag (NfsDirEntry::inode = davEtagTag(etag)) that validates cached hashes.
+//
+// Reading: every pread is one HTTP range GET on a curl multi handle, so the engine's read window
+// turns into parallel range requests (multiplexed over HTTP/2 where offered, otherwise spread
+// over up to maxConnections keep-alive connections).
+
+struct DavResource {
+    std::string path;                     // Decoded server path without trailing '/' (root: "/")
+    bool isDir = false;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    std::string etag;
+};
+
+// "dav://host:port/path" (http) and "davs://host:port/path" (https) helpers
+bool isDavUrl(const std::string& path);
+std::string davUrl(bool https, const std::string& host, const std::string& path = "/");
+bool parseDavUrl(const std::string& url, bool& https, std::string& host, std::string& path);
+// Preset URL "https://cloud/remote.php/webdav/" -> "davs://cloud/remote.php/webdav"
+std::string davUrlFromHttp(const std::string& httpUrl);
+
+// 207 Multi-Status body -> resources; any namespace prefix, hrefs relative or absolute.
+// Properties of a propstat whose status is not 200 are ignored.
+bool parseDavMultistatus(const std::string& xml, std::vector<DavResource>& out);
+// RFC 1123 date ("Sun, 06 Nov 1994 08:49:37 GMT") -> Unix time, 0 if unreadable
+int64_t parseHttpDate(const std::string& date);
+// Stable 64-bit tag of an ETag for the hash cache (0 = no ETag)
+uint64_t davEtagTag(const std::string& etag);
+// Percent-encodes a path for a request URL ('/' stays)
+std::string davEncodePath(const std::string& path);
+
+// Paths given to the backend are server paths ("/remote.php/webdav/dir"). The connection is only
+// opened by the first request; nullptr + error without a host.
+std::unique_ptr<NfsBackend> createWebDavBackend(bool https, const std::string& host, const std::string& user,
+                                                const std::string& password, std::string& error,
+                                                int maxConnections = 8);
@@ -0,0 +1,186 @@
+#include "dir_listing_cache.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+
+bool DirListingCache::lookup(const std::string& dir, const struct stat& dirSt, std::vector<std::string>& names) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(dir);
+    if (it == m_entries.end()) {
+        m_misses++;
+        return false;
+    }
+
+    Entry& e = it->second;
+    if (e.mtimeSec != (long long)dirSt.st_mtim.tv_sec || e.mtimeNsec != dirSt.st_mtim.tv_nsec ||
+        e.ctimeSec != (long long)dirSt.st_ctim.tv_sec || e.ctimeNsec != dirSt.st_ctim.tv_nsec) {
+        m_misses++;
+        return false;
+    }
+
+    // Racy listing: directory was modified in the same second it was listed.
+    // With coarse timestamps (NFSv3, FAT) a later change may not bump mtime, so re-list once.
+    if (e.mtimeSec + 1 >= (long long)e.listedAt) {
+        m_misses++;
+        return false;
+    }
+
+    e.lastSeen = time(nullptr);
+    names = e.names;
+    m_hits++;
+    return true;
+}
+
+void DirListingCache::store(const std::string& dir, const struct stat& dirSt, const std::vector<std::string>& names) {
+    Entry e;
+    e.mtimeSec = dirSt.st_mtim.tv_sec;
+    e.mtimeNsec = dirSt.st_mtim.tv_nsec;
+    e.ctimeSec = dirSt.st_ctim.tv_sec;
+    e.ctimeNsec = dirSt.st_ctim.tv_nsec;
+    e.listedAt = time(nullptr);
+    e.lastSeen = e.listedAt;
+    e.names = names;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[dir] = std::move(e);
+}
+
+void DirListingCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+size_t DirListingCache::size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+template <typename T>
+static void writePod(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool readPod(std::ifstream& file, T& value) {
+    return (bool)file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+static void writeString(std::ofstream& file, const std::string& s) {
+    uint32_t len = s.size();
+    writePod(file, len);
+    file.write(s.data(), len);
+}
+
+static bool readString(std::ifstream& file, std::string& s) {
+    uint32_t len;
+    if (!readPod(file, len) || len > 65536) return false;
+    s.resize(len);
+    return (bool)file.read(&s[0], len);
+}
+
+bool DirListingCache::save(const std::string& filename, int maxAgeDays) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Write to a temp file first so an interrupted save never leaves a truncated cache
+    std::string tmpName = filename + ".tmp";
+    std::ofstream file(tmpName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    const char header[16] = "DIRLISTCACHE_V1";
+    file.write(header, sizeof(header));
+
+    time_t cutoff = time(nullptr) - (time_t)maxAgeDays * 86400;
+    uint64_t count = 0;
+    for (const auto& [dir, e] : m_entries) {
+        if (e.lastSeen >= cutoff) count++;
+    }
+    writePod(file, count);
+
+    for (const auto& [dir, e] : m_entries) {
+        if (e.lastSeen < cutoff) continue;
+        writeString(file, dir);
+        writePod(file, e.mtimeSec);
+        writePod(file, e.mtimeNsec);
+        writePod(file, e.ctimeSec);
+        writePod(file, e.ctimeNsec);
+        writePod(file, e.listedAt);
+        writePod(file, e.lastSeen);
+        uint32_t nameCount = e.names.size();
+        writePod(file, nameCount);
+        for (const auto& name : e.names) {
+            writeString(file, name);
+        }
+    }
+
+    file.close();
+    if (!file) {
+        std::remove(tmpName.c_str());
+        return false;
+    }
+    if (std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpName.c_str());
+        return false;
+    }
+
+    std::cout << "[DirListCache] Saved " << count << " directory listings" << std::endl;
+    return true;
+}
+
+bool DirListingCache::load(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_loaded = true;
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    const long long fileSize = file.tellg();
+    file.seekg(0);
+    // Counts come from the file: check them against the bytes left before allocating anything
+    auto remaining = [&]() { return (uint64_t)std::max(0LL, fileSize - (long long)file.tellg()); };
+    const uint64_t minEntryBytes = sizeof(uint32_t) + sizeof(Entry::mtimeSec) + sizeof(Entry::mtimeNsec) +
+                                   sizeof(Entry::ctimeSec) + sizeof(Entry::ctimeNsec) + sizeof(Entry::listedAt) +
+                                   sizeof(Entry::lastSeen) + sizeof(uint32_t);
+
+    char header[16];
+    if (!file.read(header, sizeof(header)) || std::string(header, 15) != "DIRLISTCACHE_V1") {
+        std::cerr << "[DirListCache] Invalid cache format" << std::endl;
+        return false;
+    }
+
+    uint64_t count;
+    if (!readPod(file, count)) return false;
+
+    m_entries.clear();
+    if (count > remaining() / minEntryBytes) {
+        std::cerr << "[DirListCache] Truncated cache, discarding" << std::endl;
+        return false;
+    }
+    m_entries.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        std::string dir;
+        Entry e;
+        uint32_t nameCount;
+        if (!readString(file, dir) ||
+            !readPod(file, e.mtimeSec) || !readPod(file, e.mtimeNsec) ||
+            !readPod(file, e.ctimeSec) || !readPod(file, e.ctimeNsec) ||
+            !readPod(file, e.listedAt) || !readPod(file, e.lastSeen) ||
+            !readPod(file, nameCount) || nameCount > remaining() / sizeof(uint32_t)) {
+            std::cerr << "[DirListCache] Truncated cache, discarding" << std::endl;
+            m_entries.clear();
+            return false;
+        }
+        e.names.resize(nameCount);
+        for (uint32_t j = 0; j < nameCount; j++) {
+            if (!readString(file, e.names[j])) {
+                std::cerr << "[DirListCache] Truncated cache, discarding" << std::endl;
+                m_entries.clear();
+                return false;
+            }
+        }
+        m_entries.emplace(std::move(dir), std::move(e));
+    }
+
+    std::cout << "[DirListCache] Loaded " << m_entries.size() << " directory listings" << std::endl;
+    return true;
+}
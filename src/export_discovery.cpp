@@ -3,6 +3,8 @@
  */
 
 #include "export_discovery.h"
+#include "nfs_mount_rpc.h"
+#include "host_discovery.h"
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
@@ -18,46 +20,43 @@
 // ==================== NFS EXPORT DISCOVERY ====================
 
 std::vector<ExportInfo> NFSExportDiscovery::listNFSExports(const std::string& serverHost) {
-    std::vector<ExportInfo> exports;
-    
-    std::cout << "🔍 Discovering NFS exports from: " << serverHost << std::endl;
-    
-    if (!isNFSServerAccessible(serverHost)) {
-        std::cerr << "❌ NFS server not accessible: " << serverHost << std::endl;
-        return exports;
-    }
-    
-    // Use showmount -e to list exports
-    std::string cmd = "showmount -e " + serverHost + " 2>/dev/null";
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) {
-        std::cerr << "❌ Failed to execute showmount: " << serverHost << std::endl;
-        return exports;
-    }
+    return listNFSExports(std::vector<std::string>{serverHost})[serverHost];
+}
+
+std::map<std::string, std::vector<ExportInfo>> NFSExportDiscovery::listNFSExports(const std::vector<std::string>& serverHosts) {
+    std::map<std::string, std::vector<ExportInfo>> result;
     
-    std::string output;
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        output += buffer;
-    }
-    pclose(pipe);
+    std::cout << "🔍 Discovering NFS exports from " << serverHosts.size() << " server(s)" << std::endl;
     
-    if (output.empty()) {
-        std::cerr << "❌ No exports found or showmount failed: " << serverHost << std::endl;
-        return exports;
+    // Portmapper + mountd EXPORT of all servers side by side, answered from the cache when recent
+    for (const auto& reply : cachedNfsExports(serverHosts)) {
+        auto& exports = result[reply.server];
+        if (!reply.ok) {
+            std::cerr << "❌ No NFS exports from " << reply.server << " (" << reply.error << ")" << std::endl;
+            continue;
+        }
+        for (const auto& entry : reply.exports) {
+            ExportInfo info;
+            info.path = entry.path;
+            info.name = entry.path;
+            info.server = reply.server;
+            info.type = "NFS";
+            info.accessLevel = "rw";  // Not part of the export list
+            info.allowedClients = entry.groups.empty() ? std::vector<std::string>{"*"} : entry.groups;
+            info.accessible = true;
+            
+            std::cout << "  ✅ Found NFS export: " << reply.server << ":" << entry.path << std::endl;
+            
+            exports.push_back(info);
+        }
     }
     
-    std::cout << "📋 NFS Server Response:\n" << output << std::endl;
-    
-    return parseShowmountOutput(output);
+    return result;
 }
 
 bool NFSExportDiscovery::isNFSServerAccessible(const std::string& serverHost) {
-    // Try to ping the server first
-    std::string cmd = "ping -c 1 -W 1 " + serverHost + " >/dev/null 2>&1";
-    int result = system(cmd.c_str());
-    
-    if (result != 0) {
+    // Try to ping the server first (in-process ICMP echo)
+    if (!icmpPing(serverHost, 1000)) {
         std::cerr << "⚠️  Server not responding to ping: " << serverHost << std::endl;
         return false;
     }
@@ -0,0 +1,76 @@
+#include "ftp_batch_delete.h"
+#include <algorithm>
+#include <cctype>
+#include <map>
+
+static std::string ftpDeleteServer(const std::string& url) {
+    size_t schemeEnd = url.find("://");
+    size_t hostStart = (schemeEnd == std::string::npos) ? 0 : schemeEnd + 3;
+    return url.substr(0, url.find('/', hostStart));
+}
+
+std::string ftpDeletePath(const std::string& url) {
+    std::string server = ftpDeleteServer(url);
+    std::string path = url.substr(server.size());
+    return path.empty() ? "/" : path;
+}
+
+std::vector<FtpDeleteBatch> planFtpDeleteBatches(const std::vector<std::string>& urls, size_t batchSize) {
+    batchSize = std::max<size_t>(1, batchSize);
+    std::map<std::string, std::vector<std::string>> byServer;
+    for (const auto& url : urls) byServer[ftpDeleteServer(url)].push_back(url);
+
+    std::vector<FtpDeleteBatch> batches;
+    for (auto& [server, serverUrls] : byServer) {
+        std::sort(serverUrls.begin(), serverUrls.end());
+        serverUrls.erase(std::unique(serverUrls.begin(), serverUrls.end()), serverUrls.end());
+        for (size_t i = 0; i < serverUrls.size(); i += batchSize) {
+            FtpDeleteBatch batch;
+            batch.server = server;
+            batch.urls.assign(serverUrls.begin() + i, serverUrls.begin() + std::min(i + batchSize, serverUrls.size()));
+            batches.push_back(std::move(batch));
+        }
+    }
+    return batches;
+}
+
+std::vector<std::string> ftpDeleteCommands(const std::vector<std::string>& urls) {
+    std::vector<std::string> commands;
+    commands.reserve(urls.size());
+    for (const auto& url : urls) commands.push_back("*DELE " + ftpDeletePath(url));
+    return commands;
+}
+
+FtpDeleteStatus ftpDeleteStatusFor(int replyCode) {
+    if (replyCode >= 200 && replyCode < 300) return FtpDeleteStatus::Deleted;
+    if (replyCode >= 400 && replyCode < 500) return FtpDeleteStatus::Transient;
+    if (replyCode >= 500) return FtpDeleteStatus::Failed;
+    return FtpDeleteStatus::Pending;
+}
+
+static std::string_view trimLineEnd(std::string_view line) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) line.remove_suffix(1);
+    return line;
+}
+
+void FtpDeleteTranscript::command(std::string_view data) {
+    std::string_view line = trimLineEnd(data);
+    m_pending = line.size() > 5 && line.substr(0, 5) == "DELE ";
+    if (m_pending) m_pendingPath.assign(line.substr(5));
+}
+
+void FtpDeleteTranscript::reply(std::string_view data) {
+    while (!data.empty()) {
+        size_t nl = data.find('\n');
+        std::string_view line = trimLineEnd(data.substr(0, nl));
+        data = (nl == std::string_view::npos) ? std::string_view() : data.substr(nl + 1);
+
+        // Final line of a reply: "NNN text"; "NNN-" continues a multi-line reply
+        if (line.size() < 4 || line[3] != ' ' || !std::isdigit((unsigned char)line[0]) ||
+            !std::isdigit((unsigned char)line[1]) || !std::isdigit((unsigned char)line[2])) continue;
+        if (!m_pending) continue;
+        int code = (line[0] - '0') * 100 + (line[1] - '0') * 10 + (line[2] - '0');
+        m_entries.push_back({m_pendingPath, code, std::string(line)});
+        m_pending = false;
+    }
+}
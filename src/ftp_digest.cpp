@@ -0,0 +1,124 @@
+#include "ftp_digest.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+const char* ftpDigestName(FtpDigestAlgo algo) {
+    switch (algo) {
+        case FtpDigestAlgo::MD5: return "md5";
+        case FtpDigestAlgo::SHA1: return "sha1";
+        case FtpDigestAlgo::SHA256: return "sha256";
+        case FtpDigestAlgo::SHA512: return "sha512";
+        case FtpDigestAlgo::CRC32: return "crc32";
+        default: return "none";
+    }
+}
+
+static const char* hashFeatureName(FtpDigestAlgo algo) {
+    switch (algo) {
+        case FtpDigestAlgo::MD5: return "MD5";
+        case FtpDigestAlgo::SHA1: return "SHA-1";
+        case FtpDigestAlgo::SHA256: return "SHA-256";
+        case FtpDigestAlgo::SHA512: return "SHA-512";
+        case FtpDigestAlgo::CRC32: return "CRC32";
+        default: return "";
+    }
+}
+
+static size_t hexLength(FtpDigestAlgo algo) {
+    switch (algo) {
+        case FtpDigestAlgo::MD5: return 32;
+        case FtpDigestAlgo::SHA1: return 40;
+        case FtpDigestAlgo::SHA256: return 64;
+        case FtpDigestAlgo::SHA512: return 128;
+        case FtpDigestAlgo::CRC32: return 8;
+        default: return 0;
+    }
+}
+
+static bool xCommandFor(const FtpServerFeatures& f, FtpDigestAlgo algo, std::string& command) {
+    switch (algo) {
+        case FtpDigestAlgo::MD5: command = "XMD5"; return f.xmd5;
+        case FtpDigestAlgo::SHA1: command = "XSHA1"; return f.xsha1;
+        case FtpDigestAlgo::SHA256: command = "XSHA256"; return f.xsha256;
+        case FtpDigestAlgo::SHA512: command = "XSHA512"; return f.xsha512;
+        case FtpDigestAlgo::CRC32: command = "XCRC"; return f.xcrc;
+        default: return false;
+    }
+}
+
+FtpDigestPlan planFtpDigest(const FtpServerFeatures& features, const std::string& path,
+                            long long start, long long end, bool allowCrc) {
+    FtpDigestPlan plan;
+    if (path.empty() || path.find_first_of("\r\n") != std::string::npos) return plan;
+    bool ranged = start >= 0;
+    if (ranged && end <= start) return plan;
+
+    std::vector<FtpDigestAlgo> order = {FtpDigestAlgo::MD5, FtpDigestAlgo::SHA256, FtpDigestAlgo::SHA1, FtpDigestAlgo::SHA512};
+    if (allowCrc) order.push_back(FtpDigestAlgo::CRC32);
+
+    for (FtpDigestAlgo algo : order) {
+        // HASH: the whole rest of the line is the path, so spaces are fine
+        std::string name = hashFeatureName(algo);
+        if (features.hasHashAlgorithm(name) && (!ranged || features.rang)) {
+            if (features.hashSelected != name) plan.commands.push_back("OPTS HASH " + name);
+            // RANG takes inclusive positions
+            if (ranged) plan.commands.push_back("RANG " + std::to_string(start) + " " + std::to_string(end - 1));
+            plan.commands.push_back("HASH " + path);
+            plan.algo = algo;
+            return plan;
+        }
+
+        // XMD5 & co: "XMD5 path [start [end]]" - positions are separate arguments,
+        // so a path with spaces is only usable without a range
+        std::string command;
+        if (xCommandFor(features, algo, command)) {
+            if (ranged && path.find(' ') != std::string::npos) continue;
+            std::string line = command + " " + path;
+            if (ranged) line += " " + std::to_string(start) + " " + std::to_string(end);
+            plan.commands.push_back(line);
+            plan.algo = algo;
+            return plan;
+        }
+    }
+    return plan;
+}
+
+static bool isHexToken(const std::string& token, size_t length) {
+    if (token.size() != length) return false;
+    return std::all_of(token.begin(), token.end(), [](unsigned char c) { return std::isxdigit(c); });
+}
+
+bool parseFtpDigestReply(const std::string& reply, FtpDigestAlgo algo, std::string& hex) {
+    size_t length = hexLength(algo);
+    if (length == 0) return false;
+
+    std::vector<std::string> lines;
+    std::istringstream iss(reply);
+    std::string line;
+    while (std::getline(iss, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        lines.push_back(line);
+    }
+
+    // HASH: "213 SHA-256 0-49 169cd222...dd file.bin"; XMD5: "250 3e25960a..." or "213 file 3e2596..."
+    for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+        const std::string& l = *it;
+        if (l.size() < 4 || l[0] != '2' || !std::isdigit((unsigned char)l[1]) || !std::isdigit((unsigned char)l[2])) continue;
+        std::istringstream tokens(l.substr(4));
+        std::string token;
+        while (tokens >> token) {
+            if (isHexToken(token, length)) {
+                hex = token;
+                std::transform(hex.begin(), hex.end(), hex.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::string ftpDigestKey(FtpDigestAlgo algo, const std::string& hex) {
+    if (algo == FtpDigestAlgo::MD5) return hex;
+    return std::string(ftpDigestName(algo)) + ":" + hex;
+}
@@ -0,0 +1,270 @@
+#include "ftp_handle_pool.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+
+// ============================================================================
+// Lease
+// ============================================================================
+
+FtpHandlePool::Lease::Lease(Lease&& other) noexcept {
+    *this = std::move(other);
+}
+
+FtpHandlePool::Lease& FtpHandlePool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_pool = other.m_pool;
+        m_handle = other.m_handle;
+        m_key = std::move(other.m_key);
+        m_broken = other.m_broken;
+        other.m_pool = nullptr;
+        other.m_handle = nullptr;
+    }
+    return *this;
+}
+
+CURLcode FtpHandlePool::Lease::perform() {
+    CURLcode res = curl_easy_perform(m_handle);
+    if (m_pool) {
+        m_pool->m_transfers++;
+        long newConnects = 0;
+        if (curl_easy_getinfo(m_handle, CURLINFO_NUM_CONNECTS, &newConnects) == CURLE_OK && newConnects == 0 && res == CURLE_OK) {
+            m_pool->m_connReused++;
+        }
+    }
+    // Timeouts/aborts leave the control connection in an undefined state
+    if (res == CURLE_OPERATION_TIMEDOUT || res == CURLE_WRITE_ERROR || res == CURLE_ABORTED_BY_CALLBACK ||
+        res == CURLE_COULDNT_CONNECT || res == CURLE_LOGIN_DENIED || res == CURLE_SEND_ERROR || res == CURLE_RECV_ERROR) {
+        m_broken = true;
+    }
+    return res;
+}
+
+void FtpHandlePool::Lease::release() {
+    if (m_pool && m_handle) {
+        m_pool->giveBack(m_key, m_handle, m_broken);
+    }
+    m_pool = nullptr;
+    m_handle = nullptr;
+    m_broken = false;
+}
+
+// ============================================================================
+// Pool
+// ============================================================================
+
+FtpHandlePool::~FtpHandlePool() {
+    clear();
+}
+
+void FtpHandlePool::setMaxConnectionsPerServer(int maxConnections) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxPerServer = std::max(1, maxConnections);
+    m_released.notify_all();
+}
+
+void FtpHandlePool::setServerBudget(const std::string& server, int maxConnections, long long maxBytesPerSec) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Budget& budget = m_budgets[server];
+    budget.maxConnections = std::max(0, maxConnections);
+    budget.maxBytesPerSec = std::max(0LL, maxBytesPerSec);
+    m_released.notify_all();
+}
+
+void FtpHandlePool::clearServerBudgets() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budgets.clear();
+    m_released.notify_all();
+}
+
+// key = serverKey + "\n" + user
+int FtpHandlePool::limitForLocked(const std::string& key) const {
+    if (m_budgets.empty()) return m_maxPerServer;
+    auto it = m_budgets.find(key.substr(0, key.find('\n')));
+    if (it == m_budgets.end() || it->second.maxConnections <= 0) return m_maxPerServer;
+    return std::min(m_maxPerServer, it->second.maxConnections);
+}
+
+void FtpHandlePool::setHandleSetup(std::function<void(CURL*)> setup) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_setup = std::move(setup);
+}
+
+void FtpHandlePool::setReuseConnections(bool reuse) {
+    m_reuse = reuse;
+    if (!reuse) clear();
+}
+
+// "ftp://host:21/some/path" -> "ftp://host:21"
+std::string FtpHandlePool::serverKey(const std::string& url) {
+    size_t schemeEnd = url.find("://");
+    size_t hostStart = (schemeEnd == std::string::npos) ? 0 : schemeEnd + 3;
+    size_t pathStart = url.find('/', hostStart);
+    return url.substr(0, pathStart);
+}
+
+bool FtpHandlePool::isAlive(CURL* handle) {
+    curl_socket_t sock = CURL_SOCKET_BAD;
+    if (curl_easy_getinfo(handle, CURLINFO_ACTIVESOCKET, &sock) != CURLE_OK || sock == CURL_SOCKET_BAD) {
+        return true; // No open connection - curl will simply connect again
+    }
+
+    // An idle FTP control connection must be silent. Readable means EOF or an
+    // unsolicited reply such as "421 Timeout" - both mean the server dropped us.
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 0) == 0) return true;
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) return false;
+    char byte;
+    ssize_t n = recv(sock, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+FtpHandlePool::Lease FtpHandlePool::acquire(const std::string& url, const std::string& username,
+                                            const std::string& password, std::chrono::milliseconds timeout) {
+    Lease lease;
+    std::string key = serverKey(url) + "\n" + username;
+    std::thread::id self = std::this_thread::get_id();
+    CURL* handle = nullptr;
+    bool created = false;
+    std::function<void(CURL*)> setup;
+    long long maxRecvSpeed = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        Server& server = m_servers[key];
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        while (true) {
+            evictIdleLocked(std::chrono::steady_clock::now());
+            if (!server.idle.empty()) {
+                // Prefer the handle this thread used last (warm connection, warm caches)
+                auto it = std::find_if(server.idle.begin(), server.idle.end(),
+                                       [&](const IdleHandle& h) { return h.lastThread == self; });
+                if (it == server.idle.end()) it = server.idle.end() - 1;
+                handle = it->handle;
+                server.idle.erase(it);
+                break;
+            }
+            if (server.inUse < limitForLocked(key)) {
+                break; // create below, outside the lock
+            }
+            if (m_released.wait_until(lock, deadline) == std::cv_status::timeout) {
+                std::cerr << "[FTP Pool] Timeout waiting for a free connection to " << serverKey(url) << std::endl;
+                return lease;
+            }
+        }
+        server.inUse++;
+        setup = m_setup;
+        auto budget = m_budgets.find(serverKey(url));
+        if (budget != m_budgets.end() && budget->second.maxBytesPerSec > 0) {
+            maxRecvSpeed = budget->second.maxBytesPerSec / limitForLocked(key);
+        }
+    }
+
+    if (handle && !isAlive(handle)) {
+        m_healthFailures++;
+        curl_easy_cleanup(handle);
+        handle = nullptr;
+    }
+    if (!handle) {
+        handle = curl_easy_init();
+        created = true;
+        if (!handle) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_servers[key].inUse--;
+            m_released.notify_one();
+            return lease;
+        }
+    } else {
+        // Keeps the live connection, DNS and TLS session caches; only options are cleared
+        curl_easy_reset(handle);
+    }
+
+    m_acquires++;
+    if (created) m_created++; else m_reused++;
+
+    if (setup) setup(handle);
+    curl_easy_setopt(handle, CURLOPT_USERNAME, username.c_str());
+    curl_easy_setopt(handle, CURLOPT_PASSWORD, password.c_str());
+    if (maxRecvSpeed > 0) curl_easy_setopt(handle, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)maxRecvSpeed);
+
+    lease.m_pool = this;
+    lease.m_handle = handle;
+    lease.m_key = std::move(key);
+    return lease;
+}
+
+void FtpHandlePool::giveBack(const std::string& key, CURL* handle, bool broken) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Server& server = m_servers[key];
+        server.inUse--;
+        if (!broken && m_reuse && (int)(server.idle.size() + server.inUse) < limitForLocked(key)) {
+            server.idle.push_back({handle, std::this_thread::get_id(), std::chrono::steady_clock::now()});
+            handle = nullptr;
+        }
+        m_released.notify_one();
+    }
+    if (handle) curl_easy_cleanup(handle);
+}
+
+void FtpHandlePool::evictIdleLocked(std::chrono::steady_clock::time_point now) {
+    for (auto& [key, server] : m_servers) {
+        auto& idle = server.idle;
+        for (auto it = idle.begin(); it != idle.end();) {
+            if (now - it->releasedAt > m_idleTimeout) {
+                curl_easy_cleanup(it->handle);
+                it = idle.erase(it);
+                m_idleEvictions++;
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void FtpHandlePool::evictIdle() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    evictIdleLocked(std::chrono::steady_clock::now());
+}
+
+void FtpHandlePool::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [key, server] : m_servers) {
+        for (auto& h : server.idle) curl_easy_cleanup(h.handle);
+        server.idle.clear();
+    }
+}
+
+FtpHandlePool::Stats FtpHandlePool::stats() {
+    Stats s;
+    s.acquires = m_acquires;
+    s.handlesCreated = m_created;
+    s.handlesReused = m_reused;
+    s.transfers = m_transfers;
+    s.connectionsReused = m_connReused;
+    s.healthCheckFailures = m_healthFailures;
+    s.idleEvictions = m_idleEvictions;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [key, server] : m_servers) {
+        s.idle += server.idle.size();
+        s.inUse += server.inUse;
+    }
+    return s;
+}
+
+void FtpHandlePool::resetStats() {
+    m_acquires = 0;
+    m_created = 0;
+    m_reused = 0;
+    m_transfers = 0;
+    m_connReused = 0;
+    m_healthFailures = 0;
+    m_idleEvictions = 0;
+}
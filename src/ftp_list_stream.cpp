@@ -0,0 +1,212 @@
+#include "ftp_list_stream.h"
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+static constexpr size_t kMaxLineLength = 64 * 1024;   // Longer "lines" are garbage, not listings
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static bool allDigits(std::string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!std::isdigit((unsigned char)c)) return false;
+    }
+    return true;
+}
+
+static bool parseSize(std::string_view s, long long& value) {
+    if (!allDigits(s)) return false;
+    auto result = std::from_chars(s.data(), s.data() + s.size(), value);
+    return result.ec == std::errc() && result.ptr == s.data() + s.size();
+}
+
+// Split off the next whitespace separated token; end = position right after it
+static bool nextToken(std::string_view line, size_t& pos, std::string_view& token) {
+    while (pos < line.size() && isSpace(line[pos])) pos++;
+    if (pos >= line.size()) return false;
+    size_t start = pos;
+    while (pos < line.size() && !isSpace(line[pos])) pos++;
+    token = line.substr(start, pos - start);
+    return true;
+}
+
+// "01-15-24" or "01-15-2024"
+static bool isDosDate(std::string_view s) {
+    if (s.size() != 8 && s.size() != 10) return false;
+    for (size_t i = 0; i < s.size(); i++) {
+        bool sep = (i == 2 || i == 5);
+        if (sep ? (s[i] != '-' && s[i] != '/') : !std::isdigit((unsigned char)s[i])) return false;
+    }
+    return true;
+}
+
+// "03:04PM", "15:04"
+static bool isDosTime(std::string_view s) {
+    if (s.size() < 5 || s[2] != ':') return false;
+    if (!std::isdigit((unsigned char)s[0]) || !std::isdigit((unsigned char)s[1]) ||
+        !std::isdigit((unsigned char)s[3]) || !std::isdigit((unsigned char)s[4])) return false;
+    std::string_view suffix = s.substr(5);
+    return suffix.empty() || suffix == "AM" || suffix == "PM" || suffix == "am" || suffix == "pm";
+}
+
+static bool parseDosLine(std::string_view line, FtpListEntry& out) {
+    size_t pos = 0;
+    std::string_view date, time, sizeOrDir;
+    if (!nextToken(line, pos, date) || !isDosDate(date)) return false;
+    if (!nextToken(line, pos, time) || !isDosTime(time)) return false;
+    if (!nextToken(line, pos, sizeOrDir)) return false;
+    while (pos < line.size() && isSpace(line[pos])) pos++;
+    if (pos >= line.size()) return false;
+    out.name = line.substr(pos);
+
+    if (sizeOrDir == "<DIR>" || sizeOrDir == "<dir>") {
+        out.type = FtpListType::Dir;
+        out.size = -1;
+        return true;
+    }
+    if (!parseSize(sizeOrDir, out.size)) return false;
+    out.type = FtpListType::File;
+    return true;
+}
+
+// -rw-r--r--   1 owner group  2887197 Aug 21  2013 name with  spaces
+// -rw-r--r--   1 owner        2887197 Jul 12 06:49 name          (no group column)
+static bool parseUnixLine(std::string_view line, FtpListEntry& out) {
+    static const char* kTypes = "-dlcbps";
+    if (line.size() < 10 || !std::strchr(kTypes, line[0])) return false;
+
+    size_t pos = 0;
+    std::string_view tokens[9];
+    size_t ends[9];
+    int count = 0;
+    while (count < 9 && nextToken(line, pos, tokens[count])) {
+        ends[count] = pos;
+        count++;
+    }
+    if (count < 6 || tokens[0].size() < 10) return false;
+
+    // Size is the numeric column directly in front of "<month> <day> <time|year>"
+    for (int i = 1; i + 3 < count; i++) {
+        std::string_view month = tokens[i + 1], day = tokens[i + 2], when = tokens[i + 3];
+        if (!allDigits(tokens[i]) || allDigits(month) || month.size() < 3 || month.size() > 5) continue;
+        if (!allDigits(day) || day.size() > 2) continue;
+        bool isTime = when.find(':') != std::string_view::npos;
+        if (!isTime && !(allDigits(when) && when.size() == 4)) continue;
+
+        // Name: everything after the single separator following the time/year column
+        size_t nameStart = ends[i + 3] + 1;
+        if (nameStart >= line.size()) return false;
+        std::string_view name = line.substr(nameStart);
+        if (!parseSize(tokens[i], out.size)) return false;
+
+        if (line[0] == '-') {
+            out.type = FtpListType::File;
+        } else if (line[0] == 'd') {
+            out.type = FtpListType::Dir;
+        } else {
+            out.type = FtpListType::Other;
+            // Symlinks: "name -> target"
+            size_t arrow = name.find(" -> ");
+            if (arrow != std::string_view::npos) name = name.substr(0, arrow);
+        }
+        out.name = name;
+        return true;
+    }
+    return false;
+}
+
+bool parseFtpListLine(std::string_view line, FtpListEntry& out) {
+    out = FtpListEntry();
+    if (line.empty()) return false;
+    if (std::isdigit((unsigned char)line[0])) return parseDosLine(line, out);
+    return parseUnixLine(line, out);
+}
+
+static std::string_view stripSlashes(std::string_view s) {
+    while (!s.empty() && s.front() == '/') s.remove_prefix(1);
+    while (!s.empty() && s.back() == '/') s.remove_suffix(1);
+    return s;
+}
+
+FtpListRParser::FtpListRParser(EntryCallback onEntry, const std::string& root)
+    : m_onEntry(std::move(onEntry)), m_root(stripSlashes(root)) {}
+
+void FtpListRParser::feed(const char* data, size_t len) {
+    std::string_view chunk(data, len);
+    size_t start = 0;
+
+    if (!m_partial.empty()) {
+        size_t nl = chunk.find('\n');
+        if (nl == std::string_view::npos) {
+            if (m_partial.size() + len <= kMaxLineLength) m_partial.append(data, len);
+            return;
+        }
+        m_partial.append(data, nl);
+        processLine(m_partial);
+        m_partial.clear();
+        start = nl + 1;
+    }
+
+    while (start < chunk.size()) {
+        size_t nl = chunk.find('\n', start);
+        if (nl == std::string_view::npos) {
+            if (chunk.size() - start <= kMaxLineLength) m_partial.assign(data + start, chunk.size() - start);
+            return;
+        }
+        processLine(chunk.substr(start, nl - start));
+        start = nl + 1;
+    }
+}
+
+void FtpListRParser::finish() {
+    if (!m_partial.empty()) {
+        std::string last;
+        last.swap(m_partial);
+        processLine(last);
+    }
+}
+
+void FtpListRParser::enterDirectory(std::string_view header) {
+    m_headers++;
+    std::string_view dir = header;
+    if (dir == ".") {
+        dir = {};
+    } else if (dir.size() >= 2 && dir.substr(0, 2) == "./") {
+        dir.remove_prefix(2);
+    } else if (!dir.empty() && dir.front() == '/') {
+        // Absolute header: make it relative to the listed directory
+        dir = stripSlashes(dir);
+        if (!m_root.empty() && dir.substr(0, m_root.size()) == m_root &&
+            (dir.size() == m_root.size() || dir[m_root.size()] == '/')) {
+            dir.remove_prefix(m_root.size());
+        }
+    }
+    m_currentDir.assign(stripSlashes(dir));
+}
+
+void FtpListRParser::processLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.empty()) return;
+    m_lines++;
+
+    FtpListEntry entry;
+    if (!parseFtpListLine(line, entry)) {
+        if (line.size() > 6 && line.substr(0, 6) == "total " && allDigits(line.substr(6))) return;
+        if (line.back() == ':') enterDirectory(line.substr(0, line.size() - 1));
+        return;
+    }
+    if (entry.type == FtpListType::Other) return;
+    if (entry.name == "." || entry.name == "..") return;
+
+    entry.dir = m_currentDir;
+    if (entry.type == FtpListType::File) {
+        m_files++;
+    } else {
+        m_dirs++;
+        if (m_currentDir.empty()) m_rootDirs++;
+    }
+    if (m_onEntry) m_onEntry(entry);
+}
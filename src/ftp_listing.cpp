@@ -0,0 +1,185 @@
+#include "ftp_listing.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+static std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return s;
+}
+
+static std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+bool FtpServerFeatures::hasFact(const std::string& fact) const {
+    return std::find(mlstFacts.begin(), mlstFacts.end(), fact) != mlstFacts.end();
+}
+
+bool FtpServerFeatures::factEnabled(const std::string& fact) const {
+    return std::find(mlstEnabled.begin(), mlstEnabled.end(), fact) != mlstEnabled.end();
+}
+
+bool FtpServerFeatures::hasHashAlgorithm(const std::string& algorithm) const {
+    return std::find(hashAlgorithms.begin(), hashAlgorithms.end(), algorithm) != hashAlgorithms.end();
+}
+
+FtpServerFeatures parseFeatResponse(const std::string& response) {
+    FtpServerFeatures features;
+    std::istringstream iss(response);
+    std::string line;
+    bool inFeat = false;
+
+    // The response may also contain the login dialogue (banner, 331, 230, PWD...);
+    // features are only the lines between "211-" and "211 ".
+    while (std::getline(iss, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.compare(0, 4, "211-") == 0) {
+            inFeat = true;
+            features.probed = true;
+            continue;
+        }
+        if (line.compare(0, 4, "211 ") == 0) {
+            features.probed = true;
+            inFeat = false;
+            continue;
+        }
+        if (!inFeat) continue;
+        std::string feature = trim(line);
+        if (feature.empty()) continue;
+        features.features.push_back(feature);
+
+        std::string name = toLower(feature.substr(0, feature.find(' ')));
+        if (name == "size") {
+            features.size = true;
+        } else if (name == "mdtm") {
+            features.mdtm = true;
+        } else if (name == "rang") {
+            features.rang = true;
+        } else if (name == "xmd5") {
+            features.xmd5 = true;
+        } else if (name == "xsha1" || name == "xsha") {
+            features.xsha1 = true;
+        } else if (name == "xsha256") {
+            features.xsha256 = true;
+        } else if (name == "xsha512") {
+            features.xsha512 = true;
+        } else if (name == "xcrc") {
+            features.xcrc = true;
+        } else if (name == "hash") {
+            // HASH SHA-256;SHA-1*;MD5;CRC32
+            size_t space = feature.find(' ');
+            if (space == std::string::npos) continue;
+            std::istringstream algos(feature.substr(space + 1));
+            std::string algo;
+            while (std::getline(algos, algo, ';')) {
+                algo = trim(algo);
+                if (algo.empty()) continue;
+                bool selected = algo.back() == '*';
+                if (selected) algo.pop_back();
+                std::transform(algo.begin(), algo.end(), algo.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+                if (!features.hasHashAlgorithm(algo)) features.hashAlgorithms.push_back(algo);
+                if (selected) features.hashSelected = algo;
+            }
+        } else if (name == "mlst" || name == "mlsd") {
+            features.mlsd = true;
+            size_t space = feature.find(' ');
+            if (space == std::string::npos) continue;
+            std::istringstream facts(feature.substr(space + 1));
+            std::string fact;
+            while (std::getline(facts, fact, ';')) {
+                fact = toLower(trim(fact));
+                if (fact.empty()) continue;
+                bool enabled = fact.back() == '*';
+                if (enabled) fact.pop_back();
+                if (!features.hasFact(fact)) features.mlstFacts.push_back(fact);
+                if (enabled && !features.factEnabled(fact)) features.mlstEnabled.push_back(fact);
+            }
+        }
+    }
+    return features;
+}
+
+time_t parseMlsdTime(const std::string& value) {
+    if (value.size() < 14) return 0;
+    for (int i = 0; i < 14; i++) {
+        if (!std::isdigit((unsigned char)value[i])) return 0;
+    }
+    struct tm tm = {};
+    tm.tm_year = std::atoi(value.substr(0, 4).c_str()) - 1900;
+    tm.tm_mon = std::atoi(value.substr(4, 2).c_str()) - 1;
+    tm.tm_mday = std::atoi(value.substr(6, 2).c_str());
+    tm.tm_hour = std::atoi(value.substr(8, 2).c_str());
+    tm.tm_min = std::atoi(value.substr(10, 2).c_str());
+    tm.tm_sec = std::atoi(value.substr(12, 2).c_str());
+    if (tm.tm_mon < 0 || tm.tm_mon > 11 || tm.tm_mday < 1 || tm.tm_mday > 31) return 0;
+    return timegm(&tm);
+}
+
+bool parseMlsdLine(const std::string& rawLine, FtpFacts& out) {
+    out = FtpFacts();
+    std::string line = rawLine;
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) line.pop_back();
+
+    // Facts end at the first "; " - the name after it may contain ';' and spaces.
+    // MLST replies indent the entry line with one space.
+    size_t start = (!line.empty() && line[0] == ' ') ? 1 : 0;
+    size_t sep = line.find("; ", start);
+    if (sep == std::string::npos) {
+        // No facts at all: " name"
+        if (start == 1 && line.size() > 1) {
+            out.name = line.substr(1);
+            return true;
+        }
+        return false;
+    }
+    out.name = line.substr(sep + 2);
+    if (out.name.empty()) return false;
+
+    std::string facts = line.substr(start, sep - start + 1);
+    size_t pos = 0;
+    while (pos < facts.size()) {
+        size_t end = facts.find(';', pos);
+        if (end == std::string::npos) end = facts.size();
+        std::string fact = facts.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t eq = fact.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = toLower(fact.substr(0, eq));
+        std::string value = fact.substr(eq + 1);
+
+        if (key == "type") {
+            std::string type = toLower(value);
+            out.isFile = (type == "file");
+            out.isDir = (type == "dir");
+            // OS.unix=slink:/target and friends are neither file nor dir for our purposes
+        } else if (key == "size" || (key == "sizd" && out.size < 0)) {
+            char* endp = nullptr;
+            long long size = std::strtoll(value.c_str(), &endp, 10);
+            if (endp && *endp == '\0' && size >= 0) out.size = size;
+        } else if (key == "modify") {
+            out.modify = parseMlsdTime(value);
+        } else if (key == "unique") {
+            out.unique = value;
+        }
+    }
+    return true;
+}
+
+std::string mlstOptsCommand(const FtpServerFeatures& features) {
+    if (!features.mlsd) return "";
+    static const char* wanted[] = {"type", "size", "modify", "unique"};
+    std::string facts;
+    bool missing = false;
+    for (const char* fact : wanted) {
+        if (!features.hasFact(fact)) continue;
+        facts += std::string(fact) + ";";
+        if (!features.factEnabled(fact)) missing = true;
+    }
+    return missing ? "OPTS MLST " + facts : "";
+}
@@ -0,0 +1,527 @@
+#include "ftp_multi_engine.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+// Per-transfer worker backlog: pause the transfer above HIGH, resume below LOW
+static const size_t BACKLOG_HIGH = 8 * 1024 * 1024;
+static const size_t BACKLOG_LOW = 2 * 1024 * 1024;
+
+struct FtpMultiEngine::Transfer {
+    uint64_t id = 0;
+    std::string server;
+    FtpTransferRequest request;
+    Completion onDone;
+    FtpTransferResult result;
+    FtpMultiEngine* engine = nullptr;
+    Worker* worker = nullptr;
+    CURL* easy = nullptr;                 // Event thread only
+    curl_slist* quote = nullptr;          // Event thread only
+    long long maxRecvSpeed = 0;           // Bandwidth share from the server budget (bytes/s)
+    std::atomic<size_t> backlog{0};
+    std::atomic<bool> paused{false};
+};
+
+static std::string serverOf(const std::string& url) {
+    size_t schemeEnd = url.find("://");
+    size_t hostStart = (schemeEnd == std::string::npos) ? 0 : schemeEnd + 3;
+    return url.substr(0, url.find('/', hostStart));
+}
+
+FtpMultiEngine::~FtpMultiEngine() {
+    stop();
+}
+
+bool FtpMultiEngine::start(int workerThreads, int maxPerServer, int maxTotal) {
+    if (m_running) return true;
+
+    m_multi = curl_multi_init();
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!m_multi || m_epollFd < 0 || m_wakeFd < 0) {
+        std::cerr << "[FTP Multi] Initialization failed" << std::endl;
+        if (m_multi) curl_multi_cleanup(m_multi);
+        if (m_epollFd >= 0) close(m_epollFd);
+        if (m_wakeFd >= 0) close(m_wakeFd);
+        m_multi = nullptr;
+        m_epollFd = m_wakeFd = -1;
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev);
+
+    curl_multi_setopt(m_multi, CURLMOPT_SOCKETFUNCTION, socketCallback);
+    curl_multi_setopt(m_multi, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(m_multi, CURLMOPT_TIMERFUNCTION, timerCallback);
+    curl_multi_setopt(m_multi, CURLMOPT_TIMERDATA, this);
+    setLimits(maxPerServer, maxTotal);
+
+    m_running = true;
+    m_cancel = false;
+    int workers = std::max(1, workerThreads);
+    for (int i = 0; i < workers; i++) {
+        m_workers.emplace_back(new Worker());
+        Worker* w = m_workers.back().get();
+        w->thread = std::thread([this, w]() { workerLoop(w); });
+    }
+    m_eventThread = std::thread([this]() { eventLoop(); });
+
+    std::cout << "[FTP Multi] Engine started (" << workers << " workers, " << m_maxPerServer
+              << " per server, " << m_maxTotal << " total)" << std::endl;
+    return true;
+}
+
+void FtpMultiEngine::stop() {
+    if (!m_running) return;
+
+    cancelAll();
+    waitIdle();
+
+    m_running = false;
+    wake();
+    if (m_eventThread.joinable()) m_eventThread.join();
+    for (auto& w : m_workers) {
+        { std::lock_guard<std::mutex> lock(w->mutex); }
+        w->cv.notify_all();
+        if (w->thread.joinable()) w->thread.join();
+    }
+    m_workers.clear();
+
+    for (CURL* easy : m_freeHandles) curl_easy_cleanup(easy);
+    m_freeHandles.clear();
+    curl_multi_cleanup(m_multi);
+    m_multi = nullptr;
+    close(m_epollFd);
+    close(m_wakeFd);
+    m_epollFd = m_wakeFd = -1;
+}
+
+void FtpMultiEngine::setLimits(int maxPerServer, int maxTotal) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_maxPerServer = std::max(1, maxPerServer);
+        m_maxTotal = std::max(m_maxPerServer, maxTotal);
+    }
+    if (m_multi && !m_running) {
+        curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)m_maxPerServer);
+        curl_multi_setopt(m_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)m_maxTotal);
+    }
+    wake();
+}
+
+void FtpMultiEngine::setServerBudget(const std::string& server, int maxConnections, long long maxBytesPerSec) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ServerBudget& budget = m_budgets[server];
+        budget.maxConnections = std::max(0, maxConnections);
+        budget.maxBytesPerSec = std::max(0LL, maxBytesPerSec);
+    }
+    wake();
+}
+
+void FtpMultiEngine::clearServerBudgets() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budgets.clear();
+    }
+    wake();
+}
+
+void FtpMultiEngine::submit(FtpTransferRequest request, Completion onDone) {
+    auto transfer = std::make_shared<Transfer>();
+    transfer->id = m_nextId++;
+    transfer->server = serverOf(request.url);
+    transfer->request = std::move(request);
+    transfer->onDone = std::move(onDone);
+    transfer->engine = this;
+
+    if (!m_running) {
+        transfer->result.code = CURLE_FAILED_INIT;
+        if (transfer->onDone) transfer->onDone(transfer->result);
+        return;
+    }
+    transfer->worker = m_workers[transfer->id % m_workers.size()].get();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_outstanding++;
+        m_incoming.push_back(std::move(transfer));
+    }
+    m_submitted++;
+    m_queuedCount++;
+    wake();
+}
+
+void FtpMultiEngine::cancelAll() {
+    m_cancel = true;
+    wake();
+}
+
+void FtpMultiEngine::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCv.wait(lock, [this]() { return m_outstanding == 0; });
+}
+
+bool FtpMultiEngine::waitIdleFor(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_idleCv.wait_for(lock, timeout, [this]() { return m_outstanding == 0; });
+}
+
+FtpMultiEngine::Stats FtpMultiEngine::stats() {
+    Stats s;
+    s.submitted = m_submitted;
+    s.completed = m_completed;
+    s.failed = m_failed;
+    s.pauses = m_pauses;
+    s.bytes = m_bytes;
+    s.active = m_activeCount;
+    s.queued = m_queuedCount;
+    return s;
+}
+
+void FtpMultiEngine::wake() {
+    if (m_wakeFd < 0) return;
+    uint64_t one = 1;
+    ssize_t ignored = write(m_wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+// ============================================================================
+// curl callbacks (event thread)
+// ============================================================================
+
+int FtpMultiEngine::socketCallback(CURL*, curl_socket_t s, int what, void* userp, void* socketp) {
+    FtpMultiEngine* self = static_cast<FtpMultiEngine*>(userp);
+    if (what == CURL_POLL_REMOVE) {
+        epoll_ctl(self->m_epollFd, EPOLL_CTL_DEL, s, nullptr);
+        curl_multi_assign(self->m_multi, s, nullptr);
+        return 0;
+    }
+
+    struct epoll_event ev = {};
+    ev.data.fd = s;
+    if (what & CURL_POLL_IN) ev.events |= EPOLLIN;
+    if (what & CURL_POLL_OUT) ev.events |= EPOLLOUT;
+
+    if (!socketp) {
+        if (epoll_ctl(self->m_epollFd, EPOLL_CTL_ADD, s, &ev) != 0 && errno == EEXIST) {
+            epoll_ctl(self->m_epollFd, EPOLL_CTL_MOD, s, &ev);
+        }
+        curl_multi_assign(self->m_multi, s, self); // Any non-null marker: socket is registered
+    } else {
+        epoll_ctl(self->m_epollFd, EPOLL_CTL_MOD, s, &ev);
+    }
+    return 0;
+}
+
+int FtpMultiEngine::timerCallback(CURLM*, long timeoutMs, void* userp) {
+    FtpMultiEngine* self = static_cast<FtpMultiEngine*>(userp);
+    if (timeoutMs < 0) {
+        self->m_timerDeadline = std::chrono::steady_clock::time_point::max();
+    } else {
+        self->m_timerDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+    return 0;
+}
+
+// Server replies are small; collected on the event thread, read by the worker after completion
+size_t FtpMultiEngine::headerCallback(char* ptr, size_t size, size_t nmemb, void* userp) {
+    Transfer* t = static_cast<Transfer*>(userp);
+    t->result.headers.append(ptr, size * nmemb);
+    return size * nmemb;
+}
+
+size_t FtpMultiEngine::writeCallback(char* ptr, size_t size, size_t nmemb, void* userp) {
+    Transfer* t = static_cast<Transfer*>(userp);
+    size_t len = size * nmemb;
+
+    if (t->request.onData) {
+        // Backpressure: the worker is behind, stop reading from this socket for now
+        if (t->backlog.load() >= BACKLOG_HIGH) {
+            t->paused.store(true);
+            if (t->backlog.load() >= BACKLOG_HIGH) {
+                t->engine->m_pauses++;
+                return CURL_WRITEFUNC_PAUSE;
+            }
+            t->paused.store(false);
+        }
+        t->backlog += len;
+        Work work;
+        work.chunk.assign(ptr, len);
+        t->engine->enqueueWork(t->engine->m_active.at(t->easy), std::move(work));
+    }
+    if (t->request.collectBody) {
+        t->result.body.append(ptr, len);
+    }
+    t->result.bytes += len;
+    t->engine->m_bytes += len;
+    return len;
+}
+
+// ============================================================================
+// Event loop
+// ============================================================================
+
+void FtpMultiEngine::eventLoop() {
+    std::vector<struct epoll_event> events(256);
+    int running = 0;
+
+    while (m_running) {
+        auto now = std::chrono::steady_clock::now();
+        int waitMs = 1000;
+        if (m_timerDeadline != std::chrono::steady_clock::time_point::max()) {
+            auto until = std::chrono::duration_cast<std::chrono::milliseconds>(m_timerDeadline - now).count();
+            waitMs = (int)std::max<long long>(0, std::min<long long>(until, 1000));
+        }
+
+        int n = epoll_wait(m_epollFd, events.data(), (int)events.size(), waitMs);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "[FTP Multi] epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == m_wakeFd) {
+                uint64_t value;
+                while (read(m_wakeFd, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+            int flags = 0;
+            if (events[i].events & EPOLLIN) flags |= CURL_CSELECT_IN;
+            if (events[i].events & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+            curl_multi_socket_action(m_multi, fd, flags, &running);
+        }
+
+        if (std::chrono::steady_clock::now() >= m_timerDeadline) {
+            m_timerDeadline = std::chrono::steady_clock::time_point::max();
+            curl_multi_socket_action(m_multi, CURL_SOCKET_TIMEOUT, 0, &running);
+        }
+
+        // Requests from other threads
+        std::deque<std::shared_ptr<Transfer>> incoming;
+        std::vector<std::shared_ptr<Transfer>> resume;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            incoming.swap(m_incoming);
+            resume.swap(m_resume);
+        }
+        for (auto& t : incoming) {
+            m_pending[t->server].push_back(std::move(t));
+        }
+        for (auto& t : resume) {
+            if (t->easy) curl_easy_pause(t->easy, CURLPAUSE_CONT);
+        }
+
+        if (m_cancel.exchange(false)) {
+            for (auto& [server, queue] : m_pending) {
+                for (auto& t : queue) {
+                    t->result.code = CURLE_ABORTED_BY_CALLBACK;
+                    m_queuedCount--;
+                    m_failed++;
+                    Work work;
+                    work.done = true;
+                    enqueueWork(t, std::move(work));
+                }
+                queue.clear();
+            }
+            std::vector<CURL*> active;
+            for (const auto& entry : m_active) active.push_back(entry.first);
+            for (CURL* easy : active) finishTransfer(easy, CURLE_ABORTED_BY_CALLBACK);
+        }
+
+        drainCompleted();
+        admitPending();
+    }
+}
+
+void FtpMultiEngine::admitPending() {
+    int maxPerServer, maxTotal;
+    std::unordered_map<std::string, ServerBudget> budgets;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        maxPerServer = m_maxPerServer;
+        maxTotal = m_maxTotal;
+        if (!m_budgets.empty()) budgets = m_budgets;
+    }
+    auto serverLimit = [&](const std::string& server) {
+        auto it = budgets.find(server);
+        if (it == budgets.end() || it->second.maxConnections <= 0) return maxPerServer;
+        return std::min(maxPerServer, it->second.maxConnections);
+    };
+
+    // Round-robin over servers so one huge queue cannot starve the others
+    bool progress = true;
+    while (progress && (int)m_active.size() < maxTotal) {
+        progress = false;
+        for (auto& [server, queue] : m_pending) {
+            if (queue.empty() || m_activePerServer[server] >= serverLimit(server)) continue;
+            if ((int)m_active.size() >= maxTotal) break;
+            std::shared_ptr<Transfer> t = std::move(queue.front());
+            queue.pop_front();
+            m_queuedCount--;
+            auto budget = budgets.find(server);
+            if (budget != budgets.end() && budget->second.maxBytesPerSec > 0) {
+                t->maxRecvSpeed = budget->second.maxBytesPerSec / serverLimit(server);
+            }
+            startTransfer(std::move(t));
+            progress = true;
+        }
+    }
+}
+
+void FtpMultiEngine::startTransfer(std::shared_ptr<Transfer> t) {
+    CURL* easy;
+    if (!m_freeHandles.empty()) {
+        easy = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+    }
+    if (!easy) {
+        t->result.code = CURLE_FAILED_INIT;
+        m_failed++;
+        Work work;
+        work.done = true;
+        enqueueWork(t, std::move(work));
+        return;
+    }
+
+    if (m_setup) m_setup(easy);
+    const FtpTransferRequest& req = t->request;
+    curl_easy_setopt(easy, CURLOPT_URL, req.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_USERNAME, req.username.c_str());
+    curl_easy_setopt(easy, CURLOPT_PASSWORD, req.password.c_str());
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, t.get());
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    if (req.timeoutSec > 0) curl_easy_setopt(easy, CURLOPT_TIMEOUT, req.timeoutSec);
+    if (!req.range.empty()) curl_easy_setopt(easy, CURLOPT_RANGE, req.range.c_str());
+    if (t->maxRecvSpeed > 0) curl_easy_setopt(easy, CURLOPT_MAX_RECV_SPEED_LARGE, (curl_off_t)t->maxRecvSpeed);
+    if (!req.customRequest.empty()) curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, req.customRequest.c_str());
+    if (req.noBody) curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+    if (req.collectHeaders) {
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, headerCallback);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, t.get());
+    }
+    if (!req.quote.empty()) {
+        for (const auto& cmd : req.quote) t->quote = curl_slist_append(t->quote, cmd.c_str());
+        curl_easy_setopt(easy, CURLOPT_QUOTE, t->quote);
+    }
+
+    t->easy = easy;
+    m_active[easy] = t;
+    m_activePerServer[t->server]++;
+    m_activeCount++;
+    curl_multi_add_handle(m_multi, easy);
+}
+
+void FtpMultiEngine::drainCompleted() {
+    int queued = 0;
+    CURLMsg* msg;
+    while ((msg = curl_multi_info_read(m_multi, &queued)) != nullptr) {
+        if (msg->msg == CURLMSG_DONE) {
+            finishTransfer(msg->easy_handle, msg->data.result);
+        }
+    }
+}
+
+void FtpMultiEngine::finishTransfer(CURL* easy, CURLcode code) {
+    auto it = m_active.find(easy);
+    if (it == m_active.end()) return;
+    std::shared_ptr<Transfer> t = std::move(it->second);
+    m_active.erase(it);
+
+    curl_multi_remove_handle(m_multi, easy);
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &t->result.responseCode);
+    curl_off_t firstByteUs = 0, totalUs = 0;
+    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME_T, &firstByteUs);
+    curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &totalUs);
+    t->result.firstByteSec = firstByteUs / 1e6;
+    t->result.totalSec = totalUs / 1e6;
+    t->result.code = code;
+    t->easy = nullptr;
+    if (t->quote) {
+        curl_slist_free_all(t->quote);
+        t->quote = nullptr;
+    }
+    m_activePerServer[t->server]--;
+    m_activeCount--;
+    if (code == CURLE_OK) m_completed++; else m_failed++;
+
+    if ((int)m_freeHandles.size() < m_maxTotal && code == CURLE_OK) {
+        m_freeHandles.push_back(easy);
+    } else {
+        curl_easy_cleanup(easy);
+    }
+
+    Work work;
+    work.done = true;
+    enqueueWork(t, std::move(work));
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+
+void FtpMultiEngine::enqueueWork(const std::shared_ptr<Transfer>& transfer, Work work) {
+    Worker* w = transfer->worker;
+    work.transfer = transfer;
+    {
+        std::lock_guard<std::mutex> lock(w->mutex);
+        w->queue.push_back(std::move(work));
+    }
+    w->cv.notify_one();
+}
+
+void FtpMultiEngine::workerLoop(Worker* w) {
+    while (true) {
+        Work work;
+        {
+            std::unique_lock<std::mutex> lock(w->mutex);
+            w->cv.wait(lock, [&]() { return !w->queue.empty() || !m_running; });
+            if (w->queue.empty()) return;
+            work = std::move(w->queue.front());
+            w->queue.pop_front();
+        }
+        Transfer* t = work.transfer.get();
+
+        if (work.done) {
+            try {
+                if (t->onDone) t->onDone(t->result);
+            } catch (const std::exception& e) {
+                std::cerr << "[FTP Multi] Exception in completion for " << t->request.url << ": " << e.what() << std::endl;
+            }
+            transferFinishedOnWorker();
+            continue;
+        }
+
+        try {
+            t->request.onData(work.chunk.data(), work.chunk.size());
+        } catch (const std::exception& e) {
+            std::cerr << "[FTP Multi] Exception in data handler for " << t->request.url << ": " << e.what() << std::endl;
+        }
+        size_t remaining = (t->backlog -= work.chunk.size());
+        if (remaining < BACKLOG_LOW && t->paused.exchange(false)) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_resume.push_back(work.transfer);
+            }
+            wake();
+        }
+    }
+}
+
+void FtpMultiEngine::transferFinishedOnWorker() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_outstanding == 0) m_idleCv.notify_all();
+}
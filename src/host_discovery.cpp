@@ -0,0 +1,476 @@
+#include "host_discovery.h"
+#include "net_utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <ifaddrs.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <linux/if_arp.h>
+
+using SweepClock = std::chrono::steady_clock;
+
+namespace {
+
+const uint8_t ICMP_ECHO_REQUEST = 8;
+const uint8_t ICMP_ECHO_REPLY = 0;
+const int RAW_ICMP_FILTER = 1;           // SOL_RAW option from <linux/icmp.h> (clashes with netinet headers)
+const uint32_t PAYLOAD_MAGIC = 0x46445550; // "FDUP"
+const size_t ECHO_SIZE = 16;             // 8 header + magic + target index
+const size_t ARP_SIZE = 28;
+const int SEND_BATCH = 64;
+const size_t PING_WORKERS = 32;          // Parallel ping processes when no ICMP socket is permitted
+
+struct LocalInterface {
+    int index = 0;
+    uint32_t address = 0;
+    uint32_t mask = 0;
+    uint8_t mac[6] = {};
+    bool arpCapable = false;             // Ethernet-like, broadcast, not loopback
+};
+
+struct Target {
+    uint32_t address = 0;
+    int arpInterface = -1;               // Index into the interface list, -1 = ICMP
+    bool alive = false;
+};
+
+std::vector<LocalInterface> localInterfaces() {
+    std::vector<LocalInterface> interfaces;
+    struct ifaddrs* list = nullptr;
+    if (getifaddrs(&list) != 0) return interfaces;
+
+    // AF_PACKET entries carry ifindex and MAC, AF_INET entries the addresses
+    std::unordered_map<std::string, const struct sockaddr_ll*> links;
+    for (auto* entry = list; entry; entry = entry->ifa_next) {
+        if (entry->ifa_addr && entry->ifa_addr->sa_family == AF_PACKET) {
+            links[entry->ifa_name] = (const struct sockaddr_ll*)entry->ifa_addr;
+        }
+    }
+    for (auto* entry = list; entry; entry = entry->ifa_next) {
+        if (!entry->ifa_addr || entry->ifa_addr->sa_family != AF_INET || !entry->ifa_netmask) continue;
+        if (!(entry->ifa_flags & IFF_UP)) continue;
+        LocalInterface local;
+        local.address = ntohl(((const struct sockaddr_in*)entry->ifa_addr)->sin_addr.s_addr);
+        local.mask = ntohl(((const struct sockaddr_in*)entry->ifa_netmask)->sin_addr.s_addr);
+        auto link = links.find(entry->ifa_name);
+        if (link != links.end()) {
+            local.index = link->second->sll_ifindex;
+            if (link->second->sll_halen == 6) memcpy(local.mac, link->second->sll_addr, 6);
+            local.arpCapable = link->second->sll_halen == 6 && link->second->sll_hatype == ARPHRD_ETHER &&
+                               (entry->ifa_flags & IFF_BROADCAST) && !(entry->ifa_flags & IFF_LOOPBACK) &&
+                               !(entry->ifa_flags & IFF_NOARP);
+        }
+        interfaces.push_back(local);
+    }
+    freeifaddrs(list);
+    return interfaces;
+}
+
+uint16_t internetChecksum(const uint8_t* data, size_t length) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) sum += (data[i] << 8) | data[i + 1];
+    if (length & 1) sum += data[length - 1] << 8;
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+void putU16(uint8_t* out, uint16_t value) {
+    out[0] = value >> 8;
+    out[1] = value & 0xff;
+}
+
+void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (value >> (24 - 8 * i)) & 0xff;
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+std::string addressText(uint32_t address) {
+    struct in_addr in;
+    in.s_addr = htonl(address);
+    char buffer[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &in, buffer, sizeof(buffer));
+    return buffer;
+}
+
+std::string macText(const uint8_t* mac) {
+    char buffer[18];
+    snprintf(buffer, sizeof(buffer), "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return buffer;
+}
+
+// ICMP socket: unprivileged datagram socket first, raw socket (CAP_NET_RAW) second
+int openIcmpSocket(bool& raw) {
+    raw = false;
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+    if (fd < 0) {
+        fd = socket(AF_INET, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP);
+        if (fd < 0) return -1;
+        raw = true;
+        uint32_t filter = ~(1u << ICMP_ECHO_REPLY);   // Only echo replies
+        setsockopt(fd, SOL_RAW, RAW_ICMP_FILTER, &filter, sizeof(filter));
+    }
+    int buffer = 4 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    return fd;
+}
+
+// No ICMP socket: the ping binary (setuid or file capabilities) can still send echo requests.
+// Workers run one ping per target; answers are reported on the calling thread. False if ping can't run.
+bool pingFallback(const std::vector<Target>& targets, const std::vector<size_t>& indices, int timeoutMs,
+                  const std::function<void(size_t)>& onAlive, const std::function<bool()>& cancelled) {
+    std::string waitSeconds = std::to_string(std::max(1, (timeoutMs + 999) / 1000));
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> running{0};
+    std::atomic<bool> missing{false};
+    std::mutex answeredMutex;
+    std::vector<size_t> answered;
+    std::vector<std::thread> workers;
+    size_t workerCount = std::min(PING_WORKERS, indices.size());
+    running = workerCount;
+    for (size_t w = 0; w < workerCount; w++) {
+        workers.emplace_back([&]() {
+            while (!cancelled() && !missing) {
+                size_t i = next++;
+                if (i >= indices.size()) break;
+                std::string command = "ping -c 1 -n -W " + waitSeconds + " " + addressText(targets[indices[i]].address) +
+                                      " >/dev/null 2>&1";
+                int status = system(command.c_str());
+                if (status == -1 || (WIFEXITED(status) && WEXITSTATUS(status) == 127)) {
+                    missing = true;                 // Shell could not find ping
+                } else if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+                    std::lock_guard<std::mutex> lock(answeredMutex);
+                    answered.push_back(indices[i]);
+                }
+            }
+            running--;
+        });
+    }
+    auto report = [&]() {
+        std::vector<size_t> batch;
+        {
+            std::lock_guard<std::mutex> lock(answeredMutex);
+            batch.swap(answered);
+        }
+        for (size_t index : batch) onAlive(index);
+    };
+    while (running > 0) {
+        report();
+        usleep(20000);
+    }
+    for (auto& worker : workers) worker.join();
+    report();
+    return !missing;
+}
+
+HostSweepStats runSweep(std::vector<Target>& targets, const HostSweepOptions& options,
+                        const SweepHostCallback& onHost, const std::atomic<bool>* cancel) {
+    HostSweepStats stats;
+    auto started = SweepClock::now();
+    stats.targets = targets.size();
+    auto cancelled = [cancel]() { return cancel && cancel->load(); };
+
+    std::unordered_map<uint32_t, size_t> byAddress;
+    byAddress.reserve(targets.size());
+    for (size_t i = 0; i < targets.size(); i++) byAddress[targets[i].address] = i;
+
+    auto markAlive = [&](size_t index, const std::string& method, const std::string& mac) {
+        Target& target = targets[index];
+        if (target.alive) return;
+        target.alive = true;
+        stats.alive++;
+        if (onHost && !cancelled()) onHost({addressText(target.address), mac, method});
+    };
+
+    // Own addresses answer themselves; on-link targets get ARP when AF_PACKET is permitted
+    std::vector<LocalInterface> interfaces = localInterfaces();
+    int arpFd = -1;
+    if (options.useArp) {
+        arpFd = socket(AF_PACKET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, htons(ETH_P_ARP));
+        stats.arpAvailable = arpFd >= 0;
+    }
+    for (size_t i = 0; i < targets.size(); i++) {
+        for (size_t j = 0; j < interfaces.size(); j++) {
+            const LocalInterface& local = interfaces[j];
+            if (targets[i].address == local.address) {
+                markAlive(i, "local", "");
+                break;
+            }
+            if (arpFd >= 0 && local.arpCapable && (targets[i].address & local.mask) == (local.address & local.mask)) {
+                targets[i].arpInterface = (int)j;
+            }
+        }
+    }
+
+    bool icmpRaw = false;
+    int icmpFd = options.useIcmp ? openIcmpSocket(icmpRaw) : -1;
+    stats.icmpAvailable = icmpFd >= 0;
+    uint16_t echoId = (uint16_t)(std::random_device()() & 0xffff);
+
+    auto receive = [&]() {
+        uint8_t buffer[1500];
+        if (icmpFd >= 0) {
+            while (true) {
+                struct sockaddr_in from = {};
+                socklen_t fromLength = sizeof(from);
+                ssize_t n = recvfrom(icmpFd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+                if (n <= 0) break;
+                const uint8_t* icmp = buffer;
+                size_t length = (size_t)n;
+                if (icmpRaw) {
+                    size_t headerLength = (buffer[0] & 0x0f) * 4;   // Raw sockets deliver the IP header
+                    if (length < headerLength) continue;
+                    icmp += headerLength;
+                    length -= headerLength;
+                }
+                if (length < ECHO_SIZE || icmp[0] != ICMP_ECHO_REPLY) continue;
+                // Datagram sockets rewrite the id to their port, raw sockets see every reply
+                if (icmpRaw && ((icmp[4] << 8) | icmp[5]) != echoId) continue;
+                if (getU32(icmp + 8) != PAYLOAD_MAGIC) continue;
+                auto it = byAddress.find(ntohl(from.sin_addr.s_addr));
+                if (it != byAddress.end()) markAlive(it->second, "icmp", "");
+            }
+        }
+        if (arpFd >= 0) {
+            while (true) {
+                struct sockaddr_ll from = {};
+                socklen_t fromLength = sizeof(from);
+                ssize_t n = recvfrom(arpFd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+                if (n <= 0) break;
+                if (from.sll_pkttype == PACKET_OUTGOING || n < (ssize_t)ARP_SIZE) continue;
+                // Ethernet/IPv4 ARP; a request from a target proves it is up just as well as a reply
+                if (buffer[0] != 0 || buffer[1] != 1 || buffer[2] != 0x08 || buffer[3] != 0x00) continue;
+                auto it = byAddress.find(getU32(buffer + 14));
+                if (it != byAddress.end()) markAlive(it->second, "arp", macText(buffer + 8));
+            }
+        }
+    };
+
+    auto waitForReplies = [&](int milliseconds) {
+        struct pollfd fds[2];
+        int count = 0;
+        if (icmpFd >= 0) fds[count++] = {icmpFd, POLLIN, 0};
+        if (arpFd >= 0) fds[count++] = {arpFd, POLLIN, 0};
+        if (count == 0) {
+            usleep(milliseconds * 1000);
+            return;
+        }
+        if (poll(fds, count, milliseconds) > 0) receive();
+    };
+
+    std::vector<uint8_t> packets(SEND_BATCH * ARP_SIZE);
+    std::vector<struct sockaddr_in> icmpAddresses(SEND_BATCH);
+    std::vector<struct sockaddr_ll> arpAddresses(SEND_BATCH);
+    std::vector<struct iovec> vectors(SEND_BATCH);
+    std::vector<struct mmsghdr> messages(SEND_BATCH);
+
+    // Sends targets[pending[from..]] of one kind (ARP or ICMP) in one sendmmsg; returns how many were handled
+    auto sendBatch = [&](const std::vector<size_t>& pending, size_t from, size_t limit, bool arp, int round) -> size_t {
+        int fd = arp ? arpFd : icmpFd;
+        size_t count = 0;
+        while (count < limit && from + count < pending.size() && count < (size_t)SEND_BATCH) {
+            const Target& target = targets[pending[from + count]];
+            if ((target.arpInterface >= 0) != arp) break;
+            uint8_t* packet = packets.data() + count * ARP_SIZE;
+            memset(packet, 0, ARP_SIZE);
+            struct mmsghdr& message = messages[count];
+            memset(&message, 0, sizeof(message));
+            if (arp) {
+                const LocalInterface& local = interfaces[target.arpInterface];
+                putU16(packet, 1);                  // Ethernet
+                putU16(packet + 2, 0x0800);         // IPv4
+                packet[4] = 6;
+                packet[5] = 4;
+                putU16(packet + 6, 1);              // Request
+                memcpy(packet + 8, local.mac, 6);
+                putU32(packet + 14, local.address);
+                putU32(packet + 24, target.address);
+                struct sockaddr_ll& address = arpAddresses[count];
+                memset(&address, 0, sizeof(address));
+                address.sll_family = AF_PACKET;
+                address.sll_protocol = htons(ETH_P_ARP);
+                address.sll_ifindex = local.index;
+                address.sll_halen = 6;
+                memset(address.sll_addr, 0xff, 6);
+                vectors[count] = {packet, ARP_SIZE};
+                message.msg_hdr.msg_name = &address;
+                message.msg_hdr.msg_namelen = sizeof(address);
+            } else {
+                packet[0] = ICMP_ECHO_REQUEST;
+                putU16(packet + 4, echoId);
+                putU16(packet + 6, (uint16_t)round);
+                putU32(packet + 8, PAYLOAD_MAGIC);
+                putU32(packet + 12, (uint32_t)pending[from + count]);
+                putU16(packet + 2, internetChecksum(packet, ECHO_SIZE));
+                struct sockaddr_in& address = icmpAddresses[count];
+                memset(&address, 0, sizeof(address));
+                address.sin_family = AF_INET;
+                address.sin_addr.s_addr = htonl(target.address);
+                vectors[count] = {packet, ECHO_SIZE};
+                message.msg_hdr.msg_name = &address;
+                message.msg_hdr.msg_namelen = sizeof(address);
+            }
+            message.msg_hdr.msg_iov = &vectors[count];
+            message.msg_hdr.msg_iovlen = 1;
+            count++;
+        }
+        if (count == 0) return 0;
+        int sent = sendmmsg(fd, messages.data(), (unsigned int)count, 0);
+        if (sent > 0) {
+            stats.requests += sent;
+            return sent;
+        }
+        if (errno == EAGAIN || errno == ENOBUFS || errno == EINTR) {
+            waitForReplies(1);                      // Queue full: let it drain
+            return 0;
+        }
+        return 1;                                   // This target can't be reached (EHOSTUNREACH, ...)
+    };
+
+    double tokens = SEND_BATCH;
+    auto lastRefill = SweepClock::now();
+    int attempts = std::max(1, options.attempts);
+    for (int round = 0; round < attempts && !cancelled(); round++) {
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < targets.size(); i++) {
+            if (targets[i].alive) continue;
+            if (targets[i].arpInterface < 0 && icmpFd < 0) continue;
+            pending.push_back(i);
+        }
+        if (pending.empty()) break;
+
+        size_t next = 0;
+        while (next < pending.size() && !cancelled()) {
+            size_t limit = SEND_BATCH;
+            if (options.ratePerSecond > 0) {
+                auto now = SweepClock::now();
+                tokens = std::min<double>(tokens + std::chrono::duration<double>(now - lastRefill).count() * options.ratePerSecond,
+                                          std::max(SEND_BATCH, options.ratePerSecond / 20));
+                lastRefill = now;
+                if (tokens < 1) {
+                    waitForReplies(std::max(1, 1000 / options.ratePerSecond));
+                    continue;
+                }
+                limit = std::min<size_t>(limit, (size_t)tokens);
+            }
+            bool arp = targets[pending[next]].arpInterface >= 0;
+            size_t handled = sendBatch(pending, next, limit, arp, round);
+            next += handled;
+            if (options.ratePerSecond > 0) tokens -= handled;
+            receive();
+        }
+
+        auto deadline = SweepClock::now() + std::chrono::milliseconds(std::max(1, options.timeoutMs));
+        while (!cancelled() && stats.alive < targets.size()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - SweepClock::now()).count();
+            if (remaining <= 0) break;
+            waitForReplies((int)std::min<long long>(remaining, 50));
+        }
+    }
+
+    // Off-link targets were skipped above without an ICMP socket; don't report them as down silently
+    if (options.useIcmp && icmpFd < 0 && !cancelled()) {
+        std::vector<size_t> offLink;
+        for (size_t i = 0; i < targets.size(); i++) {
+            if (!targets[i].alive && targets[i].arpInterface < 0) offLink.push_back(i);
+        }
+        if (!offLink.empty()) {
+            std::cout << "[HostSweep] No ICMP socket permitted (CAP_NET_RAW/ping_group_range), pinging "
+                      << offLink.size() << " hosts with the ping binary" << std::endl;
+            stats.pingFallback = true;
+            bool pinged = pingFallback(targets, offLink, options.timeoutMs,
+                                       [&](size_t index) { markAlive(index, "ping", ""); }, cancelled);
+            stats.requests += offLink.size();
+            if (!pinged) {
+                stats.error = "ICMP unavailable: no ICMP socket permitted and no ping binary";
+                std::cerr << "[HostSweep] " << stats.error << " - hosts outside the local Ethernet subnets are not found"
+                          << std::endl;
+            }
+        }
+    }
+
+    if (icmpFd >= 0) close(icmpFd);
+    if (arpFd >= 0) close(arpFd);
+    stats.seconds = std::chrono::duration<double>(SweepClock::now() - started).count();
+    return stats;
+}
+
+} // namespace
+
+HostSweepStats sweepHostRange(uint32_t first, uint32_t last, const HostSweepOptions& options,
+                              const SweepHostCallback& onHost, const std::atomic<bool>* cancel) {
+    if (last < first) return HostSweepStats();
+    std::vector<Target> targets((size_t)(last - first) + 1);
+    for (size_t i = 0; i < targets.size(); i++) targets[i].address = first + (uint32_t)i;
+    return runSweep(targets, options, onHost, cancel);
+}
+
+HostSweepStats sweepHostList(const std::vector<std::string>& hosts, const HostSweepOptions& options,
+                             const SweepHostCallback& onHost, const std::atomic<bool>* cancel) {
+    std::vector<Target> targets;
+    for (const auto& host : hosts) {
+        struct in_addr in;
+        if (inet_pton(AF_INET, host.c_str(), &in) != 1) continue;
+        Target target;
+        target.address = ntohl(in.s_addr);
+        targets.push_back(target);
+    }
+    return runSweep(targets, options, onHost, cancel);
+}
+
+std::vector<std::string> sweepSubnet(const std::string& subnet, const HostSweepOptions& options,
+                                     const std::atomic<bool>* cancel, HostSweepStats* statsOut) {
+    std::vector<std::string> hosts;
+    uint32_t first = 0, last = 0;
+    if (!cidrToRange(normalizeSubnet(subnet), first, last)) return hosts;
+    std::vector<uint32_t> alive;
+    HostSweepStats stats = sweepHostRange(first, last, options, [&](const SweepHost& host) {
+        struct in_addr in;
+        inet_pton(AF_INET, host.ip.c_str(), &in);
+        alive.push_back(ntohl(in.s_addr));
+    }, cancel);
+    std::sort(alive.begin(), alive.end());
+    for (uint32_t address : alive) hosts.push_back(addressText(address));
+    std::cout << "[HostSweep] " << subnet << ": " << hosts.size() << "/" << stats.targets << " hosts alive, "
+              << stats.requests << " requests in " << stats.seconds << " s"
+              << (stats.arpAvailable ? " (ARP" : " (no ARP")
+              << (stats.icmpAvailable ? ", ICMP)" : stats.pingFallback && stats.error.empty() ? ", ping)" : ", no ICMP)")
+              << std::endl;
+    if (statsOut) *statsOut = stats;
+    return hosts;
+}
+
+bool icmpPing(const std::string& host, int timeoutMs) {
+    std::string address = host;
+    struct in_addr in;
+    if (inet_pton(AF_INET, host.c_str(), &in) != 1) {
+        struct addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        struct addrinfo* result = nullptr;
+        if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) return false;
+        address = addressText(ntohl(((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr));
+        freeaddrinfo(result);
+    }
+    HostSweepOptions options;
+    options.timeoutMs = timeoutMs;
+    options.attempts = 1;
+    return sweepHostList({address}, options, nullptr).alive > 0;
+}
@@ -0,0 +1,220 @@
+#include "http_backend.h"
+#include <algorithm>
+#include <iostream>
+
+HttpBackend::HttpBackend(const char* tag, int maxConnections) : m_tag(tag) {
+    m_multi = curl_multi_init();
+    curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)std::max(1, maxConnections));
+}
+
+HttpBackend::~HttpBackend() {
+    for (Transfer* transfer : m_transfers) {
+        curl_multi_remove_handle(m_multi, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        curl_slist_free_all(transfer->headers);
+        delete transfer;
+    }
+    for (CURL* easy : m_idle) curl_easy_cleanup(easy);
+    curl_multi_cleanup(m_multi);
+    for (Handle* handle : m_handles) delete handle;
+}
+
+bool HttpBackend::open(const std::string& path, OpenCallback cb) {
+    // Nothing to open over HTTP; the handle carries the path for the range GETs
+    Handle* handle = new Handle{path};
+    m_handles.insert(handle);
+    defer([cb, handle]() { cb(0, handle); });
+    return true;
+}
+
+bool HttpBackend::pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) {
+    Request request;
+    request.path = ((Handle*)handle)->path;
+    request.headers.push_back("Range: bytes=" + std::to_string(offset) + "-" + std::to_string(offset + count - 1));
+    Transfer* transfer = prepare(request);
+    if (!transfer) return false;
+    transfer->isRead = true;
+    transfer->offset = offset;
+    transfer->count = count;
+    transfer->readCb = std::move(cb);
+    transfer->body.reserve(count);
+    if (curl_multi_add_handle(m_multi, transfer->easy) != CURLM_OK) {
+        release(transfer, true);
+        return false;
+    }
+    m_transfers.insert(transfer);
+    return true;
+}
+
+void HttpBackend::close(void* handle) {
+    m_handles.erase((Handle*)handle);
+    delete (Handle*)handle;
+}
+
+bool HttpBackend::service(int timeoutMs) {
+    if (!m_deferred.empty()) {
+        std::deque<std::function<void()>> ready;
+        ready.swap(m_deferred);
+        for (auto& callback : ready) callback();
+        return true;
+    }
+    int running = 0;
+    if (curl_multi_perform(m_multi, &running) != CURLM_OK) return false;
+    if (curl_multi_poll(m_multi, nullptr, 0, timeoutMs, nullptr) != CURLM_OK) return false;
+    if (curl_multi_perform(m_multi, &running) != CURLM_OK) return false;
+
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(m_multi, &queued)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        Transfer* transfer = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&transfer);
+        CURLcode result = msg->data.result;
+        curl_multi_remove_handle(m_multi, transfer->easy);
+        m_transfers.erase(transfer);
+        finish(transfer, result);
+    }
+    return true;
+}
+
+bool HttpBackend::send(Request request, DoneCallback done) {
+    Transfer* transfer = prepare(request);
+    if (!transfer) return false;
+    transfer->done = std::move(done);
+    if (curl_multi_add_handle(m_multi, transfer->easy) != CURLM_OK) {
+        release(transfer, true);
+        return false;
+    }
+    m_transfers.insert(transfer);
+    return true;
+}
+
+long HttpBackend::perform(Request request, std::string& body) {
+    Transfer* transfer = prepare(request);
+    if (!transfer) return 0;
+    CURLcode result = curl_easy_perform(transfer->easy);
+    long code = 0;
+    curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &code);
+    if (result != CURLE_OK) {
+        m_lastError = curl_easy_strerror(result);
+        code = 0;
+    }
+    body = std::move(transfer->body);
+    release(transfer, true);
+    return code;
+}
+
+void HttpBackend::defer(std::function<void()> callback) {
+    m_deferred.push_back(std::move(callback));
+}
+
+CURL* HttpBackend::takeEasy() {
+    CURL* easy;
+    if (!m_idle.empty()) {
+        // Keeps connection and negotiated auth scheme
+        easy = m_idle.back();
+        m_idle.pop_back();
+        curl_easy_reset(easy);
+    } else {
+        easy = curl_easy_init();
+        if (!easy) return nullptr;
+    }
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, 10L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    return easy;
+}
+
+HttpBackend::Transfer* HttpBackend::prepare(Request& request) {
+    CURL* easy = takeEasy();
+    if (!easy) {
+        m_lastError = "curl_easy_init failed";
+        return nullptr;
+    }
+    authorize(request, easy);
+    Transfer* transfer = new Transfer;
+    transfer->owner = this;
+    transfer->easy = easy;
+    transfer->path = request.path;
+    transfer->requestBody = std::move(request.body);
+    for (const auto& header : request.headers) transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+
+    std::string url = requestUrl(request);
+    curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &HttpBackend::onData);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer);
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+    if (request.method == "HEAD") {
+        curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+    } else if (request.method != "GET") {
+        curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+        if (!transfer->requestBody.empty()) {
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, transfer->requestBody.c_str());
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, (long)transfer->requestBody.size());
+        }
+    }
+    return transfer;
+}
+
+void HttpBackend::release(Transfer* transfer, bool reuseHandle) {
+    // An aborted download leaves the handle's connection unusable
+    if (reuseHandle) m_idle.push_back(transfer->easy);
+    else curl_easy_cleanup(transfer->easy);
+    curl_slist_free_all(transfer->headers);
+    delete transfer;
+}
+
+size_t HttpBackend::onData(char* data, size_t size, size_t nmemb, void* userp) {
+    Transfer* transfer = (Transfer*)userp;
+    size_t len = size * nmemb;
+    if (!transfer->isRead) {
+        transfer->body.append(data, len);
+        return len;
+    }
+    if (transfer->received == 0) {
+        long code = 0;
+        curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &code);
+        if (code >= 300) return len;          // Error page, not file data
+        transfer->full = code == 200;
+        if (transfer->full && !transfer->owner->m_rangeIgnoredLogged) {
+            transfer->owner->m_rangeIgnoredLogged = true;
+            std::cout << "[" << transfer->owner->m_tag << "] Server ignores Range - reading from the start of each file" << std::endl;
+        }
+    }
+    // 200: skip to offset, keep count bytes, then stop the download
+    uint64_t start = transfer->full ? transfer->offset : 0;
+    uint64_t begin = std::max(start, transfer->received);
+    uint64_t end = std::min(start + transfer->count, transfer->received + len);
+    if (end > begin) transfer->body.append(data + (begin - transfer->received), (size_t)(end - begin));
+    transfer->received += len;
+    if (transfer->full && transfer->body.size() >= transfer->count) return 0;
+    return len;
+}
+
+void HttpBackend::finish(Transfer* transfer, CURLcode result) {
+    long code = 0;
+    curl_easy_getinfo(transfer->easy, CURLINFO_RESPONSE_CODE, &code);
+    bool aborted = result == CURLE_WRITE_ERROR && transfer->isRead && transfer->body.size() >= transfer->count;
+    if (result != CURLE_OK && !aborted) {
+        m_lastError = curl_easy_strerror(result);
+        code = 0;
+    }
+    std::string body = std::move(transfer->body);
+    DoneCallback done = std::move(transfer->done);
+    ReadCallback readCb = std::move(transfer->readCb);
+    bool isRead = transfer->isRead;
+    std::string path = transfer->path;
+    release(transfer, result == CURLE_OK);
+
+    if (!isRead) {
+        done(code, std::move(body));
+    } else if (code >= 200 && code < 300) {
+        readCb((int)body.size(), body.data(), body.size());
+    } else {
+        if (code) m_lastError = "HTTP " + std::to_string(code) + " for " + path;
+        readCb(-1, nullptr, 0);
+    }
+}
@@ -3,6 +3,24 @@
 
 #define GLFW_EXPOSE_NATIVE_X11
 #include "tree_view.h"
+#include "dir_listing_cache.h"
+#include "stat_prefetch.h"
+#include "scan_snapshot.h"
+#include "sharded_cache.h"
+#include "ftp_handle_pool.h"
+#include "ftp_multi_engine.h"
+#include "ftp_listing.h"
+#include "ftp_digest.h"
+#include "ftp_list_stream.h"
+#include "remote_bandwidth.h"
+#include "remote_hash_planner.h"
+#include "ftp_batch_delete.h"
+#include "nfs_async_engine.h"
+#include "smbclient.h"
+#include "sftpclient.h"
+#include "webdav_client.h"
+#include "s3_client.h"
+#include "nfs_mount_rpc.h"
 #include <GLFW/glfw3.h>
 #include <GLFW/glfw3native.h>
 #include "imgui.h"
@@ -195,6 +213,10 @@ struct FtpPreset {
     std::string password;
     std::vector<std::string> directories; // Discovered directories
     
+    // Budget im Multi-Server-Scan (FTP)
+    int maxConnections = 0;     // Gleichzeitige Verbindungen zu diesem Server (0 = ftpMaxConnections)
+    int bandwidthLimitKB = 0;   // Bandbreitenanteil in KB/s (0 = unbegrenzt)
+    
     // NFS-specific fields
     std::string nfsExportPath; // z.B. "/export/data"
     std::string nfsMountPoint; // z.B. "/mnt/nfs_server1"
@@ -220,8 +242,19 @@ struct FtpPreset {
     bool davUseSSL = true; // HTTPS vs HTTP
     bool davAutoMount = false; // Auto-mount beim Start
     bool davMounted = false; // Aktueller Mount-Status
+    
+    // S3-specific fields (Benutzername = Access Key, Passwort = Secret Key)
+    std::string s3Region = "us-east-1"; // Signatur-Region, MinIO: us-east-1
+    bool s3UseSSL = false; // HTTPS vs HTTP
 };
 
+// Origin of a preset's files and scan entries ("ftp://host:port")
+static std::string ftpPresetBaseUrl(const FtpPreset& preset) {
+    std::string scheme = preset.serviceType == "SFTP" ? "sftp://" : "ftp://";
+    if (preset.serviceType == "S3") scheme = preset.s3UseSSL ? "s3s://" : "s3://";
+    return scheme + preset.ip + ":" + std::to_string(preset.port);
+}
+
 // Subnet Scan Preset
 struct SubnetPreset {
     std::string name;           // z.B. "Büro Netzwerk"
@@ -393,6 +426,8 @@ struct AppState {
     
     // Network bandwidth tracking for FTP
     std::atomic<long long> ftpBytesTransferred{0};
+    std::atomic<long long> ftpBytesSaved{0};   // Not transferred thanks to samples, server checksums, hash cache
+    std::string remoteHashPlan;                // Summary of the remote hash plan (resultsMutex)
     std::chrono::steady_clock::time_point ftpScanStartTime;
     std::atomic<bool> scanThreadRunning{false};
     
@@ -424,6 +459,7 @@ struct AppState {
     bool showSaveStateDialog = false;
     bool showLoadStateDialog = false;
     char saveStateFilename[256] = "scan_state.fds"; // FileDuper Scan State
+    int snapshotPage = 0;            // Seite in der mmap-Ansicht eines geladenen Snapshots
     
     // Status notifications (NEW)
     std::string statusNotification = "";
@@ -434,6 +470,11 @@ struct AppState {
     int threadCount = 8; // Erhöht von 4 auf 8 für bessere Multi-Core Nutzung
     int scannerThreads = 128; // Lightning Speed: Anzahl paralleler IP-Scans (erhöht für mehr Speed)
     int scanTimeout = 1; // Timeout in Sekunden pro Host
+    int portScanTimeoutMs = 300;    // Port-Scan: Timeout pro Verbindungsversuch (alle gleichzeitig, epoll)
+    int portScanMaxInFlight = 4096; // Port-Scan: gleichzeitig offene Verbindungsversuche
+    int portScanRate = 0;           // Port-Scan: neue Verbindungen pro Sekunde (0 = unbegrenzt)
+    int discoveryServiceTtlMinutes = 60; // Gefundene Dienste so lange wiederverwenden (Host/MAC unverändert)
+    bool useServiceDiscovery = true;     // mDNS/DNS-SD + SSDP: angekündigte Dateiserver ohne Port-Scan listen
     bool useLightningSpeed = true;
     bool useArpDiscovery = true; // Use ARP-based discovery by default
     // ICMP discovery is automatic (used when ARP returns no hosts)
@@ -465,6 +506,11 @@ struct AppState {
     int batchScanSize = 20;          // Erhöht von 10 auf 20 - mehr Batch-Scans
     bool autoTuneThreads = true;     // Auto-Thread-Anzahl basierend auf CPU - AKTIVIERT
     bool cacheFileHashes = true;     // Hash-Cache für bekannte Dateien
+    bool useDirListingCache = true;  // Unveränderte Verzeichnisse (mtime) ohne readdir() aus Cache lesen
+    bool nfsStatPrefetch = true;     // Netzwerk-Mounts (NFS/SMB): Einträge eines Verzeichnisses parallel stat()en
+    int nfsStatPrefetchThreads = 32; // Threads im Prefetch-Pool (= gleichzeitige GETATTR/LOOKUP pro Verzeichnis)
+    bool nfsStatDontSync = false;    // AT_STATX_DONT_SYNC: leicht veraltete Attribute aus dem Client-Cache akzeptieren
+    int cacheMemoryLimitMB = 1024;   // Speicherbudget für Stat-/Hash-/Datei-Cache zusammen
     bool skipEmptyFiles = true;      // Leere Dateien überspringen
     bool smartTimeout = true;        // Adaptiver Timeout basierend auf Netzwerk
     
@@ -488,7 +534,15 @@ struct AppState {
     bool ftpSkipFailedFiles = true;  // Überspringe Dateien nach max. Retries (sonst ewig hängen)
     int ftpMaxConnections = 8;       // Max. parallele FTP-Verbindungen pro Server (8 = schnell, 1 = langsam)
     bool ftpReuseConnections = true; // Wiederverwendung von FTP-Verbindungen (SEHR schnell!)
-    int ftpMinFileSize = 100;        // Min. Dateigröße für FTP-Hash (Bytes) - kleinere werden übersprungen (zu viel Overhead)
+    int ftpMinFileSize = 100;        // Veraltet (nur noch im Settings-Format): ersetzt durch den Stichproben-Vorfilter
+    bool ftpUseMultiEngine = true;   // LIST/RETR über curl_multi + epoll statt ein Thread pro Transfer
+    int ftpMultiMaxTransfers = 128;  // Max. gleichzeitige Transfers der Multi-Engine (alle Server)
+    float remoteBandwidthLimitMB = 0.0f; // Gesamtbandbreite aller Remote-Transfers in MB/s (0 = unbegrenzt)
+    bool ftpUseMlsd = true;          // MLSD statt LIST wenn der Server es per FEAT anbietet (exakte Größe + mtime)
+    bool ftpUseServerHash = true;    // Prüfsumme vom Server (HASH/XMD5/XSHA256) statt Datei herunterzuladen
+    bool ftpSamplePrefilter = true;  // Erst Anfang+Ende laden, nur bei gleicher Stichprobe komplett übertragen
+    bool sshRemoteHash = true;       // SFTP: md5sum per SSH exec auf dem Server statt Datei zu übertragen
+    int ftpSampleKB = 64;            // Stichprobengröße je Ende (KB)
     
     // FTP/Network Optimierungen (ftpConnectTimeout is declared above in FTP Scan Optimization Settings)
     int ftpMaxRetries = 3;           // FTP Verbindungs-Wiederholungen
@@ -534,8 +588,10 @@ struct PairHash {
     }
 };
 
-static std::unordered_map<std::pair<ino_t, time_t>, std::string, PairHash> hashCache;
-static std::mutex hashCacheMutex;
+// Sharded + bounded (CLOCK eviction), see sharded_cache.h; budgets are set by applyCacheBudgets()
+static ShardedCache<std::pair<ino_t, time_t>, std::string, PairHash> hashCache(
+    256ull << 20, 64,
+    [](const std::pair<ino_t, time_t>&, const std::string& hash) { return sizeof(std::string) + hash.capacity() + 64; });
 
 // FILE CACHE: Store file listings (local + FTP) to accelerate subsequent scans
 // Key: Full file path (local: /path/to/file, FTP: ftp://host:port/path/to/file)
@@ -546,8 +602,11 @@ struct CachedFileInfo {
     ino_t inode;      // 0 for FTP files (they don't have inodes)
     std::string hash; // Optional - filled during hash calculation
 };
-static std::map<std::string, CachedFileInfo> fileCache; // Combined local + FTP cache
-static std::mutex fileCacheMutex;
+static ShardedCache<std::string, CachedFileInfo> fileCache( // Combined local + FTP cache
+    512ull << 20, 64,
+    [](const std::string& path, const CachedFileInfo& info) {
+        return sizeof(std::string) + path.capacity() + sizeof(CachedFileInfo) + info.hash.capacity() + 64;
+    });
 static std::string localCacheFilePath = "local_cache.dat";
 static std::string ftpCacheFilePath = "ftp_cache.dat";
 
@@ -557,6 +616,13 @@ static std::mutex dirCacheMutex;
 static std::string dirCacheFilePath = "directory_cache.dat";
 static time_t dirCacheTimestamp = 0;
 
+// DIRECTORY LISTING CACHE: readdir() results keyed by directory mtime/ctime (incremental rescans)
+static DirListingCache dirListingCache;
+static std::string dirListingCacheFilePath = "dir_listing_cache.dat";
+
+// NFS METADATA PREFETCH: concurrent statx() of a directory's entries on network mounts
+static StatPrefetchPool statPrefetchPool;
+
 // FTP DIRECTORY CACHE: Store FTP server directory trees
 struct FTPDirCacheEntry {
     std::string path;
@@ -574,6 +640,10 @@ static std::string treeStateFilePath = "tree_state.dat";
 
 static std::mutex resultsMutex;
 
+// SCAN SNAPSHOTS (.fds v2): mmap view of a loaded result + background writer
+static ScanSnapshotView loadedSnapshot;   // Guarded by resultsMutex
+static ScanSnapshotWriter snapshotWriter;
+
 // STAT CACHE: Cache file stat() results for NFS acceleration (100-500ms per call)
 // Reduces repeated stat() calls on mounted NFS filesystems
 struct StatCacheEntry {
@@ -582,37 +652,112 @@ struct StatCacheEntry {
     long st_mtime_sec; // Simplified: use long instead of time_t struct
     time_t cacheTime;
 };
-static std::unordered_map<std::string, StatCacheEntry> statCache;
-static std::mutex statCacheMutex;
+static ShardedCache<std::string, StatCacheEntry> statCache(
+    128ull << 20, 64,
+    [](const std::string& path, const StatCacheEntry&) { return sizeof(std::string) + path.capacity() + sizeof(StatCacheEntry) + 64; });
 static const int STAT_CACHE_TTL = 30; // Cache validity: 30 seconds
 
 // Wrapper for stat() with NFS caching
 inline int stat_cached(const std::string& path, struct stat* buf) {
     auto now = std::time(nullptr);
     
-    // Fast path: check cache
-    {
-        std::lock_guard<std::mutex> lock(statCacheMutex);
-        auto it = statCache.find(path);
-        if (it != statCache.end() && (now - it->second.cacheTime) < STAT_CACHE_TTL) {
-            buf->st_mode = it->second.st_mode;
-            buf->st_size = it->second.st_size;
-            buf->st_mtime = it->second.st_mtime_sec;
-            return 0; // Cache hit
-        }
+    // Fast path: check cache (shared lock on one shard only)
+    StatCacheEntry cached;
+    if (statCache.getIf(path, cached, [now](const StatCacheEntry& e) { return (now - e.cacheTime) < STAT_CACHE_TTL; })) {
+        buf->st_mode = cached.st_mode;
+        buf->st_size = cached.st_size;
+        buf->st_mtime = cached.st_mtime_sec;
+        return 0; // Cache hit
     }
     
     // Slow path: actual stat() call
     int result = stat(path.c_str(), buf);
     if (result == 0) {
-        std::lock_guard<std::mutex> lock(statCacheMutex);
-        statCache[path] = {buf->st_mode, buf->st_size, buf->st_mtime, now};
+        statCache.put(path, {buf->st_mode, buf->st_size, buf->st_mtime, now});
     }
     return result;
 }
 
+// Split the cache memory budget: file metadata is the largest, stat entries expire anyway
+void applyCacheBudgets() {
+    size_t total = (size_t)std::max(64, appState.cacheMemoryLimitMB) << 20;
+    statCache.setBudget(total / 8);
+    hashCache.setBudget(total / 4);
+    fileCache.setBudget(total - total / 8 - total / 4);
+}
+
+void logCacheStats() {
+    auto log = [](const char* name, auto stats) {
+        std::cout << "[Cache] " << name << ": " << stats.entries << " entries, "
+                  << (stats.bytes >> 20) << "/" << (stats.budget >> 20) << " MB, "
+                  << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.evictions << " evictions" << std::endl;
+    };
+    log("stat", statCache.stats());
+    log("hash", hashCache.stats());
+    log("file", fileCache.stats());
+}
+
 // CURL Connection Pooling für FTP-Performance
 static CURLSH* curlShareHandle = nullptr;
+static FtpHandlePool ftpHandlePool; // Reusable easy handles per server+user (keeps FTP logins alive)
+static FtpMultiEngine ftpMultiEngine; // Event-driven LIST/RETR engine (hundreds of transfers, few threads)
+// Global WAN budget for all remote transfers (remoteBandwidthLimitMB, live) + measured link quality per server
+static TokenBucket remoteBandwidth;
+static RemoteThroughputTracker remoteThroughput;
+
+static void throttleRemote(size_t bytes) {
+    remoteBandwidth.consume(bytes);
+}
+
+static void applyRemoteBandwidthLimit() {
+    remoteBandwidth.setRate(std::max(0.0f, appState.remoteBandwidthLimitMB) * 1024.0 * 1024.0);
+}
+
+// Per-transfer share of the global budget (0 = unlimited). The budget is split across all
+// remote transfers at once: pooled easy handles in use, the multi engine's running and queued
+// transfers (up to its total limit, all servers) and the transfer that asks.
+static double remoteRateShare() {
+    double rate = remoteBandwidth.rate();
+    if (rate <= 0) return 0.0;
+    long long concurrent = 1 + (long long)ftpHandlePool.stats().inUse;
+    if (ftpMultiEngine.isRunning()) {
+        FtpMultiEngine::Stats engine = ftpMultiEngine.stats();
+        concurrent += std::min<long long>(engine.active + engine.queued, std::max(1, appState.ftpMultiMaxTransfers));
+    }
+    return rate / concurrent;
+}
+
+static void recordRemoteTiming(const std::string& url, long long bytes, double firstByteSec, double totalSec) {
+    if (totalSec <= 0) return;
+    remoteThroughput.record(FtpHandlePool::serverKey(url), bytes, totalSec - firstByteSec, firstByteSec);
+}
+
+static void recordRemoteTiming(const std::string& url, CURL* curl) {
+    curl_off_t bytes = 0, firstByteUs = 0, totalUs = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &bytes);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &firstByteUs);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &totalUs);
+    recordRemoteTiming(url, (long long)bytes, firstByteUs / 1e6, totalUs / 1e6);
+}
+
+// FTP SERVER FEATURES: FEAT reply per server+user (MLSD/MLST support), probed once per session
+static std::unordered_map<std::string, FtpServerFeatures> ftpServerFeatures;
+static std::mutex ftpServerFeaturesMutex;
+// MLSD unique facts of directories already listed in this scan (symlink loops)
+static std::set<std::string> ftpSeenDirIds;
+static std::mutex ftpSeenDirIdsMutex;
+// Remote hash cache statistics (FTP hashes reused from fileCache instead of downloading)
+static std::atomic<int> ftpHashCacheHits{0};
+static std::atomic<long long> ftpHashCacheBytesSaved{0};
+// Server-side checksums (HASH / XMD5 & co): consecutive failures per server, digests received
+static std::map<std::string, int> ftpDigestFailures;
+static std::mutex ftpDigestFailuresMutex;
+static std::atomic<int> ftpServerDigests{0};
+static std::atomic<int> sshRemoteDigestCount{0};   // SFTP files hashed on the server (SSH exec)
+// Servers that rejected or ignored LIST -R (per server+user) - listed per directory from then on
+static std::set<std::string> ftpListRUnsupported;
+static std::mutex ftpListRUnsupportedMutex;
 static std::recursive_mutex curlShareMutex; // CRITICAL: recursive_mutex for CURL re-locking!
 
 // CURL Share Lock/Unlock callbacks (CRITICAL for thread-safety!)
@@ -652,10 +797,10 @@ void cleanupCurlSharing() {
 
 // Forward declarations
 void performScan();
-bool deleteFtpFile(const std::string& ftpUrl, const std::string& username, const std::string& password);
 void saveTreeState();
 void loadTreeState();
 bool deleteFile(const std::string& filepath);
+std::set<std::string> deleteFiles(const std::vector<std::string>& files);
 bool deleteEmptyDirectories(const std::string& path, int& deletedCount);
 std::vector<std::string> getFtpSubdirectories(const std::string& ftpDir, const std::string& baseUrl,
                                               const std::string& username, const std::string& password,
@@ -788,6 +933,11 @@ void restoreDefaultSettings() {
     // Basic Settings
     appState.scannerThreads = 128;
     appState.scanTimeout = 1;
+    appState.portScanTimeoutMs = 300;
+    appState.portScanMaxInFlight = 4096;
+    appState.portScanRate = 0;
+    appState.discoveryServiceTtlMinutes = 60;
+    appState.useServiceDiscovery = true;
     appState.useLightningSpeed = true;
     appState.useArpDiscovery = true;
     appState.hashAlgorithm = "AUTO";
@@ -807,6 +957,19 @@ void restoreDefaultSettings() {
     appState.batchScanSize = 20;
     appState.autoTuneThreads = true;
     appState.cacheFileHashes = true;
+    appState.useDirListingCache = true;
+    appState.nfsStatPrefetch = true;
+    appState.nfsStatPrefetchThreads = 32;
+    appState.nfsStatDontSync = false;
+    appState.cacheMemoryLimitMB = 1024;
+    appState.ftpUseMultiEngine = true;
+    appState.ftpMultiMaxTransfers = 128;
+    appState.remoteBandwidthLimitMB = 0.0f;
+    appState.ftpUseMlsd = true;
+    appState.ftpUseServerHash = true;
+    appState.ftpSamplePrefilter = true;
+    appState.sshRemoteHash = true;
+    appState.ftpSampleKB = 64;
     appState.skipEmptyFiles = true;
     appState.smartTimeout = true;
     
@@ -1190,6 +1353,8 @@ void saveFtpPresets() {
         presetObj["serviceType"] = preset.serviceType;
         presetObj["port"] = preset.port;
         presetObj["username"] = preset.username;
+        presetObj["maxConnections"] = preset.maxConnections;
+        presetObj["bandwidthLimitKB"] = preset.bandwidthLimitKB;
         // Passwort nur speichern wenn Option aktiviert ist
         if (appState.savePasswordsPermanently) {
             presetObj["password"] = preset.password;
@@ -1229,6 +1394,12 @@ void saveFtpPresets() {
             presetObj["davMounted"] = preset.davMounted;
         }
         
+        // S3-specific fields
+        if (preset.serviceType == "S3") {
+            presetObj["s3Region"] = preset.s3Region;
+            presetObj["s3UseSSL"] = preset.s3UseSSL;
+        }
+        
         j.push_back(presetObj);
     }
     
@@ -1261,6 +1432,8 @@ void loadFtpPresets() {
                 preset.port = presetObj.value("port", 21);
                 preset.username = presetObj.value("username", "");
                 preset.password = presetObj.value("password", "");
+                preset.maxConnections = presetObj.value("maxConnections", 0);
+                preset.bandwidthLimitKB = presetObj.value("bandwidthLimitKB", 0);
                 
                 // NFS-specific fields
                 // NFS-specific fields
@@ -1313,6 +1486,12 @@ void loadFtpPresets() {
                     }
                 }
                 
+                // S3-specific fields
+                if (preset.serviceType == "S3") {
+                    preset.s3Region = presetObj.value("s3Region", "us-east-1");
+                    preset.s3UseSSL = presetObj.value("s3UseSSL", false);
+                }
+                
                 appState.ftpPresets.push_back(preset);
             }
             
@@ -1463,66 +1642,102 @@ void loadSubnetPresets() {
 }
 
 // Save Scan State (kompletter Scan-Fortschritt)
+// Writes the binary .fds v2 snapshot on a background thread; only the copy of the
+// results happens on the calling thread.
 void saveScanState(const std::string& filename) {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "[Scan State] Failed to save: " << filename << std::endl;
-        return;
-    }
-    
-    // Header
-    file << "FILEDUPER_SCAN_STATE_V1" << std::endl;
-    file << time(nullptr) << std::endl; // Timestamp
-    
-    // Scan Configuration
-    file << appState.minFileSize << std::endl;
-    file << (appState.scanHiddenFiles ? 1 : 0) << std::endl;
-    file << (appState.followSymlinks ? 1 : 0) << std::endl;
-    file << appState.hashAlgorithm << std::endl;
-    
-    // Selected Directories
-    file << appState.selectedLocalDirs.size() << std::endl;
-    for (const auto& dir : appState.selectedLocalDirs) {
-        file << dir << std::endl;
-    }
-    
-    file << appState.selectedFtpDirs.size() << std::endl;
-    for (const auto& dir : appState.selectedFtpDirs) {
-        file << dir << std::endl;
+    ScanSnapshotMeta meta;
+    meta.timestamp = time(nullptr);
+    meta.minFileSize = appState.minFileSize;
+    meta.scanHiddenFiles = appState.scanHiddenFiles;
+    meta.followSymlinks = appState.followSymlinks;
+    meta.hashAlgorithm = appState.hashAlgorithm;
+    meta.localDirs.assign(appState.selectedLocalDirs.begin(), appState.selectedLocalDirs.end());
+    meta.ftpDirs.assign(appState.selectedFtpDirs.begin(), appState.selectedFtpDirs.end());
+    meta.connectedPresetIndex = appState.connectedPresetIndex;
+    
+    std::vector<ScanSnapshotGroup> groups;
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        meta.totalFiles = appState.totalFiles;
+        meta.duplicateFiles = appState.duplicateFiles;
+        meta.duplicateGroups = appState.duplicateGroups;
+        meta.totalSize = appState.totalSize;
+        meta.duplicateSize = appState.duplicateSize;
+        
+        if (!appState.duplicates.empty()) {
+            groups.reserve(appState.duplicates.size());
+            for (const auto& dup : appState.duplicates) {
+                groups.push_back({dup.hash, dup.size, dup.files});
+            }
+        } else if (loadedSnapshot.isOpen()) {
+            // Re-save of a snapshot that is only mapped, not materialized
+            groups.reserve(loadedSnapshot.groupCount());
+            for (uint64_t g = 0; g < loadedSnapshot.groupCount(); g++) {
+                groups.push_back(loadedSnapshot.loadGroup(g));
+            }
+        }
     }
     
-    // FTP Connection Info
-    file << appState.connectedPresetIndex << std::endl;
+    std::cout << "[Scan State] Saving " << groups.size() << " duplicate groups to: " << filename
+              << " (background)" << std::endl;
+    snapshotWriter.saveAsync(filename, std::move(meta), std::move(groups));
     
-    // Scan Results (filesByHash)
-    file << appState.filesByHash.size() << std::endl;
-    for (const auto& pair : appState.filesByHash) {
-        file << pair.first << std::endl; // Hash
-        file << pair.second.size() << std::endl; // Anzahl Dateien
-        for (const auto& filepath : pair.second) {
-            file << filepath << std::endl;
-        }
+    // Also save tree state for faster loading
+    saveTreeState();
+}
+
+// Load a .fds v2 snapshot: map the file and show it without deserializing the groups
+static bool loadScanSnapshot(const std::string& filename) {
+    // A background save to the same file must finish before we map it
+    snapshotWriter.wait();
+    
+    std::lock_guard<std::mutex> lock(resultsMutex);
+    if (!loadedSnapshot.open(filename)) {
+        std::cerr << "[Scan State] " << filename << ": " << loadedSnapshot.error() << std::endl;
+        return false;
     }
     
-    // Statistics
-    file << appState.totalFiles << std::endl;
-    file << appState.duplicateFiles << std::endl;
-    file << appState.duplicateGroups << std::endl;
-    file << appState.totalSize << std::endl;
-    file << appState.duplicateSize << std::endl;
+    const ScanSnapshotMeta& meta = loadedSnapshot.meta();
+    time_t timestamp = meta.timestamp;
+    std::cout << "[Scan State] Loading snapshot from " << ctime(&timestamp);
     
-    file.close();
+    appState.minFileSize = meta.minFileSize;
+    appState.scanHiddenFiles = meta.scanHiddenFiles;
+    appState.followSymlinks = meta.followSymlinks;
+    appState.hashAlgorithm = meta.hashAlgorithm;
+    // Selected directories are not restored - user must manually select each time
+    appState.selectedLocalDirs.clear();
+    appState.selectedFtpDirs.clear();
+    appState.connectedPresetIndex = meta.connectedPresetIndex;
     
-    // Also save tree state for faster loading
-    saveTreeState();
+    appState.duplicates.clear();
+    appState.filesByHash.clear();
+    appState.snapshotPage = 0;
+    appState.totalFiles = meta.totalFiles;
+    appState.duplicateFiles = meta.duplicateFiles;
+    appState.duplicateGroups = meta.duplicateGroups;
+    appState.totalSize = meta.totalSize;
+    appState.duplicateSize = meta.duplicateSize;
+    appState.scanStateFile = filename;
     
-    std::cout << "[Scan State] Saved to: " << filename << std::endl;
-    std::cout << "[Scan State] " << appState.filesByHash.size() << " hash groups, "
-              << appState.totalFiles << " files" << std::endl;
+    std::cout << "[Scan State] Mapped " << loadedSnapshot.groupCount() << " groups, "
+              << loadedSnapshot.fileCount() << " files (checksum OK)" << std::endl;
+    return true;
 }
 
-// Load Scan State
+// Load Scan State (.fds v2 snapshot, or the old FILEDUPER_SCAN_STATE_V1 text format)
 bool loadScanState(const std::string& filename) {
+    if (ScanSnapshotView::isSnapshotFile(filename)) {
+        if (!loadScanSnapshot(filename)) return false;
+        loadTreeState();
+        return true;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        loadedSnapshot.close();
+    }
+    
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "[Scan State] Failed to load: " << filename << std::endl;
@@ -1677,19 +1892,17 @@ bool isNetworkMountPoint(const std::string& path, const AppState& appState) {
 
 // Save file cache to disk (automatic, transparent)
 void saveFileCache() {
-    std::lock_guard<std::mutex> lock(fileCacheMutex);
-    
     // Separate local and FTP files
     std::vector<std::pair<std::string, CachedFileInfo>> localFiles;
     std::vector<std::pair<std::string, CachedFileInfo>> ftpFiles;
     
-    for (const auto& entry : fileCache) {
-        if (isFtpFile(entry.first)) {
-            ftpFiles.push_back(entry);
+    fileCache.forEach([&](const std::string& path, const CachedFileInfo& info) {
+        if (isFtpFile(path)) {
+            ftpFiles.emplace_back(path, info);
         } else {
-            localFiles.push_back(entry);
+            localFiles.emplace_back(path, info);
         }
-    }
+    });
     
     // Save LOCAL cache
     if (!localFiles.empty()) {
@@ -1735,7 +1948,6 @@ void saveFileCache() {
 
 // Load file cache from disk (automatic on startup)
 void loadFileCache() {
-    std::lock_guard<std::mutex> lock(fileCacheMutex);
     fileCache.clear();
     
     int totalLoaded = 0;
@@ -1756,6 +1968,7 @@ void loadFileCache() {
                     size_t pathLen;
                     file >> pathLen;
                     file.ignore();
+                    if (!file || pathLen > 65536) break;   // Truncated or corrupt: keep what was read
                     
                     std::string path(pathLen, '\0');
                     file.read(&path[0], pathLen);
@@ -1767,6 +1980,7 @@ void loadFileCache() {
                     size_t hashLen;
                     file >> hashLen;
                     file.ignore();
+                    if (!file || hashLen > 1024) break;
                     
                     if (hashLen > 0) {
                         info.hash.resize(hashLen);
@@ -1774,7 +1988,7 @@ void loadFileCache() {
                         file.ignore();
                     }
                     
-                    fileCache[path] = info;
+                    fileCache.put(path, std::move(info));
                     totalLoaded++;
                 }
             }
@@ -1798,6 +2012,7 @@ void loadFileCache() {
                     size_t pathLen;
                     file >> pathLen;
                     file.ignore();
+                    if (!file || pathLen > 65536) break;   // Truncated or corrupt: keep what was read
                     
                     std::string path(pathLen, '\0');
                     file.read(&path[0], pathLen);
@@ -1810,6 +2025,7 @@ void loadFileCache() {
                     size_t hashLen;
                     file >> hashLen;
                     file.ignore();
+                    if (!file || hashLen > 1024) break;
                     
                     if (hashLen > 0) {
                         info.hash.resize(hashLen);
@@ -1817,7 +2033,7 @@ void loadFileCache() {
                         file.ignore();
                     }
                     
-                    fileCache[path] = info;
+                    fileCache.put(path, std::move(info));
                     totalLoaded++;
                 }
             }
@@ -2174,6 +2390,11 @@ void saveSettings() {
     settings["threadCount"] = appState.threadCount;
     settings["scannerThreads"] = appState.scannerThreads;
     settings["scanTimeout"] = appState.scanTimeout;
+    settings["portScanTimeoutMs"] = appState.portScanTimeoutMs;
+    settings["portScanMaxInFlight"] = appState.portScanMaxInFlight;
+    settings["portScanRate"] = appState.portScanRate;
+    settings["discoveryServiceTtlMinutes"] = appState.discoveryServiceTtlMinutes;
+    settings["useServiceDiscovery"] = appState.useServiceDiscovery;
     settings["useLightningSpeed"] = appState.useLightningSpeed;
     settings["minFileSize"] = appState.minFileSize;
     settings["scanHiddenFiles"] = appState.scanHiddenFiles;
@@ -2195,6 +2416,19 @@ void saveSettings() {
     settings["batchScanSize"] = appState.batchScanSize;
     settings["autoTuneThreads"] = appState.autoTuneThreads;
     settings["cacheFileHashes"] = appState.cacheFileHashes;
+    settings["useDirListingCache"] = appState.useDirListingCache;
+    settings["nfsStatPrefetch"] = appState.nfsStatPrefetch;
+    settings["nfsStatPrefetchThreads"] = appState.nfsStatPrefetchThreads;
+    settings["nfsStatDontSync"] = appState.nfsStatDontSync;
+    settings["cacheMemoryLimitMB"] = appState.cacheMemoryLimitMB;
+    settings["ftpUseMultiEngine"] = appState.ftpUseMultiEngine;
+    settings["ftpMultiMaxTransfers"] = appState.ftpMultiMaxTransfers;
+    settings["remoteBandwidthLimitMB"] = appState.remoteBandwidthLimitMB;
+    settings["ftpUseMlsd"] = appState.ftpUseMlsd;
+    settings["ftpUseServerHash"] = appState.ftpUseServerHash;
+    settings["ftpSamplePrefilter"] = appState.ftpSamplePrefilter;
+    settings["sshRemoteHash"] = appState.sshRemoteHash;
+    settings["ftpSampleKB"] = appState.ftpSampleKB;
     settings["skipEmptyFiles"] = appState.skipEmptyFiles;
     settings["smartTimeout"] = appState.smartTimeout;
     
@@ -2254,6 +2488,11 @@ void loadSettings() {
         appState.threadCount = 8;
         appState.scannerThreads = 128;
         appState.scanTimeout = 1;
+        appState.portScanTimeoutMs = 300;
+        appState.portScanMaxInFlight = 4096;
+        appState.portScanRate = 0;
+        appState.discoveryServiceTtlMinutes = 60;
+        appState.useServiceDiscovery = true;
         appState.useLightningSpeed = true;
         appState.minFileSize = 0;
         appState.scanHiddenFiles = true;
@@ -2275,6 +2514,19 @@ void loadSettings() {
         appState.batchScanSize = 20;
         appState.autoTuneThreads = true;
         appState.cacheFileHashes = true;
+        appState.useDirListingCache = true;
+        appState.nfsStatPrefetch = true;
+        appState.nfsStatPrefetchThreads = 32;
+        appState.nfsStatDontSync = false;
+        appState.cacheMemoryLimitMB = 1024;
+        appState.ftpUseMultiEngine = true;
+        appState.ftpMultiMaxTransfers = 128;
+        appState.remoteBandwidthLimitMB = 0.0f;
+        appState.ftpUseMlsd = true;
+        appState.ftpUseServerHash = true;
+        appState.ftpSamplePrefilter = true;
+        appState.sshRemoteHash = true;
+        appState.ftpSampleKB = 64;
         appState.skipEmptyFiles = true;
         appState.smartTimeout = true;
         appState.ftpMaxRetries = 3;
@@ -2320,6 +2572,11 @@ void loadSettings() {
         if (settings.contains("threadCount")) appState.threadCount = settings["threadCount"];
         if (settings.contains("scannerThreads")) appState.scannerThreads = settings["scannerThreads"];
         if (settings.contains("scanTimeout")) appState.scanTimeout = settings["scanTimeout"];
+        if (settings.contains("portScanTimeoutMs")) appState.portScanTimeoutMs = settings["portScanTimeoutMs"];
+        if (settings.contains("portScanMaxInFlight")) appState.portScanMaxInFlight = settings["portScanMaxInFlight"];
+        if (settings.contains("portScanRate")) appState.portScanRate = settings["portScanRate"];
+        if (settings.contains("discoveryServiceTtlMinutes")) appState.discoveryServiceTtlMinutes = settings["discoveryServiceTtlMinutes"];
+        if (settings.contains("useServiceDiscovery")) appState.useServiceDiscovery = settings["useServiceDiscovery"];
         if (settings.contains("useLightningSpeed")) appState.useLightningSpeed = settings["useLightningSpeed"];
         if (settings.contains("minFileSize")) appState.minFileSize = settings["minFileSize"];
         if (settings.contains("scanHiddenFiles")) appState.scanHiddenFiles = settings["scanHiddenFiles"];
@@ -2341,6 +2598,19 @@ void loadSettings() {
         if (settings.contains("batchScanSize")) appState.batchScanSize = settings["batchScanSize"];
         if (settings.contains("autoTuneThreads")) appState.autoTuneThreads = settings["autoTuneThreads"];
         if (settings.contains("cacheFileHashes")) appState.cacheFileHashes = settings["cacheFileHashes"];
+        if (settings.contains("useDirListingCache")) appState.useDirListingCache = settings["useDirListingCache"];
+        if (settings.contains("nfsStatPrefetch")) appState.nfsStatPrefetch = settings["nfsStatPrefetch"];
+        if (settings.contains("nfsStatPrefetchThreads")) appState.nfsStatPrefetchThreads = settings["nfsStatPrefetchThreads"];
+        if (settings.contains("nfsStatDontSync")) appState.nfsStatDontSync = settings["nfsStatDontSync"];
+        if (settings.contains("cacheMemoryLimitMB")) appState.cacheMemoryLimitMB = settings["cacheMemoryLimitMB"];
+        if (settings.contains("ftpUseMultiEngine")) appState.ftpUseMultiEngine = settings["ftpUseMultiEngine"];
+        if (settings.contains("ftpMultiMaxTransfers")) appState.ftpMultiMaxTransfers = settings["ftpMultiMaxTransfers"];
+        if (settings.contains("remoteBandwidthLimitMB")) appState.remoteBandwidthLimitMB = settings["remoteBandwidthLimitMB"];
+        if (settings.contains("ftpUseMlsd")) appState.ftpUseMlsd = settings["ftpUseMlsd"];
+        if (settings.contains("ftpUseServerHash")) appState.ftpUseServerHash = settings["ftpUseServerHash"];
+        if (settings.contains("ftpSamplePrefilter")) appState.ftpSamplePrefilter = settings["ftpSamplePrefilter"];
+        if (settings.contains("sshRemoteHash")) appState.sshRemoteHash = settings["sshRemoteHash"];
+        if (settings.contains("ftpSampleKB")) appState.ftpSampleKB = settings["ftpSampleKB"];
         if (settings.contains("skipEmptyFiles")) appState.skipEmptyFiles = settings["skipEmptyFiles"];
         if (settings.contains("smartTimeout")) appState.smartTimeout = settings["smartTimeout"];
         
@@ -2468,10 +2738,20 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
     
     // Track network bandwidth during FTP scan
     appState.ftpBytesTransferred += totalSize;
+    throttleRemote(totalSize);
     
     return totalSize;
 }
 
+// Callback für LIST -R im Verzeichnisbrowser: direkt in den Parser, ohne Puffer
+static size_t FtpListRBrowseCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t totalSize = size * nmemb;
+    appState.ftpBytesTransferred += totalSize;
+    throttleRemote(totalSize);
+    ((FtpListRParser*)userp)->feed((const char*)contents, totalSize);
+    return totalSize;
+}
+
 // FTP Verzeichnisliste abrufen (Hybrid: ls -R oder Parallel Multi-Threaded BFS)
 bool fetchFtpDirectories(const std::string& url, const std::string& username, 
                          const std::string& password, std::vector<std::string>& directories,
@@ -2483,9 +2763,6 @@ bool fetchFtpDirectories(const std::string& url, const std::string& username,
         
         CURL* curl = curl_easy_init();
         if (curl) {
-        std::string readBuffer;
-        readBuffer.reserve(2097152); // 2MB for recursive listing
-        
         // Build URL
         std::string fullUrl = url;
         if (!fullUrl.empty() && fullUrl.back() == '/' && !currentPath.empty() && currentPath[0] == '/') {
@@ -2496,77 +2773,52 @@ bool fetchFtpDirectories(const std::string& url, const std::string& username,
             fullUrl += '/';
         }
         
+        std::string basePath = currentPath.empty() ? "/" : currentPath;
+        if (basePath.back() != '/') basePath += '/';
+        int totalDirs = 0;
+        size_t bytesReceived = 0;
+        
+        // Parsed while streaming: only directories are kept, the listing itself is never buffered
+        FtpListRParser parser([&](const FtpListEntry& entry) {
+            if (entry.type != FtpListType::Dir) return;
+            std::string fullPath = basePath;
+            if (!entry.dir.empty()) {
+                fullPath.append(entry.dir.data(), entry.dir.size());
+                fullPath += '/';
+            }
+            fullPath.append(entry.name.data(), entry.name.size());
+            
+            int depth = std::count(fullPath.begin(), fullPath.end(), '/');
+            if (depth <= appState.ftpTreeMaxDepth) {
+                directories.push_back(fullPath);
+                totalDirs++;
+            }
+        }, currentPath);
+        
         // Try using CUSTOMREQUEST for ls -R
         curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
         curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
         curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, FtpListRBrowseCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &parser);
         curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "LIST -R");
         curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L); // Longer for recursive
         curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
         
         CURLcode res = curl_easy_perform(curl);
+        curl_off_t downloaded = 0;
+        if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded) == CURLE_OK) bytesReceived = (size_t)downloaded;
         curl_easy_cleanup(curl);
+        parser.finish();
         
-        if (res == CURLE_OK && !readBuffer.empty()) {
-            std::cout << "[FTP] Recursive listing successful! Received " << readBuffer.size() << " bytes" << std::endl;
-            
-            // Parse recursive output
-            std::istringstream iss(readBuffer);
-            std::string line;
-            std::string currentDir = "/";
-            int totalDirs = 0;
-            
-            while (std::getline(iss, line)) {
-                // Remove trailing \r if present
-                if (!line.empty() && line.back() == '\r') {
-                    line.pop_back();
-                }
-                
-                // Directory header (ends with :)
-                if (!line.empty() && line.back() == ':') {
-                    std::string dirPath = line.substr(0, line.size() - 1);
-                    if (dirPath == ".") {
-                        currentDir = "/";
-                    } else if (dirPath.size() >= 2 && dirPath.substr(0, 2) == "./") {
-                        currentDir = "/" + dirPath.substr(2);
-                    } else {
-                        currentDir = "/" + dirPath;
-                    }
-                    continue;
-                }
-                
-                // Parse directory entries
-                if (line.empty() || line.length() < 10) continue;
-                if (line[0] != 'd') continue;
-                
-                size_t lastSpace = line.find_last_of(' ');
-                if (lastSpace != std::string::npos) {
-                    std::string dirName = line.substr(lastSpace + 1);
-                    if (dirName == "." || dirName == "..") continue;
-                    
-                    // Baue den vollständigen Pfad
-                    std::string fullPath;
-                    if (currentDir == "/") {
-                        fullPath = "/" + dirName;
-                    } else {
-                        fullPath = currentDir + "/" + dirName;
-                    }
-                    
-                    int depth = std::count(fullPath.begin(), fullPath.end(), '/');
-                    
-                    if (depth <= appState.ftpTreeMaxDepth) {
-                        directories.push_back(fullPath);
-                        totalDirs++;
-                    }
-                }
-            }
-            
+        if (res == CURLE_OK && parser.lines() > 0 && !parser.recursionIgnored()) {
+            std::cout << "[FTP] Recursive listing successful! Received " << bytesReceived << " bytes, "
+                      << parser.lines() << " lines" << std::endl;
             std::cout << "[FTP] Recursive scan complete: " << totalDirs << " directories found (FAST MODE)" << std::endl;
             return true;
         }
+        directories.resize(directories.size() - totalDirs);
         
         std::cout << "[FTP] Recursive listing not supported, falling back to parallel scan..." << std::endl;
         } // Ende if (curl)
@@ -3689,9 +3941,73 @@ bool connectAndFetchDirectories(FtpPreset& preset, int presetIndex = -1) {
         }
         
     } else if (preset.serviceType == "SFTP") {
-        // SFTP: Benötigt libssh2 - nicht implementiert
-        std::cout << "[FTP] Error: SFTP not yet implemented!" << std::endl;
-        return false;
+        // SFTP über libssh: Verzeichnisbaum im Hintergrund, Auswahl landet als sftp:// im Scan
+        if (!isLibsshAvailable()) {
+            std::cout << "[FTP] Error: SFTP needs libssh (built without WITH_LIBSSH)" << std::endl;
+            appState.connectionStatus = "SFTP nicht verfügbar (ohne libssh gebaut)";
+            return false;
+        }
+        appState.serverDirectories = {"/"};
+        appState.connectionStatus = "Lese SFTP-Verzeichnisse...";
+        appState.isScanningFtp = true;
+        std::string host = preset.ip, user = preset.username, pass = preset.password;
+        int port = preset.port;
+        int maxDepth = std::max(0, appState.ftpTreeMaxDepth - 1);
+        std::thread([host, port, user, pass, maxDepth]() {
+            std::vector<std::string> tempDirectories{"/"};
+            std::string error;
+            std::unique_ptr<NfsBackend> sftp = createSftpBackend(host, port, user, pass, error);
+            if (sftp) {
+                NfsAsyncEngine engine(*sftp, 64, 64 * 1024, 16);
+                engine.walk("/", maxDepth, [](const NfsAsyncEngine::FileInfo&) {}, nullptr,
+                            [&](const std::string& dir) { tempDirectories.push_back(dir); });
+                std::sort(tempDirectories.begin(), tempDirectories.end());
+                appState.connectionStatus = "[X] Verbunden! " + std::to_string(tempDirectories.size()) + " Verzeichnisse (SFTP)";
+            } else {
+                std::cerr << "[SFTP] " << host << ":" << port << " - " << error << std::endl;
+                appState.connectionStatus = "SFTP-Verbindung fehlgeschlagen: " + error;
+            }
+            {
+                std::lock_guard<std::mutex> lock(appState.serverDirectoriesMutex);
+                appState.serverDirectories = tempDirectories;
+            }
+            appState.isScanningFtp = false;
+        }).detach();
+        
+    } else if (preset.serviceType == "S3") {
+        // S3 (MinIO, AWS, Ceph): Buckets und Präfixe als Verzeichnisbaum, Auswahl landet als s3:// im Scan
+        appState.serverDirectories = {"/"};
+        appState.connectionStatus = "Lese S3-Buckets...";
+        appState.isScanningFtp = true;
+        std::string host = preset.ip + ":" + std::to_string(preset.port);
+        bool https = preset.s3UseSSL;
+        S3Credentials credentials{preset.username, preset.password, preset.s3Region};
+        int maxDepth = std::max(0, appState.ftpTreeMaxDepth - 1);
+        std::thread([host, https, credentials, maxDepth]() {
+            std::vector<std::string> tempDirectories{"/"};
+            std::string error;
+            // One level per request: the tree stops at maxDepth instead of listing every key
+            std::unique_ptr<NfsBackend> s3 = createS3Backend(https, host, credentials, error, false);
+            bool ok = false;
+            if (s3) {
+                NfsAsyncEngine engine(*s3, 32);
+                ok = engine.walk("/", maxDepth, [](const NfsAsyncEngine::FileInfo&) {}, nullptr,
+                                 [&](const std::string& dir) { tempDirectories.push_back(dir); });
+                if (!ok) error = s3->lastError();
+            }
+            if (ok) {
+                std::sort(tempDirectories.begin(), tempDirectories.end());
+                appState.connectionStatus = "[X] Verbunden! " + std::to_string(tempDirectories.size()) + " Verzeichnisse (S3)";
+            } else {
+                std::cerr << "[S3] " << host << " - " << error << std::endl;
+                appState.connectionStatus = "S3-Verbindung fehlgeschlagen: " + error;
+            }
+            {
+                std::lock_guard<std::mutex> lock(appState.serverDirectoriesMutex);
+                appState.serverDirectories = tempDirectories;
+            }
+            appState.isScanningFtp = false;
+        }).detach();
     }
     
     appState.isConnected = true;
@@ -3715,72 +4031,183 @@ bool connectAndFetchDirectories(FtpPreset& preset, int presetIndex = -1) {
 // CIDR utilities moved to net_utils
 #include "net_utils.h"
 
-// Port-Scan für einzelnen Host mit Timeout
-struct PortScanResult {
-    std::string ip;
-    std::vector<int> openPorts;
-    std::string hostIdentifier; // Für GUI-Display
-};
+// Port scans run on the epoll scanner (port_scanner.h): all hosts and ports in flight at once,
+// results stream into discoveredHosts while the scan runs. The [STOP] button sets portScanCancel.
+#include "port_scanner.h"
+#include "host_discovery.h"
+static std::atomic<bool> portScanCancel{false};
 
-PortScanResult scanHostPorts(const std::string& ip, int timeout_ms) {
-    PortScanResult result;
-    result.ip = ip;
-    
-    // File service ports: FTP, SSH, SMB-NetBIOS, SMB-CIFS, NFS
-    const int ports[] = {21, 22, 139, 445, 2049};
-    const char* serviceNames[] = {"FTP", "SSH", "SMB-NetBIOS", "SMB-CIFS", "NFS"};
-    
-    for (size_t i = 0; i < 5; i++) {
-        int port = ports[i];
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) continue;
-        
-        // Non-blocking mode
-        fcntl(sock, F_SETFL, O_NONBLOCK);
-        
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
-        
-        connect(sock, (struct sockaddr*)&addr, sizeof(addr));
-        
-        // Select mit Timeout
-        fd_set fdset;
-        FD_ZERO(&fdset);
-        FD_SET(sock, &fdset);
-        
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = timeout_ms * 1000; // Convert ms to microseconds
-        
-        int selectResult = select(sock + 1, nullptr, &fdset, nullptr, &tv);
-        
-        if (selectResult > 0) {
-            // Check if connection actually succeeded
-            int so_error;
-            socklen_t len = sizeof(so_error);
-            if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &so_error, &len) == 0 && so_error == 0) {
-                result.openPorts.push_back(port);
-                std::cout << "[PortScan] " << ip << ":" << port << " (" << serviceNames[i] << ") OPEN" << std::endl;
-            }
+static PortScanOptions filePortScanOptions() {
+    PortScanOptions options;
+    options.timeoutMs = std::max(10, appState.portScanTimeoutMs);
+    options.maxInFlight = std::max(1, appState.portScanMaxInFlight);
+    options.ratePerSecond = std::max(0, appState.portScanRate);
+    return options;
+}
+
+static void logOpenPort(const std::string& ip, int port) {
+    std::cout << "[PortScan] " << ip << ":" << port << " (" << portServiceName(port) << ") OPEN" << std::endl;
+}
+
+// "192.168.1.10 [FTP, SMB-CIFS]"
+static std::string describeFileServices(const PortScanHostResult& host) {
+    std::string text = host.ip + " [";
+    for (size_t i = 0; i < host.openPorts.size(); i++) {
+        if (i > 0) text += ", ";
+        text += portServiceName(host.openPorts[i]);
+    }
+    return text + "]";
+}
+
+static void logPortScanStats(const char* tag, const PortScanStats& stats) {
+    std::cout << "[" << tag << "] Port scan: " << stats.hosts << " hosts, " << stats.probes << " probes in "
+              << stats.seconds << " s (" << stats.open << " open, " << stats.refused << " refused, "
+              << stats.timedOut << " timeout, " << stats.unreachable << " unreachable)" << std::endl;
+}
+
+// Discovery cache (neighbor_cache.h): follows the kernel's neighbour table over rtnetlink instead of
+// re-reading /proc/net/arp, and keeps port-scan results per host. Only hosts that are new, got a new
+// MAC or outlived discoveryServiceTtlMinutes are probed again; results survive restarts.
+#include "neighbor_cache.h"
+static NeighborDiscoveryCache neighborCache;
+
+static std::string discoveryCachePath() {
+    return std::string(getenv("HOME")) + "/.fileduper_discovery_cache.dat";
+}
+
+static int discoveryServiceTtlSeconds() {
+    return std::max(0, appState.discoveryServiceTtlMinutes) * 60;
+}
+
+static uint32_t ipToHostOrder(const std::string& ip) {
+    struct in_addr addr;
+    if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) return 0;
+    return ntohl(addr.s_addr);
+}
+
+// Hosts in the kernel's neighbour table; /proc/net/arp if rtnetlink is unavailable
+static std::vector<std::string> knownNeighborHosts() {
+    if (!neighborCache.isRunning() && !neighborCache.start()) return getActiveHostsViaARP();
+    std::vector<std::string> hosts;
+    for (const auto& neighbor : neighborCache.neighbors()) hosts.push_back(neighbor.ip);
+    return hosts;
+}
+
+// Announced services (service_discovery.h): NAS boxes that advertise SMB/NFS/FTP/SFTP/WebDAV over
+// mDNS/DNS-SD or SSDP show up in discoveredHosts as soon as they announce, without a port sweep.
+#include "service_discovery.h"
+static ServiceDiscoveryBrowser serviceBrowser;
+
+// One list entry per host (caller holds hostsMutex). Port-scan results pass replace = false
+// so they never overwrite the richer description of an announced host.
+static void upsertDiscoveredHost(const std::string& ip, const std::string& entry, bool replace = true) {
+    for (auto& host : appState.discoveredHosts) {
+        if (host == ip || host.compare(0, ip.size() + 1, ip + " ") == 0) {
+            if (replace) host = entry;
+            return;
         }
-        close(sock);
     }
-    
-    // Erstelle Host-Identifier basierend auf offenen Ports
-    if (!result.openPorts.empty()) {
-        result.hostIdentifier = ip + " [";
-        for (size_t i = 0; i < result.openPorts.size(); i++) {
-            if (i > 0) result.hostIdentifier += ", ";
-            result.hostIdentifier += serviceNames[std::distance(ports, std::find(ports, ports + 5, result.openPorts[i]))];
-        }
-        result.hostIdentifier += "]";
+    appState.discoveredHosts.push_back(entry);
+}
+
+// ip -> "192.168.1.10 [SMB:445, NFS:2049 /export] NAS (mDNS)" for every announcing host
+static std::map<std::string, std::string> announcedHosts() {
+    std::map<std::string, std::vector<DiscoveredService>> byHost;
+    for (const auto& service : serviceBrowser.services()) byHost[service.ip].push_back(service);
+    std::map<std::string, std::string> result;
+    for (const auto& [ip, services] : byHost) {
+        std::string text = ip + " [";
+        std::string name = services[0].name;
+        bool ssdp = true;
+        for (size_t i = 0; i < services.size(); i++) {
+            const auto& service = services[i];
+            if (i > 0) text += ", ";
+            bool isSsdp = service.source == "ssdp";
+            text += (isSsdp ? std::string("UPnP") : serviceTypeLabel(service.serviceType)) + ":" + std::to_string(service.port);
+            if (!service.path.empty() && !isSsdp) text += " " + service.path;
+            if (!isSsdp) {
+                ssdp = false;
+                name = service.name;
+            }
+        }
+        text += "] ";
+        text += ssdp ? services[0].hostname : name;
+        text += ssdp ? " (SSDP)" : " (mDNS)";
+        result[ip] = text;
     }
-    
     return result;
 }
 
+static void startServiceDiscovery() {
+    if (!appState.useServiceDiscovery || serviceBrowser.isRunning()) return;
+    serviceBrowser.setCallback([](const DiscoveredService& service, bool removed) {
+        auto hosts = announcedHosts();
+        auto it = hosts.find(service.ip);
+        std::lock_guard<std::mutex> lock(hostsMutex);
+        if (it != hosts.end()) {
+            upsertDiscoveredHost(service.ip, it->second);
+        } else if (removed) {
+            auto& list = appState.discoveredHosts;
+            // Last announced service gone: drop its entry (port-scan entries stay)
+            list.erase(std::remove_if(list.begin(), list.end(), [&](const std::string& host) {
+                if (host.compare(0, service.ip.size() + 1, service.ip + " ") != 0 || host.size() < 6) return false;
+                std::string origin = host.substr(host.size() - 6);
+                return origin == "(mDNS)" || origin == "(SSDP)";
+            }), list.end());
+        }
+    });
+    serviceBrowser.start();
+}
+
+// Port-scan phase: announced hosts and hosts with fresh cached services are listed right away,
+// only the rest is probed
+static void probeFileServices(const std::vector<std::string>& hosts, const char* tag) {
+    auto announced = announcedHosts();
+    std::vector<std::string> silent;
+    for (const auto& ip : hosts) {
+        auto it = announced.find(ip);
+        if (it == announced.end()) {
+            silent.push_back(ip);
+            continue;
+        }
+        appState.scannedHosts++;
+        std::lock_guard<std::mutex> lock(hostsMutex);
+        upsertDiscoveredHost(ip, it->second);
+    }
+
+    int ttl = discoveryServiceTtlSeconds();
+    std::vector<std::string> toProbe = neighborCache.hostsToProbe(silent, ttl);
+    std::set<std::string> probing(toProbe.begin(), toProbe.end());
+    size_t reused = 0;
+    for (const auto& ip : silent) {
+        if (probing.count(ip)) continue;
+        uint32_t address = ipToHostOrder(ip);
+        auto cached = neighborCache.cachedServices(address, address, ttl);
+        appState.scannedHosts++;
+        reused++;
+        if (cached.empty() || cached[0].openPorts.empty()) continue;
+        std::lock_guard<std::mutex> lock(hostsMutex);
+        upsertDiscoveredHost(ip, ip, false);
+        std::cout << "[Scanner] " << ip << " (cached, " << cached[0].openPorts.size() << " services)" << std::endl;
+    }
+    std::cout << "[" << tag << "] " << hosts.size() - silent.size() << " hosts announced (mDNS/SSDP), " << reused
+              << " from discovery cache, probing " << toProbe.size() << std::endl;
+    if (toProbe.empty()) return;
+
+    PortScanStats stats = massPortScan(toProbe, filePortScanOptions(), [](const PortScanHostResult& result) {
+        appState.scannedHosts++;
+        // Silent hosts are not cached: they may just have been slow this time
+        if (result.responded) neighborCache.recordServices(result.ip, result.openPorts);
+        // Nur Hosts mit offenen Ports speichern
+        if (result.openPorts.empty()) return;
+        std::lock_guard<std::mutex> lock(hostsMutex);
+        upsertDiscoveredHost(result.ip, result.ip, false);
+        std::cout << "[Scanner] " << describeFileServices(result) << std::endl;
+    }, logOpenPort, &portScanCancel);
+    logPortScanStats(tag, stats);
+    neighborCache.save(discoveryCachePath());
+}
+
 // Ping/Service scan a range of IPs (full-range fallback)
 // Full-range scanning across IP numeric space (startIpStr and endIpStr are full IP strings)
 void scanIPRange(const std::string &startIpStr, const std::string &endIpStr, int timeout_ms, std::vector<std::string> *results) {
@@ -3789,36 +4216,20 @@ void scanIPRange(const std::string &startIpStr, const std::string &endIpStr, int
         if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) return 0;
         return ntohl(addr.s_addr);
     };
-    auto int2ip = [](uint32_t v) -> std::string {
-        struct in_addr s; s.s_addr = htonl(v);
-        char buf[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &s, buf, sizeof(buf));
-        return std::string(buf);
-    };
 
     uint32_t start = ip2int(startIpStr);
     uint32_t end = ip2int(endIpStr);
     if (start == 0 || end == 0 || end < start) return;
 
-    const int BATCH_SIZE = 80; // how many futures in-flight
-    std::vector<std::future<PortScanResult>> futures;
-    for (uint32_t ip = start; ip <= end; ++ip) {
-        std::string ipStr = int2ip(ip);
-        futures.push_back(std::async(std::launch::async, [ipStr, timeout_ms]() {
-            return scanHostPorts(ipStr, timeout_ms);
-        }));
-
-        if ((int)futures.size() >= BATCH_SIZE || ip == end) {
-            for (auto &f : futures) {
-                PortScanResult res = f.get();
-                if (!res.openPorts.empty()) {
-                    std::lock_guard<std::mutex> lock(hostsMutex);
-                    results->push_back(res.ip + " [" + std::to_string((int)res.openPorts.size()) + " services]");
-                }
-            }
-            futures.clear();
-        }
-    }
+    PortScanOptions options = filePortScanOptions();
+    options.timeoutMs = timeout_ms;
+    PortScanStats stats = massPortScanRange(start, end, options, [results](const PortScanHostResult& host) {
+        appState.scannedHosts++;
+        if (host.openPorts.empty()) return;
+        std::lock_guard<std::mutex> lock(hostsMutex);
+        results->push_back(host.ip + " [" + std::to_string((int)host.openPorts.size()) + " services]");
+    }, logOpenPort, &portScanCancel);
+    logPortScanStats("Fallback", stats);
 }
 
 // (removed - replaced by ARP + PortScan approach)
@@ -3829,8 +4240,15 @@ static const uint32_t MAX_FALLBACK_CONFIRM = 65536;
 void startLightningScan(const std::string& subnet) {
     appState.scanThreadRunning = true;
     appState.scannedHosts = 0;
-    appState.discoveredHosts.clear();
+    {
+        std::lock_guard<std::mutex> lock(hostsMutex);
+        appState.discoveredHosts.clear();
+    }
     appState.scanningNetwork = true;
+    portScanCancel = false;
+    // Fresh mDNS/SSDP query burst; answers arrive while the sweep runs
+    startServiceDiscovery();
+    if (serviceBrowser.isRunning()) serviceBrowser.queryNow();
     
     std::cout << "[Lightning Scanner] Starting ARP-based host discovery + port scanning" << std::endl;
     // Normalize quick notations -> e.g. "10.0" -> "10.0.0.0/24"
@@ -3838,37 +4256,21 @@ void startLightningScan(const std::string& subnet) {
     
     // Starte ARP-Scan in separatem Thread (non-blocking)
     std::thread([subnet, normalizedSubnet]() {
-        // If subnet is not local, use nmap-based NetworkScanner which is
-        // better-suited for scanning remote networks than ARP/ICMP.
+        // If subnet is not local, the ARP cache knows nothing about it:
+        // NetworkScanner sweeps it with ICMP echo requests instead.
         if (!isSubnetLocal(normalizedSubnet)) {
-            std::cout << "[Lightning Scanner] Subnet " << normalizedSubnet << " not local -> using NetworkScanner (nmap)" << std::endl;
+            std::cout << "[Lightning Scanner] Subnet " << normalizedSubnet << " not local -> using NetworkScanner (ICMP sweep)" << std::endl;
             NetworkScanner ns;
             auto hosts = ns.scanSubnet(normalizedSubnet);
             appState.totalHostsToScan = hosts.size();
-            // Now run existing port-scan phase over these hosts
-            const int BATCH_SIZE = 10;
-            std::vector<std::future<PortScanResult>> futures;
-            for (const auto &ip : hosts) {
-                if (!appState.scanThreadRunning) break;
-                futures.push_back(std::async(std::launch::async, [ip]() { return scanHostPorts(ip, 50); }));
-                if ((int)futures.size() >= BATCH_SIZE || ip == hosts.back()) {
-                    for (auto &f : futures) {
-                        auto result = f.get();
-                        if (!result.openPorts.empty()) {
-                            std::lock_guard<std::mutex> lock(hostsMutex);
-                            appState.discoveredHosts.push_back(result.ip);
-                            std::cout << "[Scanner] " << result.hostIdentifier << std::endl;
-                        }
-                    }
-                    futures.clear();
-                }
-            }
+            // Now run the port-scan phase over these hosts
+            probeFileServices(hosts, "Lightning Scanner");
             appState.scanningNetwork = false;
             appState.scanThreadRunning = false;
             return;
         }
-        // Phase 1: ARP-basierte aktive Host-Erkennung (sehr schnell!)
-        auto activeHosts = getActiveHostsViaARP();
+        // Phase 1: Nachbartabelle des Kernels (rtnetlink-Cache, sonst /proc/net/arp)
+        auto activeHosts = knownNeighborHosts();
         appState.totalHostsToScan = activeHosts.size();
         
         std::cout << "[Lightning Scanner] Phase 1 complete: " << activeHosts.size() 
@@ -3893,6 +4295,29 @@ void startLightningScan(const std::string& subnet) {
             activeHostsFiltered = activeHosts; // Couldn't parse requested CIDR: keep ARP results as-is
         }
         
+        // Active ARP requests (AF_PACKET) + ICMP: finds hosts the kernel's ARP cache hasn't seen yet
+        if (reqEnd != 0 && reqEnd >= reqStart && reqEnd - reqStart + 1 <= MAX_FALLBACK_CONFIRM && appState.scanThreadRunning) {
+            std::set<std::string> known(activeHostsFiltered.begin(), activeHostsFiltered.end());
+            HostSweepStats sweepStats;
+            for (const auto &h : sweepSubnet(normalizedSubnet, HostSweepOptions(), &portScanCancel, &sweepStats)) {
+                if (known.insert(h).second) activeHostsFiltered.push_back(h);
+            }
+            if (!sweepStats.error.empty()) {
+                appState.scanStatus = "ICMP nicht verfügbar - nur ARP-Cache und lokales Subnetz";
+            }
+            appState.totalHostsToScan = activeHostsFiltered.size();
+        }
+
+        // Hosts that announced file services (mDNS/SSDP) are active even if ARP/ICMP missed them
+        if (reqEnd != 0 && reqEnd >= reqStart) {
+            std::set<std::string> known(activeHostsFiltered.begin(), activeHostsFiltered.end());
+            for (const auto &[ip, entry] : announcedHosts()) {
+                uint32_t val = ipToHostOrder(ip);
+                if (val >= reqStart && val <= reqEnd && known.insert(ip).second) activeHostsFiltered.push_back(ip);
+            }
+            appState.totalHostsToScan = activeHostsFiltered.size();
+        }
+        
         if (activeHostsFiltered.empty()) {
             std::cout << "[Warning] No active hosts found via ARP, scanning anyway..." << std::endl;
             // Fallback: full-range scan for /24 networks
@@ -3922,12 +4347,9 @@ void startLightningScan(const std::string& subnet) {
                 s.s_addr = htonl(endIpNumeric);
                 std::string endIp = ""; inet_ntop(AF_INET, &s, buf, sizeof(buf)); endIp = buf;
 
-                std::vector<std::string> fallbackResults;
-                scanIPRange(startIp, endIp, 50, &fallbackResults);
-                for (const auto &r : fallbackResults) {
-                    std::lock_guard<std::mutex> l(hostsMutex);
-                    appState.discoveredHosts.push_back(r);
-                }
+                // Streams straight into discoveredHosts (scanIPRange locks hostsMutex)
+                appState.totalHostsToScan = count;
+                scanIPRange(startIp, endIp, appState.portScanTimeoutMs, &appState.discoveredHosts);
                 appState.scanningNetwork = false;
                 appState.scanThreadRunning = false;
                 std::cout << "[Fallback] Full-range scan complete: " << appState.discoveredHosts.size() << " hosts" << std::endl;
@@ -3944,34 +4366,7 @@ void startLightningScan(const std::string& subnet) {
         std::cout << "[Lightning Scanner] Phase 2: Scanning " << activeHostsFiltered.size() 
                   << " hosts for file services..." << std::endl;
         
-        const int BATCH_SIZE = 10; // Parallel scanning
-        std::vector<std::future<PortScanResult>> futures;
-        
-        for (const auto& ip : activeHostsFiltered) {
-            if (!appState.scanThreadRunning) break;
-            
-            // Async port scan
-            futures.push_back(std::async(std::launch::async, 
-                [ip]() { return scanHostPorts(ip, 50); } // 50ms timeout pro Port
-            ));
-            
-            // Batch-Limit erreicht oder letzte IP
-            if (futures.size() >= BATCH_SIZE || ip == activeHosts.back()) {
-                for (auto& future : futures) {
-                    auto result = future.get();
-                    
-                    // Nur Hosts mit offenen Ports speichern
-                            if (!result.openPorts.empty()) {
-                        std::lock_guard<std::mutex> lock(hostsMutex);
-                        appState.discoveredHosts.push_back(result.ip);
-                        std::cout << "[Scanner] " << result.hostIdentifier << std::endl;
-                    }
-                    
-                    appState.scannedHosts++;
-                }
-                futures.clear();
-            }
-        }
+        probeFileServices(activeHostsFiltered, "Lightning Scanner");
         
         appState.scanningNetwork = false;
         appState.scanThreadRunning = false;
@@ -3981,8 +4376,11 @@ void startLightningScan(const std::string& subnet) {
             int idx = appState.currentPresetScanningIndex;
             SubnetPreset &p = appState.subnetPresets[idx];
             p.lastScannedAt = time(nullptr);
-            p.lastFoundHosts = appState.discoveredHosts.size();
-            p.lastResults = appState.discoveredHosts;
+            {
+                std::lock_guard<std::mutex> lock(hostsMutex);
+                p.lastResults = appState.discoveredHosts;
+            }
+            p.lastFoundHosts = p.lastResults.size();
             saveSubnetPresets();
             appState.currentPresetScanningIndex = -1;
             std::cout << "[Preset] Updated preset '" << p.name << "' with " << p.lastFoundHosts << " hosts" << std::endl;
@@ -5772,8 +6170,8 @@ void renderNetworkScanner() {
                 for (size_t i = 0; i < appState.ftpPresets.size(); i++) {
                     const auto& preset = appState.ftpPresets[i];
                     
-                    // Filter: Nur FTP/SFTP Presets in FTP-Tab anzeigen
-                    if (preset.serviceType != "FTP" && preset.serviceType != "SFTP") continue;
+                    // Filter: Nur FTP/SFTP/S3 Presets in FTP-Tab anzeigen
+                    if (preset.serviceType != "FTP" && preset.serviceType != "SFTP" && preset.serviceType != "S3") continue;
                     
                     // Zeige: [Dienst] Name - IP:Port
                     std::string displayText = "[" + preset.serviceType + "] " + preset.name + " - " +
@@ -5789,6 +6187,8 @@ void renderNetworkScanner() {
                         textColor = ImVec4(1.0f, 1.0f, 0.3f, 1.0f); // SMB = GELB
                     } else if (preset.serviceType == "WebDAV") {
                         textColor = ImVec4(0.3f, 1.0f, 0.3f, 1.0f); // WebDAV = GRÜN
+                    } else if (preset.serviceType == "S3") {
+                        textColor = ImVec4(0.8f, 0.5f, 1.0f, 1.0f); // S3 = VIOLETT
                     } else {
                         textColor = ImVec4(0.8f, 0.8f, 0.8f, 1.0f); // Standard = GRAU
                     }
@@ -5919,7 +6319,7 @@ void renderNetworkScanner() {
             ImGui::Text("Dienst:");
             ImGui::NextColumn();
             ImGui::SetNextItemWidth(-1);
-            const char* serviceTypes[] = { "FTP", "SFTP", "SMB", "NFS", "WebDAV" };
+            const char* serviceTypes[] = { "FTP", "SFTP", "SMB", "NFS", "WebDAV", "S3" };
             static int currentService = 0;
             if (ImGui::Combo("##ServiceType", &currentService, serviceTypes, IM_ARRAYSIZE(serviceTypes))) {
                 strncpy(serviceType, serviceTypes[currentService], sizeof(serviceType) - 1);
@@ -5929,6 +6329,7 @@ void renderNetworkScanner() {
                 else if (strcmp(serviceType, "SMB") == 0) appState.ftpPort = 445;
                 else if (strcmp(serviceType, "NFS") == 0) appState.ftpPort = 2049;
                 else if (strcmp(serviceType, "WebDAV") == 0) appState.ftpPort = 8080;
+                else if (strcmp(serviceType, "S3") == 0) appState.ftpPort = 9000;
             }
             ImGui::NextColumn();
             
@@ -5959,6 +6360,22 @@ void renderNetworkScanner() {
             appState.ftpPassword = password;
             ImGui::NextColumn();
             
+            // S3: Benutzername/Passwort sind Access Key/Secret Key
+            static char s3Region[64] = "us-east-1";
+            static bool s3UseSSL = false;
+            if (strcmp(serviceType, "S3") == 0) {
+                ImGui::Text("Region:");
+                ImGui::NextColumn();
+                ImGui::SetNextItemWidth(-1);
+                ImGui::InputText("##S3Region", s3Region, sizeof(s3Region));
+                ImGui::NextColumn();
+                
+                ImGui::Text("HTTPS:");
+                ImGui::NextColumn();
+                ImGui::Checkbox("##S3UseSSL", &s3UseSSL);
+                ImGui::NextColumn();
+            }
+            
             ImGui::Columns(1);
             
             ImGui::Spacing();
@@ -5973,6 +6390,10 @@ void renderNetworkScanner() {
                     newPreset.port = appState.ftpPort;
                     newPreset.username = username;
                     newPreset.password = password;
+                    if (newPreset.serviceType == "S3") {
+                        newPreset.s3Region = s3Region;
+                        newPreset.s3UseSSL = s3UseSSL;
+                    }
                     
                     appState.ftpPresets.push_back(newPreset);
                     saveFtpPresets();
@@ -6143,6 +6564,16 @@ void renderNetworkScanner() {
                                     saveFtpPresets();
                                 }
                             }
+                            if (isLibnfsAvailable()) {
+                                if (ImGui::MenuItem("🚀 Ohne Mount scannen (libnfs)")) {
+                                    // Userspace NFS client: no root, no mount; READDIRPLUS + pipelined reads
+                                    appState.selectedFtpDirs.insert(nfsUrl(preset->ip, preset->nfsExportPath));
+                                    std::cout << "[NFS] Scan root (libnfs): " << nfsUrl(preset->ip, preset->nfsExportPath) << std::endl;
+                                }
+                                if (ImGui::IsItemHovered()) {
+                                    ImGui::SetTooltip("Export wird ohne Kernel-Mount gelesen.\nServer braucht ggf. die Export-Option \"insecure\"\n(Client nutzt keinen privilegierten Port).");
+                                }
+                            }
                             if (ImGui::MenuItem("🗑️ Preset löschen")) {
                                 // Find actual index in ftpPresets
                                 for (size_t j = 0; j < appState.ftpPresets.size(); j++) {
@@ -6221,8 +6652,31 @@ void renderNetworkScanner() {
             
             ImGui::Text("NFS Server:");
             ImGui::NextColumn();
-            ImGui::SetNextItemWidth(-1);
+            ImGui::SetNextItemWidth(-110);
             ImGui::InputText("##NfsServer", nfsServer, sizeof(nfsServer));
+            // Export-Liste per MOUNT-Protokoll (kein showmount), pro Server 5 Minuten gecacht
+            static std::mutex nfsFoundExportsMutex;
+            static std::vector<std::string> nfsFoundExports;
+            static std::string nfsFoundExportsStatus;
+            static std::atomic<bool> nfsExportsSearching{false};
+            ImGui::SameLine();
+            if (ImGui::Button(nfsExportsSearching ? "Suche..." : "🔍 Exports", ImVec2(-1, 0)) && !nfsExportsSearching && strlen(nfsServer) > 0) {
+                nfsExportsSearching = true;
+                std::string server = nfsServer;
+                std::thread([server]() {
+                    NfsExportReply reply = cachedNfsExports({server})[0];
+                    {
+                        std::lock_guard<std::mutex> lock(nfsFoundExportsMutex);
+                        nfsFoundExports.clear();
+                        for (const auto& entry : reply.exports) nfsFoundExports.push_back(entry.path);
+                        nfsFoundExportsStatus = reply.ok ? std::to_string(reply.exports.size()) + " Export(s) auf " + server
+                                                         : "Keine Exports von " + server + " (" + reply.error + ")";
+                    }
+                    std::cout << "[NFS] " << server << ": " << reply.exports.size() << " exports"
+                              << (reply.ok ? "" : " - " + reply.error) << std::endl;
+                    nfsExportsSearching = false;
+                }).detach();
+            }
             ImGui::NextColumn();
             
             ImGui::Text("Export Pfad:");
@@ -6232,6 +6686,21 @@ void renderNetworkScanner() {
             if (ImGui::IsItemHovered()) {
                 ImGui::SetTooltip("Der Share-Pfad auf dem NFS Server, z.B. /export/data");
             }
+            {
+                std::lock_guard<std::mutex> lock(nfsFoundExportsMutex);
+                if (!nfsFoundExportsStatus.empty()) {
+                    ImGui::SetNextItemWidth(-1);
+                    if (ImGui::BeginCombo("##NfsFoundExports", nfsFoundExportsStatus.c_str())) {
+                        for (const auto& path : nfsFoundExports) {
+                            if (ImGui::Selectable(path.c_str(), path == nfsExportPath)) {
+                                strncpy(nfsExportPath, path.c_str(), sizeof(nfsExportPath) - 1);
+                                nfsExportPath[sizeof(nfsExportPath) - 1] = '\0';
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+                }
+            }
             ImGui::NextColumn();
             
             ImGui::Text("Benutzername:");
@@ -6524,6 +6993,18 @@ void renderNetworkScanner() {
                                     saveFtpPresets();
                                 }
                             }
+                            if (isLibsmb2Available()) {
+                                std::string smbServer, smbShare;
+                                if (!parseSmbSharePath(preset->smbSharePath, smbServer, smbShare)) {
+                                    smbServer = preset->ip;
+                                    smbShare = preset->name;
+                                }
+                                if (ImGui::MenuItem("🚀 Ohne Mount scannen (libsmb2)")) {
+                                    // Userspace SMB2/3 client: no sudo, no cifs; several reads in flight per file
+                                    appState.selectedFtpDirs.insert(smbUrl(smbServer, smbShare));
+                                    std::cout << "[SMB] Scan root (libsmb2): " << smbUrl(smbServer, smbShare) << std::endl;
+                                }
+                            }
                             ImGui::Separator();
                             // Removed 'Add preset' from context menu (we keep presets in the header Add button)
                             if (ImGui::MenuItem("🗑️ Preset löschen")) {
@@ -6902,6 +7383,16 @@ void renderNetworkScanner() {
                                     saveFtpPresets();
                                 }
                             }
+                            {
+                                std::string davHttp = preset->davUrl;
+                                if (davHttp.empty()) davHttp = std::string(preset->davUseSSL ? "https" : "http") + "://" + preset->ip + "/webdav";
+                                if (ImGui::MenuItem("🚀 Ohne Mount scannen (HTTP)")) {
+                                    // PROPFIND + range GETs over libcurl: no davfs2, no copy in its local cache
+                                    appState.selectedFtpDirs.insert(davUrlFromHttp(davHttp));
+                                    std::cout << "[WebDAV] Scan root (HTTP): " << davUrlFromHttp(davHttp) << std::endl;
+                                }
+                            }
+                            ImGui::Separator();
                             if (ImGui::MenuItem("🗑️ Preset löschen")) {
                                 // Find actual index in ftpPresets
                                 for (size_t j = 0; j < appState.ftpPresets.size(); j++) {
@@ -7128,6 +7619,26 @@ void renderNetworkScanner() {
                 std::cout << "[Network UI] Warning: scanning flag set but no thread running; resetting state" << std::endl;
                 appState.scanningNetwork = false;
             }
+            // Tab just (re)opened: start following neighbour events and service announcements and
+            // show the cached services of the last scans right away instead of an empty list
+            static int lastNetworkTabFrame = -2;
+            if (ImGui::GetFrameCount() != lastNetworkTabFrame + 1 && !appState.scanningNetwork) {
+                if (!neighborCache.isRunning()) neighborCache.start();
+                startServiceDiscovery();
+                auto announced = announcedHosts();
+                std::lock_guard<std::mutex> lock(hostsMutex);
+                if (appState.discoveredHosts.empty()) {
+                    for (const auto& cached : neighborCache.cachedServices(0, 0xffffffff, discoveryServiceTtlSeconds())) {
+                        if (cached.openPorts.empty()) continue;
+                        PortScanHostResult host;
+                        host.ip = cached.ip;
+                        host.openPorts = cached.openPorts;
+                        appState.discoveredHosts.push_back(describeFileServices(host));
+                    }
+                }
+                for (const auto& [ip, entry] : announced) upsertDiscoveredHost(ip, entry);
+            }
+            lastNetworkTabFrame = ImGui::GetFrameCount();
             ImGui::Separator();
             
             // Subnet Presets (NEW)
@@ -7255,63 +7766,42 @@ void renderNetworkScanner() {
                         startLightningScan(std::string(subnet));
                     } else {
                         // Launch ARP-based scan in a background thread (copy the string)
+                        portScanCancel = false;
                         std::thread([s = std::string(subnet)]() {
-                            appState.discoveredHosts.clear();
+                            {
+                                std::lock_guard<std::mutex> lock(hostsMutex);
+                                appState.discoveredHosts.clear();
+                            }
                             appState.scanStatus = "Scanne Netzwerk mit ARP...";
                             std::cout << "[Network] Scanning " << s << " with ARP service detection..." << std::endl;
+                            // In-process ICMP/ARP sweep of the subnet; huge ranges only use the ARP cache
                             std::vector<std::string> liveHosts;
-                            FILE *arpPipe = popen("arp -a 2>/dev/null | grep -oE '([0-9]{1,3}\\.){3}[0-9]{1,3}' | sort -u", "r");
-                            if (arpPipe) {
-                                char ipBuf[256];
-                                while (fgets(ipBuf, sizeof(ipBuf), arpPipe)) {
-                                    std::string ip(ipBuf);
-                                    ip.erase(ip.find_last_not_of("\n\r") + 1);
-                                    if (!ip.empty()) {
-                                        liveHosts.push_back(ip);
-                                    }
-                                }
-                                pclose(arpPipe);
+                            HostSweepStats sweepStats;
+                            uint32_t rstart = 0, rend = 0;
+                            if (cidrToRange(normalizeSubnet(s), rstart, rend) &&
+                                (rend - rstart + 1 <= MAX_FALLBACK_CONFIRM || appState.allowLargeFallback)) {
+                                HostSweepOptions sweepOptions;
+                                sweepOptions.timeoutMs = std::max(1, appState.scanTimeout) * 1000;
+                                liveHosts = sweepSubnet(s, sweepOptions, &portScanCancel, &sweepStats);
+                            } else {
+                                liveHosts = knownNeighborHosts();
                             }
-                            std::cout << "[Network] Found " << liveHosts.size() << " live hosts via ARP" << std::endl;
-                            // Port scanning
-                            const int ports[] = {21, 22, 139, 445, 2049};
-                            const std::string services[] = {"FTP", "SSH", "SMB-NetBIOS", "SMB-CIFS", "NFS"};
-                            for (const auto& host : liveHosts) {
+                            std::cout << "[Network] Found " << liveHosts.size() << " live hosts (ICMP/ARP sweep)" << std::endl;
+                            // Port scanning (epoll, all hosts at once)
+                            massPortScan(liveHosts, filePortScanOptions(), [](const PortScanHostResult& result) {
                                 appState.scannedHosts++;
-                                std::vector<std::string> foundServices;
-                                for (size_t i = 0; i < 5; i++) {
-                                    int sock = socket(AF_INET, SOCK_STREAM, 0);
-                                    if (sock < 0) continue;
-                                    fcntl(sock, F_SETFL, O_NONBLOCK);
-                                    struct sockaddr_in addr;
-                                    addr.sin_family = AF_INET;
-                                    addr.sin_port = htons(ports[i]);
-                                    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
-                                    connect(sock, (struct sockaddr*)&addr, sizeof(addr));
-                                    fd_set fdset;
-                                    FD_ZERO(&fdset);
-                                    FD_SET(sock, &fdset);
-                                    struct timeval tv;
-                                    tv.tv_sec = 0;
-                                    tv.tv_usec = 500000; // 500ms
-                                    if (select(sock + 1, nullptr, &fdset, nullptr, &tv) > 0) {
-                                        foundServices.push_back(services[i]);
-                                        std::cout << "[Service] " << host << ":" << ports[i] << " (" << services[i] << ")" << std::endl;
-                                    }
-                                    close(sock);
-                                }
-                                if (!foundServices.empty()) {
-                                    std::string serviceStr;
-                                    for (size_t i = 0; i < foundServices.size(); i++) {
-                                        if (i > 0) serviceStr += ", ";
-                                        serviceStr += foundServices[i];
-                                    }
-                                    appState.discoveredHosts.push_back(host + " [" + serviceStr + "]");
-                                }
-                            }
+                                if (result.responded) neighborCache.recordServices(result.ip, result.openPorts);
+                                if (result.openPorts.empty()) return;
+                                std::lock_guard<std::mutex> lock(hostsMutex);
+                                appState.discoveredHosts.push_back(describeFileServices(result));
+                            }, logOpenPort, &portScanCancel);
+                            neighborCache.save(discoveryCachePath());
                             appState.scanningNetwork = false;
                             std::cout << "[Network] Found " << appState.discoveredHosts.size() << " servers with services" << std::endl;
-                            appState.scanStatus = "Netzwerk-Scan abgeschlossen";
+                            // Without ICMP an empty result says nothing about hosts outside the local subnet
+                            appState.scanStatus = sweepStats.error.empty()
+                                ? "Netzwerk-Scan abgeschlossen"
+                                : "Netzwerk-Scan abgeschlossen (ICMP nicht verfügbar - nur lokales Subnetz per ARP)";
                         }).detach();
                     }
                 }
@@ -7328,31 +7818,61 @@ void renderNetworkScanner() {
             ImGui::SameLine();
             ImGui::InputInt("Threads##scannerThreads", &appState.scannerThreads, 1, 32);
             ImGui::InputInt("Timeout (s)##scanTimeout", &appState.scanTimeout);
-            ImGui::TextColored(ImVec4(0.7f,0.7f,0.7f,1.0f), "Discovery: automatic (ARP → ICMP → full-range fallback)");
-            
-            if (!appState.scanningNetwork) {
-                if (ImGui::Button(appState.useLightningSpeed ? 
-                                 "[[*]] Lightning Scan" : "[SCAN] Scan starten", 
-                                 ImVec2(150, 0))) {
-                    appState.scanningNetwork = true;
-                    
+            if (ImGui::InputInt("Port-Timeout (ms)##portScanTimeoutMs", &appState.portScanTimeoutMs, 50, 500)) {
+                appState.portScanTimeoutMs = std::clamp(appState.portScanTimeoutMs, 10, 10000);
+                saveSettings();
+            }
+            if (ImGui::InputInt("Gleichzeitige Verbindungen##portScanMaxInFlight", &appState.portScanMaxInFlight, 256, 2048)) {
+                appState.portScanMaxInFlight = std::clamp(appState.portScanMaxInFlight, 1, 65536);
+                saveSettings();
+            }
+            if (ImGui::InputInt("Rate (Verbindungen/s, 0 = unbegrenzt)##portScanRate", &appState.portScanRate, 1000, 10000)) {
+                appState.portScanRate = std::max(0, appState.portScanRate);
+                saveSettings();
+            }
+            if (ImGui::InputInt("Dienste-Cache (min, 0 = immer neu prüfen)##discoveryServiceTtlMinutes", &appState.discoveryServiceTtlMinutes, 15, 60)) {
+                appState.discoveryServiceTtlMinutes = std::clamp(appState.discoveryServiceTtlMinutes, 0, 7 * 24 * 60);
+                saveSettings();
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Leeren##discoveryCache")) {
+                neighborCache.clearServices();
+                neighborCache.save(discoveryCachePath());
+            }
+            if (ImGui::Checkbox("mDNS/SSDP-Ankündigungen (NAS ohne Port-Scan finden)##useServiceDiscovery", &appState.useServiceDiscovery)) {
+                if (appState.useServiceDiscovery) startServiceDiscovery();
+                else serviceBrowser.stop();
+                saveSettings();
+            }
+            ImGui::TextColored(ImVec4(0.7f,0.7f,0.7f,1.0f), "Discovery: automatic (mDNS/SSDP + ARP → ICMP → full-range fallback)");
+            
+            if (!appState.scanningNetwork) {
+                if (ImGui::Button(appState.useLightningSpeed ? 
+                                 "[[*]] Lightning Scan" : "[SCAN] Scan starten", 
+                                 ImVec2(150, 0))) {
+                    appState.scanningNetwork = true;
+                    
                     if (appState.useLightningSpeed) {
                         // Lightning Speed: Asynchroner Multi-Thread-Scan
                         // Start Lightning Scan which may use ARP discovery by default
                         startLightningScan(std::string(subnet));
                     } else {
                         // ARP-basierter Service-Scanner: Findet nur Live-Hosts mit Services
+                        portScanCancel = false;
                         std::thread([subnet]() {
-                            appState.discoveredHosts.clear();
+                            {
+                                std::lock_guard<std::mutex> lock(hostsMutex);
+                                appState.discoveredHosts.clear();
+                            }
                             appState.scanStatus = "Scanne Netzwerk mit ARP...";
                             std::cout << "[Network] Scanning " << subnet << " with ARP service detection..." << std::endl;
                             
                             // Step 1: Get live hosts using selected discovery method
                             std::string normalizedSubnet = normalizeSubnet(subnet);
                             std::vector<std::string> liveHosts;
-                            // Prefer ARP locally (very fast); for remote subnets use nmap
+                            // Prefer the ARP cache locally (instant); remote subnets get an ICMP sweep
                             if (isSubnetLocal(normalizedSubnet)) {
-                                auto arpHosts = getActiveHostsViaARP();
+                                auto arpHosts = knownNeighborHosts();
                                 uint32_t rstart = 0, rend = 0;
                                 if (cidrToRange(normalizedSubnet, rstart, rend)) {
                                     auto ip2int = [](const std::string &ip) -> uint32_t { struct in_addr a; inet_pton(AF_INET, ip.c_str(), &a); return ntohl(a.s_addr); };
@@ -7368,7 +7888,7 @@ void renderNetworkScanner() {
                                 NetworkScanner ns;
                                 liveHosts = ns.scanSubnet(normalizedSubnet);
                             }
-                            // If ARP found none, try ICMP/ping sweep inside the same CIDR
+                            // If the ARP cache knows none, sweep the CIDR (ARP requests on-link, ICMP otherwise)
                             if (liveHosts.empty()) {
                                 uint32_t startIpNumeric = 0, endIpNumeric = 0;
                                 if (cidrToRange(normalizedSubnet, startIpNumeric, endIpNumeric)) {
@@ -7394,83 +7914,21 @@ void renderNetworkScanner() {
                                     }
                                 }
                             }
-                            // OPTIMIZED: Use popen instead of system() for piped commands
-                            FILE *arpPipe = popen("arp -a 2>/dev/null | grep -oE '([0-9]{1,3}\\.){3}[0-9]{1,3}' | sort -u", "r");
-                            if (arpPipe) {
-                                char ipBuf[256];
-                                while (fgets(ipBuf, sizeof(ipBuf), arpPipe)) {
-                                    std::string ip(ipBuf);
-                                    ip.erase(ip.find_last_not_of("\n\r") + 1);
-                                    if (!ip.empty()) {
-                                        // Process IP directly instead of writing to file
-                                    }
-                                }
-                                pclose(arpPipe);
-                            }
-                            
-                            std::ifstream arpFile("/tmp/fileduper_arp.txt");
-                            if (arpFile.is_open()) {
-                                std::string line;
-                                while (std::getline(arpFile, line)) {
-                                    if (!line.empty() && line.find('.') != std::string::npos) {
-                                        liveHosts.push_back(line);
-                                    }
-                                }
-                                arpFile.close();
-                            }
-                            
                             std::cout << "[Network] Found " << liveHosts.size() << " live hosts via ARP" << std::endl;
                             
                             // Step 2: Port scanning for services (21=FTP, 22=SSH, 139/445=SMB, 2049=NFS)
-                            const int ports[] = {21, 22, 139, 445, 2049};
-                            const std::string services[] = {"FTP", "SSH", "SMB-NetBIOS", "SMB-CIFS", "NFS"};
-                            
-                            std::map<std::string, std::vector<std::string>> hostsWithServices;
-                            
-                            for (const auto& host : liveHosts) {
+                            // One epoll loop for all hosts; hosts show up in the list as soon as they are done
+                            PortScanStats stats = massPortScan(liveHosts, filePortScanOptions(), [](const PortScanHostResult& result) {
                                 appState.scannedHosts++;
-                                std::vector<std::string> foundServices;
-                                
-                                for (size_t i = 0; i < 5; i++) {
-                                    // Ultra-fast TCP connect test (non-blocking)
-                                    int sock = socket(AF_INET, SOCK_STREAM, 0);
-                                    if (sock < 0) continue;
-                                    
-                                    fcntl(sock, F_SETFL, O_NONBLOCK);
-                                    
-                                    struct sockaddr_in addr;
-                                    addr.sin_family = AF_INET;
-                                    addr.sin_port = htons(ports[i]);
-                                    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
-                                    
-                                    connect(sock, (struct sockaddr*)&addr, sizeof(addr));
-                                    
-                                    fd_set fdset;
-                                    FD_ZERO(&fdset);
-                                    FD_SET(sock, &fdset);
-                                    
-                                    struct timeval tv;
-                                    tv.tv_sec = 0;
-                                    tv.tv_usec = 500000; // 500ms timeout
-                                    
-                                    if (select(sock + 1, nullptr, &fdset, nullptr, &tv) > 0) {
-                                        foundServices.push_back(services[i]);
-                                        std::cout << "[Service] " << host << ":" << ports[i] << " (" << services[i] << ")" << std::endl;
-                                    }
-                                    close(sock);
-                                }
-                                
+                                if (result.responded) neighborCache.recordServices(result.ip, result.openPorts);
                                 // Only show hosts with at least one service
-                                if (!foundServices.empty()) {
-                                    std::string serviceStr;
-                                    for (size_t i = 0; i < foundServices.size(); i++) {
-                                        if (i > 0) serviceStr += ", ";
-                                        serviceStr += foundServices[i];
-                                    }
-                                    appState.discoveredHosts.push_back(host + " [" + serviceStr + "]");
-                                    std::cout << "[Found] " << host << " with " << serviceStr << std::endl;
-                                }
-                            }
+                                if (result.openPorts.empty()) return;
+                                std::lock_guard<std::mutex> lock(hostsMutex);
+                                appState.discoveredHosts.push_back(describeFileServices(result));
+                                std::cout << "[Found] " << describeFileServices(result) << std::endl;
+                            }, logOpenPort, &portScanCancel);
+                            logPortScanStats("Network", stats);
+                            neighborCache.save(discoveryCachePath());
                             
                             appState.scanningNetwork = false;
                             std::cout << "[Network] Found " << appState.discoveredHosts.size() << " servers with services" << std::endl;
@@ -7496,6 +7954,7 @@ void renderNetworkScanner() {
                 // Stop-Button
                 ImGui::SameLine();
                 if (ImGui::Button("[STOP]", ImVec2(70, 0))) {
+                    portScanCancel = true;
                     appState.scanThreadRunning = false;
                     appState.scanningNetwork = false;
                     std::cout << "[Lightning] Scan stopped by user" << std::endl;
@@ -7511,13 +7970,19 @@ void renderNetworkScanner() {
                                   appState.scannerThreads, appState.scanTimeout);
             }
             
+            // Scan threads and the mDNS/SSDP browser change the list at any time: draw a copy
+            std::vector<std::string> discoveredHosts;
+            {
+                std::lock_guard<std::mutex> lock(hostsMutex);
+                discoveredHosts = appState.discoveredHosts;
+            }
             ImGui::Separator();
             ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), 
-                              "Gefundene Hosts: %zu", appState.discoveredHosts.size());
+                              "Gefundene Hosts: %zu", discoveredHosts.size());
             
             ImGui::BeginChild("DiscoveredHosts", ImVec2(0, -40), true);
-            for (size_t i = 0; i < appState.discoveredHosts.size(); i++) {
-                const auto& host = appState.discoveredHosts[i];
+            for (size_t i = 0; i < discoveredHosts.size(); i++) {
+                const auto& host = discoveredHosts[i];
                 
                 // Selectable mit Doppelklick
                 bool selected = appState.selectedFtpHost == host;
@@ -7663,8 +8128,11 @@ void renderNetworkScanner() {
                         newPreset.subnet = addSubnet;
                         newPreset.createdAt = time(nullptr);
                         newPreset.lastScannedAt = time(nullptr);
-                        newPreset.lastFoundHosts = appState.discoveredHosts.size();
-                        newPreset.lastResults = appState.discoveredHosts;
+                        {
+                            std::lock_guard<std::mutex> lock(hostsMutex);
+                            newPreset.lastResults = appState.discoveredHosts;
+                        }
+                        newPreset.lastFoundHosts = newPreset.lastResults.size();
                         newPreset.useLightning = addLightning;
                         newPreset.scannerThreads = addThreads;
                         newPreset.scanTimeout = addTimeout;
@@ -7745,6 +8213,55 @@ void renderNetworkScanner() {
     ImGui::PopStyleVar();
 }
 
+// Render a mapped .fds v2 snapshot page by page (caller holds resultsMutex).
+// Paths are read straight from the mapping; nothing is copied until the user
+// switches to the editable view.
+static void renderSnapshotResults() {
+    const uint64_t groupsPerPage = 200;
+    uint64_t groupCount = loadedSnapshot.groupCount();
+    uint64_t pageCount = std::max<uint64_t>(1, (groupCount + groupsPerPage - 1) / groupsPerPage);
+    if (appState.snapshotPage < 0) appState.snapshotPage = 0;
+    if ((uint64_t)appState.snapshotPage >= pageCount) appState.snapshotPage = pageCount - 1;
+    
+    ImGui::TextColored(ImVec4(0.5f, 0.8f, 1.0f, 1.0f), "[SNAP] %s (nur lesen, %llu Gruppen)",
+                       loadedSnapshot.filename().c_str(), (unsigned long long)groupCount);
+    if (ImGui::Button("< Zurück") && appState.snapshotPage > 0) appState.snapshotPage--;
+    ImGui::SameLine();
+    ImGui::Text("Seite %d / %llu", appState.snapshotPage + 1, (unsigned long long)pageCount);
+    ImGui::SameLine();
+    if (ImGui::Button("Weiter >") && (uint64_t)(appState.snapshotPage + 1) < pageCount) appState.snapshotPage++;
+    ImGui::SameLine();
+    if (ImGui::Button("[EDIT] Bearbeitbar laden")) {
+        // Materialize all groups so marking/deleting works as after a scan
+        appState.duplicates.reserve(groupCount);
+        for (uint64_t g = 0; g < groupCount; g++) {
+            ScanSnapshotGroup snap = loadedSnapshot.loadGroup(g);
+            DuplicateGroup group;
+            group.hash = std::move(snap.hash);
+            group.size = snap.size;
+            group.files = std::move(snap.files);
+            appState.duplicates.push_back(std::move(group));
+        }
+        loadedSnapshot.close();
+        return;
+    }
+    
+    uint64_t first = (uint64_t)appState.snapshotPage * groupsPerPage;
+    uint64_t last = std::min(groupCount, first + groupsPerPage);
+    for (uint64_t g = first; g < last; g++) {
+        uint32_t fileCount = loadedSnapshot.groupFileCount(g);
+        std::string_view hash = loadedSnapshot.groupHash(g);
+        ImGui::Separator();
+        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "▶ Gruppe %llu (%u Dateien, %s)",
+                           (unsigned long long)g + 1, fileCount, formatSize(loadedSnapshot.groupSize(g)).c_str());
+        ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "  %.*s", (int)hash.size(), hash.data());
+        for (uint32_t j = 0; j < fileCount; j++) {
+            std::string_view file = loadedSnapshot.groupFile(g, j);
+            ImGui::Text("  %.*s", (int)file.size(), file.data());
+        }
+    }
+}
+
 // Render Main Window
 void renderMainWindow() {
     ImVec2 displaySize = ImGui::GetIO().DisplaySize;
@@ -8196,6 +8713,21 @@ void renderMainWindow() {
         } else {
             ImGui::Text("%8.3f KB/s", appState.networkBandwidth * 1024.0f);
         }
+        if (appState.ftpBytesSaved > 0) {
+            long long transferred = appState.ftpBytesTransferred.load();
+            long long saved = appState.ftpBytesSaved.load();
+            ImGui::TextDisabled("      FTP: %.1f MB übertragen, %.1f MB gespart (%.0f%%)",
+                                transferred / (1024.0 * 1024.0), saved / (1024.0 * 1024.0),
+                                100.0 * saved / std::max(1LL, saved + transferred));
+        }
+        {
+            std::string plan;
+            {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                plan = appState.remoteHashPlan;
+            }
+            if (!plan.empty()) ImGui::TextDisabled("      Plan: %s", plan.c_str());
+        }
         
         // Dateien Status
         float fileProgress = 0.0f;
@@ -8293,6 +8825,9 @@ void renderMainWindow() {
                     ImGui::BeginChild("ResultsList", ImVec2(0, -40), true);
                     {
                         std::lock_guard<std::mutex> lock(resultsMutex);
+                        if (appState.duplicates.empty() && loadedSnapshot.isOpen()) {
+                            renderSnapshotResults();
+                        }
                         for (size_t i = 0; i < appState.duplicates.size(); i++) {
                             auto& group = appState.duplicates[i];
                             
@@ -8727,6 +9262,13 @@ void renderMainWindow() {
                                                     std::vector<std::string> filesToKeep;
                                                     std::vector<time_t> mtimesToKeep;
                                                     
+                                                    // Delete in one go (FTP: batched per server)
+                                                    std::vector<std::string> toDelete;
+                                                    for (size_t k = 0; k < group.files.size(); k++) {
+                                                        if (k != bestOriginalIdx) toDelete.push_back(group.files[k]);
+                                                    }
+                                                    std::set<std::string> deleted = deleteFiles(toDelete);
+                                                    
                                                     for (size_t k = 0; k < group.files.size(); k++) {
                                                         if (k == bestOriginalIdx) {
                                                             // Keep this file as original
@@ -8739,18 +9281,9 @@ void renderMainWindow() {
                                                         
                                                         const auto& dupFile = group.files[k];
                                                         
-                                                        // Get file size - each duplicate has same size as original
-                                                        if (isFtpFile(dupFile)) {
-                                                            totalSize += singleFileSize; // Add size of THIS duplicate
-                                                        } else {
-                                                            struct stat st;
-                                                            if (stat(dupFile.c_str(), &st) == 0) {
-                                                                totalSize += st.st_size;
-                                                            }
-                                                        }
-                                                        
-                                                        if (deleteFile(dupFile)) {
+                                                        if (deleted.count(dupFile)) {
                                                             std::cout << "[DELETE] Removed duplicate: " << dupFile << std::endl;
+                                                            totalSize += singleFileSize; // Each duplicate has the group's size
                                                             removed++;
                                                             appState.markedForDeletion.erase(dupFile);
                                                         } else {
@@ -8786,6 +9319,17 @@ void renderMainWindow() {
                                                     int totalRemoved = 0;
                                                     long long totalSizeDeleted = 0;
                                                     
+                                                    // Collect first, then delete in one go (FTP: batched per server)
+                                                    std::vector<std::string> toDelete;
+                                                    for (const auto& grp : appState.duplicates) {
+                                                        if (grp.files.size() < 2) continue;
+                                                        size_t bestIdx = findBestOriginalFile(grp.files);
+                                                        for (size_t k = 0; k < grp.files.size(); k++) {
+                                                            if (k != bestIdx) toDelete.push_back(grp.files[k]);
+                                                        }
+                                                    }
+                                                    std::set<std::string> deleted = deleteFiles(toDelete);
+                                                    
                                                     for (auto& grp : appState.duplicates) {
                                                         if (grp.files.size() < 2) continue; // Skip non-duplicates
                                                         
@@ -8804,7 +9348,7 @@ void renderMainWindow() {
                                                                 continue;
                                                             }
                                                             
-                                                            if (deleteFile(grp.files[k])) {
+                                                            if (deleted.count(grp.files[k])) {
                                                                 totalRemoved++;
                                                                 totalSizeDeleted += fileSize;
                                                                 appState.markedForDeletion.erase(grp.files[k]);
@@ -8859,26 +9403,33 @@ void renderMainWindow() {
                             int removed = 0;
                             long long totalSize = 0;
                             std::vector<std::string> toRemove;
+                            std::vector<std::string> toDelete;
+                            std::map<std::string, long long> fileSizes;
                             for (const auto& pair : appState.markedForDeletion) {
-                                if (pair.second) {
-                                    // Get file size before deletion
-                                    if (isFtpFile(pair.first)) {
-                                        // For FTP files, find size from duplicate groups
-                                        for (const auto& group : appState.duplicates) {
-                                            if (std::find(group.files.begin(), group.files.end(), pair.first) != group.files.end()) {
-                                                totalSize += group.size;
-                                                break;
-                                            }
-                                        }
-                                    } else {
-                                        struct stat st;
-                                        if (stat(pair.first.c_str(), &st) == 0) {
-                                            totalSize += st.st_size;
+                                if (!pair.second) continue;
+                                toDelete.push_back(pair.first);
+                                // Get file size before deletion
+                                if (isFtpFile(pair.first)) {
+                                    // For FTP files, find size from duplicate groups
+                                    for (const auto& group : appState.duplicates) {
+                                        if (std::find(group.files.begin(), group.files.end(), pair.first) != group.files.end()) {
+                                            fileSizes[pair.first] = group.size;
+                                            break;
                                         }
                                     }
-                                    
-                                    if (deleteFile(pair.first)) {
+                                } else {
+                                    struct stat st;
+                                    if (stat(pair.first.c_str(), &st) == 0) {
+                                        fileSizes[pair.first] = st.st_size;
+                                    }
+                                }
+                            }
+                            std::set<std::string> deleted = deleteFiles(toDelete); // FTP: batched per server
+                            for (const auto& pair : appState.markedForDeletion) {
+                                if (pair.second) {
+                                    if (deleted.count(pair.first)) {
                                         std::cout << "[DELETE] Removed: " << pair.first << std::endl;
+                                        totalSize += fileSizes[pair.first];
                                         removed++;
                                         toRemove.push_back(pair.first);
                                         
@@ -9567,12 +10118,16 @@ void renderSettings() {
             
             // FTP Max Connections (MEGA OPTIMIZATION!)
             if (ImGui::SliderInt("🔗 Max FTP-Verbindungen", &appState.ftpMaxConnections, 1, 32)) {
+                ftpHandlePool.setMaxConnectionsPerServer(appState.ftpMaxConnections);
+                ftpMultiEngine.setLimits(appState.ftpMaxConnections, appState.ftpMultiMaxTransfers);
                 saveScannerSettings();
                 std::cout << "[Config] FTP max connections set to: " << appState.ftpMaxConnections << std::endl;
             }
             ImGui::SameLine();
             if (ImGui::Button("Auto##ftpconn")) {
                 appState.ftpMaxConnections = 8; // Optimal: 8 parallele Connections
+                ftpHandlePool.setMaxConnectionsPerServer(appState.ftpMaxConnections);
+                ftpMultiEngine.setLimits(appState.ftpMaxConnections, appState.ftpMultiMaxTransfers);
                 saveScannerSettings();
                 std::cout << "[Config] FTP max connections auto-set to: " << appState.ftpMaxConnections << std::endl;
             }
@@ -9581,31 +10136,134 @@ void renderSettings() {
             ImGui::TextDisabled("  • Empfohlen: 8 für LAN, 4 für Internet");
             ImGui::Spacing();
             
+            // Event-driven multi engine
+            if (ImGui::Checkbox("⚡ Multi-Engine (curl_multi + epoll)", &appState.ftpUseMultiEngine)) {
+                saveSettings();
+                std::cout << "[Config] FTP multi engine: " << (appState.ftpUseMultiEngine ? "ON" : "OFF") << std::endl;
+            }
+            if (appState.ftpUseMultiEngine) {
+                if (ImGui::SliderInt("Max. Transfers gesamt##ftpMultiMax", &appState.ftpMultiMaxTransfers, 8, 512)) {
+                    ftpMultiEngine.setLimits(appState.ftpMaxConnections, appState.ftpMultiMaxTransfers);
+                    saveSettings();
+                }
+                if (ftpMultiEngine.isRunning()) {
+                    FtpMultiEngine::Stats es = ftpMultiEngine.stats();
+                    ImGui::TextDisabled("  • %d aktiv, %d wartend, %llu fertig, %llu Fehler, %llu Pausen",
+                                        es.active, es.queued, (unsigned long long)es.completed,
+                                        (unsigned long long)es.failed, (unsigned long long)es.pauses);
+                }
+            }
+            ImGui::TextDisabled("  • Alle LIST/RETR-Transfers in einem Event-Loop statt ein Thread pro Verbindung");
+            ImGui::TextDisabled("  • Pro Server weiterhin max. 'Max FTP-Verbindungen'");
+            ImGui::Spacing();
+            
+            // Global WAN budget, adjustable while a scan runs
+            if (ImGui::SliderFloat("📶 Bandbreite gesamt (MB/s, 0 = unbegrenzt)##remoteBw", &appState.remoteBandwidthLimitMB, 0.0f, 200.0f, "%.1f")) {
+                applyRemoteBandwidthLimit();
+                saveSettings();
+            }
+            ImGui::TextDisabled("  • Gilt für alle Remote-Transfers zusammen (Hashing, Stichproben, Listings)");
+            {
+                auto estimates = remoteThroughput.snapshot();
+                for (const auto& [server, estimate] : estimates) {
+                    ImGui::TextDisabled("  • %s: %.1f MB/s pro Transfer, %.0f ms bis zum ersten Byte (%d Messungen)",
+                                        server.c_str(), estimate.bytesPerSec / (1024.0 * 1024.0),
+                                        estimate.latencySec * 1000.0, estimate.samples);
+                }
+                if (!estimates.empty()) {
+                    ImGui::TextDisabled("  • Timeouts und Verbindungszahl folgen diesen Messwerten");
+                }
+            }
+            ImGui::Spacing();
+            
+            // Per-server budget (multi-server scans) for the connected preset
+            if (appState.connectedPresetIndex >= 0 && appState.connectedPresetIndex < (int)appState.ftpPresets.size()) {
+                FtpPreset& budgetPreset = appState.ftpPresets[appState.connectedPresetIndex];
+                ImGui::Text("🌐 Budget für %s:", budgetPreset.name.c_str());
+                bool budgetChanged = false;
+                ImGui::SetNextItemWidth(150);
+                if (ImGui::InputInt("Verbindungen (0 = Standard)##presetMaxConn", &budgetPreset.maxConnections)) budgetChanged = true;
+                ImGui::SetNextItemWidth(150);
+                if (ImGui::InputInt("KB/s (0 = unbegrenzt)##presetBandwidth", &budgetPreset.bandwidthLimitKB, 256, 1024)) budgetChanged = true;
+                if (budgetChanged) {
+                    budgetPreset.maxConnections = std::clamp(budgetPreset.maxConnections, 0, 64);
+                    budgetPreset.bandwidthLimitKB = std::max(0, budgetPreset.bandwidthLimitKB);
+                    saveFtpPresets();
+                }
+                ImGui::TextDisabled("  • Gilt im Scan über mehrere Server (ausgewählte Verzeichnisse aller Presets)");
+                ImGui::Spacing();
+            }
+            
+            // MLSD listings
+            if (ImGui::Checkbox("📋 MLSD verwenden (falls Server es anbietet)", &appState.ftpUseMlsd)) {
+                saveSettings();
+                std::cout << "[Config] FTP MLSD: " << (appState.ftpUseMlsd ? "ON" : "OFF") << std::endl;
+            }
+            ImGui::TextDisabled("  • Exakte Größe + Änderungszeit statt LIST-Textformat");
+            ImGui::TextDisabled("  • Unveränderte FTP-Dateien werden beim nächsten Scan nicht erneut geladen");
+            if (ftpHashCacheHits > 0) {
+                ImGui::TextDisabled("  • Letzter Scan: %d Hashes aus Cache (%.1f MB gespart)",
+                                    ftpHashCacheHits.load(), ftpHashCacheBytesSaved.load() / (1024.0 * 1024.0));
+            }
+            ImGui::Spacing();
+            
+            // Server-side checksums
+            if (ImGui::Checkbox("🧮 Prüfsummen vom Server (HASH/XMD5/XSHA256)", &appState.ftpUseServerHash)) {
+                saveSettings();
+                std::cout << "[Config] FTP server checksums: " << (appState.ftpUseServerHash ? "ON" : "OFF") << std::endl;
+            }
+            ImGui::TextDisabled("  • Server berechnet die Prüfsumme, kein Download nötig");
+            ImGui::TextDisabled("  • Download nur wenn der Server keine Prüfsummen anbietet");
+            if (ftpServerDigests > 0) {
+                ImGui::TextDisabled("  • Letzter Scan: %d Prüfsummen vom Server", ftpServerDigests.load());
+            }
+            ImGui::Spacing();
+            
+            // SFTP: md5sum on the server over SSH exec
+            if (ImGui::Checkbox("🔐 SFTP: Hashen auf dem Server (SSH exec)", &appState.sshRemoteHash)) {
+                saveSettings();
+                std::cout << "[Config] SSH remote hashing: " << (appState.sshRemoteHash ? "ON" : "OFF") << std::endl;
+            }
+            ImGui::TextDisabled("  • md5sum / head / tail laufen auf dem Server, Dateien werden nicht übertragen");
+            ImGui::TextDisabled("  • Ohne md5sum oder Shell-Zugang wird wie bisher über SFTP gelesen");
+            if (sshRemoteDigestCount > 0) {
+                ImGui::TextDisabled("  • Letzter Scan: %d Dateien auf dem Server gehasht", sshRemoteDigestCount.load());
+            }
+            ImGui::Spacing();
+            
             // FTP Reuse Connections
             if (ImGui::Checkbox("♻️ FTP-Verbindungen wiederverwenden", &appState.ftpReuseConnections)) {
+                ftpHandlePool.setReuseConnections(appState.ftpReuseConnections);
                 saveScannerSettings();
                 std::cout << "[Config] FTP reuse connections: " << (appState.ftpReuseConnections ? "ON" : "OFF") << std::endl;
             }
             ImGui::TextDisabled("  • Wiederverwendung von TCP/FTP-Verbindungen");
             ImGui::TextDisabled("  • AN = MASSIV schneller (keine TCP-Handshakes mehr!)");
             ImGui::TextDisabled("  • Empfohlen: IMMER AN (außer bei instabilen Servern)");
+            {
+                auto poolStats = ftpHandlePool.stats();
+                ImGui::TextDisabled("  • Pool: %zu aktiv, %zu frei, %.0f%% Transfers ohne Neuverbindung",
+                                    poolStats.inUse, poolStats.idle, poolStats.reuseRatio() * 100.0);
+            }
             ImGui::Spacing();
             
-            // FTP Min File Size
-            if (ImGui::SliderInt("📏 Min. FTP-Dateigröße (Bytes)", &appState.ftpMinFileSize, 0, 10000)) {
-                saveScannerSettings();
-                std::cout << "[Config] FTP min file size set to: " << appState.ftpMinFileSize << " bytes" << std::endl;
+            // FTP head/tail sample prefilter
+            if (ImGui::Checkbox("🔍 Stichproben-Vorfilter (Anfang + Ende)", &appState.ftpSamplePrefilter)) {
+                saveSettings();
+                std::cout << "[Config] FTP sample prefilter: " << (appState.ftpSamplePrefilter ? "ON" : "OFF") << std::endl;
             }
-            ImGui::SameLine();
-            if (ImGui::Button("Auto##ftpminsize")) {
-                appState.ftpMinFileSize = 100; // Optimal: 100 Bytes
-                saveScannerSettings();
-                std::cout << "[Config] FTP min file size auto-set to: " << appState.ftpMinFileSize << " bytes" << std::endl;
+            if (appState.ftpSamplePrefilter) {
+                if (ImGui::SliderInt("Stichprobe je Ende (KB)##ftpSampleKB", &appState.ftpSampleKB, 4, 1024)) {
+                    saveSettings();
+                }
+            }
+            ImGui::TextDisabled("  • Lädt nur Anfang und Ende gleich großer FTP-Dateien");
+            ImGui::TextDisabled("  • Komplett übertragen wird nur, was danach noch gleich ist");
+            ImGui::TextDisabled("  • Lokale Dateien gleicher Größe werden zuerst gelesen und mit verglichen");
+            ImGui::TextDisabled("  • Kleine Dateien (<= 2x Stichprobe) werden direkt vollständig gehasht");
+            if (appState.ftpBytesSaved > 0) {
+                ImGui::TextDisabled("  • Letzter Scan: %.1f MB nicht übertragen", appState.ftpBytesSaved.load() / (1024.0 * 1024.0));
             }
-            ImGui::TextDisabled("  • Überspringe sehr kleine FTP-Dateien (Overhead zu groß)");
-            ImGui::TextDisabled("  • 0 = alle Dateien hashen (langsam bei vielen kleinen)");
-            ImGui::TextDisabled("  • 100-1000 = nur Dateien >= X Bytes hashen (VIEL schneller!)");
-            ImGui::TextDisabled("  • Empfohlen: 100 Bytes (überspringt 1-Byte-Dateien etc.)");
             ImGui::Spacing();
             
             ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "💡 Performance-Tipp:");
@@ -10030,6 +10688,40 @@ void renderSettings() {
             }
             ImGui::TextDisabled("Speichert bekannte Hashes (schneller bei Re-Scan)");
             
+            if (ImGui::Checkbox("[DIR] Verzeichnis-Listing-Cache (mtime)", &appState.useDirListingCache)) {
+                saveSettings();
+            }
+            ImGui::TextDisabled("Unveränderte Verzeichnisse ohne readdir() einlesen (NFS: viel schneller bei Re-Scan)");
+            
+            if (ImGui::Checkbox("[NET] Metadaten-Prefetch für NFS/SMB-Mounts", &appState.nfsStatPrefetch)) {
+                saveSettings();
+            }
+            ImGui::TextDisabled("Alle Einträge eines Verzeichnisses parallel per statx() abfragen (statt RTT x Einträge)");
+            if (appState.nfsStatPrefetch) {
+                if (ImGui::SliderInt("Prefetch-Threads##nfsStatPrefetchThreads", &appState.nfsStatPrefetchThreads, 4, 128)) {
+                    saveSettings();
+                }
+                if (ImGui::Checkbox("Leicht veraltete Attribute akzeptieren (AT_STATX_DONT_SYNC)", &appState.nfsStatDontSync)) {
+                    saveSettings();
+                }
+                ImGui::TextDisabled("Nutzt den Attribut-Cache des NFS-Clients ohne Revalidierung (Größe/mtime evtl. Sekunden alt)");
+            }
+            
+            if (ImGui::InputInt("Cache-Speicher (MB)##cacheMemoryLimitMB", &appState.cacheMemoryLimitMB, 64, 512)) {
+                appState.cacheMemoryLimitMB = std::max(64, appState.cacheMemoryLimitMB);
+                applyCacheBudgets();
+                saveSettings();
+            }
+            {
+                auto hashStats = hashCache.stats();
+                auto fileStats = fileCache.stats();
+                ImGui::TextDisabled("Hash-Cache: %zu Einträge, %llu Treffer / %llu Fehl / %llu verdrängt",
+                                    hashStats.entries, (unsigned long long)hashStats.hits,
+                                    (unsigned long long)hashStats.misses, (unsigned long long)hashStats.evictions);
+                ImGui::TextDisabled("Datei-Cache: %zu Einträge, %zu / %zu MB",
+                                    fileStats.entries, fileStats.bytes >> 20, fileStats.budget >> 20);
+            }
+            
             ImGui::Spacing();
             ImGui::Separator();
             
@@ -10289,11 +10981,15 @@ void renderSettings() {
             ImGui::SameLine();
             if (ImGui::Button("🔄 Einstellungen neu laden")) {
                 loadSettings();
+                applyCacheBudgets();
+                applyRemoteBandwidthLimit();
                 std::cout << "[Settings] Settings reloaded" << std::endl;
             }
             ImGui::SameLine();
             if (ImGui::Button("🔧 DEFAULT Settings")) {
                 restoreDefaultSettings();
+                applyCacheBudgets();
+                applyRemoteBandwidthLimit();
                 appState.showSettingsRestoredMessage = true;
                 appState.settingsMessageTimer = 3.0f; // Show for 3 seconds
                 std::cout << "[Settings] ✅ DEFAULT settings SOFORT AKTIV & GESPEICHERT!" << std::endl;
@@ -10819,8 +11515,9 @@ void renderServerBrowser() {
                 
                 // Füge neue Server-Verzeichnisse HINZU (kombiniert mit lokalen)
                 for (const auto& dir : appState.selectedServerDirs) {
-                    // Speichere nur den Pfad, z.B. /sdb/Comedy
-                    appState.selectedFtpDirs.insert(dir);
+                    // Mit Herkunft speichern (ftp://host:port/sdb/Comedy) - mehrere Server pro Scan
+                    std::string path = (dir.empty() || dir[0] != '/') ? "/" + dir : dir;
+                    appState.selectedFtpDirs.insert(ftpPresetBaseUrl(preset) + path);
                     std::cout << "[FTP] Added to scan: " << dir << std::endl;
                 }
                 
@@ -12103,11 +12800,10 @@ std::string calculateHash(const std::string& filepath, const std::string& algori
     if (appState.cacheFileHashes) {
         std::pair<ino_t, time_t> cacheKey = {st.st_ino, st.st_mtime};
         
-        std::lock_guard<std::mutex> lock(hashCacheMutex);
-        auto it = hashCache.find(cacheKey);
-        if (it != hashCache.end()) {
+        std::string cachedHash;
+        if (hashCache.get(cacheKey, cachedHash)) {
             // Cache hit! Return cached hash
-            return it->second;
+            return cachedHash;
         }
     }
     
@@ -12330,19 +13026,11 @@ std::string calculateHash(const std::string& filepath, const std::string& algori
     // OPTIMIZATION: Store hash in hash cache (if enabled)
     if (appState.cacheFileHashes && !hashResult.empty()) {
         std::pair<ino_t, time_t> cacheKey = {st.st_ino, st.st_mtime};
-        
-        std::lock_guard<std::mutex> lock(hashCacheMutex);
-        hashCache[cacheKey] = hashResult;
+        hashCache.put(cacheKey, hashResult);
     }
     
     // CACHE: Update file cache with computed hash (for both local and FTP files)
-    {
-        std::lock_guard<std::mutex> lock(fileCacheMutex);
-        auto it = fileCache.find(filepath);
-        if (it != fileCache.end()) {
-            it->second.hash = hashResult;
-        }
-    }
+    fileCache.update(filepath, [&](CachedFileInfo& info) { info.hash = hashResult; });
     
     return hashResult;
 }
@@ -12404,6 +13092,7 @@ static size_t FtpHashCallback(void* contents, size_t size, size_t nmemb, void* u
     
     // Track actual file download traffic for network bandwidth
     appState.ftpBytesTransferred += realsize;
+    throttleRemote(realsize);
     
     return realsize;
 }
@@ -12427,181 +13116,942 @@ std::string urlEncode(const std::string& value) {
     return escaped.str();
 }
 
-// Delete FTP file
-bool deleteFtpFile(const std::string& ftpUrl, const std::string& username, const std::string& password) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        std::cerr << "[FTP DELETE] Failed to init CURL" << std::endl;
-        return false;
+
+// MULTI-SERVER: scan entries and FTP file paths carry their origin (ftp://host:port/...);
+// credentials and budgets come from the preset for that host:port
+// Preset for an FTP URL's server. Several presets for one server (different users): the connected
+// one wins. Bare paths (older sessions) fall back to the connected preset; a URL naming a server
+// without a preset gets nullptr - never another server's login.
+static const FtpPreset* findFtpPresetFor(const std::string& url) {
+    std::string server = isFtpFile(url) ? FtpHandlePool::serverKey(url) : "";
+    const FtpPreset* match = nullptr;
+    for (size_t i = 0; i < appState.ftpPresets.size(); i++) {
+        const auto& preset = appState.ftpPresets[i];
+        if (server.empty() || ftpPresetBaseUrl(preset) != server) continue;
+        if (!match || (int)i == appState.connectedPresetIndex) match = &preset;
+    }
+    if (!match && server.empty() &&
+        appState.connectedPresetIndex >= 0 && appState.connectedPresetIndex < (int)appState.ftpPresets.size()) {
+        match = &appState.ftpPresets[appState.connectedPresetIndex];
+    }
+    return match;
+}
+
+static bool resolveFtpCredentials(const std::string& url, std::string& username, std::string& password) {
+    const FtpPreset* preset = findFtpPresetFor(url);
+    if (!preset) return false;
+    username = preset->username;
+    password = preset->password;
+    return true;
+}
+
+// One server of a multi-server scan, resolved once at scan start (the UI may edit presets meanwhile)
+struct FtpScanServer {
+    std::string baseUrl;                  // ftp://host:port
+    std::string username;
+    std::string password;
+    int maxConnections = 0;               // 0 = global per-server limit
+    long long maxBytesPerSec = 0;         // 0 = unlimited
+    std::vector<std::string> dirs;        // Paths on this server
+};
+
+static std::vector<FtpScanServer> collectFtpScanServers() {
+    std::map<std::string, FtpScanServer> byServer;
+    for (const auto& entry : appState.selectedFtpDirs) {
+        if (isNfsUrl(entry) || isSmbUrl(entry) || isSftpUrl(entry) || isDavUrl(entry) || isS3Url(entry)) continue;    // Mount-free roots, see collectAsyncFsExports()
+        std::string baseUrl, dir;
+        if (isFtpFile(entry)) {
+            baseUrl = FtpHandlePool::serverKey(entry);
+            dir = entry.substr(baseUrl.size());
+            if (dir.empty()) dir = "/";
+        } else {
+            // Selection of an older session: path on the connected server
+            const FtpPreset* connected = findFtpPresetFor(entry);
+            if (!connected) {
+                std::cerr << "[FTP Scanner] No server for " << entry << " - skipped" << std::endl;
+                continue;
+            }
+            baseUrl = ftpPresetBaseUrl(*connected);
+            dir = entry;
+        }
+        
+        auto existing = byServer.find(baseUrl);
+        if (existing == byServer.end()) {
+            // Preset deleted or port changed since the selection was made: no login to guess
+            const FtpPreset* preset = findFtpPresetFor(baseUrl + "/");
+            if (!preset) {
+                std::cerr << "[FTP Scanner] No FTP preset for " << baseUrl << " - " << entry << " skipped" << std::endl;
+                continue;
+            }
+            FtpScanServer server;
+            server.baseUrl = baseUrl;
+            server.username = preset->username;
+            server.password = preset->password;
+            server.maxConnections = preset->maxConnections;
+            server.maxBytesPerSec = (long long)preset->bandwidthLimitKB * 1024;
+            existing = byServer.emplace(baseUrl, std::move(server)).first;
+        }
+        existing->second.dirs.push_back(dir);
     }
     
-    std::cout << "[FTP DELETE] Original URL: " << ftpUrl << std::endl;
+    std::vector<FtpScanServer> servers;
+    for (auto& [key, server] : byServer) servers.push_back(std::move(server));
+    return servers;
+}
+
+static const FtpScanServer* findFtpScanServer(const std::vector<FtpScanServer>& servers, const std::string& url) {
+    std::string key = FtpHandlePool::serverKey(url);
+    for (const auto& server : servers) {
+        if (server.baseUrl == key) return &server;
+    }
+    return nullptr;
+}
+
+// ===== NFS/SMB/SFTP WITHOUT KERNEL MOUNT (libnfs, libsmb2, libssh) =====
+// Scan roots "nfs://server/export/dir", "smb://server/share/dir" and "sftp://host:port/dir" are
+// read in user space through NfsAsyncEngine - one connection per export/share/host, no root,
+// no mount. NFS exports are found by the NFS presets (longest matching export path), SMB and
+// SFTP logins by the presets of the server. WebDAV ("dav://") and S3 ("s3://host:port/bucket")
+// go over libcurl the same way.
+enum class AsyncFsKind { Nfs, Smb, Sftp, Dav, S3 };
+
+struct AsyncFsExport {
+    AsyncFsKind kind = AsyncFsKind::Nfs;
+    std::string server;                   // WebDAV, S3: host[:port]
+    int port = 0;                         // SFTP
+    bool https = false;                   // WebDAV, S3
+    std::string root;                     // NFS export path / SMB share, empty for SFTP, WebDAV and S3
+    std::vector<std::string> dirs;        // Relative to root
+    
+    std::string key() const {
+        if (kind == AsyncFsKind::Smb) return "smb://" + server + "/" + root;
+        if (kind == AsyncFsKind::Sftp) return sftpUrl(server, port, "");
+        if (kind == AsyncFsKind::Dav) return davUrl(https, server, "");
+        if (kind == AsyncFsKind::S3) return s3Url(https, server, "");
+        return "nfs://" + server + root;
+    }
+    std::string fileUrl(const std::string& rel) const {
+        if (kind == AsyncFsKind::Smb) return smbUrl(server, root, rel);
+        if (kind == AsyncFsKind::Sftp) return sftpUrl(server, port, rel);
+        if (kind == AsyncFsKind::Dav) return davUrl(https, server, rel);
+        if (kind == AsyncFsKind::S3) return s3Url(https, server, rel);
+        return nfsUrl(server, root == "/" ? rel : root + rel);
+    }
+    const char* tag() const {
+        if (kind == AsyncFsKind::Dav) return "WebDAV";
+        if (kind == AsyncFsKind::S3) return "S3";
+        return kind == AsyncFsKind::Smb ? "SMB" : (kind == AsyncFsKind::Sftp ? "SFTP" : "NFS");
+    }
+};
+
+static bool isAsyncFsUrl(const std::string& path) {
+    return isNfsUrl(path) || isSmbUrl(path) || isSftpUrl(path) || isDavUrl(path) || isS3Url(path);
+}
+
+static bool splitAsyncFsUrl(const std::string& url, AsyncFsExport& exp, std::string& rel) {
+    if (isDavUrl(url)) {
+        exp.kind = AsyncFsKind::Dav;
+        exp.root.clear();
+        return parseDavUrl(url, exp.https, exp.server, rel);
+    }
+    if (isS3Url(url)) {
+        exp.kind = AsyncFsKind::S3;
+        exp.root.clear();
+        return parseS3Url(url, exp.https, exp.server, rel);
+    }
+    if (isSmbUrl(url)) {
+        exp.kind = AsyncFsKind::Smb;
+        return parseSmbUrl(url, exp.server, exp.root, rel);
+    }
+    if (isSftpUrl(url)) {
+        exp.kind = AsyncFsKind::Sftp;
+        exp.root.clear();
+        return parseSftpUrl(url, exp.server, exp.port, rel);
+    }
+    std::string path;
+    if (!parseNfsUrl(url, exp.server, path)) return false;
+    exp.kind = AsyncFsKind::Nfs;
+    exp.root.clear();
+    for (const auto& preset : appState.ftpPresets) {
+        if (preset.serviceType != "NFS" || preset.ip != exp.server || preset.nfsExportPath.empty()) continue;
+        const std::string& candidate = preset.nfsExportPath;
+        bool isPrefix = path.compare(0, candidate.size(), candidate) == 0 &&
+                        (path.size() == candidate.size() || path[candidate.size()] == '/' || candidate == "/");
+        if (isPrefix && candidate.size() > exp.root.size()) exp.root = candidate;
+    }
+    if (exp.root.empty()) exp.root = path;    // No preset: the whole path is the export
+    rel = exp.root == "/" ? path : path.substr(exp.root.size());
+    if (rel.empty()) rel = "/";
+    return true;
+}
+
+static std::unique_ptr<NfsBackend> connectAsyncFs(const AsyncFsExport& exp, std::string& error) {
+    if (exp.kind == AsyncFsKind::Nfs) return createLibnfsBackend(exp.server, exp.root, error);
     
-    // Extract full path from URL (after host:port)
-    std::string fullPath;
-    size_t pathStart = ftpUrl.find("://");
-    if (pathStart != std::string::npos) {
-        pathStart = ftpUrl.find('/', pathStart + 3);
-        if (pathStart != std::string::npos) {
-            fullPath = ftpUrl.substr(pathStart); // /share/Jan/Jana/.../file.mp3
+    if (exp.kind == AsyncFsKind::Sftp) {
+        const FtpPreset* login = nullptr;
+        for (const auto& preset : appState.ftpPresets) {
+            if (preset.serviceType == "SFTP" && preset.ip == exp.server && preset.port == exp.port) login = &preset;
         }
+        return createSftpBackend(exp.server, exp.port, login ? login->username : "", login ? login->password : "", error);
     }
     
-    std::cout << "[FTP DELETE] Full path: " << fullPath << std::endl;
-    
-    // Extract base URL (ftp://host:port)
-    std::string baseUrl = ftpUrl.substr(0, ftpUrl.find("://") + 3);
-    size_t hostEnd = ftpUrl.find('/', baseUrl.length());
-    if (hostEnd != std::string::npos) {
-        baseUrl = ftpUrl.substr(0, hostEnd);
+    if (exp.kind == AsyncFsKind::Dav) {
+        const FtpPreset* login = nullptr;
+        for (const auto& preset : appState.ftpPresets) {
+            if (preset.serviceType != "WebDAV") continue;
+            bool https;
+            std::string host, path;
+            bool sameHost = parseDavUrl(davUrlFromHttp(preset.davUrl), https, host, path) && host == exp.server;
+            if (sameHost || (!login && preset.ip == exp.server)) login = &preset;
+            if (sameHost) break;
+        }
+        return createWebDavBackend(exp.https, exp.server, login ? login->username : "", login ? login->password : "", error);
     }
     
-    // Prepare DELE command with FULL PATH
-    struct curl_slist* headerlist = NULL;
-    std::string deleteCmd = "DELE " + fullPath;
-    headerlist = curl_slist_append(headerlist, deleteCmd.c_str());
-    
-    std::cout << "[FTP DELETE] Base URL: " << baseUrl << std::endl;
-    std::cout << "[FTP DELETE] Command: " << deleteCmd << std::endl;
-    
-    curl_easy_setopt(curl, CURLOPT_URL, baseUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-    curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
-    curl_easy_setopt(curl, CURLOPT_QUOTE, headerlist);
-    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
-    curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L); // Debug output
-    
-    CURLcode res = curl_easy_perform(curl);
-    
-    if (res != CURLE_OK) {
-        std::cerr << "[FTP DELETE] CURL error: " << curl_easy_strerror(res) << std::endl;
-    } else {
-        std::cout << "[FTP DELETE] SUCCESS!" << std::endl;
+    if (exp.kind == AsyncFsKind::S3) {
+        S3Credentials credentials;
+        for (const auto& preset : appState.ftpPresets) {
+            if (preset.serviceType != "S3" || preset.ip + ":" + std::to_string(preset.port) != exp.server) continue;
+            credentials = {preset.username, preset.password, preset.s3Region};
+            break;
+        }
+        return createS3Backend(exp.https, exp.server, credentials, error);
     }
     
-    curl_slist_free_all(headerlist);
-    curl_easy_cleanup(curl);
-    
-    return (res == CURLE_OK);
+    const FtpPreset* login = nullptr;
+    for (const auto& preset : appState.ftpPresets) {
+        if (preset.serviceType != "SMB") continue;
+        std::string server, share;
+        bool sameShare = parseSmbSharePath(preset.smbSharePath, server, share) && server == exp.server && share == exp.root;
+        if (sameShare || (!login && preset.ip == exp.server)) login = &preset;
+        if (sameShare) break;
+    }
+    return createLibsmb2Backend(exp.server, exp.root, login ? login->username : "", login ? login->password : "",
+                                login ? login->smbDomain : "", error);
 }
 
-// Helper: Delete file (local or FTP)
-bool deleteFile(const std::string& filepath) {
-    // Check if it's an FTP file
-    if (isFtpFile(filepath)) {
-        std::cout << "[DELETE] FTP file detected: " << filepath << std::endl;
-        
-        // File already contains full FTP URL (ftp://host:port/path)
-        // Find active FTP preset for credentials
-        if (appState.connectedPresetIndex >= 0 && 
-            appState.connectedPresetIndex < (int)appState.ftpPresets.size()) {
-            const auto& preset = appState.ftpPresets[appState.connectedPresetIndex];
-            
-            std::cout << "[DELETE] Using FTP URL: " << filepath << std::endl;
-            std::cout << "[DELETE] User: " << preset.username << std::endl;
-            
-            bool result = deleteFtpFile(filepath, preset.username, preset.password);
-            std::cout << "[DELETE] FTP delete result: " << (result ? "SUCCESS" : "FAILED") << std::endl;
-            return result;
+// Connections are reused between the walk, the hashing and later deletes (an SSH login costs
+// several round trips); one user at a time, idle ones are dropped after a minute
+struct IdleAsyncFs {
+    std::unique_ptr<NfsBackend> backend;
+    std::chrono::steady_clock::time_point since;
+};
+static std::mutex asyncFsPoolMutex;
+static std::multimap<std::string, IdleAsyncFs> asyncFsIdle;
+
+static std::unique_ptr<NfsBackend> acquireAsyncFs(const AsyncFsExport& exp, std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(asyncFsPoolMutex);
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = asyncFsIdle.begin(); it != asyncFsIdle.end();) {
+            if (now - it->second.since > std::chrono::seconds(60)) it = asyncFsIdle.erase(it);
+            else ++it;
         }
-        std::cerr << "[DELETE] ERROR: No active FTP connection (connectedPresetIndex=" 
-                  << appState.connectedPresetIndex << ")" << std::endl;
-        return false;
-    } else {
-        // Local file
-        std::cout << "[DELETE] Local file: " << filepath << std::endl;
-        bool result = (remove(filepath.c_str()) == 0);
-        if (!result) {
-            std::cerr << "[DELETE] Failed to remove local file: " << strerror(errno) << std::endl;
+        auto it = asyncFsIdle.find(exp.key());
+        if (it != asyncFsIdle.end()) {
+            std::unique_ptr<NfsBackend> backend = std::move(it->second.backend);
+            asyncFsIdle.erase(it);
+            return backend;
         }
-        return result;
     }
+    return connectAsyncFs(exp, error);
 }
 
-// Calculate MD5 hash of FTP file (streaming) - OPTIMIZED with retry logic
-std::string calculateMD5FromFTP(const std::string& ftpUrl, const std::string& username, const std::string& password, long long fileSize = 0) {
-    // Thread-safe error logging mutex
-    static std::mutex ftpHashErrorMutex;
-    
-    // Retry loop with exponential backoff
-    int maxRetries = appState.ftpHashRetries; // Default: 3
-    
-    // ADAPTIVE TIMEOUT: Scale with file size (assumes ~10 MB/s network speed)
-    // Small files (< 100 MB): Use configured timeout (5s default)
-    // Large files (> 100 MB): Calculate based on size (10 seconds per 100 MB)
-    int timeout = appState.ftpHashTimeout;    // Default: 5 seconds
-    if (fileSize > 100 * 1024 * 1024) {  // > 100 MB
-        // ADAPTIVE TIMEOUT: Scale with file size
-        // Calculate timeout: 10s per 100MB, minimum = configured timeout
-        // Assumes ~10 MB/s network speed (conservative for FTP)
-        int calculatedTimeout = (fileSize / (10 * 1024 * 1024)); // 10s per 10MB = 1s per MB
-        timeout = std::max(timeout, calculatedTimeout);
-        timeout = std::min(timeout, 300); // Cap at 5 minutes for safety
+static void releaseAsyncFs(const AsyncFsExport& exp, std::unique_ptr<NfsBackend> backend) {
+    std::lock_guard<std::mutex> lock(asyncFsPoolMutex);
+    IdleAsyncFs idle;
+    idle.backend = std::move(backend);
+    idle.since = std::chrono::steady_clock::now();
+    asyncFsIdle.emplace(exp.key(), std::move(idle));
+}
+
+// SFTP: small reads, deep window - servers cap a read at 64-256 KB.
+// WebDAV, S3: every read is an HTTP request - large ranges, 4 per file over 8 files.
+static NfsAsyncEngine makeAsyncFsEngine(const AsyncFsExport& exp, NfsBackend& backend) {
+    if (exp.kind == AsyncFsKind::Sftp) return NfsAsyncEngine(backend, 64, 64 * 1024, 16);
+    if (exp.kind == AsyncFsKind::Dav || exp.kind == AsyncFsKind::S3) return NfsAsyncEngine(backend, 32, 4 * 1024 * 1024, 4);
+    return NfsAsyncEngine(backend);
+}
+
+static std::vector<AsyncFsExport> collectAsyncFsExports() {
+    std::map<std::string, AsyncFsExport> byExport;
+    for (const auto& entry : appState.selectedFtpDirs) {
+        AsyncFsExport exp;
+        std::string rel;
+        if (!isAsyncFsUrl(entry) || !splitAsyncFsUrl(entry, exp, rel)) continue;
+        AsyncFsExport& target = byExport[exp.key()];
+        if (target.server.empty()) target = exp;
+        target.dirs.push_back(rel);
+    }
+    std::vector<AsyncFsExport> exports;
+    for (auto& [key, exp] : byExport) exports.push_back(std::move(exp));
+    return exports;
+}
+
+// WebDAV and S3 files go into the file cache with their ETag tag in the inode field: like the inode
+// of a local file it keeps a cached hash valid while size and tag are unchanged
+static void recordEtagFile(const std::string& url, const NfsAsyncEngine::FileInfo& file) {
+    CachedFileInfo info;
+    info.size = (long long)file.size;
+    info.mtime = (time_t)file.mtime;
+    info.inode = (ino_t)file.inode;
+    CachedFileInfo previous;
+    if (file.inode != 0 && fileCache.get(url, previous) && previous.size == info.size && previous.inode == info.inode) {
+        info.hash = previous.hash;
+    }
+    fileCache.put(url, std::move(info));
+}
+
+// Content MD5s of the last walk the server already knew (single-part S3 ETags), by URL
+static std::mutex s3EtagMutex;
+static std::unordered_map<std::string, std::string> s3EtagMd5s;
+
+// Walk of all NFS/SMB/SFTP/WebDAV/S3 roots (READDIRPLUS / QUERY_DIRECTORY / READDIR / PROPFIND /
+// ListObjectsV2); files go into filesBySize as URLs
+static void scanAsyncFsExports(const std::vector<AsyncFsExport>& exports, std::map<long long, std::vector<std::string>>& filesBySize) {
+    {
+        std::lock_guard<std::mutex> lock(s3EtagMutex);
+        s3EtagMd5s.clear();
     }
-    
-    for (int attempt = 0; attempt < maxRetries; attempt++) {
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            if (appState.ftpSkipFailedFiles && attempt == maxRetries - 1) {
-                std::lock_guard<std::mutex> lock(ftpHashErrorMutex);
-                std::cerr << "[FTP Hash] Failed to init CURL for: " << ftpUrl << std::endl;
-            }
+    for (const auto& exp : exports) {
+        if (stopScan) break;
+        std::string error;
+        std::unique_ptr<NfsBackend> backend = acquireAsyncFs(exp, error);
+        if (!backend) {
+            std::cerr << "[" << exp.tag() << " Scanner] " << exp.key() << " - " << error << std::endl;
             continue;
         }
-        
-        // URL-encode the FTP URL to handle spaces and special characters
-        std::string encodedUrl = ftpUrl;
-        size_t pathStart = ftpUrl.find("://");
-        if (pathStart != std::string::npos) {
-            pathStart = ftpUrl.find('/', pathStart + 3); // Find path after host:port
-            if (pathStart != std::string::npos) {
-                std::string base = ftpUrl.substr(0, pathStart);
-                std::string path = ftpUrl.substr(pathStart);
-                encodedUrl = base + urlEncode(path);
+        NfsAsyncEngine engine = makeAsyncFsEngine(exp, *backend);
+        bool healthy = true;
+        int pendingFiles = 0;
+        long long pendingBytes = 0;
+        auto flush = [&]() {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            appState.filesScanned += pendingFiles;
+            appState.bytesProcessed += pendingBytes;
+            pendingFiles = 0;
+            pendingBytes = 0;
+        };
+        for (const auto& dir : exp.dirs) {
+            if (stopScan) break;
+            appState.scanStatus = std::string("Durchsuche ") + exp.tag() + " (ohne Mount): " + exp.fileUrl(dir);
+            bool ok = engine.walk(dir, 999, [&](const NfsAsyncEngine::FileInfo& file) {
+                if (file.size == 0) return;    // Empty files can't have hash duplicates
+                if (!appState.scanHiddenFiles && file.path.find("/.") != std::string::npos) return;
+                filesBySize[(long long)file.size].push_back(exp.fileUrl(file.path));
+                if (exp.kind == AsyncFsKind::Dav || exp.kind == AsyncFsKind::S3) recordEtagFile(exp.fileUrl(file.path), file);
+                if (!file.md5.empty()) {
+                    std::lock_guard<std::mutex> lock(s3EtagMutex);
+                    s3EtagMd5s[exp.fileUrl(file.path)] = file.md5;
+                }
+                pendingFiles++;
+                pendingBytes += file.size;
+                if (pendingFiles >= 1000) flush();
+            }, &stopScan);
+            if (!ok) {
+                std::cerr << "[" << exp.tag() << " Scanner] Connection lost: " << backend->lastError() << std::endl;
+                healthy = false;
+                break;
+            }
+        }
+        flush();
+        NfsAsyncEngine::Stats stats = engine.stats();
+        std::cout << "[" << exp.tag() << " Scanner] " << exp.key() << " - " << stats.readdirs << " directories, "
+                  << stats.errors << " errors, up to " << stats.maxOutstanding << " requests in flight" << std::endl;
+        if (healthy) releaseAsyncFs(exp, std::move(backend));
+    }
+}
+
+// SSH exec for an SFTP host with the login of its preset: libssh when built in (password or keys),
+// otherwise the system ssh client (keys/agent only)
+
+static std::unique_ptr<SshCommandRunner> connectSshRunner(const AsyncFsExport& exp, std::string& error) {
+    const FtpPreset* login = nullptr;
+    for (const auto& preset : appState.ftpPresets) {
+        if (preset.serviceType == "SFTP" && preset.ip == exp.server && preset.port == exp.port) login = &preset;
+    }
+    std::string user = login ? login->username : "";
+    if (isLibsshAvailable()) return createLibsshRunner(exp.server, exp.port, user, login ? login->password : "", error);
+    return createSystemSshRunner(exp.server, exp.port, user);
+}
+
+// MD5 on the SFTP server; returns the files it could not hash there
+static std::vector<NfsAsyncEngine::FileInfo> hashSftpFilesRemotely(const AsyncFsExport& exp, const std::vector<NfsAsyncEngine::FileInfo>& files,
+                                                                   const std::function<void(const std::string&, long long, const std::string&)>& done) {
+    std::string error;
+    std::unique_ptr<SshCommandRunner> runner = connectSshRunner(exp, error);
+    if (!runner) {
+        std::cerr << "[SFTP Hash] " << exp.key() << " - no SSH exec (" << error << "), reading over SFTP" << std::endl;
+        return files;
+    }
+    std::map<std::string, const NfsAsyncEngine::FileInfo*> byPath;
+    std::vector<std::string> paths;
+    for (const auto& file : files) {
+        if (byPath.emplace(file.path, &file).second) paths.push_back(file.path);
+    }
+    int hashed = 0;
+    bool ok = sshRemoteDigests(*runner, paths, 1000, [&](const std::string& path, const std::string& hex) {
+        auto it = byPath.find(path);
+        if (hex.empty() || it == byPath.end()) return;
+        done(exp.fileUrl(path), (long long)it->second->size, hex);
+        byPath.erase(it);
+        hashed++;
+    }, &stopScan);
+    sshRemoteDigestCount += hashed;
+    std::cout << "[SFTP Hash] " << exp.key() << " - " << hashed << " files hashed on the server (ssh exec)"
+              << (ok ? "" : ", remote md5sum not usable") << std::endl;
+
+    std::vector<NfsAsyncEngine::FileInfo> rest;
+    for (const auto& [path, file] : byPath) rest.push_back(*file);
+    return rest;
+}
+
+// Single-part S3 ETags are the content MD5 - unless the bucket encrypts (SSE-C/KMS): per bucket the
+// smallest such object is downloaded once, and only if it matches its ETag the other ETags are taken
+// as hashes. Returns the files that still have to be read (multipart objects, failed spot checks).
+static std::vector<NfsAsyncEngine::FileInfo> hashS3FilesByEtag(const AsyncFsExport& exp, NfsAsyncEngine& engine,
+                                                               const std::vector<NfsAsyncEngine::FileInfo>& files,
+                                                               const std::function<void(const std::string&, long long, const std::string&)>& done) {
+    std::map<std::string, std::vector<const NfsAsyncEngine::FileInfo*>> byBucket;
+    std::vector<NfsAsyncEngine::FileInfo> rest;
+    for (const auto& file : files) {
+        if (file.md5.empty()) rest.push_back(file);
+        else byBucket[file.path.substr(0, file.path.find('/', 1))].push_back(&file);
+    }
+    for (const auto& [bucket, withEtag] : byBucket) {
+        const NfsAsyncEngine::FileInfo* probe = *std::min_element(withEtag.begin(), withEtag.end(),
+            [](const NfsAsyncEngine::FileInfo* a, const NfsAsyncEngine::FileInfo* b) { return a->size < b->size; });
+        std::string probeHash;
+        engine.hashFiles({*probe}, [&](const NfsAsyncEngine::FileInfo&, const std::string& hash) { probeHash = hash; }, &stopScan);
+        if (probeHash.empty() || probeHash != probe->md5) {
+            std::cout << "[S3 Hash] " << exp.key() << bucket.substr(1) << " - ETag is no content MD5 (encryption?), downloading "
+                      << withEtag.size() << " objects" << std::endl;
+            for (const auto* file : withEtag) rest.push_back(*file);
+            continue;
+        }
+        for (const auto* file : withEtag) done(exp.fileUrl(file->path), (long long)file->size, file->md5);
+        std::cout << "[S3 Hash] " << exp.key() << bucket.substr(1) << " - " << withEtag.size()
+                  << " hashes from single-part ETags, no download" << std::endl;
+    }
+    return rest;
+}
+
+// MD5 of the NFS/SMB/SFTP/WebDAV/S3 candidates with pipelined preads; done(url, size, hash) on the calling thread.
+// SFTP files are hashed on the server over SSH exec first (sshRemoteHash), S3 objects by their ETag;
+// only the rest is read.
+static void hashAsyncFsFiles(const std::vector<std::pair<std::string, long long>>& files,
+                             const std::function<void(const std::string&, long long, const std::string&)>& done) {
+    std::map<std::string, std::pair<AsyncFsExport, std::vector<NfsAsyncEngine::FileInfo>>> byExport;
+    for (const auto& [url, size] : files) {
+        AsyncFsExport exp;
+        std::string rel;
+        if (!splitAsyncFsUrl(url, exp, rel)) continue;
+        auto& entry = byExport[exp.key()];
+        entry.first = exp;
+        entry.second.push_back({rel, (uint64_t)size, 0, 0});
+        if (exp.kind == AsyncFsKind::S3) {
+            std::lock_guard<std::mutex> lock(s3EtagMutex);
+            auto known = s3EtagMd5s.find(url);
+            if (known != s3EtagMd5s.end()) entry.second.back().md5 = known->second;
+        }
+    }
+    for (auto& [key, entry] : byExport) {
+        if (stopScan) break;
+        const AsyncFsExport& exp = entry.first;
+        if (exp.kind == AsyncFsKind::Sftp && appState.sshRemoteHash) {
+            entry.second = hashSftpFilesRemotely(exp, entry.second, done);
+            if (entry.second.empty() || stopScan) continue;
+        }
+        if (exp.kind == AsyncFsKind::Dav || exp.kind == AsyncFsKind::S3) {
+            // Hashes of the last scans whose ETag is unchanged
+            std::vector<NfsAsyncEngine::FileInfo> rest;
+            for (const auto& file : entry.second) {
+                CachedFileInfo info;
+                std::string url = exp.fileUrl(file.path);
+                if (fileCache.get(url, info) && info.inode != 0 && info.size == (long long)file.size && !info.hash.empty()) {
+                    done(url, info.size, info.hash);
+                } else {
+                    rest.push_back(file);
+                }
             }
+            if (rest.size() < entry.second.size()) {
+                std::cout << "[" << exp.tag() << " Hash] " << key << " - " << (entry.second.size() - rest.size())
+                          << " hashes from cache (ETag unchanged)" << std::endl;
+            }
+            entry.second.swap(rest);
+            if (entry.second.empty()) continue;
+        }
+        std::string error;
+        std::unique_ptr<NfsBackend> backend = acquireAsyncFs(exp, error);
+        if (!backend) {
+            std::cerr << "[" << exp.tag() << " Hash] " << key << " - " << error << std::endl;
+            for (const auto& file : entry.second) done(exp.fileUrl(file.path), (long long)file.size, "");
+            continue;
+        }
+        NfsAsyncEngine engine = makeAsyncFsEngine(exp, *backend);
+        if (exp.kind == AsyncFsKind::S3) {
+            entry.second = hashS3FilesByEtag(exp, engine, entry.second, done);
+            if (entry.second.empty() || stopScan) {
+                releaseAsyncFs(exp, std::move(backend));
+                continue;
+            }
+        }
+        bool healthy = engine.hashFiles(entry.second, [&](const NfsAsyncEngine::FileInfo& file, const std::string& hash) {
+            std::string url = exp.fileUrl(file.path);
+            if ((exp.kind == AsyncFsKind::Dav || exp.kind == AsyncFsKind::S3) && !hash.empty()) {
+                fileCache.update(url, [&](CachedFileInfo& info) {
+                    if (info.inode != 0 && info.size == (long long)file.size) info.hash = hash;
+                });
+            }
+            done(url, (long long)file.size, hash);
+        }, &stopScan);
+        NfsAsyncEngine::Stats stats = engine.stats();
+        std::cout << "[" << exp.tag() << " Hash] " << key << " - " << stats.reads << " reads, " << (stats.bytes / (1024 * 1024))
+                  << " MB, " << stats.errors << " errors, up to " << stats.maxOutstanding << " requests in flight" << std::endl;
+        if (healthy) releaseAsyncFs(exp, std::move(backend));
+    }
+}
+
+// Deletes over libnfs/libsmb2/libssh, one connection per export/share/host. Returns the files that are gone.
+static std::set<std::string> deleteAsyncFsFiles(const std::vector<std::string>& urls) {
+    std::set<std::string> deleted;
+    std::map<std::string, std::pair<AsyncFsExport, std::vector<std::pair<std::string, std::string>>>> byExport; // (url, rel)
+    for (const auto& url : urls) {
+        AsyncFsExport exp;
+        std::string rel;
+        if (!splitAsyncFsUrl(url, exp, rel)) continue;
+        auto& entry = byExport[exp.key()];
+        entry.first = exp;
+        entry.second.push_back({url, rel});
+    }
+    for (const auto& [key, entry] : byExport) {
+        std::string error;
+        std::unique_ptr<NfsBackend> backend = acquireAsyncFs(entry.first, error);
+        if (!backend) {
+            std::cerr << "[" << entry.first.tag() << " DELETE] " << key << " - " << error << std::endl;
+            continue;
+        }
+        for (const auto& [url, rel] : entry.second) {
+            if (backend->unlink(rel, error)) {
+                deleted.insert(url);
+            } else {
+                std::cerr << "[" << entry.first.tag() << " DELETE] Failed: " << url << " (" << error << ")" << std::endl;
+            }
+        }
+        releaseAsyncFs(entry.first, std::move(backend));
+    }
+    return deleted;
+}
+
+// Connection budgets and bandwidth shares of all scanned servers (handle pool and multi engine).
+// With typicalSizes (average file size per server) servers without a fixed connection budget get
+// as many connections as their measured latency/throughput needs for files of that size.
+static void applyFtpServerBudgets(const std::vector<FtpScanServer>& servers,
+                                  const std::map<std::string, long long>* typicalSizes = nullptr) {
+    ftpHandlePool.clearServerBudgets();
+    ftpMultiEngine.clearServerBudgets();
+    for (const auto& server : servers) {
+        int connections = server.maxConnections;
+        if (connections <= 0 && typicalSizes) {
+            auto it = typicalSizes->find(server.baseUrl);
+            if (it != typicalSizes->end()) {
+                connections = remoteThroughput.suggestedConnections(server.baseUrl, it->second, appState.ftpMaxConnections);
+                if (connections >= appState.ftpMaxConnections) connections = 0;
+            }
+        }
+        if (connections <= 0 && server.maxBytesPerSec <= 0) continue;
+        ftpHandlePool.setServerBudget(server.baseUrl, connections, server.maxBytesPerSec);
+        ftpMultiEngine.setServerBudget(server.baseUrl, connections, server.maxBytesPerSec);
+        std::cout << "[FTP Scanner] Budget " << server.baseUrl << ": "
+                  << (connections > 0 ? std::to_string(connections) : std::string("default")) << " connections, "
+                  << (server.maxBytesPerSec > 0 ? std::to_string(server.maxBytesPerSec / 1024) + " KB/s" : std::string("unlimited"))
+                  << std::endl;
+    }
+}
+
+// BATCH DELETE (see ftp_batch_delete.h): DELE lists per server over pooled connections instead of
+// one login per file. Every file gets its own result; 4xx replies and files left unanswered by a
+// dropped connection are retried in later batches.
+static const size_t kFtpDeleteBatchSize = 200;
+static const int kFtpDeleteAttempts = 3;
+
+static int FtpDeleteDebugCallback(CURL*, curl_infotype type, char* data, size_t size, void* userp) {
+    FtpDeleteTranscript* transcript = (FtpDeleteTranscript*)userp;
+    if (type == CURLINFO_HEADER_OUT) transcript->command(std::string_view(data, size));
+    else if (type == CURLINFO_HEADER_IN) transcript->reply(std::string_view(data, size));
+    return 0;
+}
+
+// One QUOTE list over one pooled connection; fills result of every file that got a reply
+static void runFtpDeleteBatch(const FtpDeleteBatch& batch, const std::string& username, const std::string& password,
+                              std::map<std::string, FtpDeleteResult>& results, std::mutex& resultsLock) {
+    std::string rootUrl = batch.server + "/";
+    FtpDeleteTranscript transcript;
+    CURLcode res = CURLE_FAILED_INIT;
+    
+    FtpHandlePool::Lease lease = ftpHandlePool.acquire(rootUrl, username, password);
+    if (lease) {
+        CURL* curl = lease.get();
+        struct curl_slist* quote = nullptr;
+        for (const auto& command : ftpDeleteCommands(batch.urls)) quote = curl_slist_append(quote, command.c_str());
+        curl_easy_setopt(curl, CURLOPT_URL, rootUrl.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_QUOTE, quote);
+        curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L); // Needed for the debug callback, nothing is printed
+        curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, FtpDeleteDebugCallback);
+        curl_easy_setopt(curl, CURLOPT_DEBUGDATA, &transcript);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2 + batch.urls.size()));
+        res = lease.perform();
+        if (res != CURLE_OK) lease.markBroken();
+        lease.release();
+        curl_slist_free_all(quote);
+    }
+    
+    std::map<std::string, const FtpDeleteTranscript::Entry*> replies;
+    for (const auto& entry : transcript.entries()) replies[entry.path] = &entry;
+    
+    std::lock_guard<std::mutex> lock(resultsLock);
+    for (const auto& url : batch.urls) {
+        FtpDeleteResult& result = results[url];
+        result.attempts++;
+        auto it = replies.find(ftpDeletePath(url));
+        if (it == replies.end()) {
+            result.status = FtpDeleteStatus::Pending;
+            result.reply = curl_easy_strerror(res);
+            continue;
+        }
+        result.replyCode = it->second->code;
+        result.reply = it->second->text;
+        result.status = ftpDeleteStatusFor(result.replyCode);
+    }
+}
+
+std::vector<FtpDeleteResult> deleteFtpFilesBatched(const std::vector<std::string>& urls) {
+    std::map<std::string, FtpDeleteResult> results;
+    for (const auto& url : urls) results[url].url = url;
+    
+    // Credentials per server, resolved once (presets belong to the UI thread)
+    std::map<std::string, std::pair<std::string, std::string>> credentials;
+    std::vector<std::string> pending;
+    for (auto& [url, result] : results) {
+        std::string server = FtpHandlePool::serverKey(url);
+        if (!credentials.count(server)) {
+            std::string username, password;
+            if (resolveFtpCredentials(url, username, password)) credentials[server] = {username, password};
+        }
+        if (credentials.count(server)) {
+            pending.push_back(url);
+        } else {
+            result.status = FtpDeleteStatus::Failed;
+            result.reply = "No FTP preset for " + server;
+        }
+    }
+    
+    std::mutex resultsLock;
+    for (int attempt = 0; attempt < kFtpDeleteAttempts && !pending.empty(); attempt++) {
+        if (attempt > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * (1 << (attempt - 1))));
+            std::cout << "[FTP DELETE] Retrying " << pending.size() << " files (attempt " << (attempt + 1) << ")" << std::endl;
+        }
+        std::vector<FtpDeleteBatch> batches = planFtpDeleteBatches(pending, kFtpDeleteBatchSize);
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads;
+        int workers = std::max(1, std::min(appState.ftpMaxConnections, (int)batches.size()));
+        for (int t = 0; t < workers; t++) {
+            threads.emplace_back([&]() {
+                for (size_t i = next++; i < batches.size(); i = next++) {
+                    const auto& login = credentials[batches[i].server];
+                    runFtpDeleteBatch(batches[i], login.first, login.second, results, resultsLock);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        
+        pending.clear();
+        for (const auto& [url, result] : results) {
+            if (result.status == FtpDeleteStatus::Pending || result.status == FtpDeleteStatus::Transient) pending.push_back(url);
         }
+    }
+    
+    std::vector<FtpDeleteResult> out;
+    int deleted = 0;
+    for (auto& [url, result] : results) {
+        if (result.status == FtpDeleteStatus::Deleted) {
+            deleted++;
+        } else {
+            std::cerr << "[FTP DELETE] Failed: " << url << " (" << result.reply << ", " << result.attempts << " attempts)" << std::endl;
+        }
+        out.push_back(std::move(result));
+    }
+    std::cout << "[FTP DELETE] " << deleted << " of " << out.size() << " files deleted" << std::endl;
+    return out;
+}
+
+// Helper: Delete file (local or FTP)
+bool deleteFile(const std::string& filepath) {
+    // Check if it's an FTP file
+    if (isFtpFile(filepath)) {
+        std::cout << "[DELETE] FTP file detected: " << filepath << std::endl;
+        
+        // File already contains full FTP URL (ftp://host:port/path); credentials of the preset
+        // for the file's server (multi-server scans), pooled connection + retries
+        std::vector<FtpDeleteResult> results = deleteFtpFilesBatched({filepath});
+        bool result = !results.empty() && results[0].status == FtpDeleteStatus::Deleted;
+        std::cout << "[DELETE] FTP delete result: " << (result ? "SUCCESS" : "FAILED") << std::endl;
+        return result;
+    } else if (isAsyncFsUrl(filepath)) {
+        // NFS/SMB file scanned without mount - unlink over libnfs/libsmb2
+        bool result = !deleteAsyncFsFiles({filepath}).empty();
+        std::cout << "[DELETE] NFS/SMB delete result: " << (result ? "SUCCESS" : "FAILED") << std::endl;
+        return result;
+    } else {
+        // Local file
+        std::cout << "[DELETE] Local file: " << filepath << std::endl;
+        bool result = (remove(filepath.c_str()) == 0);
+        if (!result) {
+            std::cerr << "[DELETE] Failed to remove local file: " << strerror(errno) << std::endl;
+        }
+        return result;
+    }
+}
+
+// Delete many files at once: FTP files batched per server, NFS/SMB files per export, local files
+// one by one. Returns the files that are gone.
+std::set<std::string> deleteFiles(const std::vector<std::string>& files) {
+    std::set<std::string> deleted;
+    std::vector<std::string> ftpFiles;
+    std::vector<std::string> mountlessFiles;
+    for (const auto& file : files) {
+        if (isFtpFile(file)) {
+            ftpFiles.push_back(file);
+        } else if (isAsyncFsUrl(file)) {
+            mountlessFiles.push_back(file);
+        } else if (deleteFile(file)) {
+            deleted.insert(file);
+        }
+    }
+    if (!ftpFiles.empty()) {
+        for (const auto& result : deleteFtpFilesBatched(ftpFiles)) {
+            if (result.status == FtpDeleteStatus::Deleted) deleted.insert(result.url);
+        }
+    }
+    if (!mountlessFiles.empty()) {
+        std::set<std::string> mountlessDeleted = deleteAsyncFsFiles(mountlessFiles);
+        deleted.insert(mountlessDeleted.begin(), mountlessDeleted.end());
+    }
+    return deleted;
+}
+
+// ADAPTIVE TIMEOUT: from the measured throughput + latency of the file's server (3x expected
+// time, at least the configured timeout), bounded by this transfer's share of the global
+// bandwidth limit - also before the server was measured, or a capped transfer could never
+// finish (and never be measured). Unmeasured and uncapped: assume ~10 MB/s - small files
+// (< 100 MB) use the configured timeout, large files 1s per 10 MB, capped at 5 minutes.
+static int ftpHashTimeoutFor(const std::string& ftpUrl, long long fileSize) {
+    RemoteEstimate estimate;
+    double share = remoteRateShare();
+    if (share > 0 || (remoteThroughput.estimate(FtpHandlePool::serverKey(ftpUrl), estimate) && estimate.bytesPerSec > 0)) {
+        return remoteThroughput.timeoutFor(FtpHandlePool::serverKey(ftpUrl), fileSize, appState.ftpHashTimeout,
+                                           6 * 3600, share);
+    }
+    int timeout = appState.ftpHashTimeout;    // Default: 5 seconds
+    if (fileSize > 100 * 1024 * 1024) {  // > 100 MB
+        int calculatedTimeout = (fileSize / (10 * 1024 * 1024));
+        timeout = std::max(timeout, calculatedTimeout);
+        timeout = std::min(timeout, 300); // Cap at 5 minutes for safety
+    }
+    return timeout;
+}
+
+// URL-encode the path part of an FTP file URL to handle spaces and special characters
+static std::string encodeFtpFileUrl(const std::string& ftpUrl) {
+    size_t pathStart = ftpUrl.find("://");
+    if (pathStart != std::string::npos) {
+        pathStart = ftpUrl.find('/', pathStart + 3); // Find path after host:port
+        if (pathStart != std::string::npos) {
+            return ftpUrl.substr(0, pathStart) + urlEncode(ftpUrl.substr(pathStart));
+        }
+    }
+    return ftpUrl;
+}
+
+static std::string md5FinalHex(MD5_CTX& ctx) {
+    unsigned char result[MD5_DIGEST_LENGTH];
+    MD5_Final(result, &ctx);
+    
+    std::stringstream ss;
+    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << (int)result[i];
+    }
+    return ss.str();
+}
+
+// REMOTE HASH CACHE: FTP hashes live in fileCache (key = full URL incl. server) and are only
+// trusted when the listing delivered an exact modify time (MLSD) - parseFtpListing drops the
+// hash as soon as size or modify time change. Server digests other than MD5 are cached as
+// "<algo>:<hex>"; md5Only skips those for files that must compare with local MD5s.
+static bool peekRemoteHash(const std::string& ftpUrl, long long fileSize, std::string& hash) {
+    CachedFileInfo info;
+    if (!fileCache.get(ftpUrl, info) || info.mtime == 0 || info.size != fileSize || info.hash.empty()) return false;
+    hash = info.hash;
+    return true;
+}
+
+static bool lookupRemoteHash(const std::string& ftpUrl, long long fileSize, std::string& hash, bool md5Only = false) {
+    std::string cached;
+    if (!peekRemoteHash(ftpUrl, fileSize, cached)) return false;
+    if (md5Only && cached.find(':') != std::string::npos) return false;
+    hash = cached;
+    ftpHashCacheHits++;
+    ftpHashCacheBytesSaved += fileSize;
+    appState.ftpBytesSaved += fileSize;
+    return true;
+}
+
+static void storeRemoteHash(const std::string& ftpUrl, long long fileSize, const std::string& hash) {
+    fileCache.update(ftpUrl, [&](CachedFileInfo& info) {
+        if (info.mtime != 0 && info.size == fileSize) info.hash = hash;
+    });
+}
+
+static FtpServerFeatures getFtpServerFeatures(const std::string& baseUrl, const std::string& username, const std::string& password);
+
+// SERVER-SIDE CHECKSUMS: ask the server for the digest (HASH / XMD5 & co) instead of downloading.
+// A server that fails the command three times in a row is not asked again this session.
+static bool planFtpServerDigest(const std::string& ftpUrl, const std::string& username, const std::string& password,
+                                FtpDigestPlan& plan, std::string& rootUrl, long long start = -1, long long end = -1) {
+    if (!appState.ftpUseServerHash) return false;
+    std::string server = FtpHandlePool::serverKey(ftpUrl);
+    {
+        std::lock_guard<std::mutex> lock(ftpDigestFailuresMutex);
+        if (ftpDigestFailures[server] >= 3) return false;
+    }
+    FtpServerFeatures features = getFtpServerFeatures(server + "/", username, password);
+    
+    // Path relative to the login directory, exactly as curl resolves ftp://host/path
+    std::string path = ftpUrl.substr(server.size());
+    if (!path.empty() && path.front() == '/') path = path.substr(1);
+    plan = planFtpDigest(features, path, start, end);
+    rootUrl = server + "/";
+    return (bool)plan;
+}
+
+static std::string finishFtpServerDigest(const std::string& ftpUrl, const FtpDigestPlan& plan, const std::string& reply) {
+    std::string hex;
+    std::string server = FtpHandlePool::serverKey(ftpUrl);
+    std::lock_guard<std::mutex> lock(ftpDigestFailuresMutex);
+    if (!parseFtpDigestReply(reply, plan.algo, hex)) {
+        if (++ftpDigestFailures[server] == 3) {
+            std::cout << "[FTP Hash] " << server << " keeps rejecting " << plan.commands.back().substr(0, plan.commands.back().find(' '))
+                      << " - downloading files instead" << std::endl;
+        }
+        return "";
+    }
+    ftpDigestFailures[server] = 0;
+    ftpServerDigests++;
+    return ftpDigestKey(plan.algo, hex);
+}
+
+// Server digest over a pooled connection (NOBODY + QUOTE, reply via header callback).
+// start/end: byte range [start, end), start < 0 = whole file. Returns "" if unavailable.
+static std::string requestFtpServerDigest(const std::string& ftpUrl, const std::string& username, const std::string& password,
+                                          long long start = -1, long long end = -1) {
+    FtpDigestPlan plan;
+    std::string rootUrl;
+    if (!planFtpServerDigest(ftpUrl, username, password, plan, rootUrl, start, end)) return "";
+    
+    FtpHandlePool::Lease lease = ftpHandlePool.acquire(ftpUrl, username, password);
+    if (!lease) return "";
+    CURL* curl = lease.get();
+    
+    std::string reply;
+    struct curl_slist* quote = nullptr;
+    for (const auto& command : plan.commands) quote = curl_slist_append(quote, command.c_str());
+    curl_easy_setopt(curl, CURLOPT_URL, rootUrl.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_QUOTE, quote);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &reply);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2));
+    lease.perform();
+    lease.release();
+    curl_slist_free_all(quote);
+    
+    return finishFtpServerDigest(ftpUrl, plan, reply);
+}
+
+// Calculate MD5 hash of FTP file (streaming) - OPTIMIZED with retry logic
+// Server-side checksums are tried first (non-MD5 digests come back as "<algo>:<hex>").
+// askServer = false: MD5 by transfer only (no server digest, no cached SHA-x digest) - for
+// files whose hash must match local or other servers' MD5s.
+std::string calculateMD5FromFTP(const std::string& ftpUrl, const std::string& username, const std::string& password, long long fileSize = 0,
+                                bool askServer = true) {
+    // Thread-safe error logging mutex
+    static std::mutex ftpHashErrorMutex;
+    
+    std::string cachedHash;
+    if (fileSize > 0 && lookupRemoteHash(ftpUrl, fileSize, cachedHash, !askServer)) return cachedHash;
+    
+    // Full download is the last resort
+    std::string serverHash = askServer ? requestFtpServerDigest(ftpUrl, username, password) : "";
+    if (!serverHash.empty()) {
+        storeRemoteHash(ftpUrl, fileSize, serverHash);
+        appState.ftpBytesSaved += fileSize;
+        return serverHash;
+    }
+    
+    // Retry loop with exponential backoff
+    int maxRetries = appState.ftpHashRetries; // Default: 3
+    
+    int timeout = ftpHashTimeoutFor(ftpUrl, fileSize);
+    
+    for (int attempt = 0; attempt < maxRetries; attempt++) {
+        // Pooled handle: control connection + login survive across files and retries
+        FtpHandlePool::Lease lease = ftpHandlePool.acquire(ftpUrl, username, password);
+        if (!lease) {
+            if (appState.ftpSkipFailedFiles && attempt == maxRetries - 1) {
+                std::lock_guard<std::mutex> lock(ftpHashErrorMutex);
+                std::cerr << "[FTP Hash] Failed to init CURL for: " << ftpUrl << std::endl;
+            }
+            continue;
+        }
+        CURL* curl = lease.get();
+        
+        std::string encodedUrl = encodeFtpFileUrl(ftpUrl);
         
         FtpHashData hashData;
         MD5_Init(&hashData.md5Context);
         hashData.bytesRead = 0;
         
         curl_easy_setopt(curl, CURLOPT_URL, encodedUrl.c_str());
-        curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-        curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, FtpHashCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &hashData);
         
-        // CRITICAL: Use CURL connection pooling for massive speedup!
-        if (curlShareHandle && appState.useCurlPooling) {
-            curl_easy_setopt(curl, CURLOPT_SHARE, curlShareHandle);
-        }
-        
-        // Apply optimal CURL settings (pipelining, keep-alive, TCP optimizations)
-        applyOptimalCurlSettings(curl);
-        
         // OPTIMIZATION: Aggressive timeout - 5s instead of 60s
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeout);
         curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 2L); // 2s connect timeout
         
         // OPTIMIZATION: Low speed limit - abort if < 1KB/s for 3 seconds
-        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);  // 1 KB/s
-        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 3L);      // for 3 seconds
+        // (with a global bandwidth limit slow transfers are intended: only detect stalls)
+        if (remoteBandwidth.rate() > 0) {
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, (long)(appState.ftpResponseTimeout * 4));
+        } else {
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);  // 1 KB/s
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 3L);      // for 3 seconds
+        }
         
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
+        CURLcode res = lease.perform();
+        if (res == CURLE_OK) recordRemoteTiming(ftpUrl, curl);
+        lease.release();
         
         if (res == CURLE_OK) {
             // SUCCESS - calculate final hash
-            unsigned char result[MD5_DIGEST_LENGTH];
-            MD5_Final(result, &hashData.md5Context);
-            
-            std::stringstream ss;
-            for (int i = 0; i < MD5_DIGEST_LENGTH; i++) {
-                ss << std::hex << std::setw(2) << std::setfill('0') << (int)result[i];
-            }
-            
-            return ss.str();
+            std::string hash = md5FinalHex(hashData.md5Context);
+            storeRemoteHash(ftpUrl, fileSize, hash);
+            return hash;
         }
         
         // RETRY LOGIC: Wait with exponential backoff (100ms, 200ms, 400ms)
@@ -12621,6 +14071,294 @@ std::string calculateMD5FromFTP(const std::string& ftpUrl, const std::string& us
     return ""; // Failed after all retries
 }
 
+// Non-blocking counterpart of calculateMD5FromFTP(): the server digest is requested, or the
+// file is streamed through ftpMultiEngine and hashed on an engine worker. done(hash) runs on
+// that worker; hash is empty after ftpHashRetries failed attempts or when the scan was stopped.
+// askServer = false as in calculateMD5FromFTP(): plain MD5 by transfer.
+void submitFtpHash(const std::string& ftpUrl, const std::string& username, const std::string& password,
+                   long long fileSize, std::function<void(const std::string&)> done, int attempt = 0,
+                   bool askServer = true) {
+    std::string cachedHash;
+    if (attempt == 0 && lookupRemoteHash(ftpUrl, fileSize, cachedHash, !askServer)) {
+        done(cachedHash);
+        return;
+    }
+    
+    FtpDigestPlan plan;
+    std::string rootUrl;
+    if (attempt == 0 && askServer && planFtpServerDigest(ftpUrl, username, password, plan, rootUrl)) {
+        FtpTransferRequest request;
+        request.url = rootUrl;
+        request.username = username;
+        request.password = password;
+        request.noBody = true;
+        request.collectHeaders = true;
+        request.quote = plan.commands;
+        request.timeoutSec = appState.ftpResponseTimeout * 2;
+        ftpMultiEngine.submit(std::move(request), [=](FtpTransferResult& result) {
+            std::string hash = finishFtpServerDigest(ftpUrl, plan, result.headers);
+            if (!hash.empty()) {
+                storeRemoteHash(ftpUrl, fileSize, hash);
+                appState.ftpBytesSaved += fileSize;
+                done(hash);
+            } else if (result.code == CURLE_ABORTED_BY_CALLBACK || stopScan) {
+                done("");
+            } else {
+                submitFtpHash(ftpUrl, username, password, fileSize, done, 0, false);
+            }
+        });
+        return;
+    }
+    
+    auto md5 = std::make_shared<MD5_CTX>();
+    MD5_Init(md5.get());
+    
+    FtpTransferRequest request;
+    request.url = encodeFtpFileUrl(ftpUrl);
+    request.username = username;
+    request.password = password;
+    request.timeoutSec = ftpHashTimeoutFor(ftpUrl, fileSize);
+    request.onData = [md5](const char* data, size_t len) {
+        MD5_Update(md5.get(), data, len);
+        appState.ftpBytesTransferred += len;
+        throttleRemote(len); // Worker falls behind -> engine pauses the transfer
+    };
+    
+    ftpMultiEngine.submit(std::move(request), [=](FtpTransferResult& result) {
+        if (result.code == CURLE_OK) {
+            recordRemoteTiming(ftpUrl, result.bytes, result.firstByteSec, result.totalSec);
+            std::string hash = md5FinalHex(*md5);
+            storeRemoteHash(ftpUrl, fileSize, hash);
+            done(hash);
+            return;
+        }
+        if (result.code != CURLE_ABORTED_BY_CALLBACK && !stopScan && attempt + 1 < appState.ftpHashRetries) {
+            submitFtpHash(ftpUrl, username, password, fileSize, done, attempt + 1, false);
+            return;
+        }
+        if (appState.ftpSkipFailedFiles && result.code != CURLE_ABORTED_BY_CALLBACK) {
+            std::cerr << "[FTP Hash] Failed after " << (attempt + 1) << " attempts: "
+                      << ftpUrl << " (" << curl_easy_strerror(result.code) << ")" << std::endl;
+        }
+        done("");
+    });
+}
+
+// FTP SAMPLES: MD5 of the first and last ftpSampleKB KiB, fetched as ranged RETRs (CURLOPT_RANGE =
+// REST + abort after the last byte). Key = hex(head) + hex(tail). Files up to twice the sample size
+// are fetched completely; their key is then the full MD5 (complete = true).
+static long long ftpSampleBytes() {
+    return (long long)std::max(4, appState.ftpSampleKB) * 1024;
+}
+
+static std::string ftpRangeSpec(long long start, long long end) {
+    return std::to_string(start) + "-" + std::to_string(end - 1);
+}
+
+static bool fetchFtpRangeMD5(const std::string& ftpUrl, const std::string& username, const std::string& password,
+                             const std::string& range, std::string& hex) {
+    FtpHandlePool::Lease lease = ftpHandlePool.acquire(ftpUrl, username, password);
+    if (!lease) return false;
+    CURL* curl = lease.get();
+    
+    std::string encodedUrl = encodeFtpFileUrl(ftpUrl);
+    FtpHashData hashData;
+    MD5_Init(&hashData.md5Context);
+    hashData.bytesRead = 0;
+    curl_easy_setopt(curl, CURLOPT_URL, encodedUrl.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, FtpHashCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &hashData);
+    if (!range.empty()) curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)appState.ftpHashTimeout);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 2L);
+    
+    CURLcode res = lease.perform();
+    if (res == CURLE_OK) recordRemoteTiming(ftpUrl, curl);
+    if (!range.empty()) lease.markBroken(); // Aborted RETR: don't hand the control connection on
+    lease.release();
+    if (res != CURLE_OK) return false;
+    hex = md5FinalHex(hashData.md5Context);
+    return true;
+}
+
+// Blocking sample (thread pool path)
+static std::string calculateFtpSample(const std::string& ftpUrl, const std::string& username, const std::string& password,
+                                      long long fileSize, bool& complete) {
+    long long sample = ftpSampleBytes();
+    complete = fileSize <= 2 * sample;
+    std::string head, tail;
+    if (complete) {
+        return fetchFtpRangeMD5(ftpUrl, username, password, "", head) ? head : "";
+    }
+    if (!fetchFtpRangeMD5(ftpUrl, username, password, ftpRangeSpec(0, sample), head)) return "";
+    if (!fetchFtpRangeMD5(ftpUrl, username, password, ftpRangeSpec(fileSize - sample, fileSize), tail)) return "";
+    return head + tail;
+}
+
+// Sample on ftpMultiEngine: head and tail are fetched concurrently, done() runs on an engine worker
+static void submitFtpSample(const std::string& ftpUrl, const std::string& username, const std::string& password,
+                            long long fileSize, std::function<void(const std::string& key, bool complete)> done) {
+    struct SampleState {
+        MD5_CTX head, tail;
+        std::atomic<int> remaining{0};
+        std::atomic<bool> failed{false};
+    };
+    long long sample = ftpSampleBytes();
+    bool complete = fileSize <= 2 * sample;
+    auto state = std::make_shared<SampleState>();
+    MD5_Init(&state->head);
+    MD5_Init(&state->tail);
+    state->remaining = complete ? 1 : 2;
+    
+    auto submitPart = [&](MD5_CTX* ctx, const std::string& range) {
+        FtpTransferRequest request;
+        request.url = encodeFtpFileUrl(ftpUrl);
+        request.username = username;
+        request.password = password;
+        request.range = range;
+        request.timeoutSec = appState.ftpHashTimeout;
+        request.onData = [ctx](const char* data, size_t len) {
+            MD5_Update(ctx, data, len);
+            appState.ftpBytesTransferred += len;
+            throttleRemote(len);
+        };
+        ftpMultiEngine.submit(std::move(request), [state, done, complete, ftpUrl](FtpTransferResult& result) {
+            if (result.code != CURLE_OK) state->failed = true;
+            else recordRemoteTiming(ftpUrl, result.bytes, result.firstByteSec, result.totalSec);
+            if (--state->remaining > 0) return;
+            if (state->failed) {
+                done("", complete);
+            } else if (complete) {
+                done(md5FinalHex(state->head), true);
+            } else {
+                done(md5FinalHex(state->head) + md5FinalHex(state->tail), false);
+            }
+        });
+    };
+    if (complete) {
+        submitPart(&state->head, "");
+    } else {
+        submitPart(&state->head, ftpRangeSpec(0, sample));
+        submitPart(&state->tail, ftpRangeSpec(fileSize - sample, fileSize));
+    }
+}
+
+// Local counterpart of the FTP samples: MD5 of [start, end) of a local file (start < 0 = whole file)
+static std::string localFileMD5(const std::string& path, long long start = -1, long long end = -1) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return "";
+    if (start > 0 && fseeko(file, start, SEEK_SET) != 0) {
+        fclose(file);
+        return "";
+    }
+    MD5_CTX md5;
+    MD5_Init(&md5);
+    std::vector<unsigned char> buffer(1024 * 1024);
+    long long remaining = start < 0 ? -1 : end - start;
+    while (remaining != 0) {
+        size_t want = remaining < 0 ? buffer.size() : (size_t)std::min<long long>(remaining, buffer.size());
+        size_t got = fread(buffer.data(), 1, want, file);
+        if (got == 0) break;
+        MD5_Update(&md5, buffer.data(), got);
+        if (remaining > 0) remaining -= got;
+    }
+    bool ok = !ferror(file) && remaining <= 0;
+    fclose(file);
+    return ok ? md5FinalHex(md5) : "";
+}
+
+// Same key as calculateFtpSample() for a local file
+static std::string localSampleKey(const std::string& path, long long fileSize) {
+    long long sample = ftpSampleBytes();
+    if (fileSize <= 2 * sample) return localFileMD5(path);
+    std::string head = localFileMD5(path, 0, sample);
+    std::string tail = localFileMD5(path, fileSize - sample, fileSize);
+    return (head.empty() || tail.empty()) ? "" : head + tail;
+}
+
+// Local member of a size group with remote files: MD5 like the remote side. Bypasses hashCache,
+// which is keyed by inode + mtime only - an MD5 stored there would be returned to later scans
+// that use the configured algorithm.
+static std::string localMD5ForRemoteCompare(const std::string& path) {
+    return localFileMD5(path);
+}
+
+// SFTP sample prefilter: head/tail keys computed on the server (head -c / tail -c | md5sum) and
+// locally for the size peers; members whose key is unique in their group can't be duplicates and
+// leave filesBySize before the full hashing. Groups with a failed sample are left complete. Only
+// groups of SFTP and local files larger than two samples - FTP/NFS/SMB members are left to their
+// own paths.
+static void prefilterSftpSamples(std::map<long long, std::vector<std::string>>& filesBySize) {
+    long long sample = ftpSampleBytes();
+    std::map<std::string, std::pair<AsyncFsExport, std::vector<std::string>>> byHost; // key -> (export, paths)
+    std::vector<long long> sizes;
+    for (const auto& [size, files] : filesBySize) {
+        if (files.size() <= 1 || size <= 2 * sample) continue;
+        bool hasSftp = false, otherRemote = false;
+        for (const auto& file : files) {
+            if (isSftpUrl(file)) hasSftp = true;
+            else if (isFtpFile(file) || isAsyncFsUrl(file)) otherRemote = true;
+        }
+        if (!hasSftp || otherRemote) continue;
+        sizes.push_back(size);
+        for (const auto& file : files) {
+            AsyncFsExport exp;
+            std::string rel;
+            if (!isSftpUrl(file) || !splitAsyncFsUrl(file, exp, rel)) continue;
+            auto& entry = byHost[exp.key()];
+            entry.first = exp;
+            entry.second.push_back(rel);
+        }
+    }
+    if (sizes.empty()) return;
+    
+    std::map<std::string, std::string> keys; // url -> sample key
+    for (const auto& [key, entry] : byHost) {
+        if (stopScan) return;
+        appState.scanStatus = "Stichproben auf dem Server (SSH): " + key;
+        std::string error;
+        std::unique_ptr<SshCommandRunner> runner = connectSshRunner(entry.first, error);
+        if (!runner) {
+            std::cerr << "[SFTP Samples] " << key << " - no SSH exec (" << error << ")" << std::endl;
+            continue;
+        }
+        sshRemoteSamples(*runner, entry.second, sample, 1000, [&](const std::string& path, const std::string& sampleKey) {
+            if (!sampleKey.empty()) keys[entry.first.fileUrl(path)] = sampleKey;
+        }, &stopScan);
+    }
+    
+    size_t removed = 0;
+    for (long long size : sizes) {
+        if (stopScan) return;
+        auto& files = filesBySize[size];
+        std::map<std::string, int> counts;
+        std::vector<std::string> fileKeys;
+        bool failed = false;
+        for (const auto& file : files) {
+            std::string sampleKey;
+            if (isSftpUrl(file)) {
+                auto it = keys.find(file);
+                if (it != keys.end()) sampleKey = it->second;
+            } else {
+                sampleKey = localSampleKey(file, size);
+            }
+            fileKeys.push_back(sampleKey);
+            if (sampleKey.empty()) failed = true;
+            else counts[sampleKey]++;
+        }
+        // A member without sample may be a copy of any other: the whole group is hashed in full
+        if (failed) continue;
+        std::vector<std::string> kept;
+        for (size_t i = 0; i < files.size(); i++) {
+            if (counts[fileKeys[i]] == 1) removed++;
+            else kept.push_back(files[i]);
+        }
+        files.swap(kept);
+    }
+    std::cout << "[SFTP Samples] " << keys.size() << " server-side samples, " << removed
+              << " files without a matching sample skipped" << std::endl;
+}
+
 // URL encode individual path components (not slashes)
 std::string encodePathComponent(const std::string& component) {
     std::string result;
@@ -12750,8 +14488,9 @@ std::vector<std::string> getFtpSubdirectories(const std::string& ftpDir, const s
     // No cache or expired - fetch from server
     std::cout << "[FTP] Fetching directory list from server: " << ftpDir << std::endl;
     
-    CURL* curl = curl_easy_init();
-    if (!curl) return {};
+    FtpHandlePool::Lease lease = ftpHandlePool.acquire(baseUrl, username, password);
+    if (!lease) return {};
+    CURL* curl = lease.get();
     
     std::string readBuffer;
     readBuffer.reserve(65536);
@@ -12767,15 +14506,12 @@ std::vector<std::string> getFtpSubdirectories(const std::string& ftpDir, const s
     if (fullUrl.back() != '/') fullUrl += "/";
     
     curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-    curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-    applyOptimalCurlSettings(curl);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2));
     
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+    CURLcode res = lease.perform();
+    lease.release();
     
     if (res != CURLE_OK) {
         std::cerr << "[FTP] Error fetching directory " << ftpDir << ": " << curl_easy_strerror(res) << std::endl;
@@ -12820,24 +14556,8 @@ std::vector<std::string> getFtpSubdirectories(const std::string& ftpDir, const s
     return subdirs;
 }
 
-// Scan FTP directory for files recursively (max depth 20)
-void scanFtpDirectory(const std::string& ftpDir, const std::string& baseUrl, 
-                     const std::string& username, const std::string& password,
-                     std::map<long long, std::vector<std::string>>& filesBySize,
-                     int depth = 0, int maxDepth = 30) {
-    if (stopScan) return;
-    if (depth > maxDepth) {
-        std::cout << "[FTP Scan] Max depth " << maxDepth << " reached, skipping: " << ftpDir << std::endl;
-        return;
-    }
-    
-    CURL* curl = curl_easy_init();
-    if (!curl) return;
-    
-    std::string readBuffer;
-    readBuffer.reserve(65536); // Pre-allocate 64KB buffer for large directories
-    
-    // Build URL - URL-encode the path to handle spaces and special characters
+// Directory URL for LIST - URL-encode the path to handle spaces and special characters
+static std::string ftpDirectoryUrl(const std::string& baseUrl, const std::string& ftpDir) {
     std::string encodedPath = urlEncodePath(ftpDir);
     
     // Fix: Ensure baseUrl ends with / before combining with path
@@ -12850,35 +14570,130 @@ void scanFtpDirectory(const std::string& ftpDir, const std::string& baseUrl,
     }
     fullUrl += encodedPath;
     if (fullUrl.back() != '/') fullUrl += "/";
+    return fullUrl;
+}
+
+// Prefix of the file paths stored for ftpDir: baseUrl + the raw (unencoded) directory path.
+// encodeFtpFileUrl() encodes stored paths when they are transferred.
+static std::string ftpStoredDirUrl(const std::string& baseUrl, const std::string& ftpDir) {
+    std::string dirUrl = baseUrl;
+    if (!dirUrl.empty() && dirUrl.back() != '/') {
+        dirUrl += '/';
+    }
+    std::string pathWithoutLeadingSlash = ftpDir;
+    if (!pathWithoutLeadingSlash.empty() && pathWithoutLeadingSlash.front() == '/') {
+        pathWithoutLeadingSlash = pathWithoutLeadingSlash.substr(1);
+    }
+    dirUrl += pathWithoutLeadingSlash;
+    if (dirUrl.back() != '/') dirUrl += "/";
+    return dirUrl;
+}
+
+// FEAT probe (once per server+user): NOBODY + QUOTE "FEAT", the reply arrives through the header callback
+static FtpServerFeatures getFtpServerFeatures(const std::string& baseUrl, const std::string& username, const std::string& password) {
+    std::string key = FtpHandlePool::serverKey(baseUrl) + "\n" + username;
+    {
+        std::lock_guard<std::mutex> lock(ftpServerFeaturesMutex);
+        auto it = ftpServerFeatures.find(key);
+        if (it != ftpServerFeatures.end()) return it->second;
+    }
+    
+    FtpServerFeatures features;
+    FtpHandlePool::Lease lease = ftpHandlePool.acquire(baseUrl, username, password);
+    if (lease) {
+        CURL* curl = lease.get();
+        std::string reply;
+        std::string rootUrl = ftpDirectoryUrl(baseUrl, "/");
+        struct curl_slist* quote = curl_slist_append(nullptr, "FEAT");
+        curl_easy_setopt(curl, CURLOPT_URL, rootUrl.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_QUOTE, quote);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &reply);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2));
+        CURLcode res = lease.perform();
+        lease.release();
+        curl_slist_free_all(quote);
+        
+        features = parseFeatResponse(reply);
+        if (res != CURLE_OK && !features.probed) {
+            std::cout << "[FTP] FEAT not supported by " << FtpHandlePool::serverKey(baseUrl)
+                      << " (" << curl_easy_strerror(res) << ") - using LIST" << std::endl;
+        }
+    }
+    std::cout << "[FTP] " << FtpHandlePool::serverKey(baseUrl) << ": MLSD " << (features.mlsd ? "available" : "not available")
+              << (features.hasFact("modify") ? ", modify fact" : "") << std::endl;
+    
+    std::lock_guard<std::mutex> lock(ftpServerFeaturesMutex);
+    ftpServerFeatures[key] = features;
+    return features;
+}
+
+// Add one listed FTP file (full URL) to the scan's size buckets and the file cache
+static void recordFtpFile(const std::string& fullPath, long long fileSize, time_t mtime,
+                          std::map<long long, std::vector<std::string>>& filesBySize) {
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        filesBySize[fileSize].push_back(fullPath);
+        appState.filesScanned++;
+        appState.bytesProcessed += fileSize;
+    }
+    
+    // CACHE: Store FTP file metadata for next scan. mtime is only known from MLSD (LIST: 0);
+    // a cached remote hash survives as long as size and modify time are unchanged.
+    CachedFileInfo cacheInfo;
+    cacheInfo.size = fileSize;
+    cacheInfo.mtime = mtime;
+    cacheInfo.inode = 0; // FTP files have no inode
+    CachedFileInfo previous;
+    if (mtime != 0 && fileCache.get(fullPath, previous) && previous.size == fileSize && previous.mtime == mtime) {
+        cacheInfo.hash = previous.hash;
+    }
+    fileCache.put(fullPath, std::move(cacheInfo));
+}
+
+// Parse one FTP LIST (or MLSD) response: files go into filesBySize (and the file cache),
+// subdirectories (full paths) into subdirs
+static void parseFtpListing(const std::string& readBuffer, const std::string& ftpDir, const std::string& baseUrl,
+                            std::map<long long, std::vector<std::string>>& filesBySize,
+                            std::vector<std::string>& subdirs, int& fileCount, int& dirCount, bool mlsd = false) {
+    // Store full FTP URL including host and port
+    std::string dirUrl = ftpStoredDirUrl(baseUrl, ftpDir);
     
-    std::cout << "[FTP Scan] Depth " << depth << ": " << fullUrl << std::endl;
-    
-    curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-    curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-    
-    // Apply optimal CURL settings (pipelining, keep-alive, TCP optimizations)
-    applyOptimalCurlSettings(curl);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2));
-    
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+    auto addFile = [&](const std::string& filename, long long fileSize, time_t mtime) {
+        // Skip empty files if setting is enabled
+        if (fileSize == 0 && appState.skipEmptyFiles) return;
+        
+        // Skip files with size 0 completely for deduplication
+        if (fileSize == 0 || filename.empty()) return;
+        
+        std::string fullPath = dirUrl + filename;
+        
+        // Debug: Zeige gespeicherten Pfad
+        if (fileCount < 3) { // Nur für erste paar Dateien
+            std::cout << "[FTP Scan] Stored path: " << fullPath << std::endl;
+        }
+        
+        recordFtpFile(fullPath, fileSize, mtime, filesBySize);
+        fileCount++;
+    };
     
-    if (res != CURLE_OK) {
-        std::cerr << "[FTP Scan] Error scanning " << ftpDir << ": " << curl_easy_strerror(res) << std::endl;
-        return;
-    }
+    auto addDir = [&](const std::string& dirname) {
+        // Ignore . and ..
+        if (dirname == "." || dirname == ".." || dirname.empty()) return;
+        std::string subdirPath = ftpDir;
+        if (subdirPath.empty() || subdirPath.back() != '/') subdirPath += "/";
+        subdirPath += dirname;
+        subdirs.push_back(subdirPath);
+        dirCount++;
+        
+        // NOTE: serverDirectories wird NUR beim Connect gefüllt, nicht während des Scans
+        // Dies verhindert, dass bei jedem Scan neue Verzeichnisse hinzugefügt werden
+        std::cout << "[FTP Scan]   Found subdir: " << dirname << std::endl;
+    };
     
-    // Parse FTP LIST output
     std::istringstream iss(readBuffer);
     std::string line;
-    int fileCount = 0;
-    int dirCount = 0;
-    std::vector<std::string> subdirs;
-    
-    std::cout << "[FTP Scan] Parsing directory: " << ftpDir << std::endl;
     
     while (std::getline(iss, line) && !stopScan) {
         // Check for pause - OPTIMIZED: 10ms instead of 100ms for responsive pause
@@ -12887,165 +14702,162 @@ void scanFtpDirectory(const std::string& ftpDir, const std::string& baseUrl,
         }
         if (stopScan) break;
         
+        if (!line.empty() && line.back() == '\r') line.pop_back();
         if (line.empty()) continue;
         
+        if (mlsd) {
+            // MLSD: type=file;size=2887197;modify=20130821094512;unique=803g1a2; filename.ext
+            FtpFacts facts;
+            if (!parseMlsdLine(line, facts)) continue;
+            if (facts.isFile && facts.size >= 0) {
+                addFile(facts.name, facts.size, facts.modify);
+            } else if (facts.isDir) {
+                if (!facts.unique.empty()) {
+                    // Same directory reached twice (symlinked tree) - list it only once
+                    std::lock_guard<std::mutex> lock(ftpSeenDirIdsMutex);
+                    if (!ftpSeenDirIds.insert(FtpHandlePool::serverKey(baseUrl) + "|" + facts.unique).second) continue;
+                }
+                addDir(facts.name);
+            }
+            continue;
+        }
+        
         // FTP LIST Format: -rwxrws---   1 root ftpusers  2887197 Aug 21  2013 filename.ext
         //                   drwxrws---   2 root ftpusers     4096 Jul 12 06:49 subdirname
         bool isFile = (line[0] == '-');
         bool isDir = (line[0] == 'd');
-        
-        if (isFile) {
-            // Find filename by looking for the last occurrence of year or time pattern
-            // Then everything after that is the filename
-            
-            // Simple regex-free approach: Find the size (big number) then skip 3 tokens (month day year/time)
-            std::vector<std::string> tokens;
-            std::istringstream lineStream(line);
-            std::string token;
-            while (lineStream >> token) {
-                tokens.push_back(token);
-            }
-            
-            // We need at least: perm(1) links(1) user(1) group(1) size(1) month(1) day(1) time/year(1) filename(1+)
-            if (tokens.size() < 9) continue;
-            
-            // Find the size field (should be a number after user/group)
-            long long fileSize = 0;
-            int sizeIndex = -1;
-            
-            // Size is typically at index 4, but can vary
-            int maxCheck = (tokens.size() < 6) ? tokens.size() : 6;
-            for (int i = 3; i < maxCheck; i++) {
-                bool isNumber = true;
-                for (char c : tokens[i]) {
-                    if (!isdigit(c)) {
-                        isNumber = false;
-                        break;
-                    }
-                }
-                
-                if (isNumber && !tokens[i].empty()) {
-                    try {
-                        fileSize = std::stoll(tokens[i]);
-                        sizeIndex = i;
-                        break;
-                    } catch (...) {
-                        continue;
-                    }
-                }
-            }
-            
-            if (sizeIndex == -1) continue;
-            
-            // Skip empty files if setting is enabled
-            if (fileSize == 0 && appState.skipEmptyFiles) continue;
-            
-            // Skip files with size 0 completely for deduplication
-            if (fileSize == 0) continue;
-            
-            // Filename starts after size + 3 tokens (month day year/time)
-            int filenameStartIndex = sizeIndex + 4;
-            if (filenameStartIndex >= tokens.size()) continue;
-            
-            // Reconstruct filename (may contain spaces)
-            std::string filename;
-            for (int i = filenameStartIndex; i < tokens.size(); i++) {
-                if (i > filenameStartIndex) filename += " ";
-                filename += tokens[i];
-            }
-            
-            if (!filename.empty()) {
-                // Store full FTP URL including host and port
-                std::string fullPath = baseUrl;
-                if (!fullPath.empty() && fullPath.back() != '/') {
-                    fullPath += '/';
-                }
-                std::string pathWithoutLeadingSlash = ftpDir;
-                if (!pathWithoutLeadingSlash.empty() && pathWithoutLeadingSlash.front() == '/') {
-                    pathWithoutLeadingSlash = pathWithoutLeadingSlash.substr(1);
-                }
-                fullPath += pathWithoutLeadingSlash;
-                if (fullPath.back() != '/') fullPath += "/";
-                fullPath += filename;
-                
-                // Debug: Zeige gespeicherten Pfad
-                if (fileCount < 3) { // Nur für erste paar Dateien
-                    std::cout << "[FTP Scan] Stored path: " << fullPath << std::endl;
-                }
-                
-                {
-                    std::lock_guard<std::mutex> lock(resultsMutex);
-                    filesBySize[fileSize].push_back(fullPath);
-                    fileCount++;
-                    appState.filesScanned++;
-                    appState.bytesProcessed += fileSize;
-                }
-                
-                // CACHE: Store FTP file metadata for next scan (mtime not available in LIST, use 0)
-                {
-                    std::lock_guard<std::mutex> lock(fileCacheMutex);
-                    CachedFileInfo cacheInfo;
-                    cacheInfo.size = fileSize;
-                    cacheInfo.mtime = 0; // FTP LIST doesn't provide mtime reliably
-                    cacheInfo.inode = 0; // FTP files have no inode
-                    cacheInfo.hash = ""; // Will be filled during hash calculation
-                    fileCache[fullPath] = cacheInfo;
+        if (!isFile && !isDir) continue;
+        
+        // Simple regex-free approach: Find the size (big number) then skip 3 tokens (month day year/time)
+        std::vector<std::string> tokens;
+        std::istringstream lineStream(line);
+        std::string token;
+        while (lineStream >> token) {
+            tokens.push_back(token);
+        }
+        
+        // We need at least: perm(1) links(1) user(1) group(1) size(1) month(1) day(1) time/year(1) filename(1+)
+        if (tokens.size() < 9) continue;
+        
+        // Find the size field (should be a number after user/group)
+        // Size is typically at index 4, but can vary
+        long long fileSize = 0;
+        int sizeIndex = -1;
+        int maxCheck = (tokens.size() < 6) ? tokens.size() : 6;
+        for (int i = 3; i < maxCheck; i++) {
+            bool isNumber = !tokens[i].empty();
+            for (char c : tokens[i]) {
+                if (!isdigit(c)) {
+                    isNumber = false;
+                    break;
                 }
             }
-        } else if (isDir) {
-            // Parse directory name
-            std::vector<std::string> tokens;
-            std::istringstream lineStream(line);
-            std::string token;
-            while (lineStream >> token) {
-                tokens.push_back(token);
-            }
-            
-            if (tokens.size() < 9) continue;
-            
-            // Find size field to skip to filename
-            int sizeIndex = -1;
-            for (int i = 3; i < 6 && i < tokens.size(); i++) {
-                bool isNumber = true;
-                for (char c : tokens[i]) {
-                    if (!isdigit(c)) {
-                        isNumber = false;
-                        break;
-                    }
-                }
-                if (isNumber && !tokens[i].empty()) {
+            if (isNumber) {
+                try {
+                    fileSize = std::stoll(tokens[i]);
                     sizeIndex = i;
                     break;
+                } catch (...) {
+                    continue;
                 }
             }
-            
-            if (sizeIndex == -1) continue;
-            
-            // Directory name starts after size + 3 tokens
-            int dirnameStartIndex = sizeIndex + 4;
-            if (dirnameStartIndex >= tokens.size()) continue;
-            
-            std::string dirname;
-            for (int i = dirnameStartIndex; i < tokens.size(); i++) {
-                if (i > dirnameStartIndex) dirname += " ";
-                dirname += tokens[i];
-            }
-            
-            // Ignore . and ..
-            if (dirname != "." && dirname != ".." && !dirname.empty()) {
-                std::string subdirPath = ftpDir;
-                if (subdirPath.back() != '/') subdirPath += "/";
-                subdirPath += dirname;
-                subdirs.push_back(subdirPath);
-                dirCount++;
-                
-                // NOTE: serverDirectories wird NUR beim Connect gefüllt, nicht während des Scans
-                // Dies verhindert, dass bei jedem Scan neue Verzeichnisse hinzugefügt werden
-                std::cout << "[FTP Scan]   Found subdir: " << dirname << std::endl;
+        }
+        
+        if (sizeIndex == -1) continue;
+        
+        // Name starts after size + 3 tokens (month day year/time), may contain spaces
+        int nameStartIndex = sizeIndex + 4;
+        if (nameStartIndex >= (int)tokens.size()) continue;
+        std::string name;
+        for (int i = nameStartIndex; i < (int)tokens.size(); i++) {
+            if (i > nameStartIndex) name += " ";
+            name += tokens[i];
+        }
+        
+        if (isFile) {
+            addFile(name, fileSize, 0); // LIST doesn't provide mtime reliably
+        } else {
+            addDir(name);
+        }
+    }
+}
+
+// LIST or MLSD of one directory through a pooled handle. mlsd is set when the server announced
+// MLSD (and ftpUseMlsd is on); if MLSD fails the directory is listed again with LIST and mlsd is cleared.
+static CURLcode fetchFtpListing(const std::string& ftpDir, const std::string& baseUrl,
+                                const std::string& username, const std::string& password,
+                                std::string& readBuffer, bool& mlsd) {
+    FtpServerFeatures features;
+    if (appState.ftpUseMlsd) features = getFtpServerFeatures(baseUrl, username, password);
+    mlsd = features.mlsd;
+    std::string optsCommand = mlsd ? mlstOptsCommand(features) : "";
+    std::string fullUrl = ftpDirectoryUrl(baseUrl, ftpDir);
+    
+    CURLcode res = CURLE_FAILED_INIT;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        FtpHandlePool::Lease lease = ftpHandlePool.acquire(baseUrl, username, password);
+        if (!lease) return CURLE_FAILED_INIT;
+        CURL* curl = lease.get();
+        
+        readBuffer.clear();
+        readBuffer.reserve(65536); // Pre-allocate 64KB buffer for large directories
+        curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+        
+        // Optimal CURL settings (pipelining, keep-alive, TCP) are applied by the handle pool
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2));
+        
+        struct curl_slist* quote = nullptr;
+        if (mlsd) {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "MLSD");
+            if (!optsCommand.empty()) {
+                quote = curl_slist_append(nullptr, optsCommand.c_str());
+                curl_easy_setopt(curl, CURLOPT_QUOTE, quote);
             }
         }
+        
+        res = lease.perform();
+        lease.release();
+        if (quote) curl_slist_free_all(quote);
+        
+        if (res == CURLE_OK || !mlsd || stopScan) break;
+        std::cerr << "[FTP Scan] MLSD failed for " << ftpDir << " (" << curl_easy_strerror(res) << "), retrying with LIST" << std::endl;
+        mlsd = false;
+    }
+    return res;
+}
+
+// Scan FTP directory for files recursively (max depth 20)
+void scanFtpDirectory(const std::string& ftpDir, const std::string& baseUrl, 
+                     const std::string& username, const std::string& password,
+                     std::map<long long, std::vector<std::string>>& filesBySize,
+                     int depth = 0, int maxDepth = 30) {
+    if (stopScan) return;
+    if (depth > maxDepth) {
+        std::cout << "[FTP Scan] Max depth " << maxDepth << " reached, skipping: " << ftpDir << std::endl;
+        return;
     }
     
+    std::cout << "[FTP Scan] Depth " << depth << ": " << ftpDirectoryUrl(baseUrl, ftpDir) << std::endl;
+    
+    std::string readBuffer;
+    bool mlsd = false;
+    CURLcode res = fetchFtpListing(ftpDir, baseUrl, username, password, readBuffer, mlsd);
+    
+    if (res != CURLE_OK) {
+        std::cerr << "[FTP Scan] Error scanning " << ftpDir << ": " << curl_easy_strerror(res) << std::endl;
+        return;
+    }
+    
+    // Parse FTP LIST output
+    int fileCount = 0;
+    int dirCount = 0;
+    std::vector<std::string> subdirs;
+    
+    std::cout << "[FTP Scan] Parsing directory: " << ftpDir << std::endl;
+    parseFtpListing(readBuffer, ftpDir, baseUrl, filesBySize, subdirs, fileCount, dirCount, mlsd);
+    
     std::cout << "[FTP Scan] Found " << fileCount << " files and " << dirCount << " subdirectories in " << ftpDir << " (depth " << depth << ")" << std::endl;
     
     // Recursively scan subdirectories (up to maxDepth)
@@ -13261,36 +15073,75 @@ bool deleteEmptyDirectories(const std::string& path, int& deletedCount) {
 }
 
 // Recursively scan directory for files (OHNE Tiefenbegrenzung - alle Unterverzeichnisse!)
-void scanDirectoryRecursive(const std::string& path, std::map<long long, std::vector<std::string>>& filesBySize, int depth = 0, int maxDepth = 999) {
+// remoteFs/fsDev are decided at depth 0 and re-checked whenever the walk crosses into another filesystem
+void scanDirectoryRecursive(const std::string& path, std::map<long long, std::vector<std::string>>& filesBySize, int depth = 0, int maxDepth = 999,
+                            bool remoteFs = false, dev_t fsDev = 0) {
     if (stopScan) return;
     // KEINE Tiefenbegrenzung beim Local Scan - scannt ALLE Unterverzeichnisse!
     
+    // NFS-AWARE: On network mounts every stat() is a round trip (100-500 ms on a slow link).
+    // The entries of a directory are stat()ed concurrently by statPrefetchPool instead of one by one.
+    if (depth == 0) {
+        struct stat rootSt;
+        fsDev = stat(path.c_str(), &rootSt) == 0 ? rootSt.st_dev : 0;
+        remoteFs = appState.nfsStatPrefetch && (isNetworkMountPoint(path, appState) || isRemoteFilesystem(path));
+        if (remoteFs) {
+            statPrefetchPool.start(std::clamp(appState.nfsStatPrefetchThreads, 4, 128));
+            std::cout << "[Scanner] Network mount: " << path << " -> metadata prefetch with "
+                      << statPrefetchPool.threadCount() << " threads"
+                      << (appState.nfsStatDontSync ? " (AT_STATX_DONT_SYNC)" : "") << std::endl;
+        }
+    }
+    
     // OPTIMIZATION: Larger batches reduce lock overhead (10000 instead of 1000)
     std::unordered_map<std::string, CachedFileInfo> localFileCache;
     localFileCache.reserve(10000);
     long long localBytesProcessed = 0;
     int localFilesScanned = 0;
     
-    DIR* dir = opendir(path.c_str());
-    if (!dir) return;
-    
     // OPTIMIZATION: Pre-allocate for large directories (reduce reallocs)
     std::vector<std::string> entries;
     entries.reserve(512); // Increased from 128 to 512
     
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        const char* name = entry->d_name;
-        // OPTIMIZATION: Fast check for . and .. without string allocation
-        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
-            continue;
+    // INCREMENTAL: Unchanged directory (same mtime/ctime) -> reuse cached listing, no readdir()
+    // Saves the READDIR round trips on NFS; entries are still stat()ed below
+    struct stat dirSt;
+    bool haveDirStat = appState.useDirListingCache && stat(path.c_str(), &dirSt) == 0;
+    if (!haveDirStat || !dirListingCache.lookup(path, dirSt, entries)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) return;
+        
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            const char* name = entry->d_name;
+            // OPTIMIZATION: Fast check for . and .. without string allocation
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+            entries.emplace_back(name);
+        }
+        closedir(dir);
+        
+        // OPTIMIZATION: Sort alphanumerically for better disk cache performance
+        std::sort(entries.begin(), entries.end());
+        
+        if (haveDirStat) {
+            dirListingCache.store(path, dirSt, entries);
         }
-        entries.emplace_back(name);
     }
-    closedir(dir);
     
-    // OPTIMIZATION: Sort alphanumerically for better disk cache performance
-    std::sort(entries.begin(), entries.end());
+    // Skip hidden files if option is disabled (before the prefetch - no round trips for them)
+    if (!appState.scanHiddenFiles) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const std::string& name) { return name[0] == '.'; }),
+                      entries.end());
+    }
+    
+    std::vector<PrefetchedStat> prefetched;
+    if (remoteFs) {
+        statPrefetchPool.statDirectory(path, entries, appState.followSymlinks, appState.nfsStatDontSync, prefetched);
+    }
+    time_t prefetchTime = std::time(nullptr);
     
     // OPTIMIZATION: Reserve path buffer to avoid repeated allocations
     std::string fullPath;
@@ -13300,26 +15151,35 @@ void scanDirectoryRecursive(const std::string& path, std::map<long long, std::ve
     std::unordered_map<long long, std::vector<std::string>*> sizeMapCache;
     sizeMapCache.reserve(1000);
     
-    // Process sorted entries
-    for (const auto& name : entries) {
-        if (stopScan) break;
-        
-        // Skip hidden files if option is disabled
-        if (!appState.scanHiddenFiles && name[0] == '.') {
-            continue;
-        }
+    // Process sorted entries
+    for (size_t index = 0; index < entries.size(); index++) {
+        if (stopScan) break;
+        const std::string& name = entries[index];
         
         // OPTIMIZATION: Reuse fullPath buffer instead of creating new strings
         fullPath = path;
         if (fullPath.back() != '/') fullPath += '/';
         fullPath += name;
         
-        struct stat st;
+        struct stat st{};
         // OPTIMIZATION: Use stat() directly instead of lstat+stat for symlinks
         // stat() follows symlinks automatically, only use lstat if we need to detect them
         bool useStat = true;
         
-        if (!appState.followSymlinks) {
+        if (remoteFs) {
+            // Already stat()ed by the prefetch pool (statx with AT_SYMLINK_NOFOLLOW unless following)
+            const PrefetchedStat& pre = prefetched[index];
+            if (pre.error != 0 || S_ISLNK(pre.mode)) {
+                continue; // Disappeared, inaccessible or symlink (skipped)
+            }
+            st.st_mode = pre.mode;
+            st.st_size = pre.size;
+            st.st_mtime = pre.mtime;
+            st.st_ino = pre.inode;
+            st.st_dev = pre.device;
+            statCache.put(fullPath, {st.st_mode, st.st_size, st.st_mtime, prefetchTime});
+            useStat = false;
+        } else if (!appState.followSymlinks) {
             // Need to detect symlinks - use lstat first
             if (lstat(fullPath.c_str(), &st) == 0 && S_ISLNK(st.st_mode)) {
                 continue; // Skip symlink
@@ -13333,7 +15193,15 @@ void scanDirectoryRecursive(const std::string& path, std::map<long long, std::ve
         
             if (S_ISDIR(st.st_mode)) {
                 // Recursive scan subdirectory (ALLE Unterverzeichnisse, keine Begrenzung!)
-                scanDirectoryRecursive(fullPath, filesBySize, depth + 1, maxDepth);
+                // Mount point inside the walk (e.g. NFS below a local root): decide again
+                bool subdirRemote = remoteFs;
+                if (st.st_dev != fsDev) {
+                    subdirRemote = appState.nfsStatPrefetch && isRemoteFilesystem(fullPath);
+                    if (subdirRemote) {
+                        statPrefetchPool.start(std::clamp(appState.nfsStatPrefetchThreads, 4, 128));
+                    }
+                }
+                scanDirectoryRecursive(fullPath, filesBySize, depth + 1, maxDepth, subdirRemote, st.st_dev);
             } else if (S_ISREG(st.st_mode)) {
                 // Regular file
                 // Skip empty files if setting is enabled
@@ -13364,13 +15232,10 @@ void scanDirectoryRecursive(const std::string& path, std::map<long long, std::ve
                     
                     // OPTIMIZATION: Larger batches (10000 instead of 1000) reduce lock overhead by 90%
                     if (localFilesScanned % 10000 == 0) {
-                        {
-                            std::lock_guard<std::mutex> lock(fileCacheMutex);
-                            for (const auto& entry : localFileCache) {
-                                fileCache[entry.first] = entry.second;
-                            }
-                            localFileCache.clear();
+                        for (const auto& entry : localFileCache) {
+                            fileCache.put(entry.first, entry.second);
                         }
+                        localFileCache.clear();
                         {
                             std::lock_guard<std::mutex> lock(resultsMutex);
                             appState.filesScanned += localFilesScanned;
@@ -13385,9 +15250,8 @@ void scanDirectoryRecursive(const std::string& path, std::map<long long, std::ve
     
     // Final batch flush
     if (!localFileCache.empty()) {
-            std::lock_guard<std::mutex> lock(fileCacheMutex);
             for (const auto& entry : localFileCache) {
-                fileCache[entry.first] = entry.second;
+                fileCache.put(entry.first, entry.second);
             }
             localFileCache.clear();
         }
@@ -13398,6 +15262,219 @@ void scanDirectoryRecursive(const std::string& path, std::map<long long, std::ve
         }
 }
 
+// Start the multi engine on first use (per server: ftpMaxConnections, total: ftpMultiMaxTransfers)
+static bool ensureFtpMultiEngine() {
+    if (ftpMultiEngine.isRunning()) return true;
+    int workers = std::max(2, (int)std::thread::hardware_concurrency() / 2);
+    return ftpMultiEngine.start(workers, appState.ftpMaxConnections, appState.ftpMultiMaxTransfers);
+}
+
+// Wait for all engine transfers; aborts them when the scan is stopped
+static void waitFtpMultiEngine() {
+    bool cancelled = false;
+    while (!ftpMultiEngine.waitIdleFor(std::chrono::milliseconds(100))) {
+        if (stopScan && !cancelled) {
+            ftpMultiEngine.cancelAll();
+            cancelled = true;
+        }
+    }
+}
+
+// Event-driven variant of scanFtpDirectory(): every directory is one LIST transfer on
+// ftpMultiEngine, subdirectories are submitted as soon as their parent listing is parsed
+// (on an engine worker), so all levels of all trees are listed concurrently. With several
+// servers the engine admits their queues round-robin within each server's budget.
+void scanFtpDirectoriesMulti(const std::vector<FtpScanServer>& servers,
+                             std::map<long long, std::vector<std::string>>& filesBySize, int maxDepth = 30) {
+    std::atomic<int> dirsListed{0};
+    std::atomic<int> dirsFailed{0};
+    auto startTime = std::chrono::steady_clock::now();
+    
+    struct ServerListing {
+        const FtpScanServer* server;
+        FtpServerFeatures features;
+        std::string optsCommand;
+    };
+    std::vector<ServerListing> listings;
+    for (const auto& server : servers) {
+        if (server.dirs.empty()) continue;
+        ServerListing listing{&server, FtpServerFeatures(), ""};
+        if (appState.ftpUseMlsd) listing.features = getFtpServerFeatures(server.baseUrl, server.username, server.password);
+        listing.optsCommand = mlstOptsCommand(listing.features);
+        listings.push_back(std::move(listing));
+    }
+    
+    std::function<void(const ServerListing&, const std::string&, int, bool)> submitDir =
+        [&](const ServerListing& listing, const std::string& ftpDir, int depth, bool mlsd) {
+        if (stopScan) return;
+        const std::string& baseUrl = listing.server->baseUrl;
+        const std::string& optsCommand = listing.optsCommand;
+        FtpTransferRequest request;
+        request.url = ftpDirectoryUrl(baseUrl, ftpDir);
+        request.username = listing.server->username;
+        request.password = listing.server->password;
+        request.collectBody = true;
+        request.timeoutSec = appState.ftpResponseTimeout * 2;
+        if (mlsd) {
+            request.customRequest = "MLSD";
+            if (!optsCommand.empty()) request.quote.push_back(optsCommand);
+        }
+        
+        ftpMultiEngine.submit(std::move(request), [&, ftpDir, depth, mlsd](FtpTransferResult& result) {
+            const std::string& baseUrl = listing.server->baseUrl;
+            if (result.code != CURLE_OK && mlsd && result.code != CURLE_ABORTED_BY_CALLBACK && !stopScan) {
+                std::cerr << "[FTP Scan] MLSD failed for " << ftpDir << " (" << curl_easy_strerror(result.code) << "), retrying with LIST" << std::endl;
+                submitDir(listing, ftpDir, depth, false);
+                return;
+            }
+            if (result.code != CURLE_OK) {
+                if (result.code != CURLE_ABORTED_BY_CALLBACK) {
+                    std::cerr << "[FTP Scan] Error scanning " << ftpDir << ": " << curl_easy_strerror(result.code) << std::endl;
+                }
+                dirsFailed++;
+                return;
+            }
+            int fileCount = 0;
+            int dirCount = 0;
+            std::vector<std::string> subdirs;
+            parseFtpListing(result.body, ftpDir, baseUrl, filesBySize, subdirs, fileCount, dirCount, mlsd);
+            dirsListed++;
+            
+            if (depth < maxDepth) {
+                for (const auto& subdir : subdirs) submitDir(listing, subdir, depth + 1, listing.features.mlsd);
+            } else if (!subdirs.empty()) {
+                std::cout << "[FTP Scan] Max depth " << maxDepth << " reached, skipping below: " << ftpDir << std::endl;
+            }
+        });
+    };
+    
+    for (const auto& listing : listings) {
+        for (const auto& dir : listing.server->dirs) submitDir(listing, dir, 0, listing.features.mlsd);
+    }
+    waitFtpMultiEngine();
+    
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "[FTP Scan] Multi engine listed " << dirsListed.load() << " directories on " << listings.size()
+              << " server(s) (" << dirsFailed.load() << " failed) in " << ms << " ms" << std::endl;
+}
+
+// curl write callback for LIST -R: the listing is parsed while it streams in, nothing is buffered
+static size_t FtpListRCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t totalSize = size * nmemb;
+    appState.ftpBytesTransferred += totalSize;
+    while (appState.scanPaused && !stopScan) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (stopScan) return 0; // Abort transfer
+    throttleRemote(totalSize);
+    ((FtpListRParser*)userp)->feed((const char*)contents, totalSize);
+    return totalSize;
+}
+
+// Whole tree of ftpDir with a single LIST -R; files go straight into filesBySize from the write
+// callback. Returns false if the server rejected -R (list ftpDir per directory instead). If the
+// server ignored -R, the root files are recorded and its subdirectories are returned in remainingDirs.
+// Not used when MLSD is available: only MLSD carries the modify times the remote hash cache needs.
+bool scanFtpDirectoryListR(const std::string& ftpDir, const std::string& baseUrl,
+                           const std::string& username, const std::string& password,
+                           std::map<long long, std::vector<std::string>>& filesBySize,
+                           int maxDepth, std::vector<std::string>& remainingDirs) {
+    if (!appState.ftpUseLsR) return false;
+    std::string serverKey = FtpHandlePool::serverKey(baseUrl) + "|" + username;
+    {
+        std::lock_guard<std::mutex> lock(ftpListRUnsupportedMutex);
+        if (ftpListRUnsupported.count(serverKey)) return false;
+    }
+    if (appState.ftpUseMlsd && getFtpServerFeatures(baseUrl, username, password).mlsd) return false;
+    
+    std::string rootUrl = ftpDirectoryUrl(baseUrl, ftpDir);       // Percent-encoded, for the request
+    std::string storedRoot = ftpStoredDirUrl(baseUrl, ftpDir);     // Raw, like parseFtpListing() paths
+    std::string rootDir = ftpDir;
+    if (rootDir.empty() || rootDir.back() != '/') rootDir += "/";
+    std::vector<std::string> rootSubdirs;
+    std::vector<std::pair<long long, std::string>> recorded;       // size, path - undone on abort
+    int fileCount = 0;
+    
+    FtpListRParser parser([&](const FtpListEntry& entry) {
+        int depth = entry.dir.empty() ? 0 : 1 + (int)std::count(entry.dir.begin(), entry.dir.end(), '/');
+        if (entry.type == FtpListType::Dir) {
+            if (depth == 0) rootSubdirs.push_back(rootDir + std::string(entry.name));
+            return;
+        }
+        if (depth > maxDepth || entry.size <= 0) return; // Empty files are never duplicates candidates
+        
+        std::string fullPath = storedRoot;
+        if (!entry.dir.empty()) {
+            fullPath.append(entry.dir.data(), entry.dir.size());
+            fullPath += '/';
+        }
+        fullPath.append(entry.name.data(), entry.name.size());
+        recordFtpFile(fullPath, entry.size, 0, filesBySize); // LIST doesn't provide mtime reliably
+        recorded.push_back({entry.size, std::move(fullPath)});
+        fileCount++;
+    }, ftpDir);
+    
+    auto startTime = std::chrono::steady_clock::now();
+    FtpHandlePool::Lease lease = ftpHandlePool.acquire(baseUrl, username, password);
+    if (!lease) return false;
+    CURL* curl = lease.get();
+    curl_easy_setopt(curl, CURLOPT_URL, rootUrl.c_str());
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "LIST -R");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, FtpListRCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &parser);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 0L);                  // Big trees take long; stall detection instead
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, (long)(appState.ftpResponseTimeout * 4));
+    CURLcode res = lease.perform();
+    lease.release();
+    parser.finish();
+    
+    if (stopScan) return true;
+    if (res != CURLE_OK && parser.lines() == 0) {
+        // 500/501/550: -R not understood (or taken as a file name)
+        std::cout << "[FTP Scan] LIST -R rejected by " << FtpHandlePool::serverKey(baseUrl) << " ("
+                  << curl_easy_strerror(res) << ") - listing per directory" << std::endl;
+        std::lock_guard<std::mutex> lock(ftpListRUnsupportedMutex);
+        ftpListRUnsupported.insert(serverKey);
+        return false;
+    }
+    if (res != CURLE_OK) {
+        // Broken off midway: the files recorded so far are removed again (counters included) and
+        // the whole tree is listed again per directory
+        std::cerr << "[FTP Scan] LIST -R of " << ftpDir << " aborted after " << parser.lines() << " lines ("
+                  << curl_easy_strerror(res) << ")" << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            for (const auto& [size, path] : recorded) {
+                auto group = filesBySize.find(size);
+                if (group == filesBySize.end()) continue;
+                auto it = std::find(group->second.rbegin(), group->second.rend(), path);   // Recently added
+                if (it == group->second.rend()) continue;
+                group->second.erase(std::next(it).base());
+                if (group->second.empty()) filesBySize.erase(group);
+                appState.filesScanned--;
+                appState.bytesProcessed -= size;
+            }
+        }
+        return false;
+    }
+    if (parser.recursionIgnored()) {
+        std::cout << "[FTP Scan] " << FtpHandlePool::serverKey(baseUrl) << " ignored LIST -R - listing "
+                  << rootSubdirs.size() << " subdirectories of " << ftpDir << " separately" << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(ftpListRUnsupportedMutex);
+            ftpListRUnsupported.insert(serverKey);
+        }
+        remainingDirs.insert(remainingDirs.end(), rootSubdirs.begin(), rootSubdirs.end());
+        return true;
+    }
+    
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "[FTP Scan] LIST -R " << ftpDir << ": " << fileCount << " files in " << (parser.headers() + 1)
+              << " directories, " << parser.lines() << " lines in " << ms << " ms" << std::endl;
+    return true;
+}
+
 // Scan FTP directory using cache (FAST MODE - no directory listing needed!)
 void scanFtpDirectoryCached(const std::string& ftpDir, const std::string& baseUrl,
                            const std::string& username, const std::string& password,
@@ -13446,77 +15523,171 @@ void scanFtpDirectoryCached(const std::string& ftpDir, const std::string& baseUr
     // We still need to get file list, but we KNOW the directory exists (from cache)
     // This is much faster than doing full recursive FTP LIST
     
-    CURL* curl = curl_easy_init();
-    if (!curl) return;
-    
     std::string readBuffer;
-    readBuffer.reserve(65536);
-    
-    // Build URL
-    std::string encodedPath = urlEncodePath(ftpDir);
-    std::string fullUrl = baseUrl;
-    if (!fullUrl.empty() && fullUrl.back() != '/') fullUrl += '/';
-    if (!encodedPath.empty() && encodedPath.front() == '/') encodedPath = encodedPath.substr(1);
-    fullUrl += encodedPath;
-    if (fullUrl.back() != '/') fullUrl += "/";
-    
-    curl_easy_setopt(curl, CURLOPT_URL, fullUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_USERNAME, username.c_str());
-    curl_easy_setopt(curl, CURLOPT_PASSWORD, password.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-    
-    applyOptimalCurlSettings(curl);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)(appState.ftpResponseTimeout * 2));
-    
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+    bool mlsd = false;
+    CURLcode res = fetchFtpListing(ftpDir, baseUrl, username, password, readBuffer, mlsd);
     
     if (res != CURLE_OK) {
         std::cerr << "[FTP Cache Scan] Error listing files in " << ftpDir << ": " << curl_easy_strerror(res) << std::endl;
         return;
     }
     
-    // Parse FTP LIST output (only files this time, we already know subdirs from cache!)
-    std::istringstream iss(readBuffer);
-    std::string line;
+    // Parse listing (only files are used this time, we already know subdirs from cache!)
     int fileCount = 0;
+    int dirCount = 0;
+    std::vector<std::string> ignoredSubdirs;
+    parseFtpListing(readBuffer, ftpDir, baseUrl, filesBySize, ignoredSubdirs, fileCount, dirCount, mlsd);
     
-    while (std::getline(iss, line) && !stopScan) {
-        if (line.empty()) continue;
-        
-        // Check if it's a file (not directory)
-        if (line[0] != 'd' && line[0] != 'l') {
-            // Parse file size and name
-            std::istringstream lineStream(line);
-            std::string permissions, links, owner, group;
-            long long size;
-            std::string month, day, time, filename;
-            
-            lineStream >> permissions >> links >> owner >> group >> size >> month >> day >> time;
-            std::getline(lineStream, filename);
-            
-            if (!filename.empty() && filename[0] == ' ') filename = filename.substr(1);
-            if (filename.empty() || filename == "." || filename == "..") continue;
-            
-            // Build full FTP path
-            std::string filePath = fullUrl + filename;
-            
-            // Add to filesBySize for duplicate detection
-            {
-                std::lock_guard<std::mutex> lock(resultsMutex);
-                filesBySize[size].push_back(filePath);
-                appState.filesScanned++;
-                appState.bytesProcessed += size;
-                appState.totalBytes += size;
-                appState.ftpBytesTransferred += size;
+    std::cout << "[FTP Cache Scan] Found " << fileCount << " files in " << ftpDir << std::endl;
+}
+
+// REMOTE HASH PLANNER: decide per FTP candidate how it gets its hash, cheapest first (remote hash
+// cache, server-side MD5, head/tail sample, full download - see remote_hash_planner.h). The plan and
+// the bytes it will transfer are shown before hashing starts. Local members of sampled size groups
+// are sampled first, then the remote samples are fetched; a remote file whose sample matches no
+// size peer (local or remote) is ruled out. mixedSizes: groups whose local members must be hashed
+// as MD5 to be comparable with the remote hashes. transferOnly: Download steps - hashed as MD5 by
+// transfer, without asking the server (its digest may be SHA-x and match nothing in the group).
+static void runRemoteHashPlanner(const std::map<long long, std::vector<std::string>>& filesBySize,
+                                 const std::vector<FtpScanServer>& servers,
+                                 std::set<std::string>& eliminated, std::map<std::string, std::string>& knownHashes,
+                                 std::set<long long>& mixedSizes, std::set<std::string>& transferOnly) {
+    std::vector<HashPlanGroup> groups;
+    std::map<std::string, const FtpScanServer*> serverOf;
+    for (const auto& [size, files] : filesBySize) {
+        if (files.size() <= 1) continue;
+        HashPlanGroup group;
+        group.size = size;
+        for (const auto& file : files) {
+            if (stopScan) return;
+            if (!isFtpFile(file)) {
+                group.members.push_back({file, false, RemoteHashSource::Transfer});
+                continue;
             }
+            const FtpScanServer* server = findFtpScanServer(servers, file);
+            if (!server) continue;
+            serverOf[file] = server;
             
-            fileCount++;
+            HashPlanMember member{file, true, RemoteHashSource::Transfer, FtpHandlePool::serverKey(file)};
+            std::string hash;
+            FtpDigestPlan digest;
+            std::string rootUrl;
+            if (lookupRemoteHash(file, size, hash, true)) {
+                knownHashes[file] = hash;
+                member.source = RemoteHashSource::Cached;
+            } else if (peekRemoteHash(file, size, hash)) {
+                // Cached SHA-x digest: comparable with other server digests only, like a fresh one
+                member.source = RemoteHashSource::ServerOther;
+            } else if (planFtpServerDigest(file, server->username, server->password, digest, rootUrl)) {
+                member.source = digest.algo == FtpDigestAlgo::MD5 ? RemoteHashSource::ServerMD5 : RemoteHashSource::ServerOther;
+            }
+            group.members.push_back(member);
         }
+        groups.push_back(std::move(group));
     }
     
-    std::cout << "[FTP Cache Scan] Found " << fileCount << " files in " << ftpDir << std::endl;
+    RemoteHashPlan plan = planRemoteHashing(groups, ftpSampleBytes(), appState.ftpSamplePrefilter);
+    mixedSizes = plan.mixedSizes;
+    if (plan.remoteFiles == 0) return;
+    for (const auto& [file, step] : plan.steps) {
+        if (step == RemoteHashStep::Download) transferOnly.insert(file);
+    }
+    
+    auto publishPlan = [&plan](const char* stage) {
+        std::string summary = describeRemoteHashPlan(plan);
+        std::cout << "[Hash Plan] " << stage << ": " << summary << std::endl;
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        appState.remoteHashPlan = summary;
+        appState.scanStatus = std::string("Hash-Plan: ") + summary;
+    };
+    publishPlan("Plan");
+    if (plan.sampled == 0) return;
+    
+    // 1. Local members of the sampled groups (cheap, and they decide which remote files can match)
+    struct Sample {
+        std::string file;
+        long long size;
+        std::string key;
+    };
+    std::vector<Sample> localSamples;
+    std::vector<Sample> remoteSamples;
+    for (const auto& group : groups) {
+        if (!plan.sampledSizes.count(group.size)) continue;
+        for (const auto& member : group.members) {
+            (member.remote ? remoteSamples : localSamples).push_back({member.file, group.size, ""});
+        }
+    }
+    {
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads;
+        int workers = std::max(1, std::min(std::min(128, appState.threadCount), (int)localSamples.size()));
+        for (int t = 0; t < workers && !localSamples.empty(); t++) {
+            threads.emplace_back([&]() {
+                for (size_t i = next++; i < localSamples.size() && !stopScan; i = next++) {
+                    localSamples[i].key = localSampleKey(localSamples[i].file, localSamples[i].size);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    }
+    
+    // 2. Remote samples
+    std::cout << "[Hash Plan] Sampling " << remoteSamples.size() << " FTP files (" << appState.ftpSampleKB
+              << " KB head + tail) against " << localSamples.size() << " local samples" << std::endl;
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        appState.scanStatus = "FTP-Stichproben (" + std::to_string(remoteSamples.size()) + " Dateien)...";
+    }
+    long long transferredBefore = appState.ftpBytesTransferred;
+    
+    if (appState.ftpUseMultiEngine && ensureFtpMultiEngine()) {
+        for (auto& sample : remoteSamples) {
+            if (stopScan) break;
+            const FtpScanServer* server = serverOf[sample.file];
+            Sample* target = &sample;
+            submitFtpSample(sample.file, server->username, server->password, sample.size, [target](const std::string& key, bool) {
+                target->key = key;
+            });
+        }
+        waitFtpMultiEngine();
+    } else {
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads;
+        int workers = std::max(1, std::min(appState.ftpMaxConnections, (int)remoteSamples.size()));
+        for (int t = 0; t < workers; t++) {
+            threads.emplace_back([&]() {
+                for (size_t i = next++; i < remoteSamples.size() && !stopScan; i = next++) {
+                    Sample& sample = remoteSamples[i];
+                    const FtpScanServer* server = serverOf[sample.file];
+                    bool complete = false;
+                    sample.key = calculateFtpSample(sample.file, server->username, server->password, sample.size, complete);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+    }
+    if (stopScan) return;
+    
+    // 3. Only samples with a peer in their size group still need the full file
+    std::map<long long, std::vector<std::string>> localKeys;
+    std::map<long long, std::map<std::string, std::string>> remoteKeys;
+    for (const auto& sample : localSamples) localKeys[sample.size].push_back(sample.key);
+    for (const auto& sample : remoteSamples) remoteKeys[sample.size][sample.file] = sample.key;
+    long long saved = 0;
+    for (const auto& [size, keys] : remoteKeys) {
+        int before = plan.skipped;
+        for (const auto& file : applySamples(plan, size, localKeys[size], keys)) transferOnly.insert(file);
+        saved += (plan.skipped - before) * (size - 2 * ftpSampleBytes());
+    }
+    for (const auto& [file, step] : plan.steps) {
+        if (step == RemoteHashStep::Skip) eliminated.insert(file);
+    }
+    appState.ftpBytesSaved += saved;
+    
+    std::cout << "[Hash Plan] " << plan.skipped << " FTP files ruled out by their samples, "
+              << ((appState.ftpBytesTransferred - transferredBefore) / (1024 * 1024)) << " MB sampled, "
+              << (saved / (1024 * 1024)) << " MB saved" << std::endl;
+    publishPlan("After samples");
 }
 
 // Main scan function (runs in separate thread)
@@ -13561,6 +15732,7 @@ void performScan() {
     {
         std::lock_guard<std::mutex> lock(resultsMutex);
         appState.duplicates.clear();
+        loadedSnapshot.close();
         appState.duplicateGroups = 0;
         appState.duplicateFiles = 0;
         appState.duplicateSize = 0;
@@ -13594,6 +15766,12 @@ void performScan() {
         std::cout << "[Scanner] Auto-tuned: " << appState.threadCount << " threads" << std::endl;
     }
     
+    // Load directory listing cache once (lazy, like the other caches)
+    if (appState.useDirListingCache && !dirListingCache.isLoaded()) {
+        dirListingCache.load(dirListingCacheFilePath);
+    }
+    dirListingCache.resetCounters();
+    
     // Step 1: Group files by size
     std::map<long long, std::vector<std::string>> filesBySize;
     
@@ -13782,14 +15960,23 @@ void performScan() {
         }
     }
     
-    // Scan FTP directories
-    if (appState.connectedPresetIndex >= 0 && appState.connectedPresetIndex < appState.ftpPresets.size()) {
-        const auto& preset = appState.ftpPresets[appState.connectedPresetIndex];
-        std::string ftpUrl = "ftp://" + preset.ip + ":" + std::to_string(preset.port);
-        
+    // NFS/SMB roots without kernel mount - libnfs / libsmb2 in user space
+    std::vector<AsyncFsExport> mountlessExports = collectAsyncFsExports();
+    if (!mountlessExports.empty() && !stopScan) {
+        std::cout << "[Scanner] " << mountlessExports.size() << " NFS/SMB export(s) without mount" << std::endl;
+        scanAsyncFsExports(mountlessExports, filesBySize);
+    }
+    
+    // Scan FTP directories - every server with selected directories, concurrently
+    std::vector<FtpScanServer> ftpServers = collectFtpScanServers();
+    if (!ftpServers.empty()) {
         // Initialize FTP bandwidth tracking
         appState.ftpBytesTransferred = 0;
         appState.ftpScanStartTime = std::chrono::steady_clock::now();
+        std::cout << "[FTP Scanner] " << ftpServers.size() << " server(s): ";
+        for (const auto& server : ftpServers) std::cout << server.baseUrl << " (" << server.dirs.size() << " dirs) ";
+        std::cout << std::endl;
+        applyFtpServerBudgets(ftpServers);
         
         // CACHE: Check if we can use cached FTP directory trees
         std::cout << "[FTP Scanner] Checking FTP directory cache..." << std::endl;
@@ -13803,22 +15990,25 @@ void performScan() {
                 bool allCached = true;
                 time_t now = time(nullptr);
                 
-                for (const auto& ftpDir : appState.selectedFtpDirs) {
-                    std::string cacheKey = ftpUrl + ftpDir;
-                    auto it = ftpDirCache.find(cacheKey);
-                    
-                    if (it == ftpDirCache.end()) {
-                        allCached = false;
-                        std::cout << "[FTP Scanner] Cache miss for: " << cacheKey << std::endl;
-                        break;
-                    }
-                    
-                    int age_seconds = (now - it->second.timestamp);
-                    if (age_seconds > 3600) { // Cache older than 1 hour
-                        allCached = false;
-                        std::cout << "[FTP Scanner] Cache too old (" << (age_seconds/60) << " minutes) for: " << cacheKey << std::endl;
-                        break;
+                for (const auto& server : ftpServers) {
+                    for (const auto& ftpDir : server.dirs) {
+                        std::string cacheKey = server.baseUrl + ftpDir;
+                        auto it = ftpDirCache.find(cacheKey);
+                        
+                        if (it == ftpDirCache.end()) {
+                            allCached = false;
+                            std::cout << "[FTP Scanner] Cache miss for: " << cacheKey << std::endl;
+                            break;
+                        }
+                        
+                        int age_seconds = (now - it->second.timestamp);
+                        if (age_seconds > 3600) { // Cache older than 1 hour
+                            allCached = false;
+                            std::cout << "[FTP Scanner] Cache too old (" << (age_seconds/60) << " minutes) for: " << cacheKey << std::endl;
+                            break;
+                        }
                     }
+                    if (!allCached) break;
                 }
                 
                 if (allCached) {
@@ -13829,44 +16019,92 @@ void performScan() {
             }
         }
         
+        {
+            std::lock_guard<std::mutex> lock(ftpSeenDirIdsMutex);
+            ftpSeenDirIds.clear();
+        }
+        
         if (useCachedFtpDirs) {
             // Use cached FTP directories - scan only files, not directory structure!
             std::cout << "[FTP Scanner] === FAST MODE: Scanning files from cache ===" << std::endl;
             
-            for (const auto& ftpDir : appState.selectedFtpDirs) {
-                if (stopScan) break;
-                
-                // Pause handling - OPTIMIZED: 10ms instead of 100ms for faster pause response
-                while (appState.scanPaused && !stopScan) {
-                    appState.scanStatus = "⏸ PAUSIERT - Drücke Fortsetzen";
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            for (const auto& server : ftpServers) {
+                for (const auto& ftpDir : server.dirs) {
+                    if (stopScan) break;
+                    
+                    // Pause handling - OPTIMIZED: 10ms instead of 100ms for faster pause response
+                    while (appState.scanPaused && !stopScan) {
+                        appState.scanStatus = "⏸ PAUSIERT - Drücke Fortsetzen";
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                    if (stopScan) break;
+                    
+                    std::cout << "[FTP Scanner] Processing cached FTP: " << server.baseUrl << ftpDir << std::endl;
+                    appState.scanStatus = "Durchsuche FTP (Cache): " + ftpDir;
+                    
+                    // Scan using cache (no directory listing needed!)
+                    scanFtpDirectoryCached(ftpDir, server.baseUrl, server.username, server.password, filesBySize);
                 }
-                if (stopScan) break;
-                
-                std::cout << "[FTP Scanner] Processing cached FTP: " << ftpDir << std::endl;
-                appState.scanStatus = "Durchsuche FTP (Cache): " + ftpDir;
-                
-                // Scan using cache (no directory listing needed!)
-                scanFtpDirectoryCached(ftpDir, ftpUrl, preset.username, preset.password, filesBySize);
             }
         } else {
             // No cache or cache outdated - do full FTP scan
             std::cout << "[FTP Scanner] === SLOW MODE: Full FTP directory scan ===" << std::endl;
+            bool viaEngine = appState.ftpUseMultiEngine && ensureFtpMultiEngine();
+            
+            // One scheduler thread per server, so a slow box never holds up the others. Each tries
+            // LIST -R first (one streamed transfer per tree); what that can't cover is listed per
+            // directory - on the shared multi engine (round-robin over servers, within each budget)
+            // or directly in the server's thread.
+            std::vector<FtpScanServer> remaining = ftpServers;
+            std::vector<std::thread> serverThreads;
+            for (size_t i = 0; i < ftpServers.size(); i++) {
+                serverThreads.emplace_back([&, i]() {
+                    const FtpScanServer& server = ftpServers[i];
+                    std::vector<std::string> ftpDirs;
+                    for (const auto& ftpDir : server.dirs) {
+                        if (stopScan) break;
+                        {
+                            std::lock_guard<std::mutex> lock(resultsMutex);
+                            appState.scanStatus = "Durchsuche FTP (LIST -R): " + ftpDir;
+                        }
+                        if (!scanFtpDirectoryListR(ftpDir, server.baseUrl, server.username, server.password, filesBySize,
+                                                   appState.ftpScanMaxDepth, ftpDirs)) {
+                            ftpDirs.push_back(ftpDir);
+                        }
+                    }
+                    
+                    if (viaEngine) {
+                        remaining[i].dirs = std::move(ftpDirs);
+                        return;
+                    }
+                    for (const auto& ftpDir : ftpDirs) {
+                        if (stopScan) break;
+                    
+                        // Pause handling - OPTIMIZED: 10ms instead of 100ms for faster pause response
+                        while (appState.scanPaused && !stopScan) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                        }
+                        if (stopScan) break;
+                    
+                        std::cout << "[Scanner] Scanning FTP: " << server.baseUrl << ftpDir << " (Max Depth: " << appState.ftpScanMaxDepth 
+                                  << ", Threads: " << appState.ftpMaxThreads << ")" << std::endl;
+                        {
+                            std::lock_guard<std::mutex> lock(resultsMutex);
+                            appState.scanStatus = "Durchsuche FTP: " + ftpDir;
+                        }
+                        scanFtpDirectory(ftpDir, server.baseUrl, server.username, server.password, filesBySize, 0, appState.ftpScanMaxDepth);
+                    }
+                });
+            }
+            for (auto& thread : serverThreads) thread.join();
             
-            for (const auto& ftpDir : appState.selectedFtpDirs) {
-                if (stopScan) break;
-                
-                // Pause handling - OPTIMIZED: 10ms instead of 100ms for faster pause response
-                while (appState.scanPaused && !stopScan) {
-                    appState.scanStatus = "⏸ PAUSIERT - Drücke Fortsetzen";
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-                }
-                if (stopScan) break;
-                
-                std::cout << "[Scanner] Scanning FTP: " << ftpDir << " (Max Depth: " << appState.ftpScanMaxDepth 
-                          << ", Threads: " << appState.ftpMaxThreads << ")" << std::endl;
-                appState.scanStatus = "Durchsuche FTP: " + ftpDir;
-                scanFtpDirectory(ftpDir, ftpUrl, preset.username, preset.password, filesBySize, 0, appState.ftpScanMaxDepth);
+            size_t engineDirs = 0;
+            for (const auto& server : remaining) engineDirs += viaEngine ? server.dirs.size() : 0;
+            if (engineDirs > 0 && !stopScan) {
+                std::cout << "[Scanner] Scanning " << engineDirs << " FTP dirs via multi engine (Max Depth: "
+                          << appState.ftpScanMaxDepth << ")" << std::endl;
+                appState.scanStatus = "Durchsuche FTP (Multi-Engine)...";
+                scanFtpDirectoriesMulti(remaining, filesBySize, appState.ftpScanMaxDepth);
             }
         }
     }
@@ -13897,6 +16135,10 @@ void performScan() {
         }
     }
     
+    if (appState.sshRemoteHash && appState.ftpSamplePrefilter) {
+        prefilterSftpSamples(filesBySize);
+    }
+    
     // Step 2: Calculate hashes for files with same size
     std::map<std::string, std::vector<std::string>> filesByHash;
     
@@ -13946,6 +16188,72 @@ void performScan() {
     
     // Initialize FTP bandwidth tracking for hashing phase
     appState.ftpBytesTransferred = 0;
+    ftpHashCacheHits = 0;
+    ftpHashCacheBytesSaved = 0;
+    ftpServerDigests = 0;
+    sshRemoteDigestCount = 0;
+    appState.ftpBytesSaved = 0;
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        appState.remoteHashPlan.clear();
+    }
+    
+    // Connections per server from the listing phase's measurements and the candidates' average size
+    if (!ftpServers.empty()) {
+        std::map<std::string, std::pair<long long, long long>> candidateBytes; // server -> (bytes, files)
+        for (const auto& [size, files] : filesBySize) {
+            if (files.size() <= 1) continue;
+            for (const auto& file : files) {
+                if (!isFtpFile(file)) continue;
+                auto& entry = candidateBytes[FtpHandlePool::serverKey(file)];
+                entry.first += size;
+                entry.second++;
+            }
+        }
+        std::map<std::string, long long> typicalSizes;
+        for (const auto& [server, entry] : candidateBytes) typicalSizes[server] = entry.first / entry.second;
+        applyFtpServerBudgets(ftpServers, &typicalSizes);
+    }
+    
+    // Remote hash plan: files without a possible duplicate, hashes already known, size groups
+    // whose local members are hashed as MD5 for comparison with the remote side
+    std::set<std::string> ftpNoFullHash;
+    std::map<std::string, std::string> ftpKnownHashes;
+    std::set<long long> mixedSizes;
+    std::set<std::string> ftpTransferOnly;
+    if (!ftpServers.empty()) {
+        runRemoteHashPlanner(filesBySize, ftpServers, ftpNoFullHash, ftpKnownHashes, mixedSizes, ftpTransferOnly);
+    }
+    
+    // NFS/SMB candidates: hashed as MD5 over libnfs/libsmb2 on their own thread while the pool
+    // below hashes the local files; local size peers are hashed as MD5 as well
+    std::vector<std::pair<std::string, long long>> mountlessCandidates;
+    for (const auto& [size, files] : filesBySize) {
+        if (files.size() <= 1) continue;
+        bool hasLocal = false;
+        for (const auto& file : files) {
+            if (isAsyncFsUrl(file)) mountlessCandidates.push_back({file, size});
+            else if (!isFtpFile(file)) hasLocal = true;
+        }
+        if (hasLocal && !mountlessCandidates.empty() && mountlessCandidates.back().second == size) mixedSizes.insert(size);
+    }
+    std::thread mountlessHashThread;
+    if (!mountlessCandidates.empty()) {
+        std::cout << "[Scanner] " << mountlessCandidates.size() << " NFS/SMB/SFTP/WebDAV files hashed without mount" << std::endl;
+        mountlessHashThread = std::thread([&]() {
+            hashAsyncFsFiles(mountlessCandidates, [&](const std::string& url, long long fileSize, const std::string& hash) {
+                if (!hash.empty()) {
+                    std::lock_guard<std::mutex> lock(hashMapMutex);
+                    filesByHash[hash].push_back(url);
+                }
+                hashedCount++;
+                appState.filesScanned++;
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                appState.bytesProcessed += fileSize;
+                appState.scanProgress = std::max(appState.scanProgress, 0.4f + 0.5f * ((float)hashedCount / totalToHash));
+            });
+        });
+    }
     appState.ftpScanStartTime = std::chrono::steady_clock::now();
     
     // Initialize hash speed tracking (Reset für jeden neuen Scan)
@@ -13953,6 +16261,48 @@ void performScan() {
     long long hashSpeedLastBytes = 0;
     int hashSpeedLastCount = 0;
     
+    // FTP files of candidate groups are streamed through the multi engine and hashed on its
+    // workers while the thread pool below works on the local files
+    bool ftpViaEngine = appState.ftpUseMultiEngine && !ftpServers.empty() && ensureFtpMultiEngine();
+    if (ftpViaEngine) {
+        int submitted = 0;
+        for (const auto& [size, files] : filesBySize) {
+            if (stopScan) break;
+            if (files.size() <= 1) continue;
+            for (const auto& file : files) {
+                if (!isFtpFile(file)) continue;
+                auto known = ftpKnownHashes.find(file);
+                if (ftpNoFullHash.count(file) || known != ftpKnownHashes.end()) {
+                    // Decided by the prefilter - no transfer
+                    if (known != ftpKnownHashes.end()) {
+                        std::lock_guard<std::mutex> lock(hashMapMutex);
+                        filesByHash[known->second].push_back(file);
+                    }
+                    hashedCount++;
+                    appState.filesScanned++;
+                    continue;
+                }
+                long long fileSize = size;
+                const FtpScanServer* server = findFtpScanServer(ftpServers, file);
+                if (!server) continue;
+                submitFtpHash(file, server->username, server->password, fileSize,
+                              [&, file, fileSize](const std::string& hash) {
+                    if (!hash.empty()) {
+                        std::lock_guard<std::mutex> lock(hashMapMutex);
+                        filesByHash[hash].push_back(file);
+                    }
+                    hashedCount++;
+                    appState.filesScanned++;
+                    std::lock_guard<std::mutex> lock(resultsMutex);
+                    appState.bytesProcessed += fileSize;
+                    appState.scanProgress = std::max(appState.scanProgress, 0.4f + 0.5f * ((float)hashedCount / totalToHash));
+                }, 0, !ftpTransferOnly.count(file));
+                submitted++;
+            }
+        }
+        std::cout << "[Scanner] " << submitted << " FTP files queued on the multi engine" << std::endl;
+    }
+    
     // SICHERHEIT: Process each size group in parallel - nur Dateien mit EXAKT gleicher Größe
     for (const auto& [size, files] : filesBySize) {
         if (stopScan) break;
@@ -13973,8 +16323,8 @@ void performScan() {
         // SICHERHEITSFILTER 2: Verifiziere dass alle Dateien in dieser Gruppe exakt gleiche Größe haben
         bool sizeVerified = true;
         for (const auto& file : files) {
-            // FTP-Dateien überspringen - sie haben keine lokale stat() Möglichkeit
-            if (isFtpFile(file)) {
+            // FTP/NFS/SMB-Dateien überspringen - sie haben keine lokale stat() Möglichkeit
+            if (isFtpFile(file) || isAsyncFsUrl(file)) {
                 continue; // FTP-Dateien wurden bereits beim Scan mit Größe versehen
             }
             
@@ -14008,6 +16358,16 @@ void performScan() {
         // OPTIMIZATION: Sort files ONCE before threading (not per-thread)
         // Alphanumeric sorting improves disk cache locality
         std::vector<std::string> sortedFiles = files;  // Copy needed because files is const
+        if (ftpViaEngine) {
+            // Already submitted to the multi engine
+            sortedFiles.erase(std::remove_if(sortedFiles.begin(), sortedFiles.end(), isFtpFile), sortedFiles.end());
+            if (sortedFiles.empty()) continue;
+        }
+        if (!mountlessCandidates.empty()) {
+            // Hashed by mountlessHashThread
+            sortedFiles.erase(std::remove_if(sortedFiles.begin(), sortedFiles.end(), isAsyncFsUrl), sortedFiles.end());
+            if (sortedFiles.empty()) continue;
+        }
         std::sort(sortedFiles.begin(), sortedFiles.end());
         
         std::cout << "[Scanner] Hashing " << sortedFiles.size() << " files of size " << size << " bytes (parallel, verified)" << std::endl;
@@ -14040,18 +16400,19 @@ void performScan() {
                     
                     // Check if FTP or local file
                     if (isFtpFile(file)) {
-                        // FTP file - check minimum size filter
-                        if (size < appState.ftpMinFileSize) {
-                            // OPTIMIZATION: Skip very small FTP files (overhead too high)
-                            // Mark as "skipped" by using a special hash
-                            hash = "SKIPPED_TOO_SMALL_" + std::to_string(size);
-                        } else {
-                            // FTP file - already contains full URL (ftp://host:port/path)
-                            if (appState.connectedPresetIndex >= 0 && appState.connectedPresetIndex < appState.ftpPresets.size()) {
-                                const auto& preset = appState.ftpPresets[appState.connectedPresetIndex];
-                                hash = calculateMD5FromFTP(file, preset.username, preset.password, size);
-                            }
+                        auto known = ftpKnownHashes.find(file);
+                        if (ftpNoFullHash.count(file)) {
+                            // Unique head/tail sample in its size group - cannot have a duplicate
+                        } else if (known != ftpKnownHashes.end()) {
+                            hash = known->second;
+                        } else if (const FtpScanServer* server = findFtpScanServer(ftpServers, file)) {
+                            // FTP file - already contains full URL (ftp://host:port/path), credentials per origin
+                            hash = calculateMD5FromFTP(file, server->username, server->password, size,
+                                                       !ftpTransferOnly.count(file));
                         }
+                    } else if (mixedSizes.count(size)) {
+                        // Local file with remote size peers - MD5 like the remote hashes
+                        hash = localMD5ForRemoteCompare(file);
                     } else {
                         // Local file - use selected algorithm
                         hash = calculateHash(file, appState.hashAlgorithm);
@@ -14190,6 +16551,27 @@ void performScan() {
             if (thread.joinable()) thread.join();
         }
     }
+    
+    if (ftpHashCacheHits > 0) {
+        std::cout << "[Scanner] " << ftpHashCacheHits.load() << " FTP hashes from remote hash cache ("
+                  << (ftpHashCacheBytesSaved.load() / (1024 * 1024)) << " MB not transferred)" << std::endl;
+    }
+    
+    if (mountlessHashThread.joinable()) {
+        appState.scanStatus = "Berechne NFS/SMB-Hashes (ohne Mount)...";
+        mountlessHashThread.join();
+    }
+    
+    if (ftpViaEngine) {
+        appState.scanStatus = "Berechne FTP-Hashes (Multi-Engine)...";
+        waitFtpMultiEngine();
+        FtpMultiEngine::Stats es = ftpMultiEngine.stats();
+        std::cout << "[Scanner] Multi engine: " << es.completed << " transfers, " << es.failed << " failed, "
+                  << (es.bytes / (1024 * 1024)) << " MB, " << es.pauses << " backpressure pauses" << std::endl;
+    }
+    if (ftpServerDigests > 0) {
+        std::cout << "[Scanner] " << ftpServerDigests.load() << " FTP checksums computed server-side" << std::endl;
+    }
     } // Ende Step 2: Hashing
     
     if (stopScan) {
@@ -14242,6 +16624,21 @@ void performScan() {
     // CACHE: Save file cache to disk (automatic, transparent)
     std::cout << "[Cache] Saving file cache..." << std::endl;
     saveFileCache();
+    logCacheStats();
+    
+    if (!ftpServers.empty()) {
+        auto poolStats = ftpHandlePool.stats();
+        std::cout << "[FTP Pool] " << poolStats.transfers << " transfers, "
+                  << std::fixed << std::setprecision(1) << poolStats.reuseRatio() * 100.0 << "% without reconnect, "
+                  << poolStats.handlesCreated << " handles created, " << poolStats.handlesReused << " reused, "
+                  << poolStats.healthCheckFailures << " dead connections replaced" << std::endl;
+    }
+    
+    if (appState.useDirListingCache && !appState.selectedLocalDirs.empty()) {
+        std::cout << "[DirListCache] " << dirListingCache.hits() << " directories reused without readdir, "
+                  << dirListingCache.misses() << " re-listed" << std::endl;
+        dirListingCache.save(dirListingCacheFilePath);
+    }
     
     {
         std::lock_guard<std::mutex> lock(resultsMutex);
@@ -14304,6 +16701,12 @@ int main(int argc, char* argv[]) {
     // Load settings FIRST (before anything else!)
     std::cout << "[Startup] Loading settings..." << std::endl;
     loadSettings();
+    applyCacheBudgets();
+    applyRemoteBandwidthLimit();
+    
+    // File metadata and remote hashes of earlier sessions (local_cache.dat, ftp_cache.dat).
+    // Loaded before any scan can run: loadFileCache() starts from an empty cache.
+    loadFileCache();
     
     // Auto-discover NFS mount points
     std::cout << "[Startup] Discovering NFS mount points..." << std::endl;
@@ -14322,10 +16725,13 @@ int main(int argc, char* argv[]) {
     // Init CURL Connection Pooling
     curl_global_init(CURL_GLOBAL_ALL);
     initCurlSharing();
-    
-    // Skip cache loading for now - it will be done lazily when needed
-    // This prevents GUI blocking on startup
-    std::cout << "[Startup] Cache loading deferred (lazy load)" << std::endl;
+    ftpHandlePool.setHandleSetup([](CURL* curl) {
+        if (curlShareHandle && appState.useCurlPooling) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, curlShareHandle);
+        }
+        applyOptimalCurlSettings(curl);
+    });
+    ftpMultiEngine.setHandleSetup([](CURL* curl) { applyOptimalCurlSettings(curl); });
     
     // Init GLFW
     if (!glfwInit()) {
@@ -14471,9 +16877,12 @@ int main(int argc, char* argv[]) {
     // ALWAYS create fresh config with all 45 settings after loading
     // This ensures the config file is complete even if it was created by old version
     saveScannerSettings();
+    ftpHandlePool.setMaxConnectionsPerServer(appState.ftpMaxConnections);
+    ftpHandlePool.setReuseConnections(appState.ftpReuseConnections);
     
     loadFtpPresets();
     loadSubnetPresets();  // Load subnet scan presets (NEW)
+    neighborCache.load(discoveryCachePath());  // Port-scan results of earlier sessions
     loadSearchHistory(); // Lade Such-History
     applyTheme(appState.currentTheme);
 
@@ -14731,6 +17140,12 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Let a pending background snapshot save finish
+    if (snapshotWriter.busy()) {
+        std::cout << "[Cleanup] Waiting for scan snapshot save..." << std::endl;
+    }
+    snapshotWriter.wait();
+    
     // Unmount WebDAV shares if configured
     std::cout << "[Cleanup] Unmounting WebDAV shares..." << std::endl;
     for (auto& preset : appState.ftpPresets) {
@@ -14756,19 +17171,17 @@ int main(int argc, char* argv[]) {
     if (scanThread.joinable()) {
         scanThread.join();
     }
+    // Event threads that write discoveredHosts and the neighbour cache
+    neighborCache.stop();
+    serviceBrowser.stop();
     
     // Clear all caches
-    {
-        std::lock_guard<std::mutex> lock(hashCacheMutex);
-        hashCache.clear();
-        std::cout << "[Cleanup] Hash cache cleared" << std::endl;
-    }
+    hashCache.clear();
+    std::cout << "[Cleanup] Hash cache cleared" << std::endl;
     
-    {
-        std::lock_guard<std::mutex> lock(fileCacheMutex);
-        fileCache.clear();
-        std::cout << "[Cleanup] File cache cleared" << std::endl;
-    }
+    fileCache.clear();
+    statCache.clear();
+    std::cout << "[Cleanup] File cache cleared" << std::endl;
     
     // Clear all AppState data structures
     {
@@ -14786,6 +17199,8 @@ int main(int argc, char* argv[]) {
     }
     
     // Cleanup CURL
+    ftpMultiEngine.stop();
+    ftpHandlePool.clear();
     cleanupCurlSharing();
     curl_global_cleanup();
     
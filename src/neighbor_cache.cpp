@@ -0,0 +1,312 @@
+#include "neighbor_cache.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+
+static const uint16_t NUD_ALIVE = NUD_REACHABLE | NUD_STALE | NUD_DELAY | NUD_PROBE | NUD_PERMANENT;
+
+static uint32_t parseAddress(const std::string& ip) {
+    struct in_addr in;
+    if (inet_pton(AF_INET, ip.c_str(), &in) != 1) return 0;
+    return ntohl(in.s_addr);
+}
+
+static std::string addressText(uint32_t address) {
+    struct in_addr in;
+    in.s_addr = htonl(address);
+    char buffer[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &in, buffer, sizeof(buffer));
+    return buffer;
+}
+
+NeighborDiscoveryCache::~NeighborDiscoveryCache() {
+    stop();
+}
+
+bool NeighborDiscoveryCache::start() {
+    std::lock_guard<std::mutex> lifecycle(m_lifecycleMutex);
+    if (m_running) return true;
+    m_socket = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (m_socket < 0) {
+        std::cerr << "[Neighbors] rtnetlink unavailable: " << strerror(errno) << std::endl;
+        return false;
+    }
+    int buffer = 1 << 20;
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    struct sockaddr_nl local = {};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_NEIGH;
+    if (bind(m_socket, (struct sockaddr*)&local, sizeof(local)) != 0 || !requestDump()) {
+        std::cerr << "[Neighbors] rtnetlink subscribe failed: " << strerror(errno) << std::endl;
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    // Initial table: read the dump before callers ask for neighbours (events in between are applied too)
+    char data[65536];
+    while (true) {
+        struct pollfd pfd = {m_socket, POLLIN, 0};
+        if (poll(&pfd, 1, 2000) <= 0) break;
+        ssize_t n = recv(m_socket, data, sizeof(data), 0);
+        if (n <= 0 || !handleMessages(data, (size_t)n)) break;
+    }
+
+    m_stopping = false;
+    m_running = true;
+    m_thread = std::thread([this]() { eventLoop(); });
+    std::cout << "[Neighbors] Following rtnetlink neighbour events (" << neighbors().size() << " neighbours)" << std::endl;
+    return true;
+}
+
+void NeighborDiscoveryCache::stop() {
+    std::lock_guard<std::mutex> lifecycle(m_lifecycleMutex);
+    if (!m_running) return;
+    m_stopping = true;
+    if (m_thread.joinable()) m_thread.join();
+    close(m_socket);
+    m_socket = -1;
+    m_running = false;
+}
+
+bool NeighborDiscoveryCache::requestDump() {
+    struct {
+        struct nlmsghdr header;
+        struct ndmsg body;
+    } request = {};
+    request.header.nlmsg_len = sizeof(request);
+    request.header.nlmsg_type = RTM_GETNEIGH;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = ++m_dumpSeq;
+    request.body.ndm_family = AF_INET;
+    beginDump();
+    struct sockaddr_nl kernel = {};
+    kernel.nl_family = AF_NETLINK;
+    return sendto(m_socket, &request, sizeof(request), 0, (struct sockaddr*)&kernel, sizeof(kernel)) == (ssize_t)sizeof(request);
+}
+
+void NeighborDiscoveryCache::eventLoop() {
+    char data[65536];
+    while (!m_stopping) {
+        struct pollfd pfd = {m_socket, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        ssize_t n = recv(m_socket, data, sizeof(data), MSG_DONTWAIT);
+        if (n < 0) {
+            // Events were dropped (busy network, small buffer): resynchronise with a fresh dump
+            if (errno == ENOBUFS) requestDump();
+            continue;
+        }
+        handleMessages(data, (size_t)n);
+    }
+}
+
+bool NeighborDiscoveryCache::handleMessages(const void* data, size_t length) {
+    int remaining = (int)length;
+    for (auto* header = (const struct nlmsghdr*)data; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+        if (header->nlmsg_type == NLMSG_DONE || header->nlmsg_type == NLMSG_ERROR) {
+            finishDump(header->nlmsg_type == NLMSG_DONE);
+            return false;
+        }
+        if (header->nlmsg_type != RTM_NEWNEIGH && header->nlmsg_type != RTM_DELNEIGH) continue;
+        if (header->nlmsg_len < NLMSG_LENGTH(sizeof(struct ndmsg))) continue;
+        auto* body = (const struct ndmsg*)NLMSG_DATA(header);
+        if (body->ndm_family != AF_INET) continue;
+
+        NeighborEntry entry;
+        entry.ifindex = body->ndm_ifindex;
+        entry.state = body->ndm_state;
+        entry.lastChange = time(nullptr);
+        uint32_t address = 0;
+        int attributeLength = (int)header->nlmsg_len - (int)NLMSG_LENGTH(sizeof(struct ndmsg));
+        for (auto* attribute = (const struct rtattr*)((const char*)body + NLMSG_ALIGN(sizeof(struct ndmsg)));
+             RTA_OK(attribute, attributeLength); attribute = RTA_NEXT(attribute, attributeLength)) {
+            const uint8_t* value = (const uint8_t*)RTA_DATA(attribute);
+            if (attribute->rta_type == NDA_DST && RTA_PAYLOAD(attribute) == 4) {
+                memcpy(&address, value, 4);
+                address = ntohl(address);
+            } else if (attribute->rta_type == NDA_LLADDR && RTA_PAYLOAD(attribute) == 6) {
+                char mac[18];
+                snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x", value[0], value[1], value[2], value[3], value[4], value[5]);
+                entry.mac = mac;
+            }
+        }
+        if (address == 0) continue;
+        entry.ip = addressText(address);
+        applyNeighbor(entry, header->nlmsg_type == RTM_DELNEIGH || !(entry.state & NUD_ALIVE));
+    }
+    return true;
+}
+
+void NeighborDiscoveryCache::applyNeighbor(const NeighborEntry& entry, bool removed) {
+    std::function<void(const NeighborEntry&, bool)> callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint32_t address = parseAddress(entry.ip);
+        if (m_dumpActive) {
+            if (removed) m_dumpSeen.erase(address);
+            else m_dumpSeen.insert(address);
+        }
+        auto it = m_neighbors.find(address);
+        if (removed) {
+            if (it == m_neighbors.end()) return;
+            m_neighbors.erase(it);
+        } else if (it == m_neighbors.end() || (!entry.mac.empty() && it->second.mac != entry.mac)) {
+            m_neighbors[address] = entry;
+        } else {
+            // REACHABLE <-> STALE flapping is no change worth a probe
+            it->second.state = entry.state;
+            it->second.ifindex = entry.ifindex;
+            return;
+        }
+        m_generation++;
+        callback = m_changeCallback;
+    }
+    if (callback) callback(entry, removed);
+}
+
+void NeighborDiscoveryCache::beginDump() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_dumpActive = true;
+    m_dumpSeen.clear();
+}
+
+void NeighborDiscoveryCache::finishDump(bool complete) {
+    std::vector<NeighborEntry> gone;
+    std::function<void(const NeighborEntry&, bool)> callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dumpActive) return;
+        m_dumpActive = false;
+        // A failed dump says nothing about missing entries
+        if (complete) {
+            for (auto it = m_neighbors.begin(); it != m_neighbors.end();) {
+                if (m_dumpSeen.count(it->first)) {
+                    ++it;
+                    continue;
+                }
+                gone.push_back(it->second);
+                it = m_neighbors.erase(it);
+                m_generation++;
+            }
+        }
+        m_dumpSeen.clear();
+        callback = m_changeCallback;
+    }
+    if (!gone.empty()) {
+        std::cout << "[Neighbors] Resync dropped " << gone.size() << " stale neighbours" << std::endl;
+    }
+    if (callback) {
+        for (const auto& entry : gone) callback(entry, true);
+    }
+}
+
+void NeighborDiscoveryCache::setChangeCallback(std::function<void(const NeighborEntry&, bool removed)> callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changeCallback = std::move(callback);
+}
+
+std::vector<NeighborEntry> NeighborDiscoveryCache::neighbors(uint32_t first, uint32_t last) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<NeighborEntry> result;
+    for (auto it = m_neighbors.lower_bound(first); it != m_neighbors.end() && it->first <= last; ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+std::vector<std::string> NeighborDiscoveryCache::hostsToProbe(const std::vector<std::string>& candidates, int ttlSeconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    time_t now = time(nullptr);
+    std::vector<std::string> result;
+    for (const auto& ip : candidates) {
+        uint32_t address = parseAddress(ip);
+        auto service = m_services.find(address);
+        if (service == m_services.end() || now - service->second.probedAt >= ttlSeconds) {
+            result.push_back(ip);
+            continue;
+        }
+        auto neighbor = m_neighbors.find(address);
+        if (neighbor != m_neighbors.end() && !neighbor->second.mac.empty() && !service->second.mac.empty() &&
+            neighbor->second.mac != service->second.mac) {
+            result.push_back(ip);   // Another device took the address
+        }
+    }
+    return result;
+}
+
+std::vector<HostServices> NeighborDiscoveryCache::cachedServices(uint32_t first, uint32_t last, int ttlSeconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    time_t now = time(nullptr);
+    std::vector<HostServices> result;
+    for (auto it = m_services.lower_bound(first); it != m_services.end() && it->first <= last; ++it) {
+        if (now - it->second.probedAt < ttlSeconds) result.push_back(it->second);
+    }
+    return result;
+}
+
+void NeighborDiscoveryCache::recordServices(const std::string& ip, const std::vector<int>& openPorts, time_t probedAt) {
+    uint32_t address = parseAddress(ip);
+    if (address == 0) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    HostServices& services = m_services[address];
+    services.ip = ip;
+    services.openPorts = openPorts;
+    services.probedAt = probedAt ? probedAt : time(nullptr);
+    auto neighbor = m_neighbors.find(address);
+    services.mac = neighbor != m_neighbors.end() ? neighbor->second.mac : std::string();
+}
+
+void NeighborDiscoveryCache::clearServices() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_services.clear();
+}
+
+bool NeighborDiscoveryCache::save(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ofstream file(filename + ".tmp");
+    if (!file) return false;
+    file << "DISCOVERYCACHE_V1\n";
+    for (const auto& [address, services] : m_services) {
+        file << services.ip << ' ' << (services.mac.empty() ? "-" : services.mac) << ' ' << services.probedAt << ' ';
+        if (services.openPorts.empty()) file << '-';
+        for (size_t i = 0; i < services.openPorts.size(); i++) file << (i ? "," : "") << services.openPorts[i];
+        file << '\n';
+    }
+    file.close();
+    return file && rename((filename + ".tmp").c_str(), filename.c_str()) == 0;
+}
+
+bool NeighborDiscoveryCache::load(const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != "DISCOVERYCACHE_V1") return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        HostServices services;
+        std::string ports;
+        if (!(fields >> services.ip >> services.mac >> services.probedAt >> ports)) continue;
+        uint32_t address = parseAddress(services.ip);
+        if (address == 0) continue;
+        if (services.mac == "-") services.mac.clear();
+        if (ports != "-") {
+            std::istringstream portList(ports);
+            std::string port;
+            while (std::getline(portList, port, ',')) {
+                if (!port.empty()) services.openPorts.push_back(std::atoi(port.c_str()));
+            }
+        }
+        m_services[address] = services;
+    }
+    return true;
+}
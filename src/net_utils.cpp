@@ -1,9 +1,9 @@
 #include "net_utils.h"
+#include "host_discovery.h"
+#include <algorithm>
 #include <arpa/inet.h>
 #include <sstream>
 #include <vector>
-#include <future>
-#include <mutex>
 #include <ifaddrs.h>
 #include <net/if.h>
 
@@ -83,53 +83,35 @@ std::string normalizeSubnet(const std::string& subnet) {
     return normalized;
 }
 
-// Ping a single host via system 'ping -c 1 -W <sec>' (returns true if reachable)
+// Ping a single host in-process (ICMP echo, ARP when on-link) - returns true if reachable
 bool pingHost(const std::string &ip, int timeoutSeconds) {
-    std::string cmd = "ping -c 1 -W " + std::to_string(timeoutSeconds) + " -n " + ip + " >/dev/null 2>&1";
-    int res = system(cmd.c_str());
-    return (res == 0);
+    return icmpPing(ip, std::max(1, timeoutSeconds) * 1000);
 }
 
+// One batched sweep over the whole range instead of a ping process per address
 void pingHostRange(const std::string &startIpStr, const std::string &endIpStr, int timeoutSeconds, std::vector<std::string> *results) {
     auto ip2int = [](const std::string &ip) -> uint32_t {
         struct in_addr addr;
         if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) return 0;
         return ntohl(addr.s_addr);
     };
-    auto int2ip = [](uint32_t v) -> std::string {
-        struct in_addr s; s.s_addr = htonl(v);
-        char buf[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &s, buf, sizeof(buf));
-        return std::string(buf);
-    };
 
     uint32_t start = ip2int(startIpStr);
     uint32_t end = ip2int(endIpStr);
     if (start == 0 || end == 0 || end < start) return;
 
-    const int BATCH_SIZE = 100;
-    // Local mutex for protecting results vector within this function
-    std::mutex resultsMutex;
-    std::vector<std::future<bool>> futures;
-    uint32_t ipCounter = start;
-    for (uint32_t ip = start; ip <= end; ++ip) {
-        std::string ipStr = int2ip(ip);
-        futures.push_back(std::async(std::launch::async, [ipStr, timeoutSeconds]() {
-            return pingHost(ipStr, timeoutSeconds);
-        }));
-
-        if ((int)futures.size() >= BATCH_SIZE || ip == end) {
-            uint32_t cur = ip - (futures.size()-1);
-            for (auto &f : futures) {
-                bool ok = f.get();
-                if (ok) {
-                        std::lock_guard<std::mutex> lock(resultsMutex);
-                        results->push_back(int2ip(cur));
-                    }
-                cur++;
-            }
-            futures.clear();
-        }
+    HostSweepOptions options;
+    options.timeoutMs = std::max(1, timeoutSeconds) * 1000;
+    std::vector<uint32_t> alive;
+    sweepHostRange(start, end, options, [&](const SweepHost &host) {
+        alive.push_back(ip2int(host.ip));
+    });
+    std::sort(alive.begin(), alive.end());
+    for (uint32_t ip : alive) {
+        struct in_addr s; s.s_addr = htonl(ip);
+        char buf[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &s, buf, sizeof(buf));
+        results->push_back(buf);
     }
 }
 
@@ -1,14 +1,9 @@
 #include "networkscanner.h"
+#include "host_discovery.h"
 #include <iostream>
-#include <cstdlib>
-#include <fstream>
-#include <sstream>
-#include <thread>
 #include <vector>
 #include <algorithm>
 #include <sys/types.h>
-#include <signal.h>
-#include <sys/wait.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -24,145 +19,32 @@ NetworkScanner::NetworkScanner() {
 NetworkScanner::~NetworkScanner() {
 }
 
-// Scan single IP with timeout
+// Scan single IP with timeout (seconds) - ICMP echo in-process, ARP when on-link
 bool NetworkScanner::pingHost(const std::string& ip, int timeout) {
-    std::string cmd = "ping -c 1 -W " + std::to_string(timeout) + " " + ip + " > /dev/null 2>&1";
-    int result = system(cmd.c_str());
-    return (result == 0);
+    return icmpPing(ip, std::max(1, timeout) * 1000);
 }
 
 // Scan network subnet (e.g., "192.168.1.0/24")
 std::vector<std::string> NetworkScanner::scanSubnet(const std::string& subnet) {
-    std::cout << "[NetworkScanner] Scanning subnet: " << subnet << std::endl;
-    
-    std::vector<std::string> hosts;
-    
-    // Try nmap first (fast)
-    std::string nmapCmd = "timeout 10 nmap -sn " + subnet + 
-                         " 2>/dev/null | grep 'Nmap scan report' | awk '{print $5}' > /tmp/fileduper_scan.txt";
-    system(nmapCmd.c_str());
-    
-    std::ifstream scanFile("/tmp/fileduper_scan.txt");
-    if (scanFile.is_open()) {
-        std::string line;
-        while (std::getline(scanFile, line)) {
-            if (!line.empty() && line != "()" && line.find('.') != std::string::npos) {
-                hosts.push_back(line);
-                std::cout << "[NetworkScanner]   Found: " << line << std::endl;
-            }
-        }
-        scanFile.close();
-    }
-    
-    // Fallback to ARP if nmap found nothing
-    if (hosts.empty()) {
-        std::cout << "[NetworkScanner] Using ARP fallback..." << std::endl;
-        system("arp -a | grep -oE '([0-9]{1,3}\\.){3}[0-9]{1,3}' > /tmp/fileduper_arp.txt");
-        
-        std::ifstream arpFile("/tmp/fileduper_arp.txt");
-        if (arpFile.is_open()) {
-            std::string line;
-            while (std::getline(arpFile, line)) {
-                if (!line.empty()) {
-                    hosts.push_back(line);
-                    std::cout << "[NetworkScanner]   Found (ARP): " << line << std::endl;
-                }
-            }
-            arpFile.close();
-        }
-    }
-    
-    // Remove duplicates and sort
-    std::sort(hosts.begin(), hosts.end());
-    hosts.erase(std::unique(hosts.begin(), hosts.end()), hosts.end());
-    
-    std::cout << "[NetworkScanner] Scan complete: " << hosts.size() << " hosts found" << std::endl;
-    return hosts;
+    return scanSubnetCancelable(subnet, nullptr);
 }
 
+// One batched ICMP/ARP sweep (host_discovery); cancel stops it between batches
 std::vector<std::string> NetworkScanner::scanSubnetCancelable(const std::string& subnet, std::atomic<bool>* cancel) {
-    std::cout << "[NetworkScanner] Cancelable Scanning subnet: " << subnet << std::endl;
-
-    std::vector<std::string> hosts;
-
-    // Use fork/exec so we can kill the child process if cancel is requested
-    int pipefd[2];
-    if (pipe(pipefd) != 0) {
-        return hosts;
-    }
-
-    pid_t pid = fork();
-    if (pid == 0) {
-        // child
-        dup2(pipefd[1], STDOUT_FILENO);
-        close(pipefd[0]);
-        close(pipefd[1]);
-        std::string cmd = "nmap -sn " + subnet + " 2>/dev/null | grep 'Nmap scan report' | awk '{print $5}'";
-        execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)NULL);
-        _exit(127);
-    }
-
-    // parent
-    close(pipefd[1]);
-
-    FILE *f = fdopen(pipefd[0], "r");
-    if (!f) {
-        close(pipefd[0]);
-        return hosts;
-    }
-
-    char buf[512];
-    while (fgets(buf, sizeof(buf), f)) {
-        if (cancel && cancel->load()) {
-            // kill child
-            kill(pid, SIGTERM);
-            break;
-        }
-        std::string line(buf);
-        // strip newline
-        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
-        if (!line.empty() && line.find('.') != std::string::npos) {
-            hosts.push_back(line);
-            std::cout << "[NetworkScanner]   Found: " << line << std::endl;
-        }
-    }
+    std::cout << "[NetworkScanner] Scanning subnet: " << subnet << std::endl;
 
-    fclose(f);
-
-    // wait for child
-    int status = 0;
-    waitpid(pid, &status, 0);
-
-    // Fallback to ARP if nothing and not canceled
-    if (!cancel || !cancel->load()) {
-        if (hosts.empty()) {
-            std::cout << "[NetworkScanner] Using ARP fallback..." << std::endl;
-            system("arp -a | grep -oE '([0-9]{1,3}\\.){3}[0-9]{1,3}' > /tmp/fileduper_arp.txt");
-            std::ifstream arpFile("/tmp/fileduper_arp.txt");
-            if (arpFile.is_open()) {
-                std::string line;
-                while (std::getline(arpFile, line)) {
-                    if (!line.empty()) {
-                        hosts.push_back(line);
-                        std::cout << "[NetworkScanner]   Found (ARP): " << line << std::endl;
-                    }
-                }
-                arpFile.close();
-            }
-        }
+    std::vector<std::string> hosts = sweepSubnet(subnet, HostSweepOptions(), cancel);
+    for (const auto& host : hosts) {
+        std::cout << "[NetworkScanner]   Found: " << host << std::endl;
     }
 
-    std::sort(hosts.begin(), hosts.end());
-    hosts.erase(std::unique(hosts.begin(), hosts.end()), hosts.end());
-    std::cout << "[NetworkScanner] Cancelable scan complete: " << hosts.size() << " hosts found" << std::endl;
+    std::cout << "[NetworkScanner] Scan complete: " << hosts.size() << " hosts found" << std::endl;
     return hosts;
 }
 
 // Probe FTP port on host
 bool NetworkScanner::probeFtpPort(const std::string& ip, int port) {
-    std::string cmd = "timeout 2 nc -z -w 1 " + ip + " " + std::to_string(port) + " 2>/dev/null";
-    int result = system(cmd.c_str());
-    return (result == 0);
+    return probePort(ip, port, 2000);
 }
 
 bool NetworkScanner::probePort(const std::string &ip, int port, int timeoutMs, std::atomic<bool> *cancel) {
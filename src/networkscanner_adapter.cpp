@@ -1,5 +1,8 @@
 #include "networkscanner_adapter.h"
 #include "networkscanner.h"
+#ifndef _WIN32
+#include "port_scanner.h"
+#endif
 #include <thread>
 #include <chrono>
 
@@ -34,6 +37,24 @@ void NetworkScannerAdapter::startScan() {
     m_worker = new std::thread([this]() {
         auto hosts = m_backend->scanSubnetCancelable(m_ipRange.empty() ? "192.168.1.0/24" : m_ipRange, &m_stop);
         int total = (int)hosts.size();
+#ifndef _WIN32
+        // All hosts at once on the epoll scanner; results arrive as hosts finish
+        PortScanOptions options;
+        options.ports = {21};
+        options.timeoutMs = 2000;
+        int processed = 0;
+        massPortScan(hosts, options, [&](const PortScanHostResult &host) {
+            if (m_progressCb) m_progressCb(++processed, total);
+            if (host.openPorts.empty()) return;
+            NetworkServiceCore s;
+            s.ip = host.ip;
+            s.port = 21;
+            s.service = "FTP";
+            s.serviceName = "FTP";
+            s.status = "Online";
+            if (m_serviceFoundCb) m_serviceFoundCb(s);
+        }, nullptr, &m_stop);
+#else
         for (int i = 0; i < total; ++i) {
             const std::string &ip = hosts[i];
             if (m_stop) break;
@@ -51,6 +72,7 @@ void NetworkScannerAdapter::startScan() {
             // small sleep to avoid hammering network
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+#endif
 
         if (m_scanFinishedCb) m_scanFinishedCb();
     });
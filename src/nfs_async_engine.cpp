@@ -0,0 +1,393 @@
+#include "nfs_async_engine.h"
+#include <openssl/md5.h>
+#include <algorithm>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#ifdef HAVE_LIBNFS
+#include <nfsc/libnfs.h>
+#endif
+
+bool isNfsUrl(const std::string& path) {
+    return path.compare(0, 6, "nfs://") == 0;
+}
+
+std::string nfsUrl(const std::string& server, const std::string& path) {
+    if (path.empty() || path.front() != '/') return "nfs://" + server + "/" + path;
+    return "nfs://" + server + path;
+}
+
+bool parseNfsUrl(const std::string& url, std::string& server, std::string& path) {
+    if (!isNfsUrl(url)) return false;
+    size_t slash = url.find('/', 6);
+    server = url.substr(6, slash == std::string::npos ? std::string::npos : slash - 6);
+    path = slash == std::string::npos ? "/" : url.substr(slash);
+    return !server.empty();
+}
+
+static std::string joinNfsPath(const std::string& dir, const std::string& name) {
+    if (!dir.empty() && dir.back() == '/') return dir + name;
+    return dir + "/" + name;
+}
+
+static std::string md5Hex(MD5_CTX& ctx) {
+    unsigned char digest[MD5_DIGEST_LENGTH];
+    MD5_Final(digest, &ctx);
+    char hex[MD5_DIGEST_LENGTH * 2 + 1];
+    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    return hex;
+}
+
+NfsAsyncEngine::NfsAsyncEngine(NfsBackend& backend, int maxOutstanding, size_t readChunk, int readAhead)
+    : m_backend(backend), m_maxOutstanding(std::max(1, maxOutstanding)),
+      m_readChunk(std::max<size_t>(4096, readChunk)), m_readAhead(std::max(1, readAhead)) {}
+
+void NfsAsyncEngine::noteSent() {
+    m_outstanding++;
+    m_stats.maxOutstanding = std::max(m_stats.maxOutstanding, m_outstanding);
+}
+
+bool NfsAsyncEngine::walk(const std::string& root, int maxDepth, const std::function<void(const FileInfo&)>& onFile,
+                          const std::atomic<bool>* stop, const std::function<void(const std::string&)>& onDir) {
+    struct Dir {
+        std::string path;
+        int depth;
+    };
+    std::deque<Dir> queue;
+    queue.push_back({root.empty() ? "/" : root, 0});
+
+    while (true) {
+        bool stopped = stop && *stop;
+        while (!stopped && m_outstanding < m_maxOutstanding && !queue.empty()) {
+            Dir dir = std::move(queue.front());
+            queue.pop_front();
+            noteSent();
+            m_stats.readdirs++;
+            bool sent = m_backend.readdirplus(dir.path, [this, dir, maxDepth, &queue, &onFile, &onDir](int status, std::vector<NfsDirEntry>&& entries) {
+                m_outstanding--;
+                if (status < 0) {
+                    m_stats.errors++;
+                    return;
+                }
+                for (const auto& entry : entries) {
+                    if (entry.name == "." || entry.name == "..") continue;
+                    std::string path = joinNfsPath(dir.path, entry.name);
+                    if (entry.isDir) {
+                        if (onDir) onDir(path);
+                        if (dir.depth < maxDepth) queue.push_back({path, dir.depth + 1});
+                    } else if (entry.isFile) {
+                        onFile({path, entry.size, entry.mtime, entry.inode, entry.md5});
+                    }
+                }
+            });
+            if (!sent) {
+                m_outstanding--;
+                m_stats.errors++;
+            }
+        }
+        if (m_outstanding == 0 && (queue.empty() || stopped)) return true;
+        if (!m_backend.service(100)) {
+            m_outstanding = 0;
+            return false;
+        }
+    }
+}
+
+bool NfsAsyncEngine::hashFiles(const std::vector<FileInfo>& files,
+                               const std::function<void(const FileInfo&, const std::string&)>& done,
+                               const std::atomic<bool>* stop) {
+    struct Job {
+        const FileInfo* file = nullptr;
+        void* handle = nullptr;
+        bool open = false;
+        bool failed = false;
+        bool finished = false;
+        uint64_t nextRead = 0;            // Next offset to request
+        uint64_t hashed = 0;              // Bytes fed into the MD5, in order
+        int inFlight = 0;                 // Open or preads outstanding
+        MD5_CTX md5;
+        std::map<uint64_t, std::string> early;   // Replies that overtook an earlier one
+    };
+    std::vector<Job> jobs(files.size());
+    std::vector<Job*> active;
+    size_t nextFile = 0;
+    const size_t maxFiles = std::max(1, m_maxOutstanding / m_readAhead);
+
+    auto finish = [&](Job& job, bool connectionAlive) {
+        job.finished = true;
+        if (job.handle && connectionAlive) m_backend.close(job.handle);
+        job.handle = nullptr;
+        done(*job.file, job.failed ? std::string() : md5Hex(job.md5));
+    };
+    auto maybeFinish = [&](Job& job) {
+        if (job.finished || job.inFlight > 0) return;
+        if (job.failed || (job.open && job.hashed >= job.file->size)) finish(job, true);
+    };
+
+    std::function<void(Job*, uint64_t, size_t)> sendRead = [&](Job* job, uint64_t offset, size_t count) {
+        job->inFlight++;
+        noteSent();
+        m_stats.reads++;
+        bool sent = m_backend.pread(job->handle, offset, count, [&, job, offset, count](int status, const char* data, size_t len) {
+            m_outstanding--;
+            job->inFlight--;
+            if (status < 0 || (len == 0 && count > 0)) {
+                // Error, or the file shrank since it was listed
+                if (!job->failed) m_stats.errors++;
+                job->failed = true;
+            } else if (!job->failed) {
+                len = std::min(len, count);
+                m_stats.bytes += len;
+                if (len < count) sendRead(job, offset + len, count - len);   // Short read: ask for the rest
+                if (offset == job->hashed) {
+                    MD5_Update(&job->md5, data, len);
+                    job->hashed += len;
+                    for (auto it = job->early.begin(); it != job->early.end() && it->first == job->hashed; it = job->early.erase(it)) {
+                        MD5_Update(&job->md5, it->second.data(), it->second.size());
+                        job->hashed += it->second.size();
+                    }
+                } else {
+                    job->early.emplace(offset, std::string(data, len));
+                }
+            }
+            maybeFinish(*job);
+        });
+        if (!sent) {
+            m_outstanding--;
+            job->inFlight--;
+            job->failed = true;
+            m_stats.errors++;
+        }
+    };
+
+    bool alive = true;
+    while (alive) {
+        bool stopped = stop && *stop;
+        active.erase(std::remove_if(active.begin(), active.end(), [](Job* job) { return job->finished; }), active.end());
+
+        if (stopped) {
+            for (Job* job : active) job->failed = true;
+        } else {
+            // Open more files while there is room, then fill the window with preads
+            while (m_outstanding < m_maxOutstanding && active.size() < maxFiles && nextFile < files.size()) {
+                Job* job = &jobs[nextFile];
+                job->file = &files[nextFile++];
+                MD5_Init(&job->md5);
+                active.push_back(job);
+                job->inFlight++;
+                noteSent();
+                m_stats.opens++;
+                bool sent = m_backend.open(job->file->path, [&, job](int status, void* handle) {
+                    m_outstanding--;
+                    job->inFlight--;
+                    if (status < 0) {
+                        job->failed = true;
+                        m_stats.errors++;
+                    } else {
+                        job->handle = handle;
+                        job->open = true;
+                    }
+                    maybeFinish(*job);
+                });
+                if (!sent) {
+                    m_outstanding--;
+                    job->inFlight--;
+                    job->failed = true;
+                    m_stats.errors++;
+                    maybeFinish(*job);
+                }
+            }
+            bool sentAny = true;
+            while (sentAny && m_outstanding < m_maxOutstanding) {
+                sentAny = false;
+                for (Job* job : active) {
+                    if (m_outstanding >= m_maxOutstanding) break;
+                    if (!job->open || job->failed || job->finished) continue;
+                    if (job->inFlight >= m_readAhead || job->nextRead >= job->file->size) continue;
+                    size_t count = (size_t)std::min<uint64_t>(m_readChunk, job->file->size - job->nextRead);
+                    uint64_t offset = job->nextRead;
+                    job->nextRead += count;
+                    sendRead(job, offset, count);
+                    sentAny = true;
+                }
+            }
+        }
+        for (Job* job : active) maybeFinish(*job);
+
+        bool idle = m_outstanding == 0 &&
+                    std::all_of(active.begin(), active.end(), [](Job* job) { return job->finished; });
+        if (idle && (stopped || nextFile >= files.size())) break;
+        if (m_outstanding > 0) alive = m_backend.service(100);
+    }
+
+    if (!alive) {
+        // Connection gone: nothing will answer any more
+        m_outstanding = 0;
+        for (Job* job : active) {
+            if (job->finished) continue;
+            job->failed = true;
+            finish(*job, false);
+        }
+    }
+    return alive;
+}
+
+#ifdef HAVE_LIBNFS
+namespace {
+
+// One libnfs context = one TCP connection with any number of RPCs in flight.
+// nfs_opendir_async() reads the directory with READDIRPLUS (attributes included).
+class LibnfsBackend : public NfsBackend {
+public:
+    explicit LibnfsBackend(nfs_context* nfs) : m_nfs(nfs) {}
+    ~LibnfsBackend() override {
+        // nfs_destroy_context() cancels what is still in flight; the engine's callbacks are gone by now
+        m_closing = true;
+        nfs_destroy_context(m_nfs);
+    }
+
+    bool readdirplus(const std::string& path, DirCallback cb) override {
+        auto* request = new Request<DirCallback>{this, std::move(cb), {}};
+        if (nfs_opendir_async(m_nfs, path.c_str(), &LibnfsBackend::onDir, request) != 0) {
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    bool open(const std::string& path, OpenCallback cb) override {
+        auto* request = new Request<OpenCallback>{this, std::move(cb), {}};
+        if (nfs_open_async(m_nfs, path.c_str(), O_RDONLY, &LibnfsBackend::onOpen, request) != 0) {
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    bool pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) override {
+        auto* request = new Request<ReadCallback>{this, std::move(cb), {}};
+#ifdef LIBNFS_API_V2
+        request->buffer.resize(count);
+        int rc = nfs_pread_async(m_nfs, (struct nfsfh*)handle, request->buffer.data(), count, offset,
+                                 &LibnfsBackend::onRead, request);
+#else
+        int rc = nfs_pread_async(m_nfs, (struct nfsfh*)handle, offset, count, &LibnfsBackend::onRead, request);
+#endif
+        if (rc != 0) {
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    void close(void* handle) override {
+        nfs_close_async(m_nfs, (struct nfsfh*)handle, &LibnfsBackend::onClose, nullptr);
+    }
+
+    bool service(int timeoutMs) override {
+        struct pollfd pfd;
+        pfd.fd = nfs_get_fd(m_nfs);
+        pfd.events = nfs_which_events(m_nfs);
+        pfd.revents = 0;
+        int rc = poll(&pfd, 1, timeoutMs);
+        if (rc < 0 && errno != EINTR) return false;
+        return nfs_service(m_nfs, rc > 0 ? pfd.revents : 0) >= 0;
+    }
+
+    bool unlink(const std::string& path, std::string& error) override {
+        if (nfs_unlink(m_nfs, path.c_str()) == 0) return true;
+        error = nfs_get_error(m_nfs);
+        return false;
+    }
+
+    std::string lastError() const override {
+        const char* error = nfs_get_error(m_nfs);
+        return error ? error : "";
+    }
+
+private:
+    template <typename Callback>
+    struct Request {
+        LibnfsBackend* owner;
+        Callback cb;
+        std::vector<char> buffer;         // pread target (API v2)
+    };
+
+    static void onDir(int status, struct nfs_context* nfs, void* data, void* privateData) {
+        std::unique_ptr<Request<DirCallback>> request((Request<DirCallback>*)privateData);
+        if (request->owner->m_closing) return;
+        std::vector<NfsDirEntry> entries;
+        if (status >= 0) {
+            struct nfsdir* dir = (struct nfsdir*)data;
+            struct nfsdirent* entry;
+            while ((entry = nfs_readdir(nfs, dir)) != nullptr) {
+                NfsDirEntry out;
+                out.name = entry->name;
+                out.isDir = S_ISDIR(entry->mode);
+                out.isFile = S_ISREG(entry->mode);
+                out.size = entry->size;
+                out.mtime = entry->mtime.tv_sec;
+                out.inode = entry->inode;
+                entries.push_back(std::move(out));
+            }
+            nfs_closedir(nfs, dir);
+        }
+        request->cb(status, std::move(entries));
+    }
+
+    static void onOpen(int status, struct nfs_context*, void* data, void* privateData) {
+        std::unique_ptr<Request<OpenCallback>> request((Request<OpenCallback>*)privateData);
+        if (request->owner->m_closing) return;
+        request->cb(status, status >= 0 ? data : nullptr);
+    }
+
+    static void onRead(int status, struct nfs_context*, void* data, void* privateData) {
+        std::unique_ptr<Request<ReadCallback>> request((Request<ReadCallback>*)privateData);
+        if (request->owner->m_closing) return;
+        // status = bytes read; data = our buffer (API v2) or libnfs' own
+        if (status < 0) request->cb(status, nullptr, 0);
+        else request->cb(status, (const char*)data, (size_t)status);
+    }
+
+    static void onClose(int, struct nfs_context*, void*, void*) {}
+
+    nfs_context* m_nfs;
+    bool m_closing = false;
+};
+
+} // namespace
+#endif
+
+bool isLibnfsAvailable() {
+#ifdef HAVE_LIBNFS
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<NfsBackend> createLibnfsBackend(const std::string& server, const std::string& exportPath,
+                                                std::string& error) {
+#ifdef HAVE_LIBNFS
+    struct nfs_context* nfs = nfs_init_context();
+    if (!nfs) {
+        error = "nfs_init_context failed";
+        return nullptr;
+    }
+    if (nfs_mount(nfs, server.c_str(), exportPath.c_str()) != 0) {
+        error = nfs_get_error(nfs);
+        nfs_destroy_context(nfs);
+        return nullptr;
+    }
+    return std::unique_ptr<NfsBackend>(new LibnfsBackend(nfs));
+#else
+    (void)server;
+    (void)exportPath;
+    error = "libnfs not available (built without HAVE_LIBNFS)";
+    return nullptr;
+#endif
+}
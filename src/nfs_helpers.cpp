@@ -1,4 +1,5 @@
 #include "nfs_helpers.h"
+#include "nfs_mount_rpc.h"
 #include <vector>
 #include <string>
 #include <cstdio>
@@ -14,23 +15,8 @@ std::vector<std::string> listNfsExports(const std::string& server) {
     std::vector<std::string> exports;
     if (server.empty()) return exports;
 
-    std::string cmd = "showmount -e " + server + " 2>/dev/null";
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) return exports;
-
-    char buffer[1024];
-    while (fgets(buffer, sizeof(buffer), pipe)) {
-        std::string line(buffer);
-        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) line.pop_back();
-        if (line.rfind("Export list for", 0) == 0) continue;
-        std::istringstream iss(line);
-        std::string path;
-        if (iss >> path) {
-            if (!path.empty()) exports.push_back(path);
-        }
-    }
-
-    pclose(pipe);
+    // MOUNT protocol EXPORT call, answered from the per-server cache when asked recently
+    for (const auto& entry : cachedNfsExports({server})[0].exports) exports.push_back(entry.path);
     return exports;
 }
 
@@ -3,7 +3,7 @@
 #include <string>
 #include <vector>
 
-// Query available exports from a remote NFS server via showmount.
+// Query available exports from a remote NFS server (MOUNT protocol, cached per server).
 std::vector<std::string> listNfsExports(const std::string& server);
 
 // Returns true when libnfs headers/libraries are available at build time.
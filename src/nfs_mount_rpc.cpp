@@ -0,0 +1,428 @@
+#include "nfs_mount_rpc.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <random>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace {
+
+const uint32_t kPortmapProgram = 100000;
+const uint32_t kPortmapVersion = 2;
+const uint32_t kPortmapGetport = 3;
+const uint32_t kMountProgram = 100005;
+const uint32_t kMountVersion = 3;
+const uint32_t kMountExport = 5;
+const uint32_t kProtoTcp = 6;
+const uint32_t kProtoUdp = 17;
+
+void putU32(std::string& out, uint32_t value) {
+    value = htonl(value);
+    out.append((const char*)&value, 4);
+}
+
+std::string rpcCall(uint32_t xid, uint32_t program, uint32_t version, uint32_t procedure, const std::string& args) {
+    std::string call;
+    putU32(call, xid);
+    putU32(call, 0);                      // CALL
+    putU32(call, 2);                      // RPC version
+    putU32(call, program);
+    putU32(call, version);
+    putU32(call, procedure);
+    putU32(call, 0);                      // AUTH_NONE credential
+    putU32(call, 0);
+    putU32(call, 0);                      // AUTH_NONE verifier
+    putU32(call, 0);
+    return call + args;
+}
+
+std::string getportCall(uint32_t xid, uint32_t protocol) {
+    std::string args;
+    putU32(args, kMountProgram);
+    putU32(args, kMountVersion);
+    putU32(args, protocol);
+    putU32(args, 0);
+    return rpcCall(xid, kPortmapProgram, kPortmapVersion, kPortmapGetport, args);
+}
+
+struct XdrReader {
+    const std::string& data;
+    size_t pos = 0;
+    bool ok = true;
+
+    uint32_t u32() {
+        if (pos + 4 > data.size()) {
+            ok = false;
+            return 0;
+        }
+        uint32_t value;
+        memcpy(&value, data.data() + pos, 4);
+        pos += 4;
+        return ntohl(value);
+    }
+    std::string string(size_t maxLen) {
+        uint32_t len = u32();
+        if (!ok || len > maxLen || pos + len > data.size()) {
+            ok = false;
+            return "";
+        }
+        std::string text = data.substr(pos, len);
+        pos += (len + 3) & ~3u;
+        return text;
+    }
+};
+
+// Accepted, successful reply -> result body; otherwise error text
+bool rpcResult(const std::string& reply, std::string& body, std::string& error) {
+    XdrReader in{reply};
+    in.u32();                             // xid
+    if (in.u32() != 1) {
+        error = "no RPC reply";
+        return false;
+    }
+    if (in.u32() != 0) {
+        error = "RPC call denied";
+        return false;
+    }
+    in.u32();                             // Verifier flavor
+    uint32_t verifierLen = in.u32();
+    in.pos += (verifierLen + 3) & ~3u;
+    uint32_t status = in.u32();
+    if (!in.ok || in.pos > reply.size()) {
+        error = "truncated RPC reply";
+        return false;
+    }
+    if (status != 0) {
+        error = status == 1 ? "program unavailable" : (status == 2 ? "version mismatch" : "RPC error " + std::to_string(status));
+        return false;
+    }
+    body = reply.substr(in.pos);
+    return true;
+}
+
+enum class Step { PortmapUdp, PortmapTcp, MountUdp, MountTcp, Done };
+
+struct Query {
+    NfsExportReply reply;
+    sockaddr_in addr{};
+    Step step = Step::PortmapUdp;
+    uint32_t xid = 0;
+    uint16_t port = 0;                    // Destination of the pending UDP request
+    std::string request;
+    std::chrono::steady_clock::time_point nextSend;
+    int interval = 250;
+    int tcp = -1;
+    std::string out;                      // TCP: record still to send
+    std::string in;                       // TCP: received bytes
+};
+
+void closeTcp(Query& query) {
+    if (query.tcp >= 0) close(query.tcp);
+    query.tcp = -1;
+}
+
+} // namespace
+
+bool parseMountExportList(const std::string& xdr, std::vector<NfsExport>& exports) {
+    XdrReader in{xdr};
+    while (in.u32() == 1 && in.ok) {
+        NfsExport entry;
+        entry.path = in.string(1024);
+        while (in.u32() == 1 && in.ok) entry.groups.push_back(in.string(255));
+        if (!in.ok) return false;
+        exports.push_back(std::move(entry));
+    }
+    return in.ok;
+}
+
+std::vector<NfsExportReply> queryNfsExports(const std::vector<std::string>& servers, int timeoutMs,
+                                            const std::function<void(const NfsExportReply&)>& onReply,
+                                            const std::atomic<bool>* cancel, uint16_t portmapPort) {
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::vector<Query> queries(servers.size());
+    std::map<uint32_t, size_t> byXid;
+    uint32_t nextXid = std::random_device{}();
+    size_t pending = 0;
+
+    auto finish = [&](Query& query, const std::string& error) {
+        closeTcp(query);
+        query.step = Step::Done;
+        query.reply.ok = error.empty();
+        query.reply.error = error;
+        byXid.erase(query.xid);
+        pending--;
+        if (onReply) onReply(query.reply);
+    };
+
+    int udp = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (udp >= 0) setsockopt(udp, IPPROTO_IP, IP_RECVERR, &one, sizeof(one));
+
+    auto sendUdp = [&](Query& query, uint16_t port, std::string request) {
+        byXid.erase(query.xid);
+        query.xid = nextXid++;
+        uint32_t xid = htonl(query.xid);
+        memcpy(&request[0], &xid, 4);
+        byXid[query.xid] = &query - &queries[0];
+        query.port = port;
+        query.request = std::move(request);
+        query.interval = 250;
+        query.nextSend = Clock::now();     // Sent by the loop
+    };
+
+    for (size_t i = 0; i < servers.size(); i++) {
+        Query& query = queries[i];
+        query.reply.server = servers[i];
+        pending++;
+        addrinfo hints{}, *result = nullptr;
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        if (udp < 0) {
+            finish(query, "no UDP socket");
+        } else if (getaddrinfo(servers[i].c_str(), nullptr, &hints, &result) != 0 || !result) {
+            finish(query, "unknown host");
+        } else {
+            query.addr = *(sockaddr_in*)result->ai_addr;
+            sendUdp(query, portmapPort, getportCall(0, kProtoUdp));
+        }
+        if (result) freeaddrinfo(result);
+    }
+
+    auto startTcp = [&](Query& query, uint16_t port) {
+        query.step = Step::MountTcp;
+        byXid.erase(query.xid);
+        query.xid = nextXid++;
+        query.tcp = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in addr = query.addr;
+        addr.sin_port = htons(port);
+        if (query.tcp < 0 || (connect(query.tcp, (sockaddr*)&addr, sizeof(addr)) != 0 && errno != EINPROGRESS)) {
+            finish(query, "mountd: " + std::string(strerror(errno)));
+            return;
+        }
+        std::string call = rpcCall(query.xid, kMountProgram, kMountVersion, kMountExport, "");
+        putU32(query.out, 0x80000000u | (uint32_t)call.size());    // Record marking, last fragment
+        query.out += call;
+    };
+
+    auto handleResult = [&](Query& query, const std::string& reply) {
+        std::string body, error;
+        if (!rpcResult(reply, body, error)) {
+            finish(query, query.step == Step::PortmapUdp || query.step == Step::PortmapTcp ? "portmapper: " + error : "mountd: " + error);
+            return;
+        }
+        if (query.step == Step::PortmapUdp || query.step == Step::PortmapTcp) {
+            XdrReader in{body};
+            uint32_t port = in.u32();
+            if (!in.ok || port > 65535) {
+                finish(query, "portmapper: bad reply");
+            } else if (port != 0) {
+                if (query.step == Step::PortmapUdp) {
+                    query.step = Step::MountUdp;
+                    sendUdp(query, (uint16_t)port, rpcCall(0, kMountProgram, kMountVersion, kMountExport, ""));
+                } else {
+                    startTcp(query, (uint16_t)port);
+                }
+            } else if (query.step == Step::PortmapUdp) {
+                query.step = Step::PortmapTcp;
+                sendUdp(query, query.port, getportCall(0, kProtoTcp));
+            } else {
+                finish(query, "mountd not registered");
+            }
+            return;
+        }
+        if (!parseMountExportList(body, query.reply.exports)) {
+            query.reply.exports.clear();
+            finish(query, "mountd: bad export list");
+            return;
+        }
+        finish(query, "");
+    };
+
+    std::string datagram(65536, '\0');
+    std::vector<pollfd> fds;
+    std::vector<Query*> fdQueries;
+    while (pending > 0) {
+        if (cancel && *cancel) break;
+        auto now = Clock::now();
+        if (now >= deadline) break;
+
+        // (Re)transmit due UDP requests
+        auto wake = deadline;
+        for (auto& query : queries) {
+            bool waitsUdp = query.step == Step::PortmapUdp || query.step == Step::PortmapTcp || query.step == Step::MountUdp;
+            if (!waitsUdp) continue;
+            if (query.nextSend <= now) {
+                sockaddr_in addr = query.addr;
+                addr.sin_port = htons(query.port);
+                sendto(udp, query.request.data(), query.request.size(), 0, (sockaddr*)&addr, sizeof(addr));
+                query.nextSend = now + std::chrono::milliseconds(query.interval);
+                query.interval = std::min(query.interval * 2, 1000);
+            }
+            wake = std::min(wake, query.nextSend);
+        }
+
+        fds.clear();
+        fdQueries.clear();
+        fds.push_back({udp, POLLIN, 0});
+        fdQueries.push_back(nullptr);
+        for (auto& query : queries) {
+            if (query.step != Step::MountTcp || query.tcp < 0) continue;
+            fds.push_back({query.tcp, (short)(query.out.empty() ? POLLIN : POLLOUT), 0});
+            fdQueries.push_back(&query);
+        }
+        int waitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count() + 1;
+        if (poll(fds.data(), fds.size(), std::min(waitMs, 100)) <= 0) continue;
+
+        if (fds[0].revents & POLLERR) {
+            // ICMP errors: port/host unreachable for one of the requests
+            while (true) {
+                sockaddr_in from{};
+                char control[512];
+                iovec iov{&datagram[0], datagram.size()};
+                msghdr msg{};
+                msg.msg_name = &from;
+                msg.msg_namelen = sizeof(from);
+                msg.msg_iov = &iov;
+                msg.msg_iovlen = 1;
+                msg.msg_control = control;
+                msg.msg_controllen = sizeof(control);
+                if (recvmsg(udp, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break;
+                int errnum = 0;
+                for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                    if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_RECVERR) {
+                        errnum = (int)((sock_extended_err*)CMSG_DATA(cmsg))->ee_errno;
+                    }
+                }
+                for (auto& query : queries) {
+                    bool waitsUdp = query.step == Step::PortmapUdp || query.step == Step::PortmapTcp || query.step == Step::MountUdp;
+                    if (!waitsUdp || query.addr.sin_addr.s_addr != from.sin_addr.s_addr || ntohs(from.sin_port) != query.port) continue;
+                    bool portmap = query.step != Step::MountUdp;
+                    finish(query, std::string(portmap ? "no portmapper" : "mountd") + " (" + strerror(errnum) + ")");
+                    break;
+                }
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            while (true) {
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                ssize_t n = recvfrom(udp, &datagram[0], datagram.size(), 0, (sockaddr*)&from, &fromLen);
+                if (n < 0) break;
+                if (n < 4) continue;
+                uint32_t xid;
+                memcpy(&xid, datagram.data(), 4);
+                auto it = byXid.find(ntohl(xid));
+                if (it == byXid.end()) continue;                 // Late duplicate
+                Query& query = queries[it->second];
+                if (query.step == Step::MountTcp || query.addr.sin_addr.s_addr != from.sin_addr.s_addr) continue;
+                handleResult(query, datagram.substr(0, n));
+            }
+        }
+        for (size_t i = 1; i < fds.size(); i++) {
+            Query& query = *fdQueries[i];
+            if (query.step != Step::MountTcp || !fds[i].revents) continue;
+            if (!query.out.empty()) {
+                int error = 0;
+                socklen_t len = sizeof(error);
+                getsockopt(query.tcp, SOL_SOCKET, SO_ERROR, &error, &len);
+                ssize_t n = error ? -1 : send(query.tcp, query.out.data(), query.out.size(), MSG_NOSIGNAL);
+                if (n < 0 && (error || (errno != EAGAIN && errno != EWOULDBLOCK))) {
+                    finish(query, "mountd: " + std::string(strerror(error ? error : errno)));
+                    continue;
+                }
+                if (n > 0) query.out.erase(0, n);
+                continue;
+            }
+            ssize_t n = recv(query.tcp, &datagram[0], datagram.size(), 0);
+            if (n <= 0) {
+                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) finish(query, "mountd: connection closed");
+                continue;
+            }
+            query.in.append(datagram.data(), n);
+            // Record marking: fragments of 4-byte header + data until the last-fragment bit
+            std::string record;
+            size_t pos = 0;
+            bool complete = false;
+            while (pos + 4 <= query.in.size()) {
+                uint32_t header;
+                memcpy(&header, query.in.data() + pos, 4);
+                header = ntohl(header);
+                size_t len = header & 0x7fffffffu;
+                if (pos + 4 + len > query.in.size()) break;
+                record.append(query.in, pos + 4, len);
+                pos += 4 + len;
+                if (header & 0x80000000u) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (query.in.size() > (16u << 20)) finish(query, "mountd: reply too large");
+            else if (complete) handleResult(query, record);
+        }
+    }
+
+    for (auto& query : queries) {
+        if (query.step != Step::Done) finish(query, cancel && *cancel ? "cancelled" : "timeout");
+    }
+    if (udp >= 0) close(udp);
+
+    std::vector<NfsExportReply> replies;
+    for (auto& query : queries) replies.push_back(std::move(query.reply));
+    return replies;
+}
+
+namespace {
+
+struct CachedExports {
+    NfsExportReply reply;
+    std::chrono::steady_clock::time_point fetched;
+};
+std::mutex exportCacheMutex;
+std::map<std::pair<std::string, uint16_t>, CachedExports> exportCache;
+
+} // namespace
+
+std::vector<NfsExportReply> cachedNfsExports(const std::vector<std::string>& servers, int ttlSeconds, int timeoutMs,
+                                             uint16_t portmapPort) {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<NfsExportReply> replies(servers.size());
+    std::vector<std::string> missing;
+    std::vector<size_t> missingIndex;
+    {
+        std::lock_guard<std::mutex> lock(exportCacheMutex);
+        for (size_t i = 0; i < servers.size(); i++) {
+            auto it = exportCache.find({servers[i], portmapPort});
+            int ttl = it == exportCache.end() || it->second.reply.ok ? ttlSeconds : std::min(ttlSeconds, 30);
+            if (it != exportCache.end() && now - it->second.fetched < std::chrono::seconds(ttl)) {
+                replies[i] = it->second.reply;
+            } else {
+                missing.push_back(servers[i]);
+                missingIndex.push_back(i);
+            }
+        }
+    }
+    if (missing.empty()) return replies;
+
+    std::vector<NfsExportReply> fresh = queryNfsExports(missing, timeoutMs, nullptr, nullptr, portmapPort);
+    now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(exportCacheMutex);
+    for (size_t i = 0; i < fresh.size(); i++) {
+        exportCache[{missing[i], portmapPort}] = {fresh[i], now};
+        replies[missingIndex[i]] = std::move(fresh[i]);
+    }
+    return replies;
+}
+
+void clearNfsExportCache() {
+    std::lock_guard<std::mutex> lock(exportCacheMutex);
+    exportCache.clear();
+}
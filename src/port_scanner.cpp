@@ -0,0 +1,315 @@
+#include "port_scanner.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+using ScanClock = std::chrono::steady_clock;
+
+namespace {
+
+enum class ProbeOutcome { Open, Refused, TimedOut, Unreachable };
+
+struct Probe {
+    bool active = false;
+    uint32_t generation = 0;
+    size_t host = 0;
+    int portIndex = 0;
+};
+
+struct HostState {
+    uint32_t address = 0;
+    int remaining = 0;
+    uint32_t openMask = 0;
+    bool responded = false;
+};
+
+struct Deadline {
+    ScanClock::time_point at;
+    int fd;
+    uint32_t generation;
+};
+
+// Raise the soft fd limit towards the hard limit; returns the usable number of sockets
+int socketBudget(int wanted) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return std::min(wanted, 512);
+    rlim_t needed = (rlim_t)wanted + 64;
+    if (limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur < needed) {
+        rlim_t raised = limit.rlim_max == RLIM_INFINITY ? needed : std::min(needed, limit.rlim_max);
+        if (raised > limit.rlim_cur) {
+            struct rlimit newLimit = limit;
+            newLimit.rlim_cur = raised;
+            if (setrlimit(RLIMIT_NOFILE, &newLimit) == 0) limit.rlim_cur = raised;
+        }
+    }
+    if (limit.rlim_cur == RLIM_INFINITY) return wanted;
+    return std::max(1, std::min(wanted, (int)limit.rlim_cur - 64));
+}
+
+std::string addressText(uint32_t address) {
+    struct in_addr in;
+    in.s_addr = htonl(address);
+    char buffer[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &in, buffer, sizeof(buffer));
+    return buffer;
+}
+
+// hostAt(i) -> address in host byte order, or 0 for an invalid entry (reported without probing)
+PortScanStats runScan(size_t hostCount, const std::function<uint32_t(size_t)>& hostAt, const PortScanOptions& options,
+                      const PortScanHostCallback& onHost, const PortScanOpenCallback& onOpen,
+                      const std::atomic<bool>* cancel) {
+    PortScanStats stats;
+    auto started = ScanClock::now();
+    std::vector<int> ports(options.ports.begin(), options.ports.begin() + std::min<size_t>(options.ports.size(), 32));
+    int portCount = (int)ports.size();
+    auto cancelled = [cancel]() { return cancel && cancel->load(); };
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        std::cerr << "[PortScan] epoll_create1 failed: " << strerror(errno) << std::endl;
+        return stats;
+    }
+
+    int maxInFlight = socketBudget(std::max(1, options.maxInFlight));
+    auto timeout = std::chrono::milliseconds(std::max(1, options.timeoutMs));
+    std::vector<Probe> probes;                    // Indexed by fd
+    std::deque<Deadline> deadlines;               // Same timeout for all: FIFO = deadline order
+    std::unordered_map<size_t, HostState> hosts;  // Only hosts with probes still open
+    uint32_t generation = 0;
+    int inFlight = 0;
+    size_t nextHost = 0;
+    int nextPort = 0;
+    double tokens = 1;
+    auto lastRefill = started;
+
+    auto hostDone = [&](size_t index, HostState& state) {
+        stats.hosts++;
+        if (onHost && !cancelled()) {
+            PortScanHostResult result;
+            result.ip = addressText(state.address);
+            result.responded = state.responded;
+            for (int i = 0; i < portCount; i++) {
+                if (state.openMask & (1u << i)) result.openPorts.push_back(ports[i]);
+            }
+            onHost(result);
+        }
+        hosts.erase(index);
+    };
+
+    auto finish = [&](size_t index, int portIndex, ProbeOutcome outcome) {
+        stats.probes++;
+        HostState& state = hosts[index];
+        switch (outcome) {
+            case ProbeOutcome::Open:
+                stats.open++;
+                state.openMask |= 1u << portIndex;
+                state.responded = true;
+                if (onOpen && !cancelled()) onOpen(addressText(state.address), ports[portIndex]);
+                break;
+            case ProbeOutcome::Refused:
+                stats.refused++;
+                state.responded = true;
+                break;
+            case ProbeOutcome::TimedOut: stats.timedOut++; break;
+            case ProbeOutcome::Unreachable: stats.unreachable++; break;
+        }
+        if (--state.remaining == 0) hostDone(index, state);
+    };
+
+    auto closeProbe = [&](int fd, bool reset) {
+        if (reset) {
+            // RST instead of FIN: no TIME_WAIT pile-up for open ports on big sweeps
+            struct linger lg = {1, 0};
+            setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        probes[fd].active = false;
+        inFlight--;
+    };
+
+    // Starts the next probe; false = nothing started (out of sockets/ports, retry later)
+    auto launch = [&]() -> bool {
+        if (nextPort == 0) {
+            uint32_t address = hostAt(nextHost);
+            HostState& state = hosts[nextHost];
+            state.address = address;
+            state.remaining = portCount;
+            if (address == 0 || portCount == 0) {
+                if (portCount == 0) {
+                    hostDone(nextHost, state);
+                } else {
+                    for (int i = 0; i < portCount; i++) finish(nextHost, i, ProbeOutcome::Unreachable);
+                }
+                nextHost++;
+                return true;
+            }
+        }
+        size_t index = nextHost;
+        int portIndex = nextPort;
+        auto advance = [&]() {
+            if (++nextPort == portCount) {
+                nextPort = 0;
+                nextHost++;
+            }
+        };
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                maxInFlight = std::max(1, inFlight);
+                return false;
+            }
+            advance();
+            finish(index, portIndex, ProbeOutcome::Unreachable);
+            return true;
+        }
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)ports[portIndex]);
+        addr.sin_addr.s_addr = htonl(hosts[index].address);
+        int rc = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+        int error = rc == 0 ? 0 : errno;
+        if (error == EAGAIN || error == EADDRNOTAVAIL) {
+            // Ephemeral ports exhausted: wait for in-flight probes to free some
+            close(fd);
+            if (inFlight > 0) maxInFlight = std::max(1, inFlight);
+            return false;
+        }
+        advance();
+        if (error == EINPROGRESS) {
+            if ((size_t)fd >= probes.size()) probes.resize(fd + 1024);
+            Probe& probe = probes[fd];
+            probe.active = true;
+            probe.generation = ++generation;
+            probe.host = index;
+            probe.portIndex = portIndex;
+            struct epoll_event ev = {};
+            ev.events = EPOLLOUT;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            deadlines.push_back({ScanClock::now() + timeout, fd, probe.generation});
+            inFlight++;
+            return true;
+        }
+        if (error == 0) {
+            struct linger lg = {1, 0};
+            setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+        }
+        close(fd);
+        finish(index, portIndex, error == 0 ? ProbeOutcome::Open
+                                            : (error == ECONNREFUSED ? ProbeOutcome::Refused : ProbeOutcome::Unreachable));
+        return true;
+    };
+
+    std::vector<struct epoll_event> events(1024);
+    while (!cancelled()) {
+        auto now = ScanClock::now();
+        if (options.ratePerSecond > 0) {
+            double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+            tokens = std::min<double>(tokens + elapsed * options.ratePerSecond, std::max(1, options.ratePerSecond / 20));
+            lastRefill = now;
+        }
+
+        bool blocked = false;
+        while (nextHost < hostCount && inFlight < maxInFlight && !cancelled()) {
+            if (options.ratePerSecond > 0) {
+                if (tokens < 1) break;
+                tokens -= 1;
+            }
+            if (!launch()) {
+                blocked = true;
+                break;
+            }
+        }
+        if (nextHost >= hostCount && inFlight == 0) break;
+
+        // Sleep until the next deadline, the next rate token or a cancel check
+        int waitMs = 50;
+        if (!deadlines.empty()) {
+            auto untilDeadline = std::chrono::duration_cast<std::chrono::milliseconds>(deadlines.front().at - now).count() + 1;
+            waitMs = (int)std::clamp<long long>(untilDeadline, 0, waitMs);
+        }
+        if (nextHost < hostCount && inFlight < maxInFlight) {
+            if (options.ratePerSecond > 0) waitMs = std::min(waitMs, std::max(1, 1000 / options.ratePerSecond));
+            if (blocked && inFlight == 0) waitMs = std::min(waitMs, 10);
+        }
+        int count = epoll_wait(epollFd, events.data(), (int)events.size(), waitMs);
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd < 0 || (size_t)fd >= probes.size() || !probes[fd].active) continue;
+            Probe probe = probes[fd];
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) error = errno;
+            closeProbe(fd, error == 0);
+            finish(probe.host, probe.portIndex, error == 0 ? ProbeOutcome::Open
+                                                           : (error == ECONNREFUSED ? ProbeOutcome::Refused : ProbeOutcome::Unreachable));
+            // Limit lowered by a transient shortage: grow back slowly
+            if (maxInFlight < options.maxInFlight && !blocked) maxInFlight++;
+        }
+
+        now = ScanClock::now();
+        while (!deadlines.empty() && deadlines.front().at <= now) {
+            Deadline deadline = deadlines.front();
+            deadlines.pop_front();
+            Probe& probe = probes[deadline.fd];
+            if (!probe.active || probe.generation != deadline.generation) continue;
+            Probe expired = probe;
+            closeProbe(deadline.fd, false);
+            finish(expired.host, expired.portIndex, ProbeOutcome::TimedOut);
+        }
+    }
+
+    // Cancelled: drop everything still in flight without callbacks
+    for (size_t fd = 0; fd < probes.size(); fd++) {
+        if (probes[fd].active) closeProbe((int)fd, false);
+    }
+    close(epollFd);
+    stats.seconds = std::chrono::duration<double>(ScanClock::now() - started).count();
+    return stats;
+}
+
+} // namespace
+
+PortScanStats massPortScan(const std::vector<std::string>& hosts, const PortScanOptions& options,
+                           const PortScanHostCallback& onHost, const PortScanOpenCallback& onOpen,
+                           const std::atomic<bool>* cancel) {
+    std::vector<uint32_t> addresses;
+    addresses.reserve(hosts.size());
+    for (const auto& host : hosts) {
+        struct in_addr in;
+        addresses.push_back(inet_pton(AF_INET, host.c_str(), &in) == 1 ? ntohl(in.s_addr) : 0);
+    }
+    return runScan(addresses.size(), [&](size_t i) { return addresses[i]; }, options, onHost, onOpen, cancel);
+}
+
+PortScanStats massPortScanRange(uint32_t first, uint32_t last, const PortScanOptions& options,
+                                const PortScanHostCallback& onHost, const PortScanOpenCallback& onOpen,
+                                const std::atomic<bool>* cancel) {
+    if (last < first) return PortScanStats();
+    size_t count = (size_t)(last - first) + 1;
+    return runScan(count, [first](size_t i) { return first + (uint32_t)i; }, options, onHost, onOpen, cancel);
+}
+
+std::string portServiceName(int port) {
+    switch (port) {
+        case 21: return "FTP";
+        case 22: return "SSH";
+        case 139: return "SMB-NetBIOS";
+        case 445: return "SMB-CIFS";
+        case 2049: return "NFS";
+        default: return std::to_string(port);
+    }
+}
@@ -0,0 +1,100 @@
+#include "remote_bandwidth.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+static constexpr double kEwmaAlpha = 0.3;
+static constexpr long long kMinThroughputBytes = 64 * 1024;   // Smaller transfers only measure latency
+static constexpr double kMinThroughputSec = 0.02;
+
+TokenBucket::TokenBucket(double bytesPerSec, double burstSec)
+    : m_rate(std::max(0.0, bytesPerSec)), m_burstSec(std::max(0.01, burstSec)),
+      m_last(std::chrono::steady_clock::now()) {
+    m_tokens = m_rate * m_burstSec;
+}
+
+void TokenBucket::setRate(double bytesPerSec) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    refillLocked(std::chrono::steady_clock::now());
+    m_rate = std::max(0.0, bytesPerSec);
+    // Old debt would outlive a raised limit; start the new rate with a full burst
+    m_tokens = m_rate * m_burstSec;
+}
+
+double TokenBucket::rate() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rate;
+}
+
+void TokenBucket::refillLocked(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+    m_tokens = std::min(m_rate * m_burstSec, m_tokens + elapsed * m_rate);
+}
+
+std::chrono::microseconds TokenBucket::reserve(size_t n) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_rate <= 0) return std::chrono::microseconds(0);
+    refillLocked(std::chrono::steady_clock::now());
+    m_tokens -= (double)n;
+    if (m_tokens >= 0) return std::chrono::microseconds(0);
+    return std::chrono::microseconds((long long)std::ceil(-m_tokens / m_rate * 1e6));
+}
+
+void TokenBucket::consume(size_t n) {
+    std::chrono::microseconds wait = reserve(n);
+    if (wait.count() > 0) std::this_thread::sleep_for(wait);
+}
+
+void RemoteThroughputTracker::record(const std::string& server, long long bytes, double transferSec, double latencySec) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RemoteEstimate& e = m_estimates[server];
+    if (latencySec > 0) {
+        e.latencySec = (e.latencySec > 0) ? e.latencySec + kEwmaAlpha * (latencySec - e.latencySec) : latencySec;
+    }
+    if (bytes >= kMinThroughputBytes && transferSec >= kMinThroughputSec) {
+        double bps = bytes / transferSec;
+        e.bytesPerSec = (e.bytesPerSec > 0) ? e.bytesPerSec + kEwmaAlpha * (bps - e.bytesPerSec) : bps;
+    }
+    e.samples++;
+}
+
+bool RemoteThroughputTracker::estimate(const std::string& server, RemoteEstimate& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_estimates.find(server);
+    if (it == m_estimates.end()) return false;
+    out = it->second;
+    return true;
+}
+
+std::map<std::string, RemoteEstimate> RemoteThroughputTracker::snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_estimates;
+}
+
+void RemoteThroughputTracker::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_estimates.clear();
+}
+
+int RemoteThroughputTracker::timeoutFor(const std::string& server, long long bytes, int minSec, int maxSec,
+                                        double rateCap) const {
+    RemoteEstimate e;
+    if (!estimate(server, e) || e.bytesPerSec <= 0) {
+        if (rateCap <= 0) return minSec;
+        e.bytesPerSec = rateCap;
+    } else if (rateCap > 0) {
+        e.bytesPerSec = std::min(e.bytesPerSec, rateCap);
+    }
+    double expected = e.latencySec + (double)std::max(0LL, bytes) / e.bytesPerSec;
+    double timeout = 3.0 * expected + 2.0;
+    return (int)std::clamp(timeout, (double)minSec, (double)std::max(minSec, maxSec));
+}
+
+int RemoteThroughputTracker::suggestedConnections(const std::string& server, long long typicalBytes, int maxConnections) const {
+    maxConnections = std::max(1, maxConnections);
+    RemoteEstimate e;
+    if (!estimate(server, e) || e.bytesPerSec <= 0 || e.latencySec <= 0 || typicalBytes <= 0) return maxConnections;
+    double connections = 1.0 + e.latencySec * e.bytesPerSec / (double)typicalBytes;
+    return (int)std::clamp(std::ceil(connections), 1.0, (double)maxConnections);
+}
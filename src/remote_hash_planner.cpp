@@ -0,0 +1,111 @@
+#include "remote_hash_planner.h"
+#include <cstdio>
+
+RemoteHashPlan planRemoteHashing(const std::vector<HashPlanGroup>& groups, long long sampleBytes, bool useSamples) {
+    RemoteHashPlan plan;
+    for (const auto& group : groups) {
+        if (group.members.size() <= 1) continue;
+
+        int locals = 0;
+        int remotes = 0;
+        bool wildcard = false;   // Remote hash without sample in this group
+        bool oneOrigin = true;   // All remote members on the same server
+        const std::string* origin = nullptr;
+        for (const auto& member : group.members) {
+            if (!member.remote) {
+                locals++;
+                continue;
+            }
+            remotes++;
+            if (member.source != RemoteHashSource::Transfer) wildcard = true;
+            if (!origin) origin = &member.origin;
+            else if (member.origin != *origin) oneOrigin = false;
+        }
+        plan.localFiles += locals;
+        plan.localBytes += locals * group.size;
+        if (remotes == 0) continue;
+        if (locals > 0) plan.mixedSizes.insert(group.size);
+
+        bool sample = useSamples && !wildcard && group.size > 2 * sampleBytes;
+        for (const auto& member : group.members) {
+            if (!member.remote) continue;
+            plan.remoteFiles++;
+            RemoteHashStep step;
+            if (member.source == RemoteHashSource::Cached) {
+                step = RemoteHashStep::Known;
+                plan.cached++;
+            } else if (member.source == RemoteHashSource::ServerMD5 ||
+                       (member.source == RemoteHashSource::ServerOther && locals == 0 && oneOrigin)) {
+                // A SHA-x digest cannot be compared with local MD5s or with files on other servers
+                // (MD5 or another algorithm there) - such groups download instead
+                step = RemoteHashStep::ServerDigest;
+                plan.serverDigests++;
+            } else if (sample) {
+                step = RemoteHashStep::Sample;
+                plan.sampled++;
+                plan.sampleBytes += 2 * sampleBytes;
+                plan.pendingBytes += group.size;
+            } else {
+                step = RemoteHashStep::Download;
+                plan.downloads++;
+                plan.downloadBytes += group.size;
+            }
+            plan.steps[member.file] = step;
+        }
+        if (sample) plan.sampledSizes.insert(group.size);
+    }
+    return plan;
+}
+
+std::vector<std::string> applySamples(RemoteHashPlan& plan, long long size,
+                                      const std::vector<std::string>& localKeys,
+                                      const std::map<std::string, std::string>& remoteKeys) {
+    // A failed sample could belong to a copy of any sampled peer: nothing in the group is ruled out
+    bool failed = false;
+    std::map<std::string, int> keyCount;
+    for (const auto& key : localKeys) {
+        if (key.empty()) failed = true;
+        else keyCount[key]++;
+    }
+    for (const auto& [file, key] : remoteKeys) {
+        if (key.empty()) failed = true;
+        else keyCount[key]++;
+    }
+
+    std::vector<std::string> downloads;
+    for (const auto& [file, key] : remoteKeys) {
+        auto it = plan.steps.find(file);
+        if (it == plan.steps.end() || it->second != RemoteHashStep::Sample) continue;
+        plan.sampled--;
+        plan.pendingBytes -= size;
+        if (failed || keyCount[key] > 1) {
+            it->second = RemoteHashStep::Download;
+            plan.downloads++;
+            plan.downloadBytes += size;
+            downloads.push_back(file);
+        } else {
+            it->second = RemoteHashStep::Skip;
+            plan.skipped++;
+        }
+    }
+    return downloads;
+}
+
+static std::string formatMB(long long bytes) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1f MB", bytes / (1024.0 * 1024.0));
+    return buffer;
+}
+
+std::string describeRemoteHashPlan(const RemoteHashPlan& plan) {
+    std::string text = std::to_string(plan.localFiles) + " lokal (" + formatMB(plan.localBytes) + "), " +
+                       std::to_string(plan.remoteFiles) + " remote: " +
+                       std::to_string(plan.cached) + " Cache, " +
+                       std::to_string(plan.serverDigests) + " Server-Prüfsumme, " +
+                       std::to_string(plan.sampled) + " Stichprobe, " +
+                       std::to_string(plan.downloads) + " Download";
+    if (plan.skipped > 0) text += ", " + std::to_string(plan.skipped) + " ausgeschlossen";
+    text += " - Transfer " + formatMB(plan.expectedTransferBytes());
+    if (plan.pendingBytes > 0) text += " (höchstens " + formatMB(plan.maxTransferBytes()) + ")";
+    return text;
+}
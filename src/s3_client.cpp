@@ -0,0 +1,421 @@
+#include "s3_client.h"
+#include "http_backend.h"
+#include "webdav_client.h"
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <set>
+
+bool isS3Url(const std::string& path) {
+    return path.compare(0, 5, "s3://") == 0 || path.compare(0, 6, "s3s://") == 0;
+}
+
+std::string s3Url(bool https, const std::string& host, const std::string& path) {
+    std::string url = (https ? "s3s://" : "s3://") + host;
+    if (path.empty() || path.front() != '/') url += "/";
+    return url + path;
+}
+
+bool parseS3Url(const std::string& url, bool& https, std::string& host, std::string& path) {
+    if (!isS3Url(url)) return false;
+    https = url[2] == 's';
+    size_t start = https ? 6 : 5;
+    size_t slash = url.find('/', start);
+    host = url.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+    path = slash == std::string::npos ? "/" : url.substr(slash);
+    return !host.empty();
+}
+
+static std::string xmlText(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        size_t semi;
+        if (text[i] != '&' || (semi = text.find(';', i)) == std::string::npos || semi - i > 6) {
+            out += text[i];
+            continue;
+        }
+        std::string entity = text.substr(i + 1, semi - i - 1);
+        if (entity == "amp") out += '&';
+        else if (entity == "lt") out += '<';
+        else if (entity == "gt") out += '>';
+        else if (entity == "quot") out += '"';
+        else if (entity == "apos") out += '\'';
+        else if (entity.size() > 1 && entity[0] == '#' && entity[1] != 'x' && atoi(entity.c_str() + 1) < 128) out += (char)atoi(entity.c_str() + 1);
+        else out += text.substr(i, semi - i + 1);
+        i = semi;
+    }
+    return out;
+}
+
+// Text of the first <name> element in [from, to)
+static std::string element(const std::string& xml, const std::string& name, size_t from = 0, size_t to = std::string::npos) {
+    size_t start = xml.find("<" + name + ">", from);
+    if (start == std::string::npos || start >= to) return "";
+    start += name.size() + 2;
+    size_t end = xml.find("</" + name + ">", start);
+    if (end == std::string::npos || end > to) return "";
+    return xmlText(xml.substr(start, end - start));
+}
+
+// Calls onBlock(begin, end) for every <name>...</name> block
+template <typename Callback>
+static void forEachBlock(const std::string& xml, const std::string& name, Callback onBlock) {
+    std::string open = "<" + name + ">", close = "</" + name + ">";
+    for (size_t pos = 0; (pos = xml.find(open, pos)) != std::string::npos;) {
+        size_t end = xml.find(close, pos);
+        if (end == std::string::npos) break;
+        onBlock(pos + open.size(), end);
+        pos = end + close.size();
+    }
+}
+
+bool parseS3ListObjects(const std::string& xml, S3ListPage& page) {
+    if (xml.find("<ListBucketResult") == std::string::npos) return false;
+    forEachBlock(xml, "Contents", [&](size_t begin, size_t end) {
+        S3Object object;
+        object.key = element(xml, "Key", begin, end);
+        object.size = strtoull(element(xml, "Size", begin, end).c_str(), nullptr, 10);
+        object.mtime = parseIso8601(element(xml, "LastModified", begin, end));
+        object.etag = element(xml, "ETag", begin, end);
+        if (!object.key.empty()) page.objects.push_back(std::move(object));
+    });
+    forEachBlock(xml, "CommonPrefixes", [&](size_t begin, size_t end) {
+        std::string prefix = element(xml, "Prefix", begin, end);
+        if (!prefix.empty()) page.prefixes.push_back(prefix);
+    });
+    page.truncated = element(xml, "IsTruncated") == "true";
+    page.nextToken = element(xml, "NextContinuationToken");
+    return true;
+}
+
+bool parseS3Buckets(const std::string& xml, std::vector<std::string>& buckets) {
+    if (xml.find("<ListAllMyBucketsResult") == std::string::npos) return false;
+    forEachBlock(xml, "Bucket", [&](size_t begin, size_t end) {
+        std::string name = element(xml, "Name", begin, end);
+        if (!name.empty()) buckets.push_back(name);
+    });
+    return true;
+}
+
+std::string parseS3Error(const std::string& xml) {
+    std::string code = element(xml, "Code");
+    if (code.empty()) return "";
+    std::string message = element(xml, "Message");
+    return message.empty() ? code : code + ": " + message;
+}
+
+std::string s3EtagMd5(const std::string& etag) {
+    std::string hex;
+    for (char c : etag) {
+        if (c != '"') hex += (char)tolower((unsigned char)c);
+    }
+    if (hex.size() != 32 || hex.find_first_not_of("0123456789abcdef") != std::string::npos) return "";
+    return hex;
+}
+
+int64_t parseIso8601(const std::string& text) {
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    if (sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    return (int64_t)timegm(&tm);
+}
+
+std::string s3UriEncode(const std::string& text, bool keepSlash) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : text) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~' || (keepSlash && c == '/')) {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
+}
+
+static std::string toHex(const unsigned char* data, size_t len) {
+    std::string out;
+    char buffer[3];
+    for (size_t i = 0; i < len; i++) {
+        snprintf(buffer, sizeof(buffer), "%02x", data[i]);
+        out += buffer;
+    }
+    return out;
+}
+
+std::string sha256Hex(const std::string& data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    EVP_Digest(data.data(), data.size(), digest, &len, EVP_sha256(), nullptr);
+    return toHex(digest, len);
+}
+
+static std::string hmacSha256(const std::string& key, const std::string& data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    HMAC(EVP_sha256(), key.data(), (int)key.size(), (const unsigned char*)data.data(), data.size(), digest, &len);
+    return std::string((const char*)digest, len);
+}
+
+std::vector<std::string> s3SignV4(const S3Credentials& credentials, const std::string& method, const std::string& path,
+                                  const std::map<std::string, std::string>& query,
+                                  const std::map<std::string, std::string>& signedHeaders,
+                                  const std::string& payloadHash, const std::string& amzDate) {
+    std::map<std::string, std::string> headers = signedHeaders;
+    headers["x-amz-date"] = amzDate;
+    headers["x-amz-content-sha256"] = payloadHash;
+
+    std::string canonicalQuery;
+    for (const auto& [name, value] : query) {
+        if (!canonicalQuery.empty()) canonicalQuery += '&';
+        canonicalQuery += s3UriEncode(name, false) + "=" + s3UriEncode(value, false);
+    }
+    std::string canonicalHeaders, headerNames;
+    for (const auto& [name, value] : headers) {
+        canonicalHeaders += name + ":" + value + "\n";
+        headerNames += (headerNames.empty() ? "" : ";") + name;
+    }
+    std::string canonicalRequest = method + "\n" + s3UriEncode(path, true) + "\n" + canonicalQuery + "\n" +
+                                   canonicalHeaders + "\n" + headerNames + "\n" + payloadHash;
+
+    std::string date = amzDate.substr(0, 8);
+    std::string scope = date + "/" + credentials.region + "/s3/aws4_request";
+    std::string stringToSign = "AWS4-HMAC-SHA256\n" + amzDate + "\n" + scope + "\n" + sha256Hex(canonicalRequest);
+    std::string key = hmacSha256("AWS4" + credentials.secretKey, date);
+    key = hmacSha256(key, credentials.region);
+    key = hmacSha256(key, "s3");
+    key = hmacSha256(key, "aws4_request");
+    std::string signature = hmacSha256(key, stringToSign);
+
+    return {
+        "x-amz-date: " + amzDate,
+        "x-amz-content-sha256: " + payloadHash,
+        "Authorization: AWS4-HMAC-SHA256 Credential=" + credentials.accessKey + "/" + scope +
+            ", SignedHeaders=" + headerNames + ", Signature=" + toHex((const unsigned char*)signature.data(), signature.size()),
+    };
+}
+
+namespace {
+
+class S3Backend : public HttpBackend {
+public:
+    S3Backend(bool https, std::string host, S3Credentials credentials, bool flat, int maxConnections)
+        : HttpBackend("S3", maxConnections), m_baseUrl((https ? "https://" : "http://") + host), m_host(std::move(host)),
+          m_credentials(std::move(credentials)), m_flat(flat) {}
+
+    bool readdirplus(const std::string& path, DirCallback cb) override {
+        std::string dir = normalized(path);
+        // A pooled connection may come back for the next scan - don't answer it from an old listing
+        if (std::chrono::steady_clock::now() - m_treeTime > std::chrono::seconds(30)) m_tree.clear();
+        auto it = m_tree.find(dir);
+        if (it != m_tree.end()) {
+            auto entries = std::make_shared<std::vector<NfsDirEntry>>(std::move(it->second));
+            m_tree.erase(it);
+            defer([cb, entries]() { cb(0, std::move(*entries)); });
+            return true;
+        }
+        if (dir == "/") return listBuckets(std::move(cb));
+        m_treeTime = std::chrono::steady_clock::now();
+        auto listing = std::make_shared<Listing>();
+        listing->dir = dir;
+        listing->cb = std::move(cb);
+        return listPage(listing, "");
+    }
+
+    bool unlink(const std::string& path, std::string& error) override {
+        Request request;
+        request.method = "DELETE";
+        request.path = normalized(path);
+        std::string body;
+        long code = perform(std::move(request), body);
+        if (code >= 200 && code < 300) return true;
+        error = code ? "HTTP " + std::to_string(code) + " " + parseS3Error(body) : m_lastError;
+        return false;
+    }
+
+protected:
+    std::string requestUrl(const Request& request) const override {
+        std::string url = m_baseUrl + s3UriEncode(request.path, true);
+        return request.query.empty() ? url : url + "?" + request.query;
+    }
+
+    void authorize(Request& request, CURL*) const override {
+        // curl leaves out default ports in Host - send exactly what was signed
+        request.headers.push_back("Host: " + m_host);
+        if (m_credentials.accessKey.empty()) return;
+        std::map<std::string, std::string> query;
+        for (size_t pos = 0; pos < request.query.size();) {
+            size_t amp = request.query.find('&', pos);
+            std::string pair = request.query.substr(pos, amp == std::string::npos ? std::string::npos : amp - pos);
+            size_t eq = pair.find('=');
+            query[decode(pair.substr(0, eq))] = eq == std::string::npos ? "" : decode(pair.substr(eq + 1));
+            pos = amp == std::string::npos ? request.query.size() : amp + 1;
+        }
+        time_t now = time(nullptr);
+        struct tm tm;
+        gmtime_r(&now, &tm);
+        char amzDate[17];
+        strftime(amzDate, sizeof(amzDate), "%Y%m%dT%H%M%SZ", &tm);
+        for (auto& header : s3SignV4(m_credentials, request.method, request.path, query, {{"host", m_host}},
+                                     sha256Hex(request.body), amzDate)) {
+            request.headers.push_back(std::move(header));
+        }
+    }
+
+private:
+    struct Listing {
+        std::string dir;                  // "/bucket/prefix"
+        DirCallback cb;
+        std::set<std::string> dirs;       // Directories already entered in m_tree
+        size_t objects = 0;
+    };
+
+    static std::string normalized(const std::string& path) {
+        std::string out = path.empty() || path.front() != '/' ? "/" + path : path;
+        while (out.size() > 1 && out.back() == '/') out.pop_back();
+        return out;
+    }
+
+    static std::string decode(const std::string& text) {
+        std::string out;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '%' && i + 2 < text.size()) {
+                out += (char)std::stoi(text.substr(i + 1, 2), nullptr, 16);
+                i += 2;
+            } else {
+                out += text[i];
+            }
+        }
+        return out;
+    }
+
+    void failed(long code, const std::string& body, const std::string& what) {
+        std::string detail = parseS3Error(body);
+        if (code) m_lastError = "HTTP " + std::to_string(code) + (detail.empty() ? "" : " " + detail) + " for " + what;
+    }
+
+    bool listBuckets(DirCallback cb) {
+        Request request;
+        request.path = "/";
+        return send(std::move(request), [this, cb](long code, std::string&& body) {
+            std::vector<std::string> buckets;
+            if (code != 200 || !parseS3Buckets(body, buckets)) {
+                failed(code, body, "ListBuckets");
+                cb(-1, {});
+                return;
+            }
+            std::vector<NfsDirEntry> entries;
+            for (const auto& bucket : buckets) {
+                NfsDirEntry entry;
+                entry.name = bucket;
+                entry.isDir = true;
+                entries.push_back(std::move(entry));
+            }
+            cb(0, std::move(entries));
+        });
+    }
+
+    bool listPage(const std::shared_ptr<Listing>& listing, const std::string& token) {
+        size_t slash = listing->dir.find('/', 1);
+        std::string bucket = listing->dir.substr(1, slash == std::string::npos ? std::string::npos : slash - 1);
+        std::string prefix = slash == std::string::npos ? "" : listing->dir.substr(slash + 1) + "/";
+
+        // Query parameters sorted by name, as signed
+        Request request;
+        request.path = "/" + bucket;
+        if (!token.empty()) request.query = "continuation-token=" + s3UriEncode(token, false) + "&";
+        if (!m_flat) request.query += "delimiter=%2F&";
+        request.query += "list-type=2&max-keys=1000";
+        if (!prefix.empty()) request.query += "&prefix=" + s3UriEncode(prefix, false);
+        return send(std::move(request), [this, listing, bucket, prefix](long code, std::string&& body) {
+            S3ListPage page;
+            if (code != 200 || !parseS3ListObjects(body, page)) {
+                failed(code, body, "ListObjectsV2 " + listing->dir);
+                listing->cb(-1, {});
+                return;
+            }
+            add(*listing, bucket, prefix, page);
+            if (page.truncated && !page.nextToken.empty()) {
+                if (!listPage(listing, page.nextToken)) listing->cb(-1, {});
+                return;
+            }
+            m_treeTime = std::chrono::steady_clock::now();
+            std::vector<NfsDirEntry> entries = std::move(m_tree[listing->dir]);
+            m_tree.erase(listing->dir);
+            listing->cb(0, std::move(entries));
+        });
+    }
+
+    // Enters dir and its parents up to the listed directory into m_tree
+    void addDir(Listing& listing, const std::string& dir) {
+        for (std::string path = dir; path.size() > listing.dir.size() && listing.dirs.insert(path).second;) {
+            std::string parent = path.substr(0, path.find_last_of('/'));
+            NfsDirEntry entry;
+            entry.name = path.substr(parent.size() + 1);
+            entry.isDir = true;
+            m_tree[parent].push_back(std::move(entry));
+            if (m_flat) m_tree[path];     // Listed too - possibly empty
+            path = parent;
+        }
+    }
+
+    void add(Listing& listing, const std::string& bucket, const std::string& prefix, const S3ListPage& page) {
+        std::string base = "/" + bucket;
+        m_tree[listing.dir];
+        for (const auto& common : page.prefixes) {
+            std::string dir = normalized(base + "/" + common);
+            if (common.find("//") == std::string::npos) addDir(listing, dir);
+        }
+        for (const auto& object : page.objects) {
+            // Keys that can't be a path ("a//b", "/a") are left out
+            if (object.key.find("//") != std::string::npos || object.key.compare(0, prefix.size(), prefix) != 0 ||
+                object.key.size() == prefix.size()) {
+                continue;
+            }
+            std::string path = base + "/" + object.key;
+            if (path.back() == '/') {
+                addDir(listing, normalized(path));    // Folder marker of a console upload
+                continue;
+            }
+            std::string parent = path.substr(0, path.find_last_of('/'));
+            addDir(listing, parent);
+            NfsDirEntry entry;
+            entry.name = path.substr(parent.size() + 1);
+            entry.isFile = true;
+            entry.size = object.size;
+            entry.mtime = object.mtime;
+            entry.inode = davEtagTag(object.etag);
+            entry.md5 = s3EtagMd5(object.etag);
+            m_tree[parent].push_back(std::move(entry));
+            listing.objects++;
+        }
+    }
+
+    std::string m_baseUrl;                // "http://host:port"
+    std::string m_host;
+    S3Credentials m_credentials;
+    bool m_flat;
+    std::map<std::string, std::vector<NfsDirEntry>> m_tree;   // Directories of flat listings
+    std::chrono::steady_clock::time_point m_treeTime;
+};
+
+} // namespace
+
+std::unique_ptr<NfsBackend> createS3Backend(bool https, const std::string& host, const S3Credentials& credentials,
+                                            std::string& error, bool flat, int maxConnections) {
+    if (host.empty()) {
+        error = "no host";
+        return nullptr;
+    }
+    return std::unique_ptr<NfsBackend>(new S3Backend(https, host, credentials, flat, maxConnections));
+}
@@ -0,0 +1,469 @@
+#include "scan_snapshot.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char SNAPSHOT_MAGIC[8] = {'F', 'D', 'S', 'N', 'A', 'P', '0', '2'};
+static const uint32_t SNAPSHOT_VERSION = 2;
+
+static uint64_t align8(uint64_t value) {
+    return (value + 7) & ~uint64_t(7);
+}
+
+// 64-bit streaming checksum (word-at-a-time multiply/rotate, xxHash-style mixing)
+class SnapshotChecksum {
+public:
+    void update(const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        m_total += len;
+        if (m_tailLen > 0) {
+            size_t take = std::min(len, sizeof(m_tail) - m_tailLen);
+            memcpy(m_tail + m_tailLen, p, take);
+            m_tailLen += take;
+            p += take;
+            len -= take;
+            if (m_tailLen < sizeof(m_tail)) return;
+            mixWord(m_tail);
+            m_tailLen = 0;
+        }
+        while (len >= 8) {
+            mixWord(p);
+            p += 8;
+            len -= 8;
+        }
+        if (len > 0) {
+            memcpy(m_tail, p, len);
+            m_tailLen = len;
+        }
+    }
+
+    uint64_t final() const {
+        uint64_t h = m_state;
+        for (size_t i = 0; i < m_tailLen; i++) {
+            h ^= uint64_t(m_tail[i]) * PRIME5;
+            h = rotl(h, 11) * PRIME1;
+        }
+        h ^= m_total;
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    void mixWord(const unsigned char* p) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        m_state ^= rotl(w * PRIME2, 31) * PRIME1;
+        m_state = rotl(m_state, 27) * PRIME1 + PRIME3;
+    }
+
+    uint64_t m_state = PRIME5;
+    unsigned char m_tail[8];
+    size_t m_tailLen = 0;
+    uint64_t m_total = 0;
+};
+
+// Buffered section writer that feeds the checksum on the way out
+class SnapshotOutput {
+public:
+    explicit SnapshotOutput(std::ofstream& file) : m_file(file) {}
+    void write(const void* data, size_t len) {
+        m_file.write(static_cast<const char*>(data), len);
+        m_checksum.update(data, len);
+        m_written += len;
+    }
+    void padTo(uint64_t offset) {
+        static const char zeros[8] = {0};
+        while (m_written < offset) {
+            size_t n = std::min<uint64_t>(sizeof(zeros), offset - m_written);
+            write(zeros, n);
+        }
+    }
+    uint64_t written() const { return m_written; }
+    uint64_t checksum() const { return m_checksum.final(); }
+    void setBase(uint64_t base) { m_written = base; }
+
+private:
+    std::ofstream& m_file;
+    SnapshotChecksum m_checksum;
+    uint64_t m_written = 0;
+};
+
+static void appendInt(std::string& out, int64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendString(std::string& out, const std::string& value) {
+    uint32_t len = value.size();
+    out.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    out.append(value);
+}
+
+static std::string encodeMeta(const ScanSnapshotMeta& meta) {
+    std::string out;
+    appendInt(out, meta.timestamp);
+    appendInt(out, meta.minFileSize);
+    appendInt(out, meta.scanHiddenFiles ? 1 : 0);
+    appendInt(out, meta.followSymlinks ? 1 : 0);
+    appendString(out, meta.hashAlgorithm);
+    appendInt(out, (int64_t)meta.localDirs.size());
+    for (const auto& dir : meta.localDirs) appendString(out, dir);
+    appendInt(out, (int64_t)meta.ftpDirs.size());
+    for (const auto& dir : meta.ftpDirs) appendString(out, dir);
+    appendInt(out, meta.connectedPresetIndex);
+    appendInt(out, meta.totalFiles);
+    appendInt(out, meta.duplicateFiles);
+    appendInt(out, meta.duplicateGroups);
+    appendInt(out, meta.totalSize);
+    appendInt(out, meta.duplicateSize);
+    return out;
+}
+
+bool writeScanSnapshot(const std::string& filename, const ScanSnapshotMeta& meta,
+                       const std::vector<ScanSnapshotGroup>& groups, std::string* error) {
+    auto fail = [&](const std::string& msg) {
+        if (error) *error = msg;
+        std::cerr << "[Snapshot] " << msg << std::endl;
+        return false;
+    };
+
+    uint64_t fileCount = 0;
+    uint64_t stringsSize = 0;
+    for (const auto& group : groups) {
+        fileCount += group.files.size();
+        stringsSize += group.hash.size();
+        for (const auto& file : group.files) stringsSize += file.size();
+    }
+    std::string metaBlock = encodeMeta(meta);
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.groupsOffset = align8(sizeof(SnapshotHeader));
+    header.groupCount = groups.size();
+    header.digestsOffset = header.groupsOffset + header.groupCount * sizeof(SnapshotGroupRecord);
+    header.filesOffset = header.digestsOffset + header.groupCount * sizeof(SnapshotStringRef);
+    header.fileCount = fileCount;
+    header.metaOffset = header.filesOffset + fileCount * sizeof(SnapshotStringRef);
+    header.metaSize = metaBlock.size();
+    header.stringsOffset = align8(header.metaOffset + header.metaSize);
+    header.stringsSize = stringsSize;
+    header.fileSize = header.stringsOffset + stringsSize;
+
+    std::string tmpName = filename + ".tmp";
+    // The buffer must outlive the stream: it is flushed when the stream closes
+    std::vector<char> ioBuffer(1 << 20);
+    std::ofstream file;
+    file.rdbuf()->pubsetbuf(ioBuffer.data(), ioBuffer.size());
+    file.open(tmpName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return fail("Cannot create " + tmpName);
+
+    // Placeholder header, rewritten with the checksum at the end
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    SnapshotOutput out(file);
+    out.setBase(sizeof(header));
+    out.padTo(header.groupsOffset);
+
+    // Group table
+    uint64_t nextFile = 0;
+    for (const auto& group : groups) {
+        SnapshotGroupRecord rec;
+        rec.size = group.size;
+        rec.firstFile = nextFile;
+        rec.fileCount = group.files.size();
+        rec.reserved = 0;
+        out.write(&rec, sizeof(rec));
+        nextFile += group.files.size();
+    }
+
+    // Digest column: hashes are stored first in the string table
+    uint64_t stringOffset = 0;
+    for (const auto& group : groups) {
+        SnapshotStringRef ref{stringOffset, (uint32_t)group.hash.size(), 0};
+        out.write(&ref, sizeof(ref));
+        stringOffset += group.hash.size();
+    }
+
+    // File column
+    for (const auto& group : groups) {
+        for (const auto& path : group.files) {
+            SnapshotStringRef ref{stringOffset, (uint32_t)path.size(), 0};
+            out.write(&ref, sizeof(ref));
+            stringOffset += path.size();
+        }
+    }
+
+    out.write(metaBlock.data(), metaBlock.size());
+    out.padTo(header.stringsOffset);
+
+    // String table
+    for (const auto& group : groups) {
+        out.write(group.hash.data(), group.hash.size());
+    }
+    for (const auto& group : groups) {
+        for (const auto& path : group.files) {
+            out.write(path.data(), path.size());
+        }
+    }
+
+    if (out.written() != header.fileSize) {
+        file.close();
+        std::remove(tmpName.c_str());
+        return fail("Internal size mismatch while writing " + filename);
+    }
+
+    header.checksum = out.checksum();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+    if (!file) {
+        std::remove(tmpName.c_str());
+        return fail("Write error on " + tmpName);
+    }
+    if (std::rename(tmpName.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpName.c_str());
+        return fail("Cannot rename " + tmpName + " to " + filename);
+    }
+
+    std::cout << "[Snapshot] Wrote " << groups.size() << " groups, " << fileCount << " files ("
+              << header.fileSize / 1024 << " KB) to " << filename << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Background writer
+// ============================================================================
+
+ScanSnapshotWriter::~ScanSnapshotWriter() {
+    wait();
+}
+
+void ScanSnapshotWriter::saveAsync(const std::string& filename, ScanSnapshotMeta meta, std::vector<ScanSnapshotGroup> groups) {
+    wait();
+    m_busy = true;
+    m_thread = std::thread([this, filename, meta = std::move(meta), groups = std::move(groups)]() {
+        std::string error;
+        bool ok = writeScanSnapshot(filename, meta, groups, &error);
+        {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            m_lastError = ok ? "" : error;
+        }
+        m_busy = false;
+    });
+}
+
+void ScanSnapshotWriter::wait() {
+    if (m_thread.joinable()) m_thread.join();
+}
+
+std::string ScanSnapshotWriter::lastError() {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_lastError;
+}
+
+// ============================================================================
+// mmap view
+// ============================================================================
+
+ScanSnapshotView::~ScanSnapshotView() {
+    close();
+}
+
+void ScanSnapshotView::close() {
+    if (m_data) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_groups = nullptr;
+    m_digests = nullptr;
+    m_files = nullptr;
+    m_strings = nullptr;
+    m_meta = ScanSnapshotMeta();
+    m_filename.clear();
+}
+
+bool ScanSnapshotView::isSnapshotFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[8];
+    if (!file.read(magic, sizeof(magic))) return false;
+    return memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+// Section [offset, offset + count * recordSize) lies inside the mapping (overflow-safe)
+static bool sectionFits(uint64_t offset, uint64_t count, uint64_t recordSize, uint64_t fileSize) {
+    if (offset > fileSize) return false;
+    if (recordSize != 0 && count > (fileSize - offset) / recordSize) return false;
+    return true;
+}
+
+bool ScanSnapshotView::open(const std::string& filename, bool verifyChecksum) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        m_error = "Cannot open " + filename + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        m_error = "File too small for a snapshot";
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // mapping stays valid
+    if (mapped == MAP_FAILED) {
+        m_error = std::string("mmap failed: ") + strerror(errno);
+        return false;
+    }
+    m_data = static_cast<const unsigned char*>(mapped);
+    m_size = st.st_size;
+    m_header = reinterpret_cast<const SnapshotHeader*>(m_data);
+
+    const SnapshotHeader& h = *m_header;
+    bool valid = memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) == 0 &&
+                 h.version == SNAPSHOT_VERSION &&
+                 h.headerSize == sizeof(SnapshotHeader) &&
+                 h.fileSize == m_size &&
+                 sectionFits(h.groupsOffset, h.groupCount, sizeof(SnapshotGroupRecord), m_size) &&
+                 sectionFits(h.digestsOffset, h.groupCount, sizeof(SnapshotStringRef), m_size) &&
+                 sectionFits(h.filesOffset, h.fileCount, sizeof(SnapshotStringRef), m_size) &&
+                 sectionFits(h.metaOffset, h.metaSize, 1, m_size) &&
+                 sectionFits(h.stringsOffset, h.stringsSize, 1, m_size);
+    if (!valid) {
+        m_error = "Invalid or unsupported snapshot header";
+        close();
+        return false;
+    }
+
+    if (verifyChecksum) {
+        madvise(const_cast<unsigned char*>(m_data), m_size, MADV_SEQUENTIAL);
+        SnapshotChecksum checksum;
+        checksum.update(m_data + h.headerSize, m_size - h.headerSize);
+        madvise(const_cast<unsigned char*>(m_data), m_size, MADV_RANDOM);
+        if (checksum.final() != h.checksum) {
+            m_error = "Checksum mismatch - snapshot is corrupted or truncated";
+            close();
+            return false;
+        }
+    }
+
+    m_groups = reinterpret_cast<const SnapshotGroupRecord*>(m_data + h.groupsOffset);
+    m_digests = reinterpret_cast<const SnapshotStringRef*>(m_data + h.digestsOffset);
+    m_files = reinterpret_cast<const SnapshotStringRef*>(m_data + h.filesOffset);
+    m_strings = reinterpret_cast<const char*>(m_data + h.stringsOffset);
+
+    if (!parseMeta()) {
+        m_error = "Corrupted meta block";
+        close();
+        return false;
+    }
+
+    m_filename = filename;
+    m_error.clear();
+    return true;
+}
+
+bool ScanSnapshotView::parseMeta() {
+    const char* p = reinterpret_cast<const char*>(m_data + m_header->metaOffset);
+    const char* end = p + m_header->metaSize;
+
+    auto readInt = [&](int64_t& value) {
+        if (end - p < (ptrdiff_t)sizeof(value)) return false;
+        memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        return true;
+    };
+    auto readString = [&](std::string& value) {
+        uint32_t len;
+        if (end - p < (ptrdiff_t)sizeof(len)) return false;
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        if (end - p < (ptrdiff_t)len) return false;
+        value.assign(p, len);
+        p += len;
+        return true;
+    };
+    auto readList = [&](std::vector<std::string>& list) {
+        int64_t count;
+        if (!readInt(count) || count < 0 || count > end - p) return false;
+        list.resize(count);
+        for (auto& item : list) {
+            if (!readString(item)) return false;
+        }
+        return true;
+    };
+
+    int64_t hidden = 1, symlinks = 1;
+    return readInt(m_meta.timestamp) && readInt(m_meta.minFileSize) &&
+           readInt(hidden) && readInt(symlinks) &&
+           (m_meta.scanHiddenFiles = (hidden != 0), m_meta.followSymlinks = (symlinks != 0), true) &&
+           readString(m_meta.hashAlgorithm) &&
+           readList(m_meta.localDirs) && readList(m_meta.ftpDirs) &&
+           readInt(m_meta.connectedPresetIndex) && readInt(m_meta.totalFiles) &&
+           readInt(m_meta.duplicateFiles) && readInt(m_meta.duplicateGroups) &&
+           readInt(m_meta.totalSize) && readInt(m_meta.duplicateSize);
+}
+
+std::string_view ScanSnapshotView::stringAt(const SnapshotStringRef& ref) const {
+    if (ref.offset > m_header->stringsSize || ref.length > m_header->stringsSize - ref.offset) {
+        return std::string_view();
+    }
+    return std::string_view(m_strings + ref.offset, ref.length);
+}
+
+long long ScanSnapshotView::groupSize(uint64_t group) const {
+    if (!m_data || group >= m_header->groupCount) return 0;
+    return m_groups[group].size;
+}
+
+uint32_t ScanSnapshotView::groupFileCount(uint64_t group) const {
+    if (!m_data || group >= m_header->groupCount) return 0;
+    const SnapshotGroupRecord& rec = m_groups[group];
+    if (rec.firstFile > m_header->fileCount || rec.fileCount > m_header->fileCount - rec.firstFile) return 0;
+    return rec.fileCount;
+}
+
+std::string_view ScanSnapshotView::groupHash(uint64_t group) const {
+    if (!m_data || group >= m_header->groupCount) return std::string_view();
+    return stringAt(m_digests[group]);
+}
+
+std::string_view ScanSnapshotView::groupFile(uint64_t group, uint32_t index) const {
+    if (index >= groupFileCount(group)) return std::string_view();
+    return stringAt(m_files[m_groups[group].firstFile + index]);
+}
+
+ScanSnapshotGroup ScanSnapshotView::loadGroup(uint64_t group) const {
+    ScanSnapshotGroup result;
+    result.hash = std::string(groupHash(group));
+    result.size = groupSize(group);
+    uint32_t count = groupFileCount(group);
+    result.files.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        result.files.emplace_back(groupFile(group, i));
+    }
+    return result;
+}
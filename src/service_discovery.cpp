@@ -0,0 +1,502 @@
+#include "service_discovery.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <unistd.h>
+#include <poll.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+static const uint16_t DNS_TYPE_A = 1;
+static const uint16_t DNS_TYPE_PTR = 12;
+static const uint16_t DNS_TYPE_TXT = 16;
+static const uint16_t DNS_TYPE_SRV = 33;
+static const int QUERY_BURST_MS[] = {0, 1000, 3000};   // RFC 6762 5.2: intervals at least doubling
+
+static std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+static uint16_t read16(const uint8_t* p) { return (uint16_t)(p[0] << 8 | p[1]); }
+static uint32_t read32(const uint8_t* p) { return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]; }
+
+// DNS name at offset (with compression pointers); offset moves past the name as stored
+static bool readName(const uint8_t* packet, size_t length, size_t& offset, std::string& name) {
+    name.clear();
+    size_t pos = offset;
+    bool jumped = false;
+    int jumps = 0;
+    while (pos < length) {
+        uint8_t labelLength = packet[pos];
+        if (labelLength == 0) {
+            if (!jumped) offset = pos + 1;
+            return true;
+        }
+        if ((labelLength & 0xC0) == 0xC0) {
+            if (pos + 1 >= length || ++jumps > 32) return false;
+            if (!jumped) offset = pos + 2;
+            jumped = true;
+            pos = (size_t)(labelLength & 0x3F) << 8 | packet[pos + 1];
+            continue;
+        }
+        if ((labelLength & 0xC0) != 0 || pos + 1 + labelLength > length) return false;
+        if (!name.empty()) name += '.';
+        name.append((const char*)packet + pos + 1, labelLength);
+        if (name.size() > 255) return false;
+        pos += 1 + labelLength;
+    }
+    return false;
+}
+
+static void appendName(std::vector<uint8_t>& packet, const std::string& name) {
+    std::istringstream labels(name);
+    std::string label;
+    while (std::getline(labels, label, '.')) {
+        if (label.empty() || label.size() > 63) continue;
+        packet.push_back((uint8_t)label.size());
+        packet.insert(packet.end(), label.begin(), label.end());
+    }
+    packet.push_back(0);
+}
+
+std::string serviceTypeLabel(const std::string& serviceType) {
+    static const std::map<std::string, std::string> labels = {
+        {"_smb._tcp", "SMB"}, {"_nfs._tcp", "NFS"}, {"_ftp._tcp", "FTP"},
+        {"_sftp-ssh._tcp", "SFTP"}, {"_webdav._tcp", "WebDAV"}, {"_webdavs._tcp", "WebDAVS"}
+    };
+    auto it = labels.find(serviceType);
+    return it != labels.end() ? it->second : serviceType;
+}
+
+std::vector<uint8_t> ServiceDiscoveryBrowser::buildMdnsQuery(const std::vector<std::string>& serviceTypes) {
+    std::vector<uint8_t> packet(12, 0);
+    packet[4] = (uint8_t)(serviceTypes.size() >> 8);
+    packet[5] = (uint8_t)serviceTypes.size();
+    for (const auto& type : serviceTypes) {
+        appendName(packet, type + ".local");
+        packet.insert(packet.end(), {0, DNS_TYPE_PTR, 0, 1});
+    }
+    return packet;
+}
+
+ServiceDiscoveryBrowser::~ServiceDiscoveryBrowser() {
+    stop();
+}
+
+// UDP socket for a multicast group (joined on every multicast interface) or, for a unicast
+// address (tests, single responder), an ephemeral socket that sends there directly
+static int openDiscoverySocket(const std::string& groupText, int port, int ttl, const std::vector<uint32_t>& interfaces, int& localPort) {
+    struct in_addr group;
+    if (inet_pton(AF_INET, groupText.c_str(), &group) != 1) return -1;
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    bool multicast = IN_MULTICAST(ntohl(group.s_addr));
+    if (multicast) {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+        local.sin_port = htons(port);
+        if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+            // Port taken exclusively (another responder): unicast answers to an ephemeral port still work
+            std::cerr << "[Discovery] Port " << port << " busy (" << strerror(errno) << "), passive listening disabled" << std::endl;
+            local.sin_port = 0;
+            if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) { close(fd); return -1; }
+        } else {
+            std::vector<uint32_t> joinOn = interfaces.empty() ? std::vector<uint32_t>{htonl(INADDR_ANY)} : interfaces;
+            for (uint32_t address : joinOn) {
+                struct ip_mreq membership = {};
+                membership.imr_multiaddr = group;
+                membership.imr_interface.s_addr = address;
+                setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership));
+            }
+        }
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        int loop = 1;   // Services announced by this machine
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    } else if (bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+        close(fd);
+        return -1;
+    }
+    socklen_t length = sizeof(local);
+    getsockname(fd, (struct sockaddr*)&local, &length);
+    localPort = ntohs(local.sin_port);
+    return fd;
+}
+
+bool ServiceDiscoveryBrowser::start(const ServiceDiscoveryOptions& options) {
+    if (m_running) return true;
+    m_options = options;
+
+    m_interfaces.clear();
+    struct ifaddrs* addresses = nullptr;
+    if (getifaddrs(&addresses) == 0) {
+        for (struct ifaddrs* it = addresses; it; it = it->ifa_next) {
+            if (!it->ifa_addr || it->ifa_addr->sa_family != AF_INET) continue;
+            if (!(it->ifa_flags & IFF_UP) || !(it->ifa_flags & IFF_MULTICAST) || (it->ifa_flags & IFF_LOOPBACK)) continue;
+            m_interfaces.push_back(((struct sockaddr_in*)it->ifa_addr)->sin_addr.s_addr);
+        }
+        freeifaddrs(addresses);
+    }
+
+    if (m_options.useMdns) m_mdnsSocket = openDiscoverySocket(m_options.mdnsGroup, m_options.mdnsPort, 255, m_interfaces, m_mdnsLocalPort);
+    if (m_options.useSsdp) m_ssdpSocket = openDiscoverySocket(m_options.ssdpGroup, m_options.ssdpPort, 4, m_interfaces, m_ssdpLocalPort);
+    if (m_mdnsSocket < 0 && m_ssdpSocket < 0) {
+        std::cerr << "[Discovery] No mDNS/SSDP socket available" << std::endl;
+        return false;
+    }
+
+    m_stopping = false;
+    m_queryNow = false;
+    m_running = true;
+    m_thread = std::thread([this]() { listenLoop(); });
+    std::cout << "[Discovery] Browsing " << m_options.serviceTypes.size() << " DNS-SD service types"
+              << (m_ssdpSocket >= 0 ? " + SSDP" : "") << " on " << m_interfaces.size() << " interfaces" << std::endl;
+    return true;
+}
+
+void ServiceDiscoveryBrowser::stop() {
+    if (!m_running) return;
+    m_stopping = true;
+    if (m_thread.joinable()) m_thread.join();
+    if (m_mdnsSocket >= 0) close(m_mdnsSocket);
+    if (m_ssdpSocket >= 0) close(m_ssdpSocket);
+    m_mdnsSocket = m_ssdpSocket = -1;
+    m_running = false;
+}
+
+static void sendToGroup(int fd, const std::string& groupText, int port, const std::vector<uint32_t>& interfaces, const void* data, size_t length) {
+    struct sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+    inet_pton(AF_INET, groupText.c_str(), &target.sin_addr);
+    if (!IN_MULTICAST(ntohl(target.sin_addr.s_addr)) || interfaces.empty()) {
+        sendto(fd, data, length, 0, (struct sockaddr*)&target, sizeof(target));
+        return;
+    }
+    for (uint32_t address : interfaces) {
+        struct in_addr outgoing;
+        outgoing.s_addr = address;
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &outgoing, sizeof(outgoing));
+        sendto(fd, data, length, 0, (struct sockaddr*)&target, sizeof(target));
+    }
+}
+
+void ServiceDiscoveryBrowser::sendQueries() {
+    if (m_mdnsSocket >= 0) {
+        std::vector<uint8_t> query = buildMdnsQuery(m_options.serviceTypes);
+        sendToGroup(m_mdnsSocket, m_options.mdnsGroup, m_options.mdnsPort, m_interfaces, query.data(), query.size());
+    }
+    if (m_ssdpSocket >= 0) {
+        std::string search = "M-SEARCH * HTTP/1.1\r\nHOST: " + m_options.ssdpGroup + ":" + std::to_string(m_options.ssdpPort) +
+                             "\r\nMAN: \"ssdp:discover\"\r\nMX: 2\r\nST: ssdp:all\r\n\r\n";
+        sendToGroup(m_ssdpSocket, m_options.ssdpGroup, m_options.ssdpPort, m_interfaces, search.data(), search.size());
+    }
+}
+
+void ServiceDiscoveryBrowser::listenLoop() {
+    using Clock = std::chrono::steady_clock;
+    auto burstStart = Clock::now();
+    size_t burstIndex = 0;
+    auto nextQuery = burstStart;
+    auto nextExpiry = burstStart + std::chrono::seconds(1);
+    uint8_t buffer[9000];   // Largest mDNS message (RFC 6762 17)
+
+    while (!m_stopping) {
+        auto now = Clock::now();
+        if (m_queryNow.exchange(false)) {
+            burstStart = now;
+            burstIndex = 0;
+        }
+        if (burstIndex < 3) {
+            if (now >= burstStart + std::chrono::milliseconds(QUERY_BURST_MS[burstIndex])) {
+                sendQueries();
+                if (++burstIndex == 3) nextQuery = now + std::chrono::seconds(m_options.queryIntervalSeconds);
+            }
+        } else if (m_options.queryIntervalSeconds > 0 && now >= nextQuery) {
+            sendQueries();
+            nextQuery = now + std::chrono::seconds(m_options.queryIntervalSeconds);
+        }
+        if (now >= nextExpiry) {
+            expireServices();
+            nextExpiry = now + std::chrono::seconds(1);
+        }
+
+        struct pollfd fds[2] = {{m_mdnsSocket, POLLIN, 0}, {m_ssdpSocket, POLLIN, 0}};
+        if (poll(fds, 2, 100) <= 0) continue;
+        for (int i = 0; i < 2; i++) {
+            if (!(fds[i].revents & POLLIN)) continue;
+            while (true) {
+                struct sockaddr_in from = {};
+                socklen_t fromLength = sizeof(from);
+                ssize_t n = recvfrom(fds[i].fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+                if (n <= 0) break;
+                char address[INET_ADDRSTRLEN];
+                inet_ntop(AF_INET, &from.sin_addr, address, sizeof(address));
+                if (i == 0) handleMdnsPacket(buffer, (size_t)n, address);
+                else handleSsdpPacket((const char*)buffer, (size_t)n, address);
+            }
+        }
+    }
+}
+
+void ServiceDiscoveryBrowser::handleMdnsPacket(const uint8_t* data, size_t length, const std::string& from) {
+    if (length < 12 || !(data[2] & 0x80)) return;   // Queries (ours included) carry no answers for us
+    size_t questions = read16(data + 4);
+    size_t records = (size_t)read16(data + 6) + read16(data + 8) + read16(data + 10);
+
+    size_t offset = 12;
+    std::string name;
+    for (size_t i = 0; i < questions; i++) {
+        if (!readName(data, length, offset, name) || offset + 4 > length) return;
+        offset += 4;
+    }
+
+    struct Record {
+        std::string name;
+        uint16_t type;
+        uint32_t ttl;
+        size_t rdata;
+        uint16_t rdlength;
+    };
+    std::vector<Record> parsed;
+    for (size_t i = 0; i < records; i++) {
+        Record record;
+        if (!readName(data, length, offset, record.name) || offset + 10 > length) break;
+        record.type = read16(data + offset);
+        record.ttl = read32(data + offset + 4);
+        record.rdlength = read16(data + offset + 8);
+        record.rdata = offset + 10;
+        offset = record.rdata + record.rdlength;
+        if (offset > length) break;
+        record.name = lowercase(record.name);
+        parsed.push_back(record);
+    }
+
+    Events events;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        time_t now = time(nullptr);
+        std::set<std::string> touched;
+        // Instance of a browsed type: "nas._smb._tcp.local" -> "_smb._tcp"
+        auto browsedType = [this](const std::string& instance) -> std::string {
+            for (const auto& type : m_options.serviceTypes) {
+                std::string suffix = "." + lowercase(type) + ".local";
+                if (instance.size() > suffix.size() && instance.compare(instance.size() - suffix.size(), suffix.size(), suffix) == 0) return type;
+            }
+            return "";
+        };
+
+        // Addresses first: SRV targets in the same packet resolve right away
+        for (const auto& record : parsed) {
+            if (record.type != DNS_TYPE_A || record.rdlength != 4) continue;
+            char address[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, data + record.rdata, address, sizeof(address));
+            if (record.ttl == 0) m_hostAddresses.erase(record.name);
+            else m_hostAddresses[record.name] = address;
+        }
+        for (const auto& record : parsed) {
+            if (record.type == DNS_TYPE_PTR) {
+                size_t rdata = record.rdata;
+                std::string instanceName;
+                if (!readName(data, length, rdata, instanceName)) continue;
+                std::string key = lowercase(instanceName);
+                std::string type = browsedType(key);
+                if (type.empty() || record.name != lowercase(type) + ".local") continue;
+                if (record.ttl == 0) {   // Goodbye
+                    m_instances.erase(key);
+                    withdraw(key, events);
+                    continue;
+                }
+                Instance& instance = m_instances[key];
+                instance.name = instanceName.substr(0, instanceName.size() - type.size() - 7);
+                instance.type = type;
+                instance.expires = now + record.ttl;
+                instance.from = from;
+                touched.insert(key);
+            } else if (record.type == DNS_TYPE_SRV && record.rdlength >= 7) {
+                std::string type = browsedType(record.name);
+                if (type.empty()) continue;
+                if (record.ttl == 0) {
+                    m_instances.erase(record.name);
+                    withdraw(record.name, events);
+                    continue;
+                }
+                size_t rdata = record.rdata + 6;
+                std::string target;
+                if (!readName(data, length, rdata, target)) continue;
+                Instance& instance = m_instances[record.name];
+                instance.type = type;
+                instance.port = read16(data + record.rdata + 4);
+                instance.host = lowercase(target);
+                instance.from = from;
+                if (instance.expires == 0) instance.expires = now + record.ttl;
+                touched.insert(record.name);
+            } else if (record.type == DNS_TYPE_TXT) {
+                if (browsedType(record.name).empty()) continue;
+                Instance& instance = m_instances[record.name];
+                instance.txt.clear();
+                for (size_t pos = record.rdata; pos < record.rdata + record.rdlength;) {
+                    size_t entryLength = data[pos];
+                    if (pos + 1 + entryLength > record.rdata + record.rdlength) break;
+                    std::string entry((const char*)data + pos + 1, entryLength);
+                    size_t equals = entry.find('=');
+                    if (!entry.empty()) instance.txt[lowercase(entry.substr(0, equals))] = equals == std::string::npos ? "" : entry.substr(equals + 1);
+                    pos += 1 + entryLength;
+                }
+                touched.insert(record.name);
+            }
+        }
+
+        for (const auto& key : touched) {
+            auto it = m_instances.find(key);
+            if (it == m_instances.end()) continue;
+            const Instance& instance = it->second;
+            if (instance.type.empty() || instance.port == 0) continue;   // SRV still missing
+            DiscoveredService service;
+            auto address = m_hostAddresses.find(instance.host);
+            service.ip = address != m_hostAddresses.end() ? address->second : instance.from;
+            service.hostname = instance.host;
+            service.name = instance.name.empty() ? key.substr(0, key.find('.')) : instance.name;
+            service.serviceType = instance.type;
+            service.port = instance.port;
+            service.txt = instance.txt;
+            auto path = instance.txt.find("path");
+            if (path != instance.txt.end()) service.path = path->second;
+            service.source = "mdns";
+            service.expires = instance.expires;
+            publish(key, service, events);
+        }
+    }
+    notify(events);
+}
+
+void ServiceDiscoveryBrowser::handleSsdpPacket(const char* data, size_t length, const std::string& from) {
+    std::istringstream message(std::string(data, length));
+    std::string line;
+    if (!std::getline(message, line)) return;
+    bool response = line.compare(0, 9, "HTTP/1.1 ") == 0 && line.find(" 200") != std::string::npos;
+    bool announcement = line.compare(0, 7, "NOTIFY ") == 0;
+    if (!response && !announcement) return;   // M-SEARCH from others (or our own)
+
+    std::map<std::string, std::string> headers;
+    while (std::getline(message, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        headers[lowercase(line.substr(0, colon))] = value;
+    }
+    std::string type = response ? headers["st"] : headers["nt"];
+    std::string usn = headers["usn"].empty() ? from + " " + type : headers["usn"];
+    std::string key = "ssdp:" + usn;
+
+    Events events;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (lowercase(headers["nts"]) == "ssdp:byebye") {
+            withdraw(key, events);
+        } else {
+            std::string haystack = lowercase(type + " " + headers["server"]);
+            bool wanted = m_options.ssdpFilters.empty();
+            for (const auto& filter : m_options.ssdpFilters) {
+                if (haystack.find(lowercase(filter)) != std::string::npos) wanted = true;
+            }
+            if (!wanted || type.empty()) return;
+
+            DiscoveredService service;
+            service.ip = from;
+            service.hostname = headers["server"];
+            service.name = usn;
+            service.serviceType = type;
+            service.path = headers["location"];
+            service.port = 80;
+            size_t scheme = service.path.find("://");
+            if (scheme != std::string::npos) {
+                size_t hostEnd = service.path.find_first_of(":/", scheme + 3);
+                if (hostEnd != std::string::npos && service.path[hostEnd] == ':') service.port = std::atoi(service.path.c_str() + hostEnd + 1);
+            }
+            int maxAge = 1800;
+            size_t maxAgePos = lowercase(headers["cache-control"]).find("max-age");
+            if (maxAgePos != std::string::npos) {
+                size_t equals = headers["cache-control"].find('=', maxAgePos);
+                if (equals != std::string::npos) maxAge = std::max(1, std::atoi(headers["cache-control"].c_str() + equals + 1));
+            }
+            service.source = "ssdp";
+            service.expires = time(nullptr) + maxAge;
+            publish(key, service, events);
+        }
+    }
+    notify(events);
+}
+
+void ServiceDiscoveryBrowser::publish(const std::string& key, const DiscoveredService& service, Events& events) {
+    auto it = m_services.find(key);
+    bool changed = it == m_services.end() || it->second.ip != service.ip || it->second.port != service.port ||
+                   it->second.path != service.path || it->second.hostname != service.hostname || it->second.txt != service.txt;
+    m_services[key] = service;   // Refreshes expiry either way
+    if (changed) events.emplace_back(service, false);
+}
+
+void ServiceDiscoveryBrowser::withdraw(const std::string& key, Events& events) {
+    auto it = m_services.find(key);
+    if (it == m_services.end()) return;
+    events.emplace_back(it->second, true);
+    m_services.erase(it);
+}
+
+void ServiceDiscoveryBrowser::notify(const Events& events) {
+    if (events.empty()) return;
+    std::function<void(const DiscoveredService&, bool)> callback;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        callback = m_callback;
+    }
+    for (const auto& [service, removed] : events) {
+        std::cout << "[Discovery] " << (removed ? "Gone: " : "") << service.ip << ":" << service.port << " "
+                  << serviceTypeLabel(service.serviceType) << " \"" << service.name << "\" (" << service.source << ")" << std::endl;
+        if (callback) callback(service, removed);
+    }
+}
+
+void ServiceDiscoveryBrowser::expireServices() {
+    Events events;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        time_t now = time(nullptr);
+        for (auto it = m_services.begin(); it != m_services.end();) {
+            if (it->second.expires > now) { ++it; continue; }
+            events.emplace_back(it->second, true);
+            m_instances.erase(it->first);
+            it = m_services.erase(it);
+        }
+    }
+    notify(events);
+}
+
+std::vector<DiscoveredService> ServiceDiscoveryBrowser::services() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<DiscoveredService> result;
+    for (const auto& [key, service] : m_services) result.push_back(service);
+    return result;
+}
+
+void ServiceDiscoveryBrowser::setCallback(std::function<void(const DiscoveredService&, bool removed)> callback) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callback = std::move(callback);
+}
@@ -1 +1,315 @@
 #include "sftpclient.h"
+#include <algorithm>
+#include <iostream>
+#include <deque>
+#include <vector>
+#include <fcntl.h>
+#ifdef WITH_LIBSSH
+#include <libssh/libssh.h>
+#include <libssh/sftp.h>
+#endif
+
+bool isSftpUrl(const std::string& path) {
+    return path.compare(0, 7, "sftp://") == 0;
+}
+
+std::string sftpUrl(const std::string& host, int port, const std::string& path) {
+    std::string url = "sftp://" + host + ":" + std::to_string(port);
+    if (path.empty() || path.front() != '/') url += "/";
+    return url + path;
+}
+
+bool parseSftpUrl(const std::string& url, std::string& host, int& port, std::string& path) {
+    if (!isSftpUrl(url)) return false;
+    size_t slash = url.find('/', 7);
+    std::string authority = url.substr(7, slash == std::string::npos ? std::string::npos : slash - 7);
+    size_t colon = authority.rfind(':');
+    port = 22;
+    if (colon != std::string::npos) {
+        try {
+            port = std::stoi(authority.substr(colon + 1));
+        } catch (...) {
+            return false;
+        }
+        authority.resize(colon);
+    }
+    host = authority;
+    path = slash == std::string::npos ? "/" : url.substr(slash);
+    return !host.empty() && port > 0 && port < 65536;
+}
+
+bool isLibsshAvailable() {
+#ifdef WITH_LIBSSH
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef WITH_LIBSSH
+namespace {
+
+class SftpBackend : public NfsBackend {
+public:
+    SftpBackend(ssh_session ssh, sftp_session sftp) : m_ssh(ssh), m_sftp(sftp) {}
+    ~SftpBackend() override {
+        sftp_free(m_sftp);
+        ssh_disconnect(m_ssh);
+        ssh_free(m_ssh);
+    }
+
+    bool readdirplus(const std::string& path, DirCallback cb) override {
+        Request request;
+        request.kind = Request::Dir;
+        request.path = path;
+        request.dirCb = std::move(cb);
+        m_queue.push_back(std::move(request));
+        return true;
+    }
+
+    bool open(const std::string& path, OpenCallback cb) override {
+        Request request;
+        request.kind = Request::Open;
+        request.path = path;
+        request.openCb = std::move(cb);
+        m_queue.push_back(std::move(request));
+        return true;
+    }
+
+    bool pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) override {
+        // Sent now, collected in service() - the server works on all of them meanwhile
+        sftp_file file = (sftp_file)handle;
+        if (sftp_seek64(file, offset) < 0) return false;
+        int id = sftp_async_read_begin(file, (uint32_t)count);
+        if (id < 0) return false;
+        Request request;
+        request.kind = Request::Read;
+        request.file = file;
+        request.id = (uint32_t)id;
+        request.count = count;
+        request.readCb = std::move(cb);
+        m_queue.push_back(std::move(request));
+        return true;
+    }
+
+    void close(void* handle) override {
+        sftp_close((sftp_file)handle);
+    }
+
+    bool service(int) override {
+        if (!ssh_is_connected(m_ssh)) return false;
+        if (m_queue.empty()) return true;
+        Request request = std::move(m_queue.front());
+        m_queue.pop_front();
+
+        if (request.kind == Request::Dir) {
+            std::vector<NfsDirEntry> entries;
+            sftp_dir dir = sftp_opendir(m_sftp, request.path.c_str());
+            if (!dir) {
+                request.dirCb(-1, {});
+                return ssh_is_connected(m_ssh);
+            }
+            while (sftp_attributes attributes = sftp_readdir(m_sftp, dir)) {
+                NfsDirEntry entry;
+                entry.name = attributes->name ? attributes->name : "";
+                entry.isDir = attributes->type == SSH_FILEXFER_TYPE_DIRECTORY;
+                entry.isFile = attributes->type == SSH_FILEXFER_TYPE_REGULAR;
+                entry.size = attributes->size;
+                entry.mtime = attributes->mtime64 ? (int64_t)attributes->mtime64 : (int64_t)attributes->mtime;
+                sftp_attributes_free(attributes);
+                entries.push_back(std::move(entry));
+            }
+            bool complete = sftp_dir_eof(dir);
+            sftp_closedir(dir);
+            request.dirCb(complete ? 0 : -1, std::move(entries));
+        } else if (request.kind == Request::Open) {
+            sftp_file file = sftp_open(m_sftp, request.path.c_str(), O_RDONLY, 0);
+            request.openCb(file ? 0 : -1, file);
+        } else {
+            m_buffer.resize(request.count);
+            int len = sftp_async_read(request.file, m_buffer.data(), (uint32_t)request.count, request.id);
+            if (len < 0) request.readCb(-1, nullptr, 0);
+            else request.readCb(len, m_buffer.data(), (size_t)len);
+        }
+        return ssh_is_connected(m_ssh);
+    }
+
+    bool unlink(const std::string& path, std::string& error) override {
+        if (sftp_unlink(m_sftp, path.c_str()) == 0) return true;
+        error = ssh_get_error(m_ssh);
+        return false;
+    }
+
+    std::string lastError() const override {
+        return ssh_get_error(m_ssh);
+    }
+
+private:
+    struct Request {
+        enum Kind { Dir, Open, Read } kind = Dir;
+        std::string path;
+        sftp_file file = nullptr;
+        uint32_t id = 0;
+        size_t count = 0;
+        DirCallback dirCb;
+        OpenCallback openCb;
+        ReadCallback readCb;
+    };
+
+    ssh_session m_ssh;
+    sftp_session m_sftp;
+    std::deque<Request> m_queue;          // Answered in the order sent
+    std::vector<char> m_buffer;
+};
+
+bool verifyHost(ssh_session ssh, const std::string& host, std::string& error) {
+    switch (ssh_session_is_known_server(ssh)) {
+    case SSH_KNOWN_HOSTS_OK:
+        return true;
+    case SSH_KNOWN_HOSTS_UNKNOWN:
+    case SSH_KNOWN_HOSTS_NOT_FOUND:
+        // Trust on first use, like ssh with StrictHostKeyChecking=accept-new
+        std::cout << "[SFTP] New host key for " << host << " - added to known_hosts" << std::endl;
+        ssh_session_update_known_hosts(ssh);
+        return true;
+    case SSH_KNOWN_HOSTS_CHANGED:
+    case SSH_KNOWN_HOSTS_OTHER:
+        error = "host key of " + host + " changed - refusing to connect";
+        return false;
+    default:
+        error = ssh_get_error(ssh);
+        return false;
+    }
+}
+
+// Connected and authenticated session (password, or keys/agent without one)
+ssh_session openSshSession(const std::string& host, int port, const std::string& user,
+                           const std::string& password, std::string& error) {
+    ssh_session ssh = ssh_new();
+    if (!ssh) {
+        error = "ssh_new failed";
+        return nullptr;
+    }
+    long timeout = 10;
+    ssh_options_set(ssh, SSH_OPTIONS_HOST, host.c_str());
+    ssh_options_set(ssh, SSH_OPTIONS_PORT, &port);
+    ssh_options_set(ssh, SSH_OPTIONS_TIMEOUT, &timeout);
+    if (!user.empty()) ssh_options_set(ssh, SSH_OPTIONS_USER, user.c_str());
+
+    bool ok = ssh_connect(ssh) == SSH_OK;
+    if (!ok) error = ssh_get_error(ssh);
+    if (ok) ok = verifyHost(ssh, host, error);
+    if (ok) {
+        int auth = password.empty() ? ssh_userauth_publickey_auto(ssh, nullptr, nullptr)
+                                    : ssh_userauth_password(ssh, nullptr, password.c_str());
+        ok = auth == SSH_AUTH_SUCCESS;
+        if (!ok) error = std::string("authentication failed: ") + ssh_get_error(ssh);
+    }
+    if (!ok) {
+        ssh_disconnect(ssh);
+        ssh_free(ssh);
+        return nullptr;
+    }
+    return ssh;
+}
+
+// One exec channel per command on a shared session. Output is read while stdin is written in
+// slices, so a command answering early cannot fill the window and stall the write.
+class LibsshRunner : public SshCommandRunner {
+public:
+    explicit LibsshRunner(ssh_session ssh) : m_ssh(ssh) {}
+    ~LibsshRunner() override {
+        ssh_disconnect(m_ssh);
+        ssh_free(m_ssh);
+    }
+
+    bool run(const std::string& command, const std::string& input,
+             const std::function<void(const char*, size_t)>& onOutput, int& exitStatus, std::string& error) override {
+        exitStatus = -1;
+        ssh_channel channel = ssh_channel_new(m_ssh);
+        if (!channel) {
+            error = ssh_get_error(m_ssh);
+            return false;
+        }
+        if (ssh_channel_open_session(channel) != SSH_OK || ssh_channel_request_exec(channel, command.c_str()) != SSH_OK) {
+            error = ssh_get_error(m_ssh);
+            ssh_channel_free(channel);
+            return false;
+        }
+
+        char buffer[65536];
+        auto drain = [&](int timeoutMs) {
+            for (int is_stderr = 0; is_stderr < 2; is_stderr++) {
+                int n;
+                while ((n = ssh_channel_read_timeout(channel, buffer, sizeof(buffer), is_stderr, timeoutMs)) > 0) {
+                    if (!is_stderr) onOutput(buffer, (size_t)n);
+                    else if (error.size() < 4096) error.append(buffer, (size_t)n);
+                    timeoutMs = 0;
+                }
+            }
+        };
+        bool ok = true;
+        for (size_t written = 0; ok && written < input.size();) {
+            size_t slice = std::min<size_t>(32768, input.size() - written);
+            int n = ssh_channel_write(channel, input.data() + written, (uint32_t)slice);
+            if (n < 0) ok = false;
+            else written += (size_t)n;
+            drain(0);
+        }
+        if (ok) ssh_channel_send_eof(channel);
+        while (ok && !ssh_channel_is_eof(channel) && ssh_channel_is_open(channel)) drain(1000);
+        drain(0);
+
+        if (ok) exitStatus = ssh_channel_get_exit_status(channel);
+        else error = ssh_get_error(m_ssh);
+        ssh_channel_close(channel);
+        ssh_channel_free(channel);
+        return ok && exitStatus == 0;
+    }
+
+private:
+    ssh_session m_ssh;
+};
+
+} // namespace
+#endif
+
+std::unique_ptr<NfsBackend> createSftpBackend(const std::string& host, int port, const std::string& user,
+                                              const std::string& password, std::string& error) {
+#ifdef WITH_LIBSSH
+    ssh_session ssh = openSshSession(host, port, user, password, error);
+    if (!ssh) return nullptr;
+    sftp_session sftp = sftp_new(ssh);
+    if (!sftp || sftp_init(sftp) != SSH_OK) {
+        error = ssh_get_error(ssh);
+        if (sftp) sftp_free(sftp);
+        ssh_disconnect(ssh);
+        ssh_free(ssh);
+        return nullptr;
+    }
+    return std::unique_ptr<NfsBackend>(new SftpBackend(ssh, sftp));
+#else
+    (void)host;
+    (void)port;
+    (void)user;
+    (void)password;
+    error = "libssh not available (built without WITH_LIBSSH)";
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<SshCommandRunner> createLibsshRunner(const std::string& host, int port, const std::string& user,
+                                                     const std::string& password, std::string& error) {
+#ifdef WITH_LIBSSH
+    ssh_session ssh = openSshSession(host, port, user, password, error);
+    if (!ssh) return nullptr;
+    return std::unique_ptr<SshCommandRunner>(new LibsshRunner(ssh));
+#else
+    (void)host;
+    (void)port;
+    (void)user;
+    (void)password;
+    error = "libssh not available (built without WITH_LIBSSH)";
+    return nullptr;
+#endif
+}
@@ -1 +1,206 @@
 #include "smbclient.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#include <vector>
+#ifdef HAVE_LIBSMB2
+#include <smb2/smb2.h>
+#include <smb2/libsmb2.h>
+#endif
+
+bool isSmbUrl(const std::string& path) {
+    return path.compare(0, 6, "smb://") == 0;
+}
+
+std::string smbUrl(const std::string& server, const std::string& share, const std::string& path) {
+    if (path.empty() || path == "/") return "smb://" + server + "/" + share;
+    if (path.front() != '/') return "smb://" + server + "/" + share + "/" + path;
+    return "smb://" + server + "/" + share + path;
+}
+
+bool parseSmbUrl(const std::string& url, std::string& server, std::string& share, std::string& path) {
+    if (!isSmbUrl(url)) return false;
+    size_t shareStart = url.find('/', 6);
+    if (shareStart == std::string::npos) return false;
+    server = url.substr(6, shareStart - 6);
+    size_t pathStart = url.find('/', shareStart + 1);
+    share = url.substr(shareStart + 1, pathStart == std::string::npos ? std::string::npos : pathStart - shareStart - 1);
+    path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+    return !server.empty() && !share.empty();
+}
+
+bool parseSmbSharePath(const std::string& sharePath, std::string& server, std::string& share) {
+    size_t start = sharePath.find_first_not_of("/\\");
+    if (start == std::string::npos) return false;
+    size_t serverEnd = sharePath.find_first_of("/\\", start);
+    if (serverEnd == std::string::npos) return false;
+    size_t shareEnd = sharePath.find_first_of("/\\", serverEnd + 1);
+    server = sharePath.substr(start, serverEnd - start);
+    share = sharePath.substr(serverEnd + 1, shareEnd == std::string::npos ? std::string::npos : shareEnd - serverEnd - 1);
+    return !server.empty() && !share.empty();
+}
+
+bool isLibsmb2Available() {
+#ifdef HAVE_LIBSMB2
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_LIBSMB2
+namespace {
+
+// One smb2_context = one connection; libsmb2 keeps as many requests in flight as the server
+// grants credits. Paths are relative to the share without the leading '/'.
+class Libsmb2Backend : public NfsBackend {
+public:
+    explicit Libsmb2Backend(smb2_context* smb2) : m_smb2(smb2) {}
+    ~Libsmb2Backend() override {
+        // Outstanding requests are cancelled by smb2_destroy_context(); the engine is gone by now
+        m_closing = true;
+        smb2_disconnect_share(m_smb2);
+        smb2_destroy_context(m_smb2);
+    }
+
+    bool readdirplus(const std::string& path, DirCallback cb) override {
+        auto* request = new Request<DirCallback>{this, std::move(cb), {}};
+        if (smb2_opendir_async(m_smb2, sharePath(path), &Libsmb2Backend::onDir, request) != 0) {
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    bool open(const std::string& path, OpenCallback cb) override {
+        auto* request = new Request<OpenCallback>{this, std::move(cb), {}};
+        if (smb2_open_async(m_smb2, sharePath(path), O_RDONLY, &Libsmb2Backend::onOpen, request) != 0) {
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    bool pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) override {
+        // libsmb2 caps a read at the negotiated max read size - the engine asks for the rest
+        auto* request = new Request<ReadCallback>{this, std::move(cb), std::vector<uint8_t>(count)};
+        if (smb2_pread_async(m_smb2, (struct smb2fh*)handle, request->buffer.data(), (uint32_t)count, offset,
+                             &Libsmb2Backend::onRead, request) != 0) {
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    void close(void* handle) override {
+        smb2_close_async(m_smb2, (struct smb2fh*)handle, &Libsmb2Backend::onClose, nullptr);
+    }
+
+    bool service(int timeoutMs) override {
+        struct pollfd pfd;
+        pfd.fd = smb2_get_fd(m_smb2);
+        pfd.events = smb2_which_events(m_smb2);
+        pfd.revents = 0;
+        int rc = poll(&pfd, 1, timeoutMs);
+        if (rc < 0 && errno != EINTR) return false;
+        return smb2_service(m_smb2, rc > 0 ? pfd.revents : 0) >= 0;
+    }
+
+    bool unlink(const std::string& path, std::string& error) override {
+        if (smb2_unlink(m_smb2, sharePath(path)) == 0) return true;
+        error = smb2_get_error(m_smb2);
+        return false;
+    }
+
+    std::string lastError() const override {
+        const char* error = smb2_get_error(m_smb2);
+        return error ? error : "";
+    }
+
+private:
+    template <typename Callback>
+    struct Request {
+        Libsmb2Backend* owner;
+        Callback cb;
+        std::vector<uint8_t> buffer;
+    };
+
+    static const char* sharePath(const std::string& path) {
+        size_t skip = path.find_first_not_of('/');
+        return skip == std::string::npos ? "" : path.c_str() + skip;
+    }
+
+    static void onDir(struct smb2_context* smb2, int status, void* data, void* privateData) {
+        std::unique_ptr<Request<DirCallback>> request((Request<DirCallback>*)privateData);
+        if (request->owner->m_closing) return;
+        std::vector<NfsDirEntry> entries;
+        if (status >= 0) {
+            struct smb2dir* dir = (struct smb2dir*)data;
+            struct smb2dirent* entry;
+            while ((entry = smb2_readdir(smb2, dir)) != nullptr) {
+                NfsDirEntry out;
+                out.name = entry->name;
+                out.isDir = entry->st.smb2_type == SMB2_TYPE_DIRECTORY;
+                out.isFile = entry->st.smb2_type == SMB2_TYPE_FILE;
+                out.size = entry->st.smb2_size;
+                out.mtime = (int64_t)entry->st.smb2_mtime;
+                out.inode = entry->st.smb2_ino;
+                entries.push_back(std::move(out));
+            }
+            smb2_closedir(smb2, dir);
+        }
+        request->cb(status, std::move(entries));
+    }
+
+    static void onOpen(struct smb2_context*, int status, void* data, void* privateData) {
+        std::unique_ptr<Request<OpenCallback>> request((Request<OpenCallback>*)privateData);
+        if (request->owner->m_closing) return;
+        request->cb(status, status >= 0 ? data : nullptr);
+    }
+
+    static void onRead(struct smb2_context*, int status, void*, void* privateData) {
+        std::unique_ptr<Request<ReadCallback>> request((Request<ReadCallback>*)privateData);
+        if (request->owner->m_closing) return;
+        // status = bytes read into our buffer
+        if (status < 0) request->cb(status, nullptr, 0);
+        else request->cb(status, (const char*)request->buffer.data(), (size_t)status);
+    }
+
+    static void onClose(struct smb2_context*, int, void*, void*) {}
+
+    smb2_context* m_smb2;
+    bool m_closing = false;
+};
+
+} // namespace
+#endif
+
+std::unique_ptr<NfsBackend> createLibsmb2Backend(const std::string& server, const std::string& share,
+                                                 const std::string& user, const std::string& password,
+                                                 const std::string& domain, std::string& error) {
+#ifdef HAVE_LIBSMB2
+    struct smb2_context* smb2 = smb2_init_context();
+    if (!smb2) {
+        error = "smb2_init_context failed";
+        return nullptr;
+    }
+    smb2_set_security_mode(smb2, SMB2_NEGOTIATE_SIGNING_ENABLED);
+    if (!user.empty()) smb2_set_user(smb2, user.c_str());
+    if (!password.empty()) smb2_set_password(smb2, password.c_str());
+    if (!domain.empty()) smb2_set_domain(smb2, domain.c_str());
+    if (smb2_connect_share(smb2, server.c_str(), share.c_str(), user.empty() ? nullptr : user.c_str()) != 0) {
+        error = smb2_get_error(smb2);
+        smb2_destroy_context(smb2);
+        return nullptr;
+    }
+    return std::unique_ptr<NfsBackend>(new Libsmb2Backend(smb2));
+#else
+    (void)server;
+    (void)share;
+    (void)user;
+    (void)password;
+    (void)domain;
+    error = "libsmb2 not available (built without HAVE_LIBSMB2)";
+    return nullptr;
+#endif
+}
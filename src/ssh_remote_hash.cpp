@@ -0,0 +1,223 @@
+#include "ssh_remote_hash.h"
+#include <algorithm>
+#include <set>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+std::string sshDigestCommand() {
+    // Probe first: busybox and old coreutils have no -z
+    return "md5sum -z </dev/null >/dev/null 2>&1 || exit 126; xargs -0 -r md5sum -z --";
+}
+
+std::string sshSampleCommand(long long sampleBytes) {
+    std::string n = std::to_string(sampleBytes);
+    return "command -v md5sum >/dev/null || exit 127; xargs -0 -r sh -c 'for f do [ -r \"$f\" ] || continue; "
+           "h=$(head -c " + n + " -- \"$f\" | md5sum); t=$(tail -c " + n + " -- \"$f\" | md5sum); "
+           "printf \"%s %s %s\\0\" \"${h%% *}\" \"${t%% *}\" \"$f\"; done' sh";
+}
+
+static bool isMd5Hex(const std::string& text) {
+    return text.size() == 32 && text.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+
+void SshDigestParser::feed(const char* data, size_t len,
+                           const std::function<void(const std::string&, const std::string&)>& onRecord) {
+    m_pending.append(data, len);
+    size_t start = 0;
+    for (size_t end; (end = m_pending.find('\0', start)) != std::string::npos; start = end + 1) {
+        std::string record = m_pending.substr(start, end - start);
+        size_t first = record.find(' ');
+        if (first == std::string::npos) continue;
+        std::string key = record.substr(0, first);
+        std::string path;
+        if (m_samples) {
+            size_t second = record.find(' ', first + 1);
+            if (second == std::string::npos) continue;
+            std::string tail = record.substr(first + 1, second - first - 1);
+            path = record.substr(second + 1);
+            key = (isMd5Hex(key) && isMd5Hex(tail)) ? key + tail : "";
+        } else {
+            // md5sum: "hash  path" (text mode) or "hash *path" (binary mode)
+            if (record.size() < first + 2) continue;
+            path = record.substr(first + 2);
+            if (!isMd5Hex(key)) key.clear();
+        }
+        onRecord(path, key);
+    }
+    m_pending.erase(0, start);
+}
+
+// Runs the batches; false if the tools are missing or the connection failed
+static bool runBatches(SshCommandRunner& runner, const std::string& command, bool samples,
+                       const std::vector<std::string>& paths, size_t batchSize,
+                       const std::function<void(const std::string&, const std::string&)>& done,
+                       const std::atomic<bool>* stop) {
+    batchSize = std::max<size_t>(1, batchSize);
+    for (size_t begin = 0; begin < paths.size(); begin += batchSize) {
+        if (stop && *stop) return true;
+        size_t end = std::min(paths.size(), begin + batchSize);
+        std::string input;
+        std::set<std::string> open;
+        for (size_t i = begin; i < end; i++) {
+            input += paths[i];
+            input += '\0';
+            open.insert(paths[i]);
+        }
+
+        SshDigestParser parser(samples);
+        int status = -1;
+        std::string error;
+        runner.run(command, input, [&](const char* data, size_t len) {
+            parser.feed(data, len, [&](const std::string& path, const std::string& key) {
+                if (open.erase(path)) done(path, key);
+            });
+        }, status, error);
+
+        // ssh: 255 = connection failed; 126/127 = tool missing or too old (probe, xargs)
+        if (status < 0 || status == 255 || status == 126 || status == 127) return false;
+        for (const auto& path : open) done(path, "");    // Not readable on the server
+    }
+    return true;
+}
+
+bool sshRemoteDigests(SshCommandRunner& runner, const std::vector<std::string>& paths, size_t batchSize,
+                      const std::function<void(const std::string&, const std::string&)>& done,
+                      const std::atomic<bool>* stop) {
+    return runBatches(runner, sshDigestCommand(), false, paths, batchSize, done, stop);
+}
+
+bool sshRemoteSamples(SshCommandRunner& runner, const std::vector<std::string>& paths, long long sampleBytes,
+                      size_t batchSize, const std::function<void(const std::string&, const std::string&)>& done,
+                      const std::atomic<bool>* stop) {
+    return runBatches(runner, sshSampleCommand(sampleBytes), true, paths, batchSize, done, stop);
+}
+
+namespace {
+
+// fork/exec with stdin fed and stdout/stderr drained through poll() - no pipe deadlock
+class PipeRunner : public SshCommandRunner {
+public:
+    explicit PipeRunner(std::vector<std::string> prefix) : m_prefix(std::move(prefix)) {}
+
+    bool run(const std::string& command, const std::string& input,
+             const std::function<void(const char*, size_t)>& onOutput, int& exitStatus, std::string& error) override {
+        exitStatus = -1;
+        int in[2], out[2], err[2];
+        if (pipe(in) != 0) return fail(error);
+        if (pipe(out) != 0) {
+            closeBoth(in);
+            return fail(error);
+        }
+        if (pipe(err) != 0) {
+            closeBoth(in);
+            closeBoth(out);
+            return fail(error);
+        }
+
+        std::vector<std::string> args = m_prefix;
+        args.push_back(command);
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(&arg[0]);
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            closeBoth(in);
+            closeBoth(out);
+            closeBoth(err);
+            return fail(error);
+        }
+        if (pid == 0) {
+            dup2(in[0], STDIN_FILENO);
+            dup2(out[1], STDOUT_FILENO);
+            dup2(err[1], STDERR_FILENO);
+            closeBoth(in);
+            closeBoth(out);
+            closeBoth(err);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+        close(in[0]);
+        close(out[1]);
+        close(err[1]);
+        fcntl(in[1], F_SETFL, O_NONBLOCK);
+
+        int stdinFd = input.empty() ? -1 : in[1];
+        if (stdinFd < 0) close(in[1]);
+        size_t written = 0;
+        int stdoutFd = out[0], stderrFd = err[0];
+        char buffer[65536];
+        while (stdoutFd >= 0 || stderrFd >= 0) {
+            struct pollfd fds[3];
+            int n = 0;
+            if (stdinFd >= 0) fds[n++] = {stdinFd, POLLOUT, 0};
+            if (stdoutFd >= 0) fds[n++] = {stdoutFd, POLLIN, 0};
+            if (stderrFd >= 0) fds[n++] = {stderrFd, POLLIN, 0};
+            if (poll(fds, n, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                if (!fds[i].revents) continue;
+                if (fds[i].fd == stdinFd) {
+                    ssize_t w = write(stdinFd, input.data() + written, input.size() - written);
+                    if (w > 0) written += (size_t)w;
+                    if ((w < 0 && errno != EAGAIN) || written == input.size()) {
+                        close(stdinFd);
+                        stdinFd = -1;
+                    }
+                } else {
+                    ssize_t r = read(fds[i].fd, buffer, sizeof(buffer));
+                    if (r <= 0) {
+                        close(fds[i].fd);
+                        (fds[i].fd == stdoutFd ? stdoutFd : stderrFd) = -1;
+                    } else if (fds[i].fd == stdoutFd) {
+                        onOutput(buffer, (size_t)r);
+                    } else if (error.size() < 4096) {
+                        error.append(buffer, (size_t)r);
+                    }
+                }
+            }
+        }
+        if (stdinFd >= 0) close(stdinFd);
+        if (stdoutFd >= 0) close(stdoutFd);
+        if (stderrFd >= 0) close(stderrFd);
+
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        return exitStatus == 0;
+    }
+
+private:
+    static void closeBoth(int fds[2]) {
+        close(fds[0]);
+        close(fds[1]);
+    }
+    static bool fail(std::string& error) {
+        error = strerror(errno);
+        return false;
+    }
+
+    std::vector<std::string> m_prefix;
+};
+
+} // namespace
+
+std::unique_ptr<SshCommandRunner> createSystemSshRunner(const std::string& host, int port, const std::string& user) {
+    signal(SIGPIPE, SIG_IGN);
+    return std::unique_ptr<SshCommandRunner>(new PipeRunner({
+        "ssh", "-o", "BatchMode=yes", "-o", "ConnectTimeout=10", "-o", "StrictHostKeyChecking=accept-new",
+        "-p", std::to_string(port), user.empty() ? host : user + "@" + host
+    }));
+}
+
+std::unique_ptr<SshCommandRunner> createLocalShellRunner() {
+    signal(SIGPIPE, SIG_IGN);
+    return std::unique_ptr<SshCommandRunner>(new PipeRunner({"/bin/sh", "-c"}));
+}
@@ -0,0 +1,185 @@
+#include "stat_prefetch.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/vfs.h>
+
+#ifndef AT_STATX_DONT_SYNC
+#define AT_STATX_DONT_SYNC 0x4000
+#endif
+
+// Below this many entries the hand-off costs more than it hides
+static const size_t MIN_PREFETCH_BATCH = 4;
+
+struct StatPrefetchPool::Batch {
+    int dirFd = -1;
+    int flags = 0;
+    size_t count = 0;         // Copy: names may be gone once the batch is finished
+    const std::vector<std::string>* names = nullptr;
+    std::vector<PrefetchedStat>* out = nullptr;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+    std::mutex doneMutex;
+    std::condition_variable doneCv;
+};
+
+static void statOne(int dirFd, const std::string& name, int flags, PrefetchedStat& result) {
+#ifdef STATX_BASIC_STATS
+    struct statx stx;
+    if (statx(dirFd, name.c_str(), flags, STATX_TYPE | STATX_MODE | STATX_SIZE | STATX_MTIME | STATX_INO, &stx) == 0) {
+        result.mode = stx.stx_mode;
+        result.size = (long long)stx.stx_size;
+        result.mtime = stx.stx_mtime.tv_sec;
+        result.inode = stx.stx_ino;
+        result.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+        return;
+    }
+    if (errno != ENOSYS) {
+        result.error = errno;
+        return;
+    }
+#endif
+    // Kernel/libc without statx: plain fstatat (no DONT_SYNC)
+    struct stat st;
+    if (fstatat(dirFd, name.c_str(), &st, flags & AT_SYMLINK_NOFOLLOW) != 0) {
+        result.error = errno;
+        return;
+    }
+    result.mode = st.st_mode;
+    result.size = st.st_size;
+    result.mtime = st.st_mtime;
+    result.inode = st.st_ino;
+    result.device = st.st_dev;
+}
+
+void StatPrefetchPool::runBatch(Batch& batch) {
+    size_t count = batch.count;
+    size_t done = 0;
+    for (size_t i = batch.next++; i < count; i = batch.next++) {
+        statOne(batch.dirFd, (*batch.names)[i], batch.flags, (*batch.out)[i]);
+        done++;
+    }
+    if (done > 0 && batch.finished.fetch_add(done) + done == count) {
+        std::lock_guard<std::mutex> lock(batch.doneMutex);
+        batch.doneCv.notify_all();
+    }
+}
+
+StatPrefetchPool::~StatPrefetchPool() {
+    stop();
+}
+
+void StatPrefetchPool::start(int threads) {
+    std::lock_guard<std::mutex> startLock(m_startMutex);
+    threads = std::max(1, threads);
+    if ((int)m_threads.size() == threads) return;
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = false;
+    }
+    for (int i = 0; i < threads; i++) {
+        m_threads.emplace_back([this]() { worker(); });
+    }
+}
+
+void StatPrefetchPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    for (auto& thread : m_threads) thread.join();
+    m_threads.clear();
+}
+
+int StatPrefetchPool::threadCount() {
+    std::lock_guard<std::mutex> startLock(m_startMutex);
+    return (int)m_threads.size();
+}
+
+void StatPrefetchPool::worker() {
+    while (true) {
+        std::shared_ptr<Batch> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            batch = m_queue.front();
+            // Every index handed out: later workers go to the next directory
+            if (batch->next.load() >= batch->count) {
+                m_queue.pop_front();
+                continue;
+            }
+        }
+        runBatch(*batch);
+    }
+}
+
+void StatPrefetchPool::statDirectory(const std::string& dir, const std::vector<std::string>& names,
+                                     bool followSymlinks, bool dontSync, std::vector<PrefetchedStat>& out) {
+    out.assign(names.size(), PrefetchedStat());
+    if (names.empty()) return;
+
+    int dirFd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        for (auto& result : out) result.error = errno;
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->dirFd = dirFd;
+    batch->flags = (followSymlinks ? 0 : AT_SYMLINK_NOFOLLOW) | (dontSync ? AT_STATX_DONT_SYNC : 0);
+    batch->count = names.size();
+    batch->names = &names;
+    batch->out = &out;
+
+    bool pooled = false;
+    if (names.size() >= MIN_PREFETCH_BATCH) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_threads.empty() && !m_stopping) {
+            m_queue.push_back(batch);
+            pooled = true;
+        }
+    }
+    if (pooled) m_cv.notify_all();
+
+    // The caller works on its own directory too
+    runBatch(*batch);
+
+    if (pooled) {
+        std::unique_lock<std::mutex> lock(batch->doneMutex);
+        batch->doneCv.wait(lock, [&]() { return batch->finished.load() == names.size(); });
+        std::lock_guard<std::mutex> queueLock(m_mutex);
+        for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+            if (*it == batch) {
+                m_queue.erase(it);
+                break;
+            }
+        }
+    }
+    close(dirFd);
+}
+
+bool isRemoteFilesystem(const std::string& path) {
+    struct statfs fs;
+    if (statfs(path.c_str(), &fs) != 0) return false;
+    switch ((unsigned long)fs.f_type) {
+        case 0x6969:        // NFS
+        case 0x517B:        // SMB
+        case 0xFF534D42:    // CIFS
+        case 0xFE534D42:    // SMB2
+        case 0x65735546:    // FUSE (sshfs, davfs2, rclone, ...)
+        case 0x73757245:    // Coda
+        case 0x5346414F:    // AFS
+        case 0x00C36400:    // Ceph
+        case 0x01021997:    // 9p
+            return true;
+        default:
+            return false;
+    }
+}
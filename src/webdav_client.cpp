@@ -0,0 +1,365 @@
+#include "webdav_client.h"
+#include "http_backend.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <map>
+
+bool isDavUrl(const std::string& path) {
+    return path.compare(0, 6, "dav://") == 0 || path.compare(0, 7, "davs://") == 0;
+}
+
+std::string davUrl(bool https, const std::string& host, const std::string& path) {
+    std::string url = (https ? "davs://" : "dav://") + host;
+    if (path.empty() || path.front() != '/') url += "/";
+    return url + path;
+}
+
+bool parseDavUrl(const std::string& url, bool& https, std::string& host, std::string& path) {
+    if (!isDavUrl(url)) return false;
+    https = url[3] == 's';
+    size_t start = https ? 7 : 6;
+    size_t slash = url.find('/', start);
+    host = url.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+    path = slash == std::string::npos ? "/" : url.substr(slash);
+    return !host.empty();
+}
+
+std::string davUrlFromHttp(const std::string& httpUrl) {
+    bool https = httpUrl.compare(0, 8, "https://") == 0;
+    size_t start = https ? 8 : (httpUrl.compare(0, 7, "http://") == 0 ? 7 : 0);
+    size_t slash = httpUrl.find('/', start);
+    std::string host = httpUrl.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+    std::string path = slash == std::string::npos ? "/" : httpUrl.substr(slash);
+    while (path.size() > 1 && path.back() == '/') path.pop_back();
+    return davUrl(start == 0 || https, host, path);
+}
+
+std::string davEncodePath(const std::string& path) {
+    static const char* hex = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : path) {
+        if (isalnum(c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += (char)c;
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
+}
+
+static std::string percentDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '%' && i + 2 < text.size() && isxdigit((unsigned char)text[i + 1]) && isxdigit((unsigned char)text[i + 2])) {
+            out += (char)std::stoi(text.substr(i + 1, 2), nullptr, 16);
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+static std::string xmlDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        size_t semi;
+        if (text[i] != '&' || (semi = text.find(';', i)) == std::string::npos || semi - i > 10) {
+            out += text[i];
+            continue;
+        }
+        std::string entity = text.substr(i + 1, semi - i - 1);
+        if (entity == "amp") out += '&';
+        else if (entity == "lt") out += '<';
+        else if (entity == "gt") out += '>';
+        else if (entity == "quot") out += '"';
+        else if (entity == "apos") out += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            unsigned long code = entity[1] == 'x' ? strtoul(entity.c_str() + 2, nullptr, 16) : strtoul(entity.c_str() + 1, nullptr, 10);
+            // UTF-8
+            if (code < 0x80) out += (char)code;
+            else if (code < 0x800) {
+                out += (char)(0xC0 | (code >> 6));
+                out += (char)(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += (char)(0xE0 | (code >> 12));
+                out += (char)(0x80 | ((code >> 6) & 0x3F));
+                out += (char)(0x80 | (code & 0x3F));
+            } else {
+                out += (char)(0xF0 | (code >> 18));
+                out += (char)(0x80 | ((code >> 12) & 0x3F));
+                out += (char)(0x80 | ((code >> 6) & 0x3F));
+                out += (char)(0x80 | (code & 0x3F));
+            }
+        } else {
+            out += text.substr(i, semi - i + 1);
+        }
+        i = semi;
+    }
+    return out;
+}
+
+// href -> decoded path without scheme/host and trailing '/'
+static std::string hrefPath(const std::string& href) {
+    std::string path = href;
+    size_t scheme = path.find("://");
+    if (scheme != std::string::npos) {
+        size_t slash = path.find('/', scheme + 3);
+        path = slash == std::string::npos ? "/" : path.substr(slash);
+    }
+    path = percentDecode(path);
+    while (path.size() > 1 && path.back() == '/') path.pop_back();
+    return path.empty() ? "/" : path;
+}
+
+static std::string trimmed(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    return text.substr(start, text.find_last_not_of(" \t\r\n") - start + 1);
+}
+
+bool parseDavMultistatus(const std::string& xml, std::vector<DavResource>& out) {
+    struct Props {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        std::string etag;
+        bool collection = false;
+    };
+    bool multistatus = false;
+    DavResource current;
+    Props props;
+    std::string status, text;
+    size_t pos = 0;
+    for (size_t lt; (lt = xml.find('<', pos)) != std::string::npos;) {
+        text += xml.substr(pos, lt - pos);
+        if (xml.compare(lt, 4, "<!--") == 0) {
+            size_t end = xml.find("-->", lt);
+            if (end == std::string::npos) break;
+            pos = end + 3;
+            continue;
+        }
+        if (xml.compare(lt, 9, "<![CDATA[") == 0) {
+            size_t end = xml.find("]]>", lt);
+            if (end == std::string::npos) break;
+            text += xml.substr(lt + 9, end - lt - 9);
+            pos = end + 3;
+            continue;
+        }
+        size_t gt = xml.find('>', lt);
+        if (gt == std::string::npos) break;
+        pos = gt + 1;
+        std::string tag = xml.substr(lt + 1, gt - lt - 1);
+        if (tag.empty() || tag[0] == '?' || tag[0] == '!') continue;
+
+        bool closing = tag[0] == '/';
+        bool selfClosing = tag.back() == '/';
+        size_t nameStart = closing ? 1 : 0;
+        size_t nameEnd = tag.find_first_of(" \t\r\n/", nameStart);
+        std::string name = tag.substr(nameStart, nameEnd == std::string::npos ? std::string::npos : nameEnd - nameStart);
+        size_t colon = name.find(':');
+        if (colon != std::string::npos) name = name.substr(colon + 1);
+
+        if (!closing) {
+            if (name == "multistatus") multistatus = true;
+            else if (name == "response") current = DavResource();
+            else if (name == "propstat") {
+                props = Props();
+                status.clear();
+            } else if (name == "collection") props.collection = true;
+            if (!selfClosing) {
+                text.clear();
+                continue;
+            }
+        }
+
+        std::string value = xmlDecode(trimmed(text));
+        text.clear();
+        if (name == "href") current.path = hrefPath(value);
+        else if (name == "getcontentlength") props.size = strtoull(value.c_str(), nullptr, 10);
+        else if (name == "getlastmodified") props.mtime = parseHttpDate(value);
+        else if (name == "getetag") props.etag = value;
+        else if (name == "status") status = value;
+        else if (name == "propstat") {
+            // "HTTP/1.1 200 OK"; 404 propstats list the properties the server doesn't have
+            if (status.find(" 200") != std::string::npos) {
+                if (props.size) current.size = props.size;
+                if (props.mtime) current.mtime = props.mtime;
+                if (!props.etag.empty()) current.etag = props.etag;
+                if (props.collection) current.isDir = true;
+            }
+        } else if (name == "response") {
+            if (!current.path.empty()) out.push_back(current);
+        }
+    }
+    return multistatus;
+}
+
+int64_t parseHttpDate(const std::string& date) {
+    static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    char month[4] = {0};
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    size_t comma = date.find(',');
+    const char* start = date.c_str() + (comma == std::string::npos ? 0 : comma + 1);
+    if (sscanf(start, " %d %3s %d %d:%d:%d", &tm.tm_mday, month, &tm.tm_year, &tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6) return 0;
+    tm.tm_mon = -1;
+    for (int i = 0; i < 12; i++) {
+        if (strcmp(month, months[i]) == 0) tm.tm_mon = i;
+    }
+    if (tm.tm_mon < 0) return 0;
+    tm.tm_year -= 1900;
+    return (int64_t)timegm(&tm);
+}
+
+uint64_t davEtagTag(const std::string& etag) {
+    if (etag.empty()) return 0;
+    uint64_t hash = 1469598103934665603ULL;    // FNV-1a
+    for (unsigned char c : etag) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash ? hash : 1;
+}
+
+static std::string parentPath(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos || slash == 0) return "/";
+    return path.substr(0, slash);
+}
+
+static std::string normalizedPath(const std::string& path) {
+    std::string out = path.empty() || path.front() != '/' ? "/" + path : path;
+    while (out.size() > 1 && out.back() == '/') out.pop_back();
+    return out;
+}
+
+namespace {
+
+const char* kPropfindBody =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+    "<d:propfind xmlns:d=\"DAV:\"><d:prop>"
+    "<d:resourcetype/><d:getcontentlength/><d:getlastmodified/><d:getetag/>"
+    "</d:prop></d:propfind>";
+
+class WebDavBackend : public HttpBackend {
+public:
+    WebDavBackend(std::string baseUrl, std::string user, std::string password, int maxConnections)
+        : HttpBackend("WebDAV", maxConnections), m_baseUrl(std::move(baseUrl)), m_user(std::move(user)),
+          m_password(std::move(password)) {}
+
+    bool readdirplus(const std::string& path, DirCallback cb) override {
+        std::string key = normalizedPath(path);
+        // A pooled connection may come back for the next scan - don't answer it from an old listing
+        if (std::chrono::steady_clock::now() - m_treeTime > std::chrono::seconds(30)) m_tree.clear();
+        auto it = m_tree.find(key);
+        if (it != m_tree.end()) {
+            // Covered by an earlier Depth: infinity reply
+            auto entries = std::make_shared<std::vector<NfsDirEntry>>(std::move(it->second));
+            m_tree.erase(it);
+            defer([cb, entries]() { cb(0, std::move(*entries)); });
+            return true;
+        }
+        return list(key, m_infinityRefused ? 1 : -1, std::move(cb));
+    }
+
+    bool open(const std::string& path, OpenCallback cb) override {
+        return HttpBackend::open(normalizedPath(path), std::move(cb));
+    }
+
+    bool unlink(const std::string& path, std::string& error) override {
+        Request request;
+        request.method = "DELETE";
+        request.path = normalizedPath(path);
+        std::string body;
+        long code = perform(std::move(request), body);
+        if (code >= 200 && code < 300) return true;
+        error = code ? "HTTP " + std::to_string(code) : m_lastError;
+        return false;
+    }
+
+protected:
+    std::string requestUrl(const Request& request) const override {
+        return m_baseUrl + davEncodePath(request.path);
+    }
+
+    void authorize(Request&, CURL* easy) const override {
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        if (m_user.empty()) return;
+        curl_easy_setopt(easy, CURLOPT_USERNAME, m_user.c_str());
+        curl_easy_setopt(easy, CURLOPT_PASSWORD, m_password.c_str());
+        curl_easy_setopt(easy, CURLOPT_HTTPAUTH, (long)CURLAUTH_ANY);
+    }
+
+private:
+    // depth -1 = infinity
+    bool list(const std::string& path, int depth, DirCallback cb) {
+        Request request;
+        request.method = "PROPFIND";
+        request.path = path == "/" ? path : path + "/";    // Collections: no redirect
+        request.headers = {depth < 0 ? "Depth: infinity" : "Depth: 1", "Content-Type: application/xml; charset=utf-8"};
+        request.body = kPropfindBody;
+        return send(std::move(request), [this, path, depth, cb](long code, std::string&& body) {
+            if (depth < 0 && (code == 403 || code == 400 || code == 501 || code == 412)) {
+                // propfind-finite-depth: list level by level from now on
+                m_infinityRefused = true;
+                std::cout << "[WebDAV] Depth: infinity refused (HTTP " << code << "), listing per directory" << std::endl;
+                if (!list(path, 1, cb)) cb(-1, {});
+                return;
+            }
+            std::vector<DavResource> resources;
+            if (code != 207 || !parseDavMultistatus(body, resources)) {
+                if (code) m_lastError = "HTTP " + std::to_string(code) + " (no multistatus) for " + path;
+                cb(-1, {});
+                return;
+            }
+            cb(0, entriesOf(path, depth, resources));
+        });
+    }
+
+    std::vector<NfsDirEntry> entriesOf(const std::string& path, int depth, const std::vector<DavResource>& resources) {
+        std::vector<NfsDirEntry> entries;
+        for (const auto& resource : resources) {
+            if (resource.path == path) continue;     // The directory itself
+            std::string parent = parentPath(resource.path);
+            NfsDirEntry entry;
+            entry.name = resource.path.substr(resource.path.find_last_of('/') + 1);
+            entry.isDir = resource.isDir;
+            entry.isFile = !resource.isDir;
+            entry.size = resource.size;
+            entry.mtime = resource.mtime;
+            entry.inode = davEtagTag(resource.etag);
+            if (parent == path) {
+                entries.push_back(std::move(entry));
+            } else if (depth < 0) {
+                m_tree[parent].push_back(std::move(entry));
+            }
+            if (depth < 0 && resource.isDir) m_tree[resource.path];    // Empty directories too
+        }
+        if (depth < 0) m_treeTime = std::chrono::steady_clock::now();
+        return entries;
+    }
+
+    std::string m_baseUrl;                // "https://host:port"
+    std::string m_user, m_password;
+    std::map<std::string, std::vector<NfsDirEntry>> m_tree;   // Directories of Depth: infinity replies
+    std::chrono::steady_clock::time_point m_treeTime;
+    bool m_infinityRefused = false;
+};
+
+} // namespace
+
+std::unique_ptr<NfsBackend> createWebDavBackend(bool https, const std::string& host, const std::string& user,
+                                                const std::string& password, std::string& error, int maxConnections) {
+    if (host.empty()) {
+        error = "no host";
+        return nullptr;
+    }
+    return std::unique_ptr<NfsBackend>(new WebDavBackend((https ? "https://" : "http://") + host, user, password, maxConnections));
+}
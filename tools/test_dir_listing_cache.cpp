@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "dir_listing_cache.h"
+
+static void setOldMtime(const std::string& path) {
+    struct timespec times[2];
+    times[0].tv_sec = time(nullptr) - 3600; times[0].tv_nsec = 0;
+    times[1] = times[0];
+    utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+int main() {
+    char tmpl[] = "/tmp/fd_dirlist_XXXXXX";
+    std::string dir = mkdtemp(tmpl);
+    std::string cacheFile = dir + ".dat";
+    FILE* f = fopen((dir + "/a.txt").c_str(), "w"); fputs("a", f); fclose(f);
+    setOldMtime(dir);
+
+    struct stat st;
+    int statResult = stat(dir.c_str(), &st);
+    assert(statResult == 0);
+
+    DirListingCache cache;
+    std::vector<std::string> names;
+    assert(!cache.lookup(dir, st, names));
+    cache.store(dir, st, {"a.txt"});
+    assert(cache.lookup(dir, st, names));
+    assert(names.size() == 1 && names[0] == "a.txt");
+
+    // Round trip through disk
+    bool saved = cache.save(cacheFile);
+    assert(saved);
+    DirListingCache loaded;
+    bool loadedOk = loaded.load(cacheFile);
+    assert(loadedOk);
+    (void)saved;
+    (void)loadedOk;
+    names.clear();
+    assert(loaded.lookup(dir, st, names) && names.size() == 1);
+
+    // Adding an entry bumps the directory mtime -> listing must be re-read
+    f = fopen((dir + "/b.txt").c_str(), "w"); fputs("b", f); fclose(f);
+    statResult = stat(dir.c_str(), &st);
+    assert(statResult == 0);
+    (void)statResult;
+    assert(!loaded.lookup(dir, st, names));
+
+    // Freshly modified directories are not trusted (coarse timestamp race)
+    loaded.store(dir, st, {"a.txt", "b.txt"});
+    assert(!loaded.lookup(dir, st, names));
+
+    // Corrupt counts: discarded like a truncated file instead of allocating what they claim
+    auto writeCorrupt = [&](uint64_t count, uint32_t nameCount) {
+        FILE* out = fopen(cacheFile.c_str(), "wb");
+        fwrite("DIRLISTCACHE_V1", 1, 16, out);
+        fwrite(&count, sizeof(count), 1, out);
+        uint32_t dirLength = 1;
+        fwrite(&dirLength, sizeof(dirLength), 1, out);
+        fputc('/', out);
+        long long times[6] = {0, 0, 0, 0, 0, 0};
+        fwrite(times, sizeof(times), 1, out);
+        fwrite(&nameCount, sizeof(nameCount), 1, out);
+        fclose(out);
+    };
+    writeCorrupt(~0ULL, 0);
+    DirListingCache corrupt;
+    bool corruptOk = corrupt.load(cacheFile);
+    assert(!corruptOk);
+    writeCorrupt(1, 0xffffffffu);
+    corruptOk = corrupt.load(cacheFile);
+    assert(!corruptOk);
+    (void)corruptOk;
+    assert(!corrupt.lookup(dir, st, names));
+
+    std::cout << "dir_listing_cache: hits=" << loaded.hits() << " misses=" << loaded.misses() << std::endl;
+    remove((dir + "/a.txt").c_str());
+    remove((dir + "/b.txt").c_str());
+    rmdir(dir.c_str());
+    remove(cacheFile.c_str());
+    std::cout << "dir_listing_cache tests passed" << std::endl;
+    return 0;
+}
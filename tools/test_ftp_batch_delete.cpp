@@ -0,0 +1,51 @@
+#include <iostream>
+#include <cassert>
+#include "ftp_batch_delete.h"
+
+int main() {
+    assert(ftpDeletePath("ftp://10.0.0.5:21/share/a b/x.mp3") == "/share/a b/x.mp3");
+    assert(ftpDeletePath("ftp://10.0.0.5:21") == "/");
+
+    // Per server, directory order, duplicates dropped, batch size respected
+    std::vector<FtpDeleteBatch> batches = planFtpDeleteBatches({
+        "ftp://b:21/z/1", "ftp://a:21/y/2", "ftp://a:21/x/1", "ftp://a:21/y/1", "ftp://a:21/x/1", "ftp://b:21/z/0",
+    }, 2);
+    assert(batches.size() == 3);
+    assert(batches[0].server == "ftp://a:21" && batches[0].urls.size() == 2);
+    assert(batches[0].urls[0] == "ftp://a:21/x/1" && batches[0].urls[1] == "ftp://a:21/y/1");
+    assert(batches[1].server == "ftp://a:21" && batches[1].urls.size() == 1 && batches[1].urls[0] == "ftp://a:21/y/2");
+    assert(batches[2].server == "ftp://b:21" && batches[2].urls[0] == "ftp://b:21/z/0");
+
+    std::vector<std::string> commands = ftpDeleteCommands(batches[0].urls);
+    assert(commands.size() == 2 && commands[0] == "*DELE /x/1");
+
+    assert(ftpDeleteStatusFor(250) == FtpDeleteStatus::Deleted);
+    assert(ftpDeleteStatusFor(450) == FtpDeleteStatus::Transient);
+    assert(ftpDeleteStatusFor(550) == FtpDeleteStatus::Failed);
+    assert(ftpDeleteStatusFor(0) == FtpDeleteStatus::Pending);
+
+    // Login and PWD replies are ignored, multi-line replies count once, the last DELE got no reply
+    FtpDeleteTranscript transcript;
+    transcript.reply("220 Welcome\r\n");
+    transcript.command("USER anonymous\r\n");
+    transcript.reply("331 Password required\r\n");
+    transcript.command("PASS x\r\n");
+    transcript.reply("230-Hello\r\n230 Logged in\r\n");
+    transcript.command("DELE /x/1\r\n");
+    transcript.reply("250 DELE command successful\r\n");
+    transcript.command("DELE /x/with space\r\n");
+    transcript.reply("550-Permission denied\r\n");
+    transcript.reply("550 /x/with space: not removed\r\n");
+    transcript.command("DELE /y/1\r\n");
+    transcript.reply("450 File busy\r\n");
+    transcript.command("DELE /y/2\r\n");
+
+    const auto& entries = transcript.entries();
+    assert(entries.size() == 3);
+    assert(entries[0].path == "/x/1" && entries[0].code == 250);
+    assert(entries[1].path == "/x/with space" && entries[1].code == 550 && entries[1].text.find("not removed") != std::string::npos);
+    assert(entries[2].path == "/y/1" && ftpDeleteStatusFor(entries[2].code) == FtpDeleteStatus::Transient);
+
+    std::cout << "ftp_batch_delete tests passed" << std::endl;
+    return 0;
+}
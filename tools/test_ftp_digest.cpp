@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "ftp_digest.h"
+
+int main() {
+    // ProFTPD mod_digest style
+    FtpServerFeatures proftpd = parseFeatResponse(
+        "211-Features:\r\n"
+        " HASH SHA-256;SHA-1*;MD5;CRC32\r\n"
+        " RANG STREAM\r\n"
+        " XCRC\r\n"
+        " XMD5\r\n"
+        " XSHA256\r\n"
+        "211 End\r\n");
+    assert(proftpd.hasHashAlgorithm("MD5") && proftpd.hashSelected == "SHA-1" && proftpd.rang);
+    assert(proftpd.xmd5 && proftpd.xcrc && proftpd.xsha256 && !proftpd.xsha1);
+
+    FtpDigestPlan plan = planFtpDigest(proftpd, "media/my movie.mkv");
+    assert(plan.algo == FtpDigestAlgo::MD5);
+    assert(plan.commands.size() == 2);
+    assert(plan.commands[0] == "OPTS HASH MD5");
+    assert(plan.commands[1] == "HASH media/my movie.mkv");
+
+    plan = planFtpDigest(proftpd, "media/a.mkv", 0, 65536);
+    assert(plan.commands.size() == 3 && plan.commands[1] == "RANG 0 65535");
+
+    // X-commands only
+    FtpServerFeatures filezilla = parseFeatResponse("211-Features:\n XMD5\n XCRC\n211 End\n");
+    plan = planFtpDigest(filezilla, "a.bin", 100, 200);
+    assert(plan.algo == FtpDigestAlgo::MD5 && plan.commands.size() == 1 && plan.commands[0] == "XMD5 a.bin 100 200");
+    // Ranged X-command cannot carry a path with spaces
+    assert(!planFtpDigest(filezilla, "a b.bin", 0, 10));
+    assert(planFtpDigest(filezilla, "a b.bin").commands[0] == "XMD5 a b.bin");
+
+    // CRC only with allowCrc
+    FtpServerFeatures crcOnly = parseFeatResponse("211-Features:\n XCRC\n211 End\n");
+    assert(!planFtpDigest(crcOnly, "a.bin"));
+    plan = planFtpDigest(crcOnly, "a.bin", -1, -1, true);
+    assert(plan.algo == FtpDigestAlgo::CRC32 && plan.commands[0] == "XCRC a.bin");
+
+    // SHA-256 via HASH when it is already selected: no OPTS
+    FtpServerFeatures sha = parseFeatResponse("211-Features:\n HASH SHA-256*;SHA-1\n211 End\n");
+    plan = planFtpDigest(sha, "x");
+    assert(plan.algo == FtpDigestAlgo::SHA256 && plan.commands.size() == 1);
+    // Ranges need RANG
+    assert(!planFtpDigest(sha, "x", 0, 10));
+    assert(!planFtpDigest(parseFeatResponse("211 no features\n"), "x"));
+
+    // Replies (after the login dialogue in the header stream)
+    std::string hex;
+    assert(parseFtpDigestReply("230 Login successful.\r\n200 OPTS HASH MD5\r\n"
+                               "213 MD5 0-1048575 D41D8CD98F00B204E9800998ECF8427E media/my movie.mkv\r\n",
+                               FtpDigestAlgo::MD5, hex));
+    assert(hex == "d41d8cd98f00b204e9800998ecf8427e");
+    assert(parseFtpDigestReply("250 3e25960a79dbc69b674cd4ec67a72c62\r\n", FtpDigestAlgo::MD5, hex));
+    assert(hex == "3e25960a79dbc69b674cd4ec67a72c62");
+    assert(parseFtpDigestReply("250 a.bin 0 10 CBF43926\r\n", FtpDigestAlgo::CRC32, hex) && hex == "cbf43926");
+    assert(!parseFtpDigestReply("550 a.bin: No such file\r\n", FtpDigestAlgo::MD5, hex));
+    assert(!parseFtpDigestReply("213 SHA-1 0-9 356a192b7913b04c54574d18c28d46e6395428ab x\r\n", FtpDigestAlgo::MD5, hex));
+
+    assert(ftpDigestKey(FtpDigestAlgo::MD5, "ab") == "ab");
+    assert(ftpDigestKey(FtpDigestAlgo::SHA256, "ab") == "sha256:ab");
+
+    std::cout << "ftp_digest tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "ftp_handle_pool.h"
+
+// Minimal FTP server stand-in on 127.0.0.1: greeting, login and the commands curl sends
+// for a NOBODY request on "/", one thread per control connection. dropAll() sends
+// "421 Timeout" and closes every open connection, like a server's idle timeout.
+class FtpStandIn {
+public:
+    std::atomic<int> connections{0};
+
+    int start() {
+        m_listen = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int bound = bind(m_listen, (sockaddr*)&addr, sizeof(addr));
+        int listening = listen(m_listen, 64);
+        assert(bound == 0 && listening == 0);
+        (void)bound;
+        (void)listening;
+        socklen_t len = sizeof(addr);
+        getsockname(m_listen, (sockaddr*)&addr, &len);
+        m_acceptor = std::thread([this]() {
+            while (true) {
+                int fd = accept(m_listen, nullptr, nullptr);
+                if (fd < 0) break;
+                connections++;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_open.insert(fd);
+                }
+                std::thread([this, fd]() { serve(fd); }).detach();
+            }
+        });
+        return ntohs(addr.sin_port);
+    }
+
+    void dropAll() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int fd : m_open) {
+            const char* bye = "421 Timeout.\r\n";
+            send(fd, bye, strlen(bye), MSG_NOSIGNAL);
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+
+    void stop() {
+        shutdown(m_listen, SHUT_RDWR);
+        close(m_listen);
+        m_acceptor.join();
+        dropAll();
+    }
+
+private:
+    static void reply(int fd, const std::string& line) {
+        std::string out = line + "\r\n";
+        send(fd, out.data(), out.size(), MSG_NOSIGNAL);
+    }
+
+    void serve(int fd) {
+        reply(fd, "220 Stand-in ready");
+        std::string buffer;
+        char chunk[512];
+        bool open = true;
+        while (open) {
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) break;
+            buffer.append(chunk, n);
+            size_t eol;
+            while (open && (eol = buffer.find("\r\n")) != std::string::npos) {
+                std::string cmd = buffer.substr(0, buffer.find_first_of(" \r"));
+                buffer.erase(0, eol + 2);
+                if (cmd == "USER") reply(fd, "331 Password required");
+                else if (cmd == "PASS") reply(fd, "230 Logged in");
+                else if (cmd == "PWD") reply(fd, "257 \"/\" is current directory");
+                else if (cmd == "CWD") reply(fd, "250 OK");
+                else if (cmd == "TYPE") reply(fd, "200 OK");
+                else if (cmd == "NOOP") reply(fd, "200 OK");
+                else if (cmd == "QUIT") { reply(fd, "221 Bye"); open = false; }
+                else reply(fd, "502 Not implemented");
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open.erase(fd);
+        }
+        close(fd);
+    }
+
+    int m_listen = -1;
+    std::thread m_acceptor;
+    std::mutex m_mutex;
+    std::set<int> m_open;
+};
+
+static CURLcode touchRoot(FtpHandlePool::Lease& lease, const std::string& url) {
+    curl_easy_setopt(lease.get(), CURLOPT_URL, url.c_str());
+    curl_easy_setopt(lease.get(), CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(lease.get(), CURLOPT_CONNECTTIMEOUT, 5L);
+    curl_easy_setopt(lease.get(), CURLOPT_TIMEOUT, 10L);
+    return lease.perform();
+}
+
+int main() {
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    FtpStandIn server;
+    int port = server.start();
+    std::string url = "ftp://127.0.0.1:" + std::to_string(port) + "/";
+    assert(FtpHandlePool::serverKey(url + "dir/file.bin") == "ftp://127.0.0.1:" + std::to_string(port));
+
+    FtpHandlePool pool;
+    pool.setMaxConnectionsPerServer(2);
+
+    // Reuse across leases: the second transfer runs on the pooled control connection
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+        CURLcode res = touchRoot(lease, url);
+        assert(res == CURLE_OK);
+        (void)res;
+    }
+    assert(pool.stats().idle == 1 && pool.stats().inUse == 0);
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+        CURLcode res = touchRoot(lease, url);
+        assert(res == CURLE_OK);
+        (void)res;
+    }
+    auto s = pool.stats();
+    assert(s.handlesCreated == 1 && s.handlesReused == 1);
+    assert(s.transfers == 2 && s.connectionsReused == 1);
+    assert(server.connections == 1);
+
+    // Another user never gets this user's connection
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "other", "secret");
+        assert(lease);
+        assert(pool.stats().handlesCreated == 2);
+        lease.markBroken();
+    }
+
+    // Health check: a connection the server closed while idle is not handed out again
+    server.dropAll();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+        assert(pool.stats().healthCheckFailures == 1);
+        CURLcode res = touchRoot(lease, url);
+        assert(res == CURLE_OK);
+        (void)res;
+    }
+    assert(server.connections == 2);
+
+    // markBroken(): the handle is closed instead of pooled
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+        lease.markBroken();
+    }
+    assert(pool.stats().idle == 0);
+    uint64_t createdBefore = pool.stats().handlesCreated;
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+        CURLcode res = touchRoot(lease, url);
+        assert(res == CURLE_OK);
+        (void)res;
+    }
+    assert(pool.stats().handlesCreated == createdBefore + 1);
+    assert(server.connections == 3);
+
+    // Reuse switched off: released handles are closed, pooled ones dropped at once
+    pool.setReuseConnections(false);
+    assert(pool.stats().idle == 0);
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+    }
+    assert(pool.stats().idle == 0);
+    pool.setReuseConnections(true);
+
+    // Idle eviction
+    {
+        FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret");
+        assert(lease);
+    }
+    assert(pool.stats().idle == 1);
+    pool.setIdleTimeout(std::chrono::seconds(0));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.evictIdle();
+    assert(pool.stats().idle == 0 && pool.stats().idleEvictions == 1);
+    pool.setIdleTimeout(std::chrono::seconds(60));
+
+    // Per-server limit: acquire() blocks until a lease is released, or times out
+    pool.setMaxConnectionsPerServer(1);
+    {
+        FtpHandlePool::Lease held = pool.acquire(url, "user", "secret");
+        assert(held);
+        FtpHandlePool::Lease late = pool.acquire(url, "user", "secret", std::chrono::milliseconds(100));
+        assert(!late);
+
+        std::atomic<bool> waiterGotLease{false};
+        std::thread waiter([&]() {
+            FtpHandlePool::Lease lease = pool.acquire(url, "user", "secret", std::chrono::seconds(10));
+            waiterGotLease = (bool)lease;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        assert(!waiterGotLease);
+        held.release();
+        waiter.join();
+        assert(waiterGotLease);
+    }
+    assert(pool.stats().inUse == 0);
+
+    s = pool.stats();
+    std::cout << "ftp_handle_pool: acquires=" << s.acquires << " created=" << s.handlesCreated
+              << " reused=" << s.handlesReused << " healthFailures=" << s.healthCheckFailures
+              << " evictions=" << s.idleEvictions << " reuseRatio=" << s.reuseRatio() << std::endl;
+
+    pool.clear();
+    server.stop();
+    curl_global_cleanup();
+    std::cout << "All FtpHandlePool tests passed" << std::endl;
+    return 0;
+}
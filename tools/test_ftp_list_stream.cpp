@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include "ftp_list_stream.h"
+
+struct Collected {
+    std::vector<std::string> files;       // "dir|name|size"
+    std::vector<std::string> dirs;        // "dir|name"
+};
+
+static FtpListRParser makeParser(Collected& c, const std::string& root = "") {
+    return FtpListRParser([&c](const FtpListEntry& e) {
+        std::string dir(e.dir), name(e.name);
+        if (e.type == FtpListType::File) c.files.push_back(dir + "|" + name + "|" + std::to_string(e.size));
+        else c.dirs.push_back(dir + "|" + name);
+    }, root);
+}
+
+// Feed in chunks of n bytes to exercise lines split across curl callbacks
+static void feedChunked(FtpListRParser& parser, const std::string& data, size_t n) {
+    for (size_t i = 0; i < data.size(); i += n) parser.feed(data.data() + i, std::min(n, data.size() - i));
+    parser.finish();
+}
+
+int main() {
+    FtpListEntry e;
+    assert(parseFtpListLine("-rwxrws---   1 root ftpusers  2887197 Aug 21  2013 file name.ext", e));
+    assert(e.type == FtpListType::File && e.size == 2887197 && e.name == "file name.ext");
+    assert(parseFtpListLine("-rw-r--r--   1 ftp      1234 Jul 12 06:49  two spaces", e));   // no group column
+    assert(e.size == 1234 && e.name == " two spaces");
+    assert(parseFtpListLine("drwxr-xr-x   2 1000 1000     4096 Mär  3 11:00 Fotos", e));  // numeric owner, German month
+    assert(e.type == FtpListType::Dir && e.name == "Fotos");
+    assert(parseFtpListLine("lrwxrwxrwx   1 root root 7 Jan  1  2020 current -> v1.2", e));
+    assert(e.type == FtpListType::Other && e.name == "current");
+    assert(parseFtpListLine("01-15-24  03:04PM       <DIR>          Program Files", e));
+    assert(e.type == FtpListType::Dir && e.name == "Program Files");
+    assert(parseFtpListLine("01-15-2024  15:04                 1234 report.pdf", e));
+    assert(e.type == FtpListType::File && e.size == 1234 && e.name == "report.pdf");
+    assert(!parseFtpListLine("total 24", e));
+    assert(!parseFtpListLine("./sub:", e));
+
+    // Unix LIST -R: root entries without header, "total" lines, relative headers, CRLF
+    const std::string unixListing =
+        "total 12\r\n"
+        "-rw-r--r--   1 u g      100 Jan  1  2020 a.txt\r\n"
+        "drwxr-xr-x   2 u g     4096 Jan  1  2020 sub\r\n"
+        "drwxr-xr-x   2 u g     4096 Jan  1  2020 .\r\n"
+        "\r\n"
+        "./sub:\r\n"
+        "total 4\r\n"
+        "-rw-r--r--   1 u g      200 Feb  2 10:00 b c.bin\r\n"
+        "drwxr-xr-x   2 u g     4096 Feb  2 10:00 deep\r\n"
+        "\r\n"
+        "./sub/deep:\r\n"
+        "-rw-r--r--   1 u g      300 Feb  2 10:00 d";   // no final newline
+    for (size_t chunk : {1, 7, 4096}) {
+        Collected c;
+        FtpListRParser parser = makeParser(c);
+        feedChunked(parser, unixListing, chunk);
+        assert(c.files.size() == 3);
+        assert(c.files[0] == "|a.txt|100");
+        assert(c.files[1] == "sub|b c.bin|200");
+        assert(c.files[2] == "sub/deep|d|300");
+        assert(c.dirs.size() == 2 && c.dirs[0] == "|sub" && c.dirs[1] == "sub|deep");
+        assert(parser.headers() == 2 && !parser.recursionIgnored());
+    }
+
+    // Absolute headers are made relative to the listed directory
+    {
+        Collected c;
+        FtpListRParser parser = makeParser(c, "/pub/media/");
+        feedChunked(parser, "/pub/media:\n-rw-r--r-- 1 u g 5 Jan  1  2020 x\n\n/pub/media/y:\n-rw-r--r-- 1 u g 6 Jan  1  2020 z\n", 3);
+        assert(c.files.size() == 2 && c.files[0] == "|x|5" && c.files[1] == "y|z|6");
+    }
+
+    // Server ignored -R: subdirectories but no header
+    {
+        Collected c;
+        FtpListRParser parser = makeParser(c);
+        feedChunked(parser, "01-15-24  03:04PM       <DIR>          docs\r\n01-15-24  03:04PM   42 a.txt\r\n", 16);
+        assert(parser.recursionIgnored() && parser.rootDirs() == 1 && c.files.size() == 1);
+    }
+
+    std::cout << "ftp_list_stream tests passed" << std::endl;
+    return 0;
+}
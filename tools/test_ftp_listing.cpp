@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include "ftp_listing.h"
+
+int main() {
+    // vsftpd-style FEAT reply, as seen by the header callback after the login dialogue
+    FtpServerFeatures f = parseFeatResponse(
+        "220-Welcome\r\n"
+        " to our server\r\n"
+        "220 Ready\r\n"
+        "230 Login successful.\r\n"
+        "211-Features:\r\n"
+        " EPSV\r\n"
+        " MDTM\r\n"
+        " MLST Type*;Size*;Modify*;Perm;Unique;\r\n"
+        " SIZE\r\n"
+        " UTF8\r\n"
+        "211 End\r\n");
+    assert(f.probed && f.mlsd && f.size && f.mdtm);
+    assert(f.hasFact("type") && f.hasFact("unique") && !f.hasFact("sizd"));
+    assert(f.factEnabled("modify") && !f.factEnabled("unique"));
+    assert(mlstOptsCommand(f) == "OPTS MLST type;size;modify;unique;");
+
+    // All wanted facts enabled already -> no OPTS needed
+    FtpServerFeatures all = parseFeatResponse("211-Ext:\n MLST type*;size*;modify*;unique*;\n211 END\n");
+    assert(all.mlsd && mlstOptsCommand(all).empty());
+
+    // No MLST -> LIST fallback
+    FtpServerFeatures old = parseFeatResponse("211-Features:\r\n SIZE\r\n211 End\r\n");
+    assert(old.probed && !old.mlsd && old.size);
+    assert(parseFeatResponse("500 FEAT not understood\r\n").probed == false);
+
+    // MLSD lines
+    FtpFacts facts;
+    assert(parseMlsdLine("type=file;size=2887197;modify=20130821094512;UNIX.mode=0644;unique=803g1a2; my file; v2.txt\r", facts));
+    assert(facts.isFile && !facts.isDir);
+    assert(facts.size == 2887197);
+    assert(facts.modify == 1377078312);
+    assert(facts.unique == "803g1a2");
+    assert(facts.name == "my file; v2.txt");
+
+    assert(parseMlsdLine("Type=dir;Modify=20240101000000.123;Unique=11; photos", facts));
+    assert(facts.isDir && !facts.isFile && facts.size == -1 && facts.name == "photos");
+    assert(facts.modify == 1704067200);
+
+    assert(parseMlsdLine("type=cdir;modify=20240101000000; .", facts));
+    assert(!facts.isDir && !facts.isFile);
+
+    // MLST entry line (leading space), missing modify
+    assert(parseMlsdLine(" type=file;size=10; /pub/a.bin", facts));
+    assert(facts.isFile && facts.size == 10 && facts.modify == 0 && facts.name == "/pub/a.bin");
+
+    assert(!parseMlsdLine("garbage", facts));
+    assert(!parseMlsdLine("", facts));
+    assert(parseMlsdTime("2024") == 0);
+    assert(parseMlsdTime("20241301000000") == 0);
+
+    std::cout << "ftp_listing tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include "host_discovery.h"
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void testLoopback() {
+    // 127.0.0.1 is an own interface address, the rest of 127/8 answers ICMP on loopback
+    std::map<std::string, SweepHost> found;
+    HostSweepOptions options;
+    options.timeoutMs = 300;
+    HostSweepStats stats = sweepHostList({"127.0.0.1", "127.0.0.2", "not-an-ip"}, options,
+                                         [&](const SweepHost& host) { found[host.ip] = host; });
+    assert(stats.targets == 2);
+    assert(found.count("127.0.0.1") && found["127.0.0.1"].method == "local");
+    if (!stats.icmpAvailable) {
+        // Off-link targets go to the ping binary; without one the sweep says so instead of finding nothing
+        assert(stats.pingFallback);
+        if (stats.error.empty()) assert(found.count("127.0.0.2") && found["127.0.0.2"].method == "ping");
+        std::cout << "  (no ICMP socket permitted: " << (stats.error.empty() ? "ping fallback" : stats.error) << ")" << std::endl;
+        return;
+    }
+    assert(!stats.pingFallback && stats.error.empty());
+    assert(found.count("127.0.0.2") && found["127.0.0.2"].method == "icmp");
+
+    // A whole /24 in one batched sweep, finished long before the timeout
+    options.timeoutMs = 2000;
+    size_t alive = 0;
+    auto start = std::chrono::steady_clock::now();
+    stats = sweepHostRange((127u << 24) | (1u << 8) | 1, (127u << 24) | (1u << 8) | 254, options,
+                           [&](const SweepHost&) { alive++; });
+    double seconds = secondsSince(start);
+    std::cout << "  127.0.1.0/24: " << alive << " alive, " << stats.requests << " requests in " << seconds << " s" << std::endl;
+    assert(alive == 254 && stats.alive == 254);
+    assert(stats.requests == 254);           // Everyone answered the first round
+    assert(seconds < 1.5);
+
+    assert(icmpPing("127.0.0.3", 500));
+    assert(icmpPing("localhost", 500));
+    assert(!icmpPing("no-such-host.invalid", 200));
+
+    std::vector<std::string> hosts = sweepSubnet("127.0.2.0/29", options);
+    assert((hosts == std::vector<std::string>{"127.0.2.1", "127.0.2.2", "127.0.2.3", "127.0.2.4", "127.0.2.5", "127.0.2.6"}));
+}
+
+static void testSilentHost() {
+    // TEST-NET-2: nobody answers; both rounds wait their timeout
+    HostSweepOptions options;
+    options.timeoutMs = 200;
+    options.attempts = 2;
+    auto start = std::chrono::steady_clock::now();
+    HostSweepStats stats = sweepHostList({"198.51.100.77"}, options, nullptr);
+    double seconds = secondsSince(start);
+    assert(stats.alive == 0);
+    if (stats.icmpAvailable && stats.requests == 2) assert(seconds >= 0.39 && seconds < 1.5);
+}
+
+static void testCancel() {
+    std::atomic<bool> cancel{true};
+    int callbacks = 0;
+    auto start = std::chrono::steady_clock::now();
+    HostSweepStats stats = sweepHostRange((127u << 24) | (3u << 8) | 1, (127u << 24) | (3u << 8) | 254, HostSweepOptions(),
+                                          [&](const SweepHost&) { callbacks++; }, &cancel);
+    assert(callbacks == 0 && stats.requests == 0);
+    assert(secondsSince(start) < 0.5);
+}
+
+// Live ARP sweep of a local Ethernet subnet, e.g. FILEDUPER_ARP_TEST_SUBNET=192.168.1.0/24
+static void testLiveArp() {
+    const char* subnet = getenv("FILEDUPER_ARP_TEST_SUBNET");
+    if (!subnet) return;
+    HostSweepOptions options;
+    options.useIcmp = false;
+    std::vector<std::string> hosts = sweepSubnet(subnet, options);
+    std::cout << "  ARP sweep " << subnet << ": " << hosts.size() << " hosts" << std::endl;
+    for (const auto& host : hosts) std::cout << "   - " << host << std::endl;
+}
+
+int main() {
+    testLoopback();
+    testSilentHost();
+    testCancel();
+    testLiveArp();
+    std::cout << "host_discovery tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+#include "neighbor_cache.h"
+
+// Appends one RTM_NEWNEIGH/RTM_DELNEIGH message as the kernel would send it
+static void appendNeighbor(std::vector<char>& buffer, uint16_t type, const char* ip, const uint8_t* mac, uint16_t state) {
+    size_t offset = buffer.size();
+    size_t length = NLMSG_LENGTH(sizeof(struct ndmsg)) + RTA_SPACE(4) + (mac ? RTA_SPACE(6) : 0);
+    buffer.resize(offset + NLMSG_ALIGN(length), 0);
+    auto* header = (struct nlmsghdr*)&buffer[offset];
+    header->nlmsg_len = length;
+    header->nlmsg_type = type;
+    auto* body = (struct ndmsg*)NLMSG_DATA(header);
+    body->ndm_family = AF_INET;
+    body->ndm_ifindex = 2;
+    body->ndm_state = state;
+    auto* attribute = (struct rtattr*)((char*)body + NLMSG_ALIGN(sizeof(struct ndmsg)));
+    attribute->rta_type = NDA_DST;
+    attribute->rta_len = RTA_LENGTH(4);
+    inet_pton(AF_INET, ip, RTA_DATA(attribute));
+    if (mac) {
+        attribute = (struct rtattr*)((char*)attribute + RTA_SPACE(4));
+        attribute->rta_type = NDA_LLADDR;
+        attribute->rta_len = RTA_LENGTH(6);
+        memcpy(RTA_DATA(attribute), mac, 6);
+    }
+}
+
+static void appendDone(std::vector<char>& buffer) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + NLMSG_ALIGN(NLMSG_LENGTH(sizeof(int))), 0);
+    auto* header = (struct nlmsghdr*)&buffer[offset];
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(int));
+    header->nlmsg_type = NLMSG_DONE;
+}
+
+static const uint8_t MAC_A[6] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55};
+static const uint8_t MAC_B[6] = {0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb};
+
+static void testEvents() {
+    NeighborDiscoveryCache cache;
+    int changes = 0, removals = 0;
+    cache.setChangeCallback([&](const NeighborEntry&, bool removed) { changes++; if (removed) removals++; });
+
+    // Dump reply: two live neighbours, one failed entry, terminated by NLMSG_DONE
+    std::vector<char> dump;
+    appendNeighbor(dump, RTM_NEWNEIGH, "192.168.1.10", MAC_A, NUD_REACHABLE);
+    appendNeighbor(dump, RTM_NEWNEIGH, "192.168.1.20", MAC_B, NUD_STALE);
+    appendNeighbor(dump, RTM_NEWNEIGH, "192.168.1.30", nullptr, NUD_FAILED);
+    appendDone(dump);
+    bool more = cache.handleMessages(dump.data(), dump.size());
+    assert(!more);   // NLMSG_DONE ends the dump
+    auto all = cache.neighbors();
+    assert(all.size() == 2);
+    assert(all[0].ip == "192.168.1.10" && all[0].mac == "00:11:22:33:44:55" && all[0].ifindex == 2);
+    assert(all[1].ip == "192.168.1.20");
+    assert(changes == 2 && cache.generation() == 2);
+
+    // Range filter (host order)
+    assert(cache.neighbors(0xC0A8010F, 0xC0A801FF).size() == 1);
+
+    // State flapping does not count as a change, a new MAC does
+    std::vector<char> event;
+    appendNeighbor(event, RTM_NEWNEIGH, "192.168.1.10", MAC_A, NUD_STALE);
+    more = cache.handleMessages(event.data(), event.size());
+    assert(more);
+    (void)more;
+    assert(cache.generation() == 2);
+    event.clear();
+    appendNeighbor(event, RTM_NEWNEIGH, "192.168.1.10", MAC_B, NUD_REACHABLE);
+    cache.handleMessages(event.data(), event.size());
+    assert(cache.generation() == 3 && cache.neighbors()[0].mac == "66:77:88:99:aa:bb");
+
+    // Removal by RTM_DELNEIGH and by a FAILED state; unknown removals are ignored
+    event.clear();
+    appendNeighbor(event, RTM_DELNEIGH, "192.168.1.10", MAC_B, NUD_REACHABLE);
+    appendNeighbor(event, RTM_NEWNEIGH, "192.168.1.20", nullptr, NUD_FAILED);
+    appendNeighbor(event, RTM_DELNEIGH, "192.168.1.99", nullptr, 0);
+    cache.handleMessages(event.data(), event.size());
+    assert(cache.neighbors().empty());
+    assert(removals == 2 && cache.generation() == 5);
+
+    // Truncated datagram is ignored instead of read past its end
+    event.clear();
+    appendNeighbor(event, RTM_NEWNEIGH, "192.168.1.40", MAC_A, NUD_REACHABLE);
+    cache.handleMessages(event.data(), 10);
+    assert(cache.neighbors().empty());
+}
+
+// Resync after ENOBUFS: neighbours missing from the new dump were removed while events were lost
+static void testResync() {
+    NeighborDiscoveryCache cache;
+    int removals = 0;
+    cache.setChangeCallback([&](const NeighborEntry&, bool removed) { if (removed) removals++; });
+    std::vector<char> event;
+    appendNeighbor(event, RTM_NEWNEIGH, "192.168.1.10", MAC_A, NUD_REACHABLE);
+    appendNeighbor(event, RTM_NEWNEIGH, "192.168.1.20", MAC_B, NUD_REACHABLE);
+    cache.handleMessages(event.data(), event.size());
+    assert(cache.neighbors().size() == 2 && cache.generation() == 2);
+
+    // A failed dump keeps everything
+    cache.beginDump();
+    std::vector<char> failed;
+    appendNeighbor(failed, RTM_NEWNEIGH, "192.168.1.10", MAC_A, NUD_REACHABLE);
+    cache.handleMessages(failed.data(), failed.size());
+    size_t offset = failed.size();
+    appendDone(failed);
+    ((struct nlmsghdr*)&failed[offset])->nlmsg_type = NLMSG_ERROR;
+    cache.handleMessages(failed.data() + offset, failed.size() - offset);
+    assert(cache.neighbors().size() == 2 && removals == 0);
+
+    cache.beginDump();
+    std::vector<char> dump;
+    appendNeighbor(dump, RTM_NEWNEIGH, "192.168.1.10", MAC_A, NUD_STALE);
+    appendNeighbor(dump, RTM_NEWNEIGH, "192.168.1.30", MAC_B, NUD_REACHABLE);
+    appendDone(dump);
+    cache.handleMessages(dump.data(), dump.size());
+    auto all = cache.neighbors();
+    assert(all.size() == 2 && all[0].ip == "192.168.1.10" && all[1].ip == "192.168.1.30");
+    assert(removals == 1 && cache.generation() == 4);
+
+    // Outside a dump NLMSG_DONE removes nothing
+    std::vector<char> done;
+    appendDone(done);
+    cache.handleMessages(done.data(), done.size());
+    assert(cache.neighbors().size() == 2 && removals == 1);
+}
+
+static void testServices() {
+    NeighborDiscoveryCache cache;
+    std::vector<char> event;
+    appendNeighbor(event, RTM_NEWNEIGH, "10.0.0.5", MAC_A, NUD_REACHABLE);
+    appendNeighbor(event, RTM_NEWNEIGH, "10.0.0.6", MAC_A, NUD_REACHABLE);
+    cache.handleMessages(event.data(), event.size());
+
+    time_t now = time(nullptr);
+    cache.recordServices("10.0.0.5", {21, 445});
+    cache.recordServices("10.0.0.6", {}, now - 7200);    // Probed two hours ago
+    std::vector<std::string> candidates = {"10.0.0.5", "10.0.0.6", "10.0.0.7"};
+    assert((cache.hostsToProbe(candidates, 3600) == std::vector<std::string>{"10.0.0.6", "10.0.0.7"}));
+    assert(cache.cachedServices(0x0A000000, 0x0A0000FF, 3600).size() == 1);
+
+    // Another device took 10.0.0.5: probe again despite the fresh entry
+    event.clear();
+    appendNeighbor(event, RTM_NEWNEIGH, "10.0.0.5", MAC_B, NUD_REACHABLE);
+    cache.handleMessages(event.data(), event.size());
+    assert((cache.hostsToProbe({"10.0.0.5"}, 3600) == std::vector<std::string>{"10.0.0.5"}));
+    cache.recordServices("10.0.0.5", {2049});
+    assert(cache.hostsToProbe({"10.0.0.5"}, 3600).empty());
+
+    // Persistence
+    std::string file = "/tmp/fileduper_test_discovery_cache.dat";
+    bool saved = cache.save(file);
+    assert(saved);
+    NeighborDiscoveryCache restored;
+    bool loaded = restored.load(file);
+    assert(loaded);
+    auto services = restored.cachedServices(0, 0xffffffff, 3 * 3600);
+    assert(services.size() == 2);
+    assert(services[0].ip == "10.0.0.5" && services[0].mac == "66:77:88:99:aa:bb");
+    assert((services[0].openPorts == std::vector<int>{2049}));
+    assert(services[1].ip == "10.0.0.6" && services[1].openPorts.empty() && services[1].probedAt == now - 7200);
+    restored.clearServices();
+    assert(restored.cachedServices(0, 0xffffffff, 3600).empty());
+    std::remove(file.c_str());
+    loaded = restored.load(file);
+    assert(!loaded);
+    (void)saved;
+    (void)loaded;
+}
+
+// Live subscription: the dump must work wherever rtnetlink is available
+static void testLive() {
+    NeighborDiscoveryCache cache;
+    if (!cache.start()) {
+        std::cout << "  (rtnetlink not available)" << std::endl;
+        return;
+    }
+    assert(cache.isRunning());
+    std::cout << "  live neighbour table: " << cache.neighbors().size() << " entries" << std::endl;
+    cache.stop();
+    assert(!cache.isRunning());
+
+    // UI and scan thread may start the cache at the same time: one subscription, one event thread
+    std::vector<std::thread> starters;
+    std::atomic<int> started{0};
+    for (int i = 0; i < 4; i++) starters.emplace_back([&]() { if (cache.start()) started++; });
+    for (auto& starter : starters) starter.join();
+    assert(started == 4 && cache.isRunning());
+    cache.stop();
+    cache.stop();
+    assert(!cache.isRunning());
+}
+
+int main() {
+    testEvents();
+    testResync();
+    testServices();
+    testLive();
+    std::cout << "neighbor_cache tests passed" << std::endl;
+    return 0;
+}
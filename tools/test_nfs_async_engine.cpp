@@ -0,0 +1,169 @@
+#include <iostream>
+#include <cassert>
+#include <map>
+#include <set>
+#include <openssl/md5.h>
+#include "nfs_async_engine.h"
+
+// In-memory NFS server stand-in: requests are queued and answered in reverse
+// order on service(), reads are capped like a small server rsize would.
+class FakeNfsServer : public NfsBackend {
+public:
+    std::map<std::string, std::string> files;     // path -> content
+    std::set<std::string> dirs;
+    size_t maxReply = 3000;
+    int outstanding = 0;
+    int maxOutstanding = 0;
+    int maxReadsPerFile = 0;
+    std::map<std::string, int> readsInFlight;
+
+    bool readdirplus(const std::string& path, DirCallback cb) override {
+        if (!dirs.count(path)) return queue([cb]() { cb(-2, {}); });
+        std::vector<NfsDirEntry> entries{{".", true, false, 0, 0, 0}, {"..", true, false, 0, 0, 0}};
+        std::string prefix = path == "/" ? "/" : path + "/";
+        for (const auto& dir : dirs)
+            if (dir.size() > prefix.size() && dir.compare(0, prefix.size(), prefix) == 0 && dir.find('/', prefix.size()) == std::string::npos)
+                entries.push_back({dir.substr(prefix.size()), true, false, 0, 0, 0});
+        uint64_t inode = 100;
+        for (const auto& [file, content] : files)
+            if (file.compare(0, prefix.size(), prefix) == 0 && file.find('/', prefix.size()) == std::string::npos)
+                entries.push_back({file.substr(prefix.size()), false, true, content.size(), 1700000000, inode++});
+        return queue([cb, entries]() mutable { cb(0, std::move(entries)); });
+    }
+
+    bool open(const std::string& path, OpenCallback cb) override {
+        auto it = files.find(path);
+        if (it == files.end()) return queue([cb]() { cb(-2, nullptr); });
+        return queue([cb, it]() { cb(0, (void*)&it->first); });
+    }
+
+    bool pread(void* handle, uint64_t offset, size_t count, ReadCallback cb) override {
+        const std::string& path = *(const std::string*)handle;
+        int& inFlight = readsInFlight[path];
+        maxReadsPerFile = std::max(maxReadsPerFile, ++inFlight);
+        return queue([this, cb, path, offset, count]() {
+            readsInFlight[path]--;
+            const std::string& content = files[path];
+            size_t len = offset < content.size() ? std::min({count, maxReply, content.size() - offset}) : 0;
+            cb((int)len, content.data() + offset, len);
+        });
+    }
+
+    void close(void*) override {}
+
+    bool service(int) override {
+        std::vector<std::function<void()>> replies;
+        replies.swap(m_pending);
+        for (auto it = replies.rbegin(); it != replies.rend(); ++it) {
+            outstanding--;
+            (*it)();
+        }
+        return true;
+    }
+
+    bool unlink(const std::string& path, std::string& error) override {
+        if (files.erase(path)) return true;
+        error = "NFS3ERR_NOENT";
+        return false;
+    }
+
+private:
+    bool queue(std::function<void()> reply) {
+        m_pending.push_back(std::move(reply));
+        maxOutstanding = std::max(maxOutstanding, ++outstanding);
+        return true;
+    }
+
+    std::vector<std::function<void()>> m_pending;
+};
+
+static std::string md5Of(const std::string& data) {
+    unsigned char digest[MD5_DIGEST_LENGTH];
+    MD5((const unsigned char*)data.data(), data.size(), digest);
+    char hex[MD5_DIGEST_LENGTH * 2 + 1];
+    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    return hex;
+}
+
+int main() {
+    std::string server, path;
+    assert(parseNfsUrl("nfs://192.168.1.10/export/media/a.mkv", server, path));
+    assert(server == "192.168.1.10" && path == "/export/media/a.mkv");
+    assert(parseNfsUrl("nfs://nas", server, path) && server == "nas" && path == "/");
+    assert(!parseNfsUrl("ftp://nas/x", server, path));
+    assert(nfsUrl("nas", "/export") == "nfs://nas/export" && isNfsUrl(nfsUrl("nas", "x")));
+
+    FakeNfsServer nfs;
+    nfs.dirs = {"/", "/a", "/a/deep", "/a/deep/er", "/b"};
+    for (int i = 0; i < 40; i++) nfs.files["/b/f" + std::to_string(i)] = std::string(i * 10, 'x');
+    std::string big;
+    for (int i = 0; i < 50000; i++) big += (char)('a' + i % 23);
+    nfs.files["/a/big.bin"] = big;
+    nfs.files["/a/deep/er/hidden"] = "too deep";
+    nfs.files["/a/deep/shallow"] = "ok";
+    nfs.files["/empty"] = "";
+
+    // Walk: sizes from READDIRPLUS, depth limit, window respected
+    NfsAsyncEngine engine(nfs, 4, 8192, 3);
+    std::map<std::string, uint64_t> seen;
+    std::vector<std::string> dirsSeen;
+    bool walked = engine.walk("/", 2, [&](const NfsAsyncEngine::FileInfo& file) { seen[file.path] = file.size; },
+                              nullptr, [&](const std::string& dir) { dirsSeen.push_back(dir); });
+    assert(walked);
+    assert(seen.size() == 43);
+    assert(seen["/a/big.bin"] == big.size() && seen["/b/f7"] == 70 && seen.count("/empty"));
+    assert(!seen.count("/a/deep/er/hidden") && seen.count("/a/deep/shallow"));
+    assert(dirsSeen.size() == 4);
+    assert(nfs.maxOutstanding <= 4 && engine.stats().readdirs == 4);
+
+    // Missing directory counts as an error, not a failure of the walk
+    NfsAsyncEngine missing(nfs);
+    walked = missing.walk("/nope", 5, [](const NfsAsyncEngine::FileInfo&) {});
+    assert(walked && missing.stats().errors == 1);
+
+    // Hash: out-of-order short replies reassembled, several preads per file in flight
+    nfs.maxOutstanding = 0;
+    std::vector<NfsAsyncEngine::FileInfo> toHash{{"/a/big.bin", big.size(), 0, 0}, {"/b/f39", 390, 0, 0},
+                                                 {"/empty", 0, 0, 0}, {"/gone", 10, 0, 0}};
+    std::map<std::string, std::string> hashes;
+    NfsAsyncEngine hasher(nfs, 6, 8192, 3);
+    bool hashed = hasher.hashFiles(toHash, [&](const NfsAsyncEngine::FileInfo& file, const std::string& hex) {
+        assert(!hashes.count(file.path));
+        hashes[file.path] = hex;
+    });
+    assert(hashed);
+    assert(hashes.size() == 4);
+    assert(hashes["/a/big.bin"] == md5Of(big));
+    assert(hashes["/b/f39"] == md5Of(std::string(390, 'x')));
+    assert(hashes["/empty"] == md5Of(""));
+    assert(hashes["/gone"].empty());
+    assert(nfs.maxOutstanding <= 6 && nfs.maxReadsPerFile > 1);
+    assert(hasher.stats().bytes == big.size() + 390 && hasher.stats().errors == 1);
+
+    // File shrank after the listing: no hash
+    hashes.clear();
+    hashed = hasher.hashFiles({{"/b/f1", 500, 0, 0}}, [&](const NfsAsyncEngine::FileInfo& file, const std::string& hex) {
+        hashes[file.path] = hex;
+    });
+    assert(hashed);
+    assert(hashes.size() == 1 && hashes["/b/f1"].empty());
+
+    // Stop before starting: nothing is opened
+    std::atomic<bool> stop{true};
+    int calls = 0;
+    hashed = hasher.hashFiles(toHash, [&](const NfsAsyncEngine::FileInfo&, const std::string&) { calls++; }, &stop);
+    assert(hashed);
+    assert(calls == 0);
+
+    std::string error;
+    bool deleted = nfs.unlink("/b/f0", error);
+    bool deletedTwice = nfs.unlink("/b/f0", error);
+    assert(deleted && !deletedTwice && error == "NFS3ERR_NOENT");
+    (void)walked;
+    (void)hashed;
+    (void)deleted;
+    (void)deletedTwice;
+
+    std::cout << "nfs_async_engine tests passed" << std::endl;
+    return 0;
+}
@@ -13,7 +13,7 @@ int main(int argc, char** argv) {
     std::string server = argv[1];
     auto exports = listNfsExports(server);
     if (exports.empty()) {
-        std::cout << "No exports found (or showmount not available) for: " << server << std::endl;
+        std::cout << "No exports found (or no mountd answer) for: " << server << std::endl;
         return 2;
     }
 
@@ -7,8 +7,8 @@ if [[ $# -lt 1 ]]; then
 fi
 
 for server in "$@"; do
-  printf "Testing showmount exports for %s...\n" "$server"
-  ./test_nfs_listexports "$server" || echo "No exports for $server (maybe showmount missing)"
+  printf "Testing MOUNT exports for %s...\n" "$server"
+  ./test_nfs_listexports "$server" || echo "No exports for $server (no portmapper/mountd answer)"
 done
 
 echo "Done." 
@@ -0,0 +1,292 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "nfs_mount_rpc.h"
+
+static void putU32(std::string& out, uint32_t value) {
+    value = htonl(value);
+    out.append((const char*)&value, 4);
+}
+
+static uint32_t getU32(const std::string& data, size_t pos) {
+    uint32_t value = 0;
+    if (pos + 4 <= data.size()) memcpy(&value, data.data() + pos, 4);
+    return ntohl(value);
+}
+
+static void putString(std::string& out, const std::string& text) {
+    putU32(out, (uint32_t)text.size());
+    out += text;
+    out.append((4 - text.size() % 4) % 4, '\0');
+}
+
+static std::string exportList(const std::vector<NfsExport>& exports) {
+    std::string xdr;
+    for (const auto& entry : exports) {
+        putU32(xdr, 1);
+        putString(xdr, entry.path);
+        for (const auto& group : entry.groups) {
+            putU32(xdr, 1);
+            putString(xdr, group);
+        }
+        putU32(xdr, 0);
+    }
+    putU32(xdr, 0);
+    return xdr;
+}
+
+static std::string acceptedReply(uint32_t xid, const std::string& result) {
+    std::string reply;
+    putU32(reply, xid);
+    putU32(reply, 1);                     // REPLY
+    putU32(reply, 0);                     // MSG_ACCEPTED
+    putU32(reply, 0);                     // AUTH_NONE verifier
+    putU32(reply, 0);
+    putU32(reply, 0);                     // SUCCESS
+    return reply + result;
+}
+
+// Stand-in for portmapper + mountd of one "server" (a loopback address of its own)
+struct ServerStandIn {
+    std::string ip;
+    uint16_t mountUdpPort = 0;            // 0 = not registered
+    uint16_t mountTcpPort = 0;
+    std::vector<NfsExport> exports;
+    bool silent = false;
+    int dropFirst = 0;                    // Portmapper requests to ignore (retransmit test)
+    std::atomic<int> portmapCalls{0};
+    std::atomic<int> exportCalls{0};
+
+    int portmap = -1, mountUdp = -1, mountTcp = -1;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+
+    static int bindSocket(const std::string& ip, int type, uint16_t port) {
+        int fd = socket(AF_INET, type, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
+        if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (type == SOCK_STREAM) listen(fd, 8);
+        return fd;
+    }
+
+    static uint16_t portOf(int fd) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        getsockname(fd, (sockaddr*)&addr, &len);
+        return ntohs(addr.sin_port);
+    }
+
+    bool start(uint16_t portmapPort, bool withUdp, bool withTcp) {
+        portmap = bindSocket(ip, SOCK_DGRAM, portmapPort);
+        if (portmap < 0) return false;
+        if (withUdp) {
+            mountUdp = bindSocket(ip, SOCK_DGRAM, 0);
+            mountUdpPort = portOf(mountUdp);
+        }
+        if (withTcp) {
+            mountTcp = bindSocket(ip, SOCK_STREAM, 0);
+            mountTcpPort = portOf(mountTcp);
+        }
+        worker = std::thread([this]() { run(); });
+        return true;
+    }
+
+    void stop() {
+        stopping = true;
+        worker.join();
+        for (int fd : {portmap, mountUdp, mountTcp}) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    std::string answer(const std::string& call, bool isPortmap) {
+        uint32_t xid = getU32(call, 0);
+        uint32_t program = getU32(call, 12), procedure = getU32(call, 20);
+        std::string result;
+        if (isPortmap) {
+            assert(program == 100000 && procedure == 3);
+            assert(getU32(call, 40) == 100005 && getU32(call, 44) == 3);
+            uint32_t protocol = getU32(call, 48);
+            putU32(result, protocol == 17 ? mountUdpPort : (protocol == 6 ? mountTcpPort : 0));
+        } else {
+            assert(program == 100005 && getU32(call, 16) == 3 && procedure == 5);
+            exportCalls++;
+            result = exportList(exports);
+        }
+        return acceptedReply(xid, result);
+    }
+
+    void run() {
+        char buffer[65536];
+        while (!stopping) {
+            std::vector<pollfd> fds;
+            for (int fd : {portmap, mountUdp, mountTcp}) {
+                if (fd >= 0) fds.push_back({fd, POLLIN, 0});
+            }
+            if (poll(fds.data(), fds.size(), 20) <= 0) continue;
+            for (const auto& entry : fds) {
+                if (!(entry.revents & POLLIN)) continue;
+                if (entry.fd == mountTcp) {
+                    int client = accept(mountTcp, nullptr, nullptr);
+                    std::string in;
+                    while (in.size() < 4 || in.size() < 4 + (getU32(in, 0) & 0x7fffffff)) {
+                        ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+                        if (n <= 0) break;
+                        in.append(buffer, n);
+                    }
+                    std::string reply = answer(in.substr(4), false);
+                    // Two fragments, sent apart
+                    size_t half = reply.size() / 2;
+                    std::string first, second;
+                    putU32(first, (uint32_t)half);
+                    first += reply.substr(0, half);
+                    putU32(second, 0x80000000u | (uint32_t)(reply.size() - half));
+                    second += reply.substr(half);
+                    send(client, first.data(), first.size(), MSG_NOSIGNAL);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    send(client, second.data(), second.size(), MSG_NOSIGNAL);
+                    close(client);
+                    continue;
+                }
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                ssize_t n = recvfrom(entry.fd, buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromLen);
+                if (n <= 0 || silent) continue;
+                bool isPortmap = entry.fd == portmap;
+                if (isPortmap) {
+                    portmapCalls++;
+                    if (dropFirst > 0) {
+                        dropFirst--;
+                        continue;
+                    }
+                }
+                std::string reply = answer(std::string(buffer, n), isPortmap);
+                sendto(entry.fd, reply.data(), reply.size(), 0, (sockaddr*)&from, fromLen);
+            }
+        }
+    }
+};
+
+static void testParser() {
+    std::vector<NfsExport> exports;
+    assert(parseMountExportList(exportList({{"/export/data", {"192.168.1.0/24", "backup"}}, {"/srv/nfs4", {}}}), exports));
+    assert(exports.size() == 2);
+    assert(exports[0].path == "/export/data" && exports[0].groups.size() == 2 && exports[0].groups[1] == "backup");
+    assert(exports[1].path == "/srv/nfs4" && exports[1].groups.empty());
+
+    std::vector<NfsExport> none;
+    assert(parseMountExportList(exportList({}), none) && none.empty());
+    std::string truncated = exportList({{"/export/data", {}}});
+    truncated.resize(10);
+    assert(!parseMountExportList(truncated, none));
+}
+
+static void testQueries() {
+    // Portmapper port shared by all stand-ins, each on its own loopback address
+    ServerStandIn udpServer, tcpServer, unregistered, silentServer;
+    udpServer.ip = "127.0.0.2";
+    udpServer.exports = {{"/export/data", {"192.168.1.0/24"}}, {"/export/media", {}}};
+    tcpServer.ip = "127.0.0.3";
+    tcpServer.exports = {{"/volume1/backup", {"*"}}};
+    unregistered.ip = "127.0.0.5";
+    unregistered.dropFirst = 1;
+    silentServer.ip = "127.0.0.6";
+    silentServer.silent = true;
+
+    uint16_t portmapPort = 0;
+    for (int attempt = 0; attempt < 20 && !portmapPort; attempt++) {
+        int probe = ServerStandIn::bindSocket("127.0.0.2", SOCK_DGRAM, 0);
+        uint16_t candidate = ServerStandIn::portOf(probe);
+        close(probe);
+        if (udpServer.start(candidate, true, false)) {
+            if (tcpServer.start(candidate, false, true) && unregistered.start(candidate, false, false) &&
+                silentServer.start(candidate, false, false)) {
+                portmapPort = candidate;
+            }
+        }
+    }
+    assert(portmapPort);
+
+    // 127.0.0.4: nothing listens - ICMP port unreachable
+    std::vector<std::string> servers = {"127.0.0.2", "127.0.0.3", "127.0.0.4", "127.0.0.5", "127.0.0.6", "no-such-host.invalid"};
+    std::map<std::string, double> doneAfterMs;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<NfsExportReply> replies = queryNfsExports(servers, 1500, [&](const NfsExportReply& reply) {
+        doneAfterMs[reply.server] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }, nullptr, portmapPort);
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    assert(replies.size() == servers.size());
+    for (size_t i = 0; i < servers.size(); i++) assert(replies[i].server == servers[i]);
+
+    assert(replies[0].ok && replies[0].exports.size() == 2);
+    assert(replies[0].exports[0].path == "/export/data" && replies[0].exports[0].groups[0] == "192.168.1.0/24");
+
+    assert(replies[1].ok && replies[1].exports.size() == 1 && replies[1].exports[0].path == "/volume1/backup");
+
+    assert(!replies[2].ok && replies[2].error.find("no portmapper") == 0);
+    assert(doneAfterMs["127.0.0.4"] < 500);
+
+    assert(!replies[3].ok && replies[3].error == "mountd not registered");
+    assert(unregistered.portmapCalls >= 3);    // Dropped + retransmitted GETPORT(UDP), then GETPORT(TCP)
+
+    assert(!replies[4].ok && replies[4].error == "timeout");
+    assert(!replies[5].ok && replies[5].error == "unknown host");
+
+    // The servers are asked side by side: answered ones don't wait for the silent one
+    assert(doneAfterMs["127.0.0.2"] < 500 && doneAfterMs["127.0.0.3"] < 500);
+    assert(totalMs >= 1400 && totalMs < 2500);
+
+    // Cancel
+    std::atomic<bool> cancel{true};
+    std::vector<NfsExportReply> cancelled = queryNfsExports({"127.0.0.6"}, 5000, nullptr, &cancel, portmapPort);
+    assert(cancelled[0].error == "cancelled");
+
+    // Cache: second call answers without asking again, failures included
+    clearNfsExportCache();
+    int exportCalls = udpServer.exportCalls;
+    std::vector<NfsExportReply> first = cachedNfsExports({"127.0.0.2", "127.0.0.4"}, 300, 1000, portmapPort);
+    assert(first[0].ok && !first[1].ok);
+    assert(udpServer.exportCalls == exportCalls + 1);
+    start = std::chrono::steady_clock::now();
+    std::vector<NfsExportReply> second = cachedNfsExports({"127.0.0.4", "127.0.0.2"}, 300, 1000, portmapPort);
+    assert(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(50));
+    assert(second[1].ok && second[1].exports.size() == 2 && !second[0].ok);
+    assert(udpServer.exportCalls == exportCalls + 1);
+    // Expired entries are asked again
+    std::vector<NfsExportReply> expired = cachedNfsExports({"127.0.0.2"}, 0, 1000, portmapPort);
+    assert(expired[0].ok && udpServer.exportCalls == exportCalls + 2);
+    clearNfsExportCache();
+
+    udpServer.stop();
+    tcpServer.stop();
+    unregistered.stop();
+    silentServer.stop();
+}
+
+int main() {
+    testParser();
+    testQueries();
+    std::cout << "nfs_mount_rpc tests passed" << std::endl;
+    return 0;
+}
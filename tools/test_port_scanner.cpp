@@ -0,0 +1,173 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "port_scanner.h"
+
+static int listenOn(const std::string& ip, uint16_t& port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = 0;
+    inet_pton(AF_INET, ip.c_str(), &addr.sin_addr);
+    int bound = bind(fd, (sockaddr*)&addr, sizeof(addr));
+    int listening = listen(fd, 512);
+    assert(bound == 0 && listening == 0);
+    (void)bound;
+    (void)listening;
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+
+// A port nobody listens on (bound and closed again)
+static int closedPort() {
+    uint16_t port = 0;
+    close(listenOn("127.0.0.1", port));
+    return port;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void testOpenAndRefused() {
+    uint16_t portA = 0, portB = 0;
+    int listenerA = listenOn("127.0.0.1", portA);
+    int listenerB = listenOn("127.0.0.3", portB);
+    int closed = closedPort();
+
+    PortScanOptions options;
+    options.ports = {portA, portB, closed};
+    options.timeoutMs = 1000;
+    std::map<std::string, PortScanHostResult> results;
+    std::vector<std::pair<std::string, int>> opened;
+    PortScanStats stats = massPortScan({"127.0.0.1", "127.0.0.3", "127.0.0.4", "not-an-ip"}, options,
+        [&](const PortScanHostResult& host) { results[host.ip] = host; },
+        [&](const std::string& ip, int port) { opened.push_back({ip, port}); });
+
+    assert(stats.hosts == 4 && stats.probes == 12);
+    assert(results.size() == 4);
+    assert((results["127.0.0.1"].openPorts == std::vector<int>{portA}));
+    assert((results["127.0.0.3"].openPorts == std::vector<int>{portB}));
+    assert(results["127.0.0.4"].openPorts.empty() && results["127.0.0.4"].responded);
+    // Invalid entries come back as 0.0.0.0 without response
+    assert(results["0.0.0.0"].openPorts.empty() && !results["0.0.0.0"].responded);
+    assert(stats.open == 2 && opened.size() == 2);
+    assert(stats.refused == 7 && stats.unreachable == 3);
+    close(listenerA);
+    close(listenerB);
+}
+
+// Thousands of targets in flight: a /20 on loopback (4096 hosts x 2 ports)
+static void testLargeSweep() {
+    uint16_t port = 0;
+    int listener = listenOn("127.0.0.1", port);
+    PortScanOptions options;
+    options.ports = {port, closedPort()};
+    options.maxInFlight = 2048;
+    std::set<std::string> seen;
+    size_t withOpen = 0;
+    uint32_t first = (127u << 24), last = first + 4095;
+    auto start = std::chrono::steady_clock::now();
+    PortScanStats stats = massPortScanRange(first, last, options, [&](const PortScanHostResult& host) {
+        seen.insert(host.ip);
+        if (!host.openPorts.empty()) withOpen++;
+    });
+    double seconds = secondsSince(start);
+    std::cout << "  /20 sweep: " << stats.probes << " probes in " << seconds << " s" << std::endl;
+    assert(seen.size() == 4096 && stats.hosts == 4096 && stats.probes == 8192);
+    assert(seen.count("127.0.0.0") && seen.count("127.0.15.255"));
+    assert(withOpen == 1);
+    assert(seconds < 20);
+    close(listener);
+}
+
+static void testRateLimit() {
+    PortScanOptions options;
+    options.ports = {closedPort()};
+    options.ratePerSecond = 1000;
+    std::vector<std::string> hosts;
+    for (int i = 1; i <= 300; i++) hosts.push_back("127.0.1." + std::to_string(i % 256));
+    auto start = std::chrono::steady_clock::now();
+    PortScanStats stats = massPortScan(hosts, options, nullptr);
+    double seconds = secondsSince(start);
+    assert(stats.probes == 300);
+    // 300 connects at 1000/s with a 50 connect burst
+    assert(seconds > 0.2 && seconds < 2.0);
+}
+
+static void testCancel() {
+    PortScanOptions options;
+    options.ports = {closedPort()};
+    options.ratePerSecond = 2000;
+    std::atomic<bool> cancel{false};
+    int callbacks = 0;
+    bool afterCancel = false;
+    PortScanStats stats = massPortScanRange((127u << 24) + 1, (127u << 24) + 60000, options,
+        [&](const PortScanHostResult&) {
+            if (cancel) afterCancel = true;
+            if (++callbacks == 100) cancel = true;
+        }, nullptr, &cancel);
+    assert(callbacks == 100 && !afterCancel);
+    assert(stats.hosts < 1000);
+}
+
+// Per-target deadline: a connect that never completes is timed out on its own
+static void testTimeout() {
+    // Full backlog on a listener that never accepts: further SYNs are dropped
+    uint16_t port = 0;
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.7", &addr.sin_addr);
+    int bound = bind(listener, (sockaddr*)&addr, sizeof(addr));
+    int listening = listen(listener, 0);
+    assert(bound == 0 && listening == 0);
+    (void)bound;
+    (void)listening;
+    socklen_t len = sizeof(addr);
+    getsockname(listener, (sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+    std::vector<int> fillers;
+    for (int i = 0; i < 4; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        connect(fd, (sockaddr*)&addr, sizeof(addr));
+        fillers.push_back(fd);
+    }
+    usleep(100000);
+
+    PortScanOptions options;
+    options.ports = {port};
+    options.timeoutMs = 200;
+    auto start = std::chrono::steady_clock::now();
+    PortScanStats stats = massPortScan({"127.0.0.7"}, options, nullptr);
+    double seconds = secondsSince(start);
+    if (stats.timedOut == 1) {
+        assert(seconds >= 0.19 && seconds < 1.0);
+    } else {
+        std::cout << "  (kernel accepted the SYN, timeout path not exercised)" << std::endl;
+    }
+    for (int fd : fillers) close(fd);
+    close(listener);
+}
+
+int main() {
+    testOpenAndRefused();
+    testLargeSweep();
+    testRateLimit();
+    testCancel();
+    testTimeout();
+    assert(portServiceName(445) == "SMB-CIFS" && portServiceName(8080) == "8080");
+    std::cout << "port_scanner tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include "remote_bandwidth.h"
+
+int main() {
+    // Unlimited: never waits
+    TokenBucket bucket;
+    assert(bucket.reserve(100 * 1024 * 1024).count() == 0);
+
+    // 1 MB/s with a 0.25 s burst: 256 KB free, the next 512 KB cost ~0.5 s
+    bucket.setRate(1024 * 1024);
+    assert(bucket.reserve(256 * 1024).count() == 0);
+    auto wait = bucket.reserve(512 * 1024);
+    assert(wait >= std::chrono::milliseconds(450) && wait <= std::chrono::milliseconds(550));
+
+    // Raising the limit live drops the old debt
+    bucket.setRate(100 * 1024 * 1024);
+    assert(bucket.reserve(1024 * 1024).count() == 0);
+    bucket.setRate(0);
+    assert(bucket.reserve(1ULL << 30).count() == 0);
+
+    // consume() actually paces: 3 x 64 KB at 256 KB/s (64 KB burst) ~ 0.5 s
+    TokenBucket paced(256 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 3; i++) paced.consume(64 * 1024);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    assert(ms >= 400);
+
+    RemoteThroughputTracker tracker;
+    const std::string server = "ftp://10.0.0.5:21";
+    assert(tracker.timeoutFor(server, 1LL << 30, 5) == 5);                 // Nothing measured yet
+    assert(tracker.timeoutFor(server, 50LL << 20, 5, 3600, 1 << 20) >= 150); // ... but capped at 1 MB/s
+    assert(tracker.suggestedConnections(server, 1024, 8) == 8);
+
+    tracker.record(server, 10 * 1024 * 1024, 1.0, 0.05);                  // 10 MB/s, 50 ms
+    RemoteEstimate e;
+    assert(tracker.estimate(server, e) && e.samples == 1);
+    assert(e.bytesPerSec > 10.4e6 && e.bytesPerSec < 10.5e6 && e.latencySec == 0.05);
+    tracker.record(server, 1000, 0.001, 0.15);                             // Small file: latency only
+    assert(tracker.estimate(server, e) && e.bytesPerSec > 10.4e6 && e.latencySec > 0.05 && e.latencySec < 0.15);
+
+    // 1 GB at ~10 MB/s: 3 x ~100 s
+    int timeout = tracker.timeoutFor(server, 1LL << 30, 5);
+    assert(timeout > 250 && timeout < 350);
+    assert(tracker.timeoutFor(server, 1000, 5) == 5);
+    // A bandwidth cap stretches the timeout
+    assert(tracker.timeoutFor(server, 10 * 1024 * 1024, 5, 3600, 1024 * 1024) >= 30);
+
+    // Small files on a high-latency link need more connections than big ones
+    int smallFiles = tracker.suggestedConnections(server, 64 * 1024, 32);   // 1 + 0.08 s * 10 MB/s / 64 KB
+    assert(smallFiles >= 10 && smallFiles < 32);
+    assert(tracker.suggestedConnections(server, 1LL << 30, 16) == 2);
+
+    std::cout << "remote_bandwidth tests passed" << std::endl;
+    return 0;
+}
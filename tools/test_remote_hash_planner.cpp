@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cassert>
+#include "remote_hash_planner.h"
+
+static HashPlanMember local(const std::string& file) {
+    return {file, false, RemoteHashSource::Transfer};
+}
+
+static HashPlanMember remote(const std::string& file, RemoteHashSource source = RemoteHashSource::Transfer) {
+    return {file, true, source};
+}
+
+int main() {
+    const long long kSample = 64 * 1024;
+    const long long kBig = 100LL * 1024 * 1024;
+
+    std::vector<HashPlanGroup> groups = {
+        // Mixed: one local, two remotes without hash -> sample all remotes
+        {kBig, {local("/a"), remote("ftp://h/a1"), remote("ftp://h/a2")}},
+        // Remote unique among remotes, server offers MD5 -> no transfer
+        {kBig + 1, {local("/b"), remote("ftp://h/b", RemoteHashSource::ServerMD5)}},
+        // Cached peer: sampling cannot rule the other one out
+        {kBig + 2, {remote("ftp://h/c1", RemoteHashSource::Cached), remote("ftp://h/c2")}},
+        // Small files are downloaded outright
+        {1000, {local("/d"), remote("ftp://h/d")}},
+        // SHA-256 only: fine among remotes, useless against a local MD5
+        {kBig + 3, {remote("ftp://h/e1", RemoteHashSource::ServerOther), remote("ftp://h/e2", RemoteHashSource::ServerOther)}},
+        {kBig + 4, {local("/f"), remote("ftp://h/f", RemoteHashSource::ServerOther)}},
+        // Local only and singletons stay out of the remote plan
+        {5000, {local("/g1"), local("/g2")}},
+        {7, {remote("ftp://h/single")}},
+    };
+    RemoteHashPlan plan = planRemoteHashing(groups, kSample, true);
+
+    assert(plan.steps.at("ftp://h/a1") == RemoteHashStep::Sample);
+    assert(plan.steps.at("ftp://h/a2") == RemoteHashStep::Sample);
+    assert(plan.steps.at("ftp://h/b") == RemoteHashStep::ServerDigest);
+    assert(plan.steps.at("ftp://h/c1") == RemoteHashStep::Known);
+    assert(plan.steps.at("ftp://h/c2") == RemoteHashStep::Download);
+    assert(plan.steps.at("ftp://h/d") == RemoteHashStep::Download);
+    assert(plan.steps.at("ftp://h/e1") == RemoteHashStep::ServerDigest);
+    assert(plan.steps.at("ftp://h/f") == RemoteHashStep::Download);
+    assert(!plan.steps.count("ftp://h/single"));
+
+    assert(plan.mixedSizes.count(kBig) && plan.mixedSizes.count(1000) && !plan.mixedSizes.count(5000));
+    assert(plan.sampledSizes.size() == 1 && plan.sampledSizes.count(kBig));
+    assert(plan.localFiles == 6 && plan.remoteFiles == 9);
+    assert(plan.sampleBytes == 4 * kSample);
+    assert(plan.downloadBytes == (kBig + 2) + 1000 + (kBig + 4));
+    assert(plan.pendingBytes == 2 * kBig);
+    assert(plan.maxTransferBytes() == plan.expectedTransferBytes() + 2 * kBig);
+
+    // a2 matches the local file, a1 matches nothing -> only a2 is downloaded
+    std::vector<std::string> downloads = applySamples(plan, kBig, {"L"}, {{"ftp://h/a1", "X"}, {"ftp://h/a2", "L"}});
+    assert(downloads.size() == 1 && downloads[0] == "ftp://h/a2");
+    assert(plan.steps.at("ftp://h/a1") == RemoteHashStep::Skip);
+    assert(plan.skipped == 1 && plan.sampled == 0 && plan.pendingBytes == 0);
+    assert(plan.downloadBytes == (kBig + 2) + 1000 + (kBig + 4) + kBig);
+
+    // Two remotes with the same sample, or a failed sample -> download
+    {
+        std::vector<HashPlanGroup> remoteOnly = {{kBig, {remote("r1"), remote("r2"), remote("r3")}}};
+        RemoteHashPlan p = planRemoteHashing(remoteOnly, kSample, true);
+        assert(p.mixedSizes.empty() && p.sampled == 3);
+        auto d = applySamples(p, kBig, {}, {{"r1", "S"}, {"r2", "S"}, {"r3", ""}});
+        assert(d.size() == 3 && p.skipped == 0);
+    }
+
+    // One unique sample next to a failed one: the failed file may be its copy -> nothing skipped
+    {
+        std::vector<HashPlanGroup> remoteOnly = {{kBig, {remote("r1"), remote("r2")}}};
+        RemoteHashPlan p = planRemoteHashing(remoteOnly, kSample, true);
+        auto d = applySamples(p, kBig, {}, {{"r1", "U"}, {"r2", ""}});
+        assert(d.size() == 2 && p.skipped == 0 && p.steps.at("r1") == RemoteHashStep::Download);
+    }
+    // Same with a failed local sample
+    {
+        std::vector<HashPlanGroup> mixed = {{kBig, {local("/l1"), remote("r1")}}};
+        RemoteHashPlan p = planRemoteHashing(mixed, kSample, true);
+        auto d = applySamples(p, kBig, {""}, {{"r1", "U"}});
+        assert(d.size() == 1 && p.skipped == 0);
+    }
+
+    // SHA-256 on two different servers: digests of one server can't match the other's -> MD5 downloads
+    {
+        HashPlanMember x{"ftp://x/e", true, RemoteHashSource::ServerOther, "ftp://x"};
+        HashPlanMember y{"ftp://y/e", true, RemoteHashSource::ServerOther, "ftp://y"};
+        HashPlanMember x2{"ftp://x/e2", true, RemoteHashSource::ServerOther, "ftp://x"};
+        HashPlanMember x3{"ftp://x/e3", true, RemoteHashSource::ServerOther, "ftp://x"};
+        RemoteHashPlan p = planRemoteHashing({{kBig, {x, y}}, {kBig + 1, {x2, x3}}}, kSample, true);
+        assert(p.steps.at("ftp://x/e") == RemoteHashStep::Download && p.steps.at("ftp://y/e") == RemoteHashStep::Download);
+        assert(p.steps.at("ftp://x/e2") == RemoteHashStep::ServerDigest && p.serverDigests == 2);
+    }
+
+    // Samples disabled: everything without a hash source is downloaded
+    {
+        RemoteHashPlan p = planRemoteHashing(groups, kSample, false);
+        assert(p.sampled == 0 && p.steps.at("ftp://h/a1") == RemoteHashStep::Download && p.pendingBytes == 0);
+    }
+
+    assert(describeRemoteHashPlan(plan).find("ausgeschlossen") != std::string::npos);
+
+    std::cout << "remote_hash_planner tests passed" << std::endl;
+    return 0;
+}
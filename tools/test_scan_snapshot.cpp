@@ -0,0 +1,75 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include "scan_snapshot.h"
+
+int main() {
+    std::string path = "/tmp/fd_test_snapshot.fds";
+
+    ScanSnapshotMeta meta;
+    meta.timestamp = 1700000000;
+    meta.minFileSize = 4096;
+    meta.hashAlgorithm = "XXH3";
+    meta.localDirs = {"/data/a", "/data/b"};
+    meta.duplicateGroups = 2;
+    meta.duplicateFiles = 5;
+
+    std::vector<ScanSnapshotGroup> groups;
+    groups.push_back({"aaaa1111", 100, {"/data/a/x.bin", "/data/b/x.bin"}});
+    groups.push_back({"bbbb2222", 2000, {"/data/a/y.bin", "/data/b/y.bin", "ftp://host/y.bin"}});
+
+    // Background writer
+    ScanSnapshotWriter writer;
+    writer.saveAsync(path, meta, groups);
+    writer.wait();
+    assert(writer.lastError().empty());
+    assert(ScanSnapshotView::isSnapshotFile(path));
+
+    ScanSnapshotView view;
+    bool opened = view.open(path);
+    assert(opened);
+    assert(view.groupCount() == 2 && view.fileCount() == 5);
+    assert(view.meta().hashAlgorithm == "XXH3");
+    assert(view.meta().localDirs.size() == 2 && view.meta().localDirs[1] == "/data/b");
+    assert(view.meta().minFileSize == 4096);
+    assert(view.groupHash(1) == "bbbb2222");
+    assert(view.groupSize(1) == 2000);
+    assert(view.groupFileCount(1) == 3);
+    assert(view.groupFile(1, 2) == "ftp://host/y.bin");
+    assert(view.groupFile(1, 3).empty());
+    assert(view.groupFile(5, 0).empty());
+    ScanSnapshotGroup g0 = view.loadGroup(0);
+    assert(g0.files.size() == 2 && g0.files[0] == "/data/a/x.bin");
+    view.close();
+
+    // Flip one byte in the string table -> checksum must reject the file
+    {
+        std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(-3, std::ios::end);
+        f.put('#');
+    }
+    opened = view.open(path);
+    assert(!opened);
+    std::cout << "corrupt snapshot rejected: " << view.error() << std::endl;
+
+    // Truncated file is rejected by the header/size check
+    {
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f << "FDSNAP02";
+    }
+    opened = view.open(path);
+    assert(!opened);
+    (void)opened;
+
+    // Old text format is not mistaken for a snapshot
+    {
+        std::ofstream f(path, std::ios::trunc);
+        f << "FILEDUPER_SCAN_STATE_V1\n";
+    }
+    assert(!ScanSnapshotView::isSnapshotFile(path));
+
+    std::remove(path.c_str());
+    std::cout << "scan_snapshot tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,265 @@
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "service_discovery.h"
+
+// Minimal mDNS responder side: uncompressed names, records appended in order
+struct DnsMessage {
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(12, 0);
+    uint16_t answers = 0;
+
+    DnsMessage() { bytes[2] = 0x84; }   // QR + AA
+
+    void name(const std::string& text) {
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t dot = text.find('.', start);
+            if (dot == std::string::npos) dot = text.size();
+            bytes.push_back((uint8_t)(dot - start));
+            bytes.insert(bytes.end(), text.begin() + start, text.begin() + dot);
+            start = dot + 1;
+        }
+        bytes.push_back(0);
+    }
+    void u16(uint16_t value) { bytes.push_back(value >> 8); bytes.push_back(value & 0xff); }
+    void header(const std::string& owner, uint16_t type, uint32_t ttl) {
+        name(owner);
+        u16(type);
+        u16(0x8001);   // IN + cache flush
+        u16(ttl >> 16);
+        u16(ttl & 0xffff);
+        answers++;
+        bytes[6] = answers >> 8;
+        bytes[7] = answers & 0xff;
+    }
+    // rdlength is patched after the rdata was appended
+    size_t beginData() { u16(0); return bytes.size(); }
+    void endData(size_t start) {
+        size_t length = bytes.size() - start;
+        bytes[start - 2] = length >> 8;
+        bytes[start - 1] = length & 0xff;
+    }
+
+    void ptr(const std::string& type, const std::string& instance, uint32_t ttl = 4500) {
+        header(type, 12, ttl);
+        size_t start = beginData();
+        name(instance);
+        endData(start);
+    }
+    void srv(const std::string& instance, uint16_t port, const std::string& target, uint32_t ttl = 120) {
+        header(instance, 33, ttl);
+        size_t start = beginData();
+        u16(0); u16(0); u16(port);
+        name(target);
+        endData(start);
+    }
+    void txt(const std::string& instance, const std::vector<std::string>& entries) {
+        header(instance, 16, 4500);
+        size_t start = beginData();
+        for (const auto& entry : entries) {
+            bytes.push_back((uint8_t)entry.size());
+            bytes.insert(bytes.end(), entry.begin(), entry.end());
+        }
+        endData(start);
+    }
+    void a(const std::string& host, const char* ip) {
+        header(host, 1, 120);
+        size_t start = beginData();
+        struct in_addr address;
+        inet_pton(AF_INET, ip, &address);
+        bytes.insert(bytes.end(), (uint8_t*)&address, (uint8_t*)&address + 4);
+        endData(start);
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void testQuery() {
+    std::vector<uint8_t> query = ServiceDiscoveryBrowser::buildMdnsQuery({"_smb._tcp", "_nfs._tcp"});
+    assert(query[2] == 0 && query[5] == 2);
+    const uint8_t expected[] = {4, '_', 's', 'm', 'b', 4, '_', 't', 'c', 'p', 5, 'l', 'o', 'c', 'a', 'l', 0, 0, 12, 0, 1};
+    assert(memcmp(query.data() + 12, expected, sizeof(expected)) == 0);
+    assert(serviceTypeLabel("_sftp-ssh._tcp") == "SFTP" && serviceTypeLabel("_foo._tcp") == "_foo._tcp");
+}
+
+static void testPackets() {
+    ServiceDiscoveryBrowser browser;
+    std::vector<std::pair<DiscoveredService, bool>> events;
+    browser.setCallback([&](const DiscoveredService& service, bool removed) { events.emplace_back(service, removed); });
+
+    // PTR + SRV + TXT + A in one response
+    DnsMessage response;
+    response.ptr("_webdav._tcp.local", "Keller NAS._webdav._tcp.local");
+    response.srv("Keller NAS._webdav._tcp.local", 5005, "nas.local");
+    response.txt("Keller NAS._webdav._tcp.local", {"path=/dav/share", "u=guest", "flag"});
+    response.a("nas.local", "192.168.7.20");
+    browser.handleMdnsPacket(response.bytes.data(), response.bytes.size(), "192.168.7.99");
+    assert(events.size() == 1 && !events[0].second);
+    const DiscoveredService& webdav = events[0].first;
+    assert(webdav.ip == "192.168.7.20" && webdav.port == 5005 && webdav.name == "Keller NAS");
+    assert(webdav.serviceType == "_webdav._tcp" && webdav.path == "/dav/share" && webdav.hostname == "nas.local");
+    assert(webdav.txt.at("u") == "guest" && webdav.txt.count("flag") && webdav.source == "mdns");
+
+    // Repeated announcement: no new event
+    browser.handleMdnsPacket(response.bytes.data(), response.bytes.size(), "192.168.7.99");
+    assert(events.size() == 1);
+
+    // SRV first, address missing: falls back to the sender; unrelated types are ignored
+    DnsMessage split;
+    split.srv("Drucker._ipp._tcp.local", 631, "printer.local");
+    split.srv("Backup._smb._tcp.local", 445, "backup.local");
+    browser.handleMdnsPacket(split.bytes.data(), split.bytes.size(), "192.168.7.30");
+    assert(events.size() == 2 && events[1].first.ip == "192.168.7.30" && events[1].first.serviceType == "_smb._tcp");
+    assert(browser.services().size() == 2);
+
+    // Goodbye (TTL 0)
+    DnsMessage goodbye;
+    goodbye.ptr("_webdav._tcp.local", "Keller NAS._webdav._tcp.local", 0);
+    browser.handleMdnsPacket(goodbye.bytes.data(), goodbye.bytes.size(), "192.168.7.99");
+    assert(events.size() == 3 && events[2].second && events[2].first.name == "Keller NAS");
+    assert(browser.services().size() == 1);
+
+    // Compression pointer loop and truncation must not hang or crash
+    std::vector<uint8_t> loop = {0, 0, 0x84, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0xC0, 12};
+    browser.handleMdnsPacket(loop.data(), loop.size(), "192.168.7.1");
+    for (size_t length = 0; length < response.bytes.size(); length++) {
+        browser.handleMdnsPacket(response.bytes.data(), length, "192.168.7.1");
+    }
+    // Queries (QR = 0) carry nothing for us
+    std::vector<uint8_t> query = ServiceDiscoveryBrowser::buildMdnsQuery(FILE_SERVICE_TYPES);
+    browser.handleMdnsPacket(query.data(), query.size(), "192.168.7.1");
+
+    // SSDP: NAS kept, router filtered, byebye withdraws
+    size_t before = events.size();
+    std::string nas = "HTTP/1.1 200 OK\r\nCACHE-CONTROL: max-age=900\r\nLOCATION: http://192.168.7.40:8200/rootDesc.xml\r\n"
+                      "SERVER: Linux/5.10 UPnP/1.0 MiniDLNA/1.3\r\nST: urn:schemas-upnp-org:device:MediaServer:1\r\n"
+                      "USN: uuid:4d696e69-444c-164e-9d41-001122334455::urn:schemas-upnp-org:device:MediaServer:1\r\n\r\n";
+    std::string router = "HTTP/1.1 200 OK\r\nLOCATION: http://192.168.7.1:5000/igd.xml\r\nSERVER: Router UPnP/1.0\r\n"
+                         "ST: urn:schemas-upnp-org:device:InternetGatewayDevice:1\r\nUSN: uuid:router\r\n\r\n";
+    browser.handleSsdpPacket(nas.data(), nas.size(), "192.168.7.40");
+    browser.handleSsdpPacket(router.data(), router.size(), "192.168.7.1");
+    assert(events.size() == before + 1);
+    const DiscoveredService& media = events.back().first;
+    assert(media.source == "ssdp" && media.ip == "192.168.7.40" && media.port == 8200);
+    assert(media.path == "http://192.168.7.40:8200/rootDesc.xml");
+    assert(media.expires > time(nullptr) + 800);
+    std::string byebye = "NOTIFY * HTTP/1.1\r\nNT: urn:schemas-upnp-org:device:MediaServer:1\r\nNTS: ssdp:byebye\r\n"
+                         "USN: uuid:4d696e69-444c-164e-9d41-001122334455::urn:schemas-upnp-org:device:MediaServer:1\r\n\r\n";
+    browser.handleSsdpPacket(byebye.data(), byebye.size(), "192.168.7.40");
+    assert(events.size() == before + 2 && events.back().second);
+}
+
+// Responder on loopback: answers the browser's queries (legacy unicast, RFC 6762 6.7)
+// and later announces a service unsolicited to the browser's listening port
+static void testResponder() {
+    int mdns = socket(AF_INET, SOCK_DGRAM, 0);
+    int ssdp = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int mdnsBound = bind(mdns, (struct sockaddr*)&local, sizeof(local));
+    int ssdpBound = bind(ssdp, (struct sockaddr*)&local, sizeof(local));
+    assert(mdnsBound == 0 && ssdpBound == 0);
+    (void)mdnsBound;
+    (void)ssdpBound;
+    socklen_t length = sizeof(local);
+    getsockname(mdns, (struct sockaddr*)&local, &length);
+    int mdnsPort = ntohs(local.sin_port);
+    getsockname(ssdp, (struct sockaddr*)&local, &length);
+    int ssdpPort = ntohs(local.sin_port);
+
+    std::mutex mutex;
+    std::vector<DiscoveredService> found;
+    ServiceDiscoveryBrowser browser;
+    browser.setCallback([&](const DiscoveredService& service, bool removed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!removed) found.push_back(service);
+    });
+    ServiceDiscoveryOptions options;
+    options.mdnsGroup = "127.0.0.1";
+    options.mdnsPort = mdnsPort;
+    options.ssdpGroup = "127.0.0.1";
+    options.ssdpPort = ssdpPort;
+    auto start = std::chrono::steady_clock::now();
+    bool started = browser.start(options);
+    assert(started);
+    (void)started;
+
+    // Active: the query arrives right away and is answered
+    uint8_t buffer[9000];
+    struct sockaddr_in from = {};
+    socklen_t fromLength = sizeof(from);
+    struct pollfd pfd = {mdns, POLLIN, 0};
+    int ready = poll(&pfd, 1, 2000);
+    assert(ready == 1);
+    ssize_t n = recvfrom(mdns, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+    assert(n > 12 && buffer[2] == 0 && buffer[5] == FILE_SERVICE_TYPES.size());
+    DnsMessage answer;
+    answer.ptr("_smb._tcp.local", "Archiv._smb._tcp.local");
+    answer.srv("Archiv._smb._tcp.local", 445, "archiv.local");
+    answer.a("archiv.local", "127.0.0.1");
+    sendto(mdns, answer.bytes.data(), answer.bytes.size(), 0, (struct sockaddr*)&from, fromLength);
+
+    pfd = {ssdp, POLLIN, 0};
+    ready = poll(&pfd, 1, 2000);
+    assert(ready == 1);
+    (void)ready;
+    n = recvfrom(ssdp, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLength);
+    assert(n > 0 && std::string((char*)buffer, n).compare(0, 8, "M-SEARCH") == 0);
+    std::string reply = "HTTP/1.1 200 OK\r\nLOCATION: http://127.0.0.1:8200/desc.xml\r\nSERVER: Synology NAS\r\n"
+                        "ST: upnp:rootdevice\r\nUSN: uuid:nas::upnp:rootdevice\r\n\r\n";
+    sendto(ssdp, reply.data(), reply.size(), 0, (struct sockaddr*)&from, fromLength);
+
+    // Passive: unsolicited announcement to the browser's listening socket
+    struct sockaddr_in listener = {};
+    listener.sin_family = AF_INET;
+    listener.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    listener.sin_port = htons(browser.mdnsLocalPort());
+    DnsMessage announce;
+    announce.ptr("_nfs._tcp.local", "Archiv._nfs._tcp.local");
+    announce.srv("Archiv._nfs._tcp.local", 2049, "archiv.local");
+    announce.txt("Archiv._nfs._tcp.local", {"path=/export/archiv"});
+    sendto(mdns, announce.bytes.data(), announce.bytes.size(), 0, (struct sockaddr*)&listener, sizeof(listener));
+
+    while (secondsSince(start) < 3) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (found.size() == 3) break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double seconds = secondsSince(start);
+    browser.stop();
+    close(mdns);
+    close(ssdp);
+
+    std::cout << "  responder: " << found.size() << " services in " << seconds << " s" << std::endl;
+    assert(found.size() == 3);
+    assert(seconds < 1.0);   // From the first query burst, no waiting for the periodic one
+    bool smb = false, nfs = false, upnp = false;
+    for (const auto& service : found) {
+        if (service.serviceType == "_smb._tcp") smb = service.ip == "127.0.0.1" && service.port == 445 && service.name == "Archiv";
+        if (service.serviceType == "_nfs._tcp") nfs = service.ip == "127.0.0.1" && service.path == "/export/archiv";
+        if (service.source == "ssdp") upnp = service.port == 8200 && service.hostname == "Synology NAS";
+    }
+    assert(smb && nfs && upnp);
+}
+
+int main() {
+    testQuery();
+    testPackets();
+    testResponder();
+    std::cout << "service_discovery tests passed" << std::endl;
+    return 0;
+}
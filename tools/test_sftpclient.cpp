@@ -0,0 +1,45 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include "sftpclient.h"
+
+int main() {
+    std::string host, path;
+    int port = 0;
+    assert(parseSftpUrl("sftp://nas:2222/home/user/a b.jpg", host, port, path));
+    assert(host == "nas" && port == 2222 && path == "/home/user/a b.jpg");
+    assert(parseSftpUrl("sftp://10.0.0.2", host, port, path) && port == 22 && path == "/");
+    assert(!parseSftpUrl("sftp://nas:x/", host, port, path));
+    assert(!parseSftpUrl("ftp://nas/", host, port, path));
+
+    assert(sftpUrl("nas", 22) == "sftp://nas:22/");
+    assert(sftpUrl("nas", 22, "/srv/data") == "sftp://nas:22/srv/data");
+    assert(sftpUrl("nas", 22, "") == "sftp://nas:22/");
+    assert(isSftpUrl("sftp://nas:22/") && !isSftpUrl("smb://nas/share"));
+
+    // Against a real server when configured: SFTP_TEST_URL=sftp://host:22/dir [SFTP_TEST_USER/PASSWORD]
+    std::string error;
+    const char* url = getenv("SFTP_TEST_URL");
+    if (!isLibsshAvailable()) {
+        assert(!createSftpBackend("127.0.0.1", 22, "", "", error) && !error.empty());
+    } else if (url && parseSftpUrl(url, host, port, path)) {
+        const char* user = getenv("SFTP_TEST_USER");
+        const char* password = getenv("SFTP_TEST_PASSWORD");
+        std::unique_ptr<NfsBackend> sftp = createSftpBackend(host, port, user ? user : "", password ? password : "", error);
+        assert(sftp);
+        NfsAsyncEngine engine(*sftp, 64, 64 * 1024, 16);
+        std::vector<NfsAsyncEngine::FileInfo> files;
+        bool walked = engine.walk(path, 999, [&](const NfsAsyncEngine::FileInfo& file) { files.push_back(file); });
+        assert(walked);
+        int hashed = 0;
+        bool finished = engine.hashFiles(files, [&](const NfsAsyncEngine::FileInfo&, const std::string& hash) { hashed += !hash.empty(); });
+        assert(finished);
+        (void)walked;
+        (void)finished;
+        std::cout << files.size() << " files, " << hashed << " hashed, " << (engine.stats().bytes / (1024 * 1024))
+                  << " MB, up to " << engine.stats().maxOutstanding << " requests in flight" << std::endl;
+    }
+
+    std::cout << "sftpclient tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sharded_cache.h"
+
+int main() {
+    // Basic get/put/update/erase
+    {
+        ShardedCache<std::string, int> cache(1 << 20, 8);
+        int v = 0;
+        assert(!cache.get("a", v));
+        cache.put("a", 1);
+        assert(cache.get("a", v) && v == 1);
+        cache.put("a", 2);
+        assert(cache.get("a", v) && v == 2);
+        bool updated = cache.update("a", [](int& x) { x += 10; });
+        assert(updated);
+        assert(cache.get("a", v) && v == 12);
+        updated = cache.update("missing", [](int& x) { x = 0; });
+        assert(!updated);
+        (void)updated;
+        assert(!cache.getIf("a", v, [](int x) { return x < 10; }));
+        bool erased = cache.erase("a");
+        assert(erased && !cache.contains("a"));
+        (void)erased;
+
+        auto s = cache.stats();
+        assert(s.hits == 3 && s.misses == 2 && s.entries == 0);
+    }
+
+    // Budget is enforced by CLOCK eviction; recently used entries survive
+    {
+        const size_t entryCost = 100;
+        ShardedCache<int, int> cache(1000, 1, [](const int&, const int&) { return entryCost; });
+        for (int i = 0; i < 10; i++) cache.put(i, i);
+        int v;
+        assert(cache.get(0, v)); // sets reference bit on 0
+        for (int i = 10; i < 15; i++) cache.put(i, i);
+        auto s = cache.stats();
+        assert(s.bytes <= 1000);
+        assert(s.entries == 10);
+        assert(s.evictions == 5);
+        assert(cache.contains(0));
+        assert(cache.contains(14));
+
+        cache.setBudget(300);
+        cache.put(100, 100);
+        assert(cache.stats().entries <= 3 && cache.contains(100));
+    }
+
+    // Concurrent readers and writers across shards
+    {
+        ShardedCache<int, std::string> cache(4 << 20, 64);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 16; t++) {
+            threads.emplace_back([&cache, t]() {
+                std::string out;
+                for (int i = 0; i < 20000; i++) {
+                    int key = (i * 7 + t) % 5000;
+                    if (!cache.get(key, out)) cache.put(key, std::to_string(key));
+                    else assert(out == std::to_string(key));
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        auto s = cache.stats();
+        assert(s.entries == 5000);
+        assert(s.hits + s.misses == 16 * 20000);
+        std::cout << "sharded_cache: hits=" << s.hits << " misses=" << s.misses << std::endl;
+    }
+
+    std::cout << "sharded_cache tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include "smbclient.h"
+
+int main() {
+    std::string server, share, path;
+    assert(parseSmbUrl("smb://nas/media/Filme/a b.mkv", server, share, path));
+    assert(server == "nas" && share == "media" && path == "/Filme/a b.mkv");
+    assert(parseSmbUrl("smb://10.0.0.2/public", server, share, path) && share == "public" && path == "/");
+    assert(!parseSmbUrl("smb://nas", server, share, path));
+    assert(!parseSmbUrl("nfs://nas/export", server, share, path));
+
+    assert(smbUrl("nas", "media") == "smb://nas/media");
+    assert(smbUrl("nas", "media", "/x/y") == "smb://nas/media/x/y");
+    assert(parseSmbUrl(smbUrl("nas", "media", "/x"), server, share, path) && path == "/x");
+    assert(isSmbUrl("smb://nas/media") && !isSmbUrl("/mnt/smb"));
+
+    assert(parseSmbSharePath("//192.168.1.100/shared/sub", server, share));
+    assert(server == "192.168.1.100" && share == "shared");
+    assert(parseSmbSharePath("\\\\FILESRV\\Daten", server, share) && server == "FILESRV" && share == "Daten");
+    assert(!parseSmbSharePath("//192.168.1.100", server, share));
+
+    // Against a real Samba share when configured: SMB_TEST_URL=smb://host/share [SMB_TEST_USER/PASSWORD]
+    std::string error;
+    const char* url = getenv("SMB_TEST_URL");
+    if (!isLibsmb2Available()) {
+        assert(!createLibsmb2Backend("127.0.0.1", "share", "", "", "", error) && !error.empty());
+    } else if (url && parseSmbUrl(url, server, share, path)) {
+        const char* user = getenv("SMB_TEST_USER");
+        const char* password = getenv("SMB_TEST_PASSWORD");
+        std::unique_ptr<NfsBackend> smb = createLibsmb2Backend(server, share, user ? user : "", password ? password : "", "", error);
+        assert(smb);
+        NfsAsyncEngine engine(*smb);
+        std::vector<NfsAsyncEngine::FileInfo> files;
+        bool walked = engine.walk(path, 999, [&](const NfsAsyncEngine::FileInfo& file) { files.push_back(file); });
+        assert(walked);
+        int hashed = 0;
+        bool finished = engine.hashFiles(files, [&](const NfsAsyncEngine::FileInfo&, const std::string& hash) { hashed += !hash.empty(); });
+        assert(finished);
+        (void)walked;
+        (void)finished;
+        std::cout << files.size() << " files, " << hashed << " hashed, up to " << engine.stats().maxOutstanding
+                  << " requests in flight" << std::endl;
+    }
+
+    std::cout << "smbclient tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <cassert>
+#include <fstream>
+#include <map>
+#include <cstdlib>
+#include <unistd.h>
+#include <openssl/md5.h>
+#include "ssh_remote_hash.h"
+
+static std::string md5Of(const std::string& data) {
+    unsigned char digest[MD5_DIGEST_LENGTH];
+    MD5((const unsigned char*)data.data(), data.size(), digest);
+    char hex[MD5_DIGEST_LENGTH * 2 + 1];
+    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    return hex;
+}
+
+int main() {
+    // Records split across reads, both md5sum modes, garbage ignored
+    std::map<std::string, std::string> got;
+    auto record = [&](const std::string& path, const std::string& key) { got[path] = key; };
+    SshDigestParser digests(false);
+    const char first[] = "d41d8cd98f00b204e9800998ecf8427e  /a b";
+    const char second[] = "0cc175b9c0f1b6a831c399e269772661 */x\ny";
+    std::string stream = std::string(first, sizeof(first)) + std::string(second, sizeof(second)) + "md5sum: /gone: No such file";
+    digests.feed(stream.data(), 20, record);
+    assert(got.empty());
+    digests.feed(stream.data() + 20, stream.size() - 20, record);
+    assert(got.size() == 2 && got["/a b"] == "d41d8cd98f00b204e9800998ecf8427e");
+    assert(got["/x\ny"] == "0cc175b9c0f1b6a831c399e269772661");
+
+    got.clear();
+    SshDigestParser samples(true);
+    std::string sampleRecord = std::string(32, 'a') + " " + std::string(32, 'b') + " /dir/with space\0";
+    samples.feed(sampleRecord.data(), sampleRecord.size() + 1, record);
+    assert(got["/dir/with space"] == std::string(32, 'a') + std::string(32, 'b'));
+
+    // Real md5sum/head/tail through /bin/sh, batches of 2
+    char dir[] = "/tmp/ssh_remote_hash_XXXXXX";
+    assert(mkdtemp(dir));
+    std::string base = dir;
+    std::map<std::string, std::string> contents = {
+        {base + "/plain", "hello world"},
+        {base + "/with space", std::string(300000, 'x') + "end"},
+        {base + "/new\nline", "newline name"},
+        {base + "/'quote\"", std::string(200000, 'q') + std::string(200000, 'r')},
+    };
+    std::vector<std::string> paths;
+    for (const auto& [path, data] : contents) {
+        std::ofstream(path, std::ios::binary) << data;
+        paths.push_back(path);
+    }
+    paths.push_back(base + "/missing");
+
+    std::unique_ptr<SshCommandRunner> shell = createLocalShellRunner();
+    std::map<std::string, std::string> hashes;
+    int calls = 0;
+    bool md5sumWorks = system("echo | md5sum -z > /dev/null 2>&1") == 0;
+    bool ok = sshRemoteDigests(*shell, paths, 2, [&](const std::string& path, const std::string& hex) {
+        calls++;
+        hashes[path] = hex;
+    });
+    assert(ok == md5sumWorks);
+    if (ok) {
+        assert(calls == 5);
+        for (const auto& [path, data] : contents) assert(hashes[path] == md5Of(data));
+        assert(hashes[base + "/missing"].empty());
+
+        std::map<std::string, std::string> keys;
+        assert(sshRemoteSamples(*shell, paths, 65536, 3, [&](const std::string& path, const std::string& key) { keys[path] = key; }));
+        const std::string& big = contents[base + "/'quote\""];
+        assert(keys[base + "/'quote\""] == md5Of(big.substr(0, 65536)) + md5Of(big.substr(big.size() - 65536)));
+        assert(keys[base + "/missing"].empty() && keys.size() == 5);
+    }
+
+    // Tool missing -> false, caller falls back to transferring
+    std::string out;
+    int status = 0;
+    std::string error;
+    shell->run("exit 127", "", [&](const char* data, size_t len) { out.append(data, len); }, status, error);
+    assert(status == 127);
+    bool ran = shell->run("cat", std::string(1 << 20, 'z'), [&](const char* data, size_t len) { out.append(data, len); }, status, error);
+    assert(ran);
+    (void)ran;
+    assert(out.size() == (1 << 20));
+
+    for (const auto& path : paths) unlink(path.c_str());
+    rmdir(dir);
+    std::cout << "ssh_remote_hash tests passed" << std::endl;
+    return 0;
+}
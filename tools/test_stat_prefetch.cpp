@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "stat_prefetch.h"
+
+static std::string makeTree() {
+    char tmpl[] = "/tmp/fileduper_prefetch_XXXXXX";
+    std::string root = mkdtemp(tmpl);
+    for (int i = 0; i < 300; i++) {
+        std::ofstream(root + "/file" + std::to_string(i)) << std::string(i, 'x');
+    }
+    mkdir((root + "/subdir").c_str(), 0755);
+    assert(symlink("file7", (root + "/link").c_str()) == 0);
+    assert(symlink("missing", (root + "/dangling").c_str()) == 0);
+    return root;
+}
+
+static void removeTree(const std::string& root) {
+    std::string command = "rm -rf '" + root + "'";
+    assert(system(command.c_str()) == 0);
+}
+
+static std::vector<std::string> namesOf() {
+    std::vector<std::string> names;
+    for (int i = 0; i < 300; i++) names.push_back("file" + std::to_string(i));
+    names.push_back("subdir");
+    names.push_back("link");
+    names.push_back("dangling");
+    names.push_back("gone");
+    return names;
+}
+
+// Results must match what the sequential lstat()/stat() walk in scanDirectoryRecursive saw
+static void checkResults(const std::string& root, const std::vector<std::string>& names,
+                         const std::vector<PrefetchedStat>& results, bool followSymlinks) {
+    assert(results.size() == names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        std::string path = root + "/" + names[i];
+        struct stat st;
+        int rc = followSymlinks ? stat(path.c_str(), &st) : lstat(path.c_str(), &st);
+        if (rc != 0) {
+            assert(results[i].error == ENOENT);
+            continue;
+        }
+        assert(results[i].error == 0);
+        assert(results[i].mode == st.st_mode);
+        assert(results[i].size == st.st_size);
+        assert(results[i].mtime == st.st_mtime);
+        assert(results[i].inode == st.st_ino);
+        assert(results[i].device == st.st_dev);
+    }
+}
+
+static void testSingleCaller(const std::string& root) {
+    std::vector<std::string> names = namesOf();
+    std::vector<PrefetchedStat> results;
+
+    // Without start(): inline on the caller
+    StatPrefetchPool inlinePool;
+    inlinePool.statDirectory(root, names, false, false, results);
+    checkResults(root, names, results, false);
+    assert(S_ISLNK(results[301].mode) && S_ISLNK(results[302].mode));
+
+    StatPrefetchPool pool;
+    pool.start(16);
+    assert(pool.threadCount() == 16);
+    pool.statDirectory(root, names, true, false, results);
+    checkResults(root, names, results, true);
+    assert(S_ISREG(results[301].mode) && results[301].size == 7);
+    assert(results[302].error == ENOENT);
+    assert(S_ISDIR(results[300].mode));
+
+    // Stale-ok attributes: same answers on a local filesystem
+    pool.statDirectory(root, names, false, true, results);
+    checkResults(root, names, results, false);
+
+    // Empty and tiny directories, missing directory
+    pool.statDirectory(root, {}, true, false, results);
+    assert(results.empty());
+    pool.statDirectory(root, {"file1", "file2"}, true, false, results);
+    assert(results.size() == 2 && results[0].size == 1 && results[1].size == 2);
+    pool.statDirectory(root + "/nope", {"a", "b", "c", "d", "e"}, true, false, results);
+    assert(results.size() == 5 && results[4].error == ENOENT);
+
+    // Resize
+    pool.start(4);
+    assert(pool.threadCount() == 4);
+    pool.statDirectory(root, names, false, false, results);
+    checkResults(root, names, results, false);
+    pool.stop();
+    assert(pool.threadCount() == 0);
+    pool.statDirectory(root, names, false, false, results);
+    checkResults(root, names, results, false);
+}
+
+// Parallel directory scan: several threads submit directories at once
+static void testConcurrentCallers(const std::string& root) {
+    StatPrefetchPool pool;
+    pool.start(8);
+    std::vector<std::string> names = namesOf();
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 6; t++) {
+        callers.emplace_back([&, t]() {
+            std::vector<PrefetchedStat> results;
+            for (int round = 0; round < 50; round++) {
+                pool.statDirectory(root, names, (t + round) % 2 == 0, false, results);
+                checkResults(root, names, results, (t + round) % 2 == 0);
+            }
+        });
+    }
+    for (auto& caller : callers) caller.join();
+}
+
+static void testRemoteDetection(const std::string& root) {
+    assert(!isRemoteFilesystem("/proc"));
+    assert(!isRemoteFilesystem(root + "/does-not-exist"));
+    const char* nfsPath = getenv("FILEDUPER_NFS_TEST_PATH");
+    if (nfsPath) {
+        assert(isRemoteFilesystem(nfsPath));
+        std::cout << "NFS path detected as remote: " << nfsPath << std::endl;
+    }
+}
+
+int main() {
+    std::string root = makeTree();
+    testSingleCaller(root);
+    testConcurrentCallers(root);
+    testRemoteDetection(root);
+    removeTree(root);
+    std::cout << "stat_prefetch tests passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,402 @@
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <curl/curl.h>
+#include <openssl/md5.h>
+#include "webdav_client.h"
+
+static std::string md5Of(const std::string& data) {
+    unsigned char digest[MD5_DIGEST_LENGTH];
+    MD5((const unsigned char*)data.data(), data.size(), digest);
+    char hex[33];
+    for (int i = 0; i < MD5_DIGEST_LENGTH; i++) snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    return hex;
+}
+
+// Minimal WebDAV server stand-in on 127.0.0.1: PROPFIND (Depth 0/1/infinity), ranged GET and
+// DELETE over keep-alive HTTP/1.1, one thread per connection.
+class DavStandIn {
+public:
+    std::map<std::string, std::string> files;     // path -> content
+    std::set<std::string> dirs;
+    std::atomic<bool> refuseInfinity{false};
+    std::atomic<bool> ignoreRange{false};
+    std::atomic<int> propfinds{0};
+    std::atomic<int> rangeGets{0};
+    std::atomic<int> connections{0};
+    std::mutex mutex;
+
+    int start() {
+        m_listen = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int bound = bind(m_listen, (sockaddr*)&addr, sizeof(addr));
+        int listening = listen(m_listen, 64);
+        assert(bound == 0 && listening == 0);
+        (void)bound;
+        (void)listening;
+        socklen_t len = sizeof(addr);
+        getsockname(m_listen, (sockaddr*)&addr, &len);
+        m_acceptor = std::thread([this]() {
+            while (true) {
+                int fd = accept(m_listen, nullptr, nullptr);
+                if (fd < 0) break;
+                connections++;
+                std::thread([this, fd]() { serve(fd); }).detach();
+            }
+        });
+        return ntohs(addr.sin_port);
+    }
+
+    void stop() {
+        shutdown(m_listen, SHUT_RDWR);
+        close(m_listen);
+        m_acceptor.join();
+    }
+
+private:
+    static std::string decode(const std::string& text) {
+        std::string out;
+        for (size_t i = 0; i < text.size(); i++) {
+            if (text[i] == '%' && i + 2 < text.size()) {
+                out += (char)std::stoi(text.substr(i + 1, 2), nullptr, 16);
+                i += 2;
+            } else {
+                out += text[i];
+            }
+        }
+        while (out.size() > 1 && out.back() == '/') out.pop_back();
+        return out;
+    }
+
+    static std::string xmlEscape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '&') out += "&amp;";
+            else if (c == '<') out += "&lt;";
+            else out += c;
+        }
+        return out;
+    }
+
+    std::string responseXml(const std::string& path, bool isDir, int index) {
+        std::string href = davEncodePath(path) + (isDir && path != "/" ? "/" : "");
+        if (index % 3 == 1) href = "http://127.0.0.1" + href;    // Some servers send absolute hrefs
+        std::string xml = "<D:response><D:href>" + xmlEscape(href) + "</D:href><D:propstat><D:prop>";
+        if (isDir) {
+            xml += "<D:resourcetype><D:collection/></D:resourcetype>";
+        } else {
+            xml += "<D:resourcetype/><D:getcontentlength>" + std::to_string(files[path].size()) + "</D:getcontentlength>"
+                   "<D:getetag>&quot;" + md5Of(files[path]).substr(0, 8) + "&quot;</D:getetag>"
+                   "<D:getlastmodified>Sun, 06 Nov 1994 08:49:37 GMT</D:getlastmodified>";
+        }
+        xml += "</D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat>"
+               "<D:propstat><D:prop><D:quota-used-bytes/></D:prop><D:status>HTTP/1.1 404 Not Found</D:status></D:propstat>"
+               "</D:response>";
+        return xml;
+    }
+
+    std::string handle(const std::string& method, const std::string& target, const std::map<std::string, std::string>& headers,
+                       std::string& body) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string path = decode(target);
+        if (method == "PROPFIND") {
+            propfinds++;
+            auto depthIt = headers.find("depth");
+            std::string depth = depthIt == headers.end() ? "infinity" : depthIt->second;
+            if (depth == "infinity" && refuseInfinity) {
+                body = "<?xml version=\"1.0\"?><D:error xmlns:D=\"DAV:\"><D:propfind-finite-depth/></D:error>";
+                return "403 Forbidden";
+            }
+            if (!dirs.count(path) && !files.count(path)) return "404 Not Found";
+            std::string prefix = path == "/" ? "/" : path + "/";
+            body = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<D:multistatus xmlns:D=\"DAV:\">";
+            body += responseXml(path, dirs.count(path) > 0, 0);
+            int index = 1;
+            auto include = [&](const std::string& candidate) {
+                if (candidate.size() <= prefix.size() || candidate.compare(0, prefix.size(), prefix) != 0) return false;
+                return depth == "infinity" || (depth == "1" && candidate.find('/', prefix.size()) == std::string::npos);
+            };
+            for (const auto& dir : dirs) {
+                if (include(dir)) body += responseXml(dir, true, index++);
+            }
+            for (const auto& file : files) {
+                if (include(file.first)) body += responseXml(file.first, false, index++);
+            }
+            body += "</D:multistatus>";
+            return "207 Multi-Status";
+        }
+        if (method == "GET") {
+            auto it = files.find(path);
+            if (it == files.end()) return "404 Not Found";
+            auto range = headers.find("range");
+            if (range == headers.end() || ignoreRange) {
+                body = it->second;
+                return "200 OK";
+            }
+            rangeGets++;
+            unsigned long long first = 0, last = 0;
+            sscanf(range->second.c_str(), "bytes=%llu-%llu", &first, &last);
+            if (first >= it->second.size()) return "416 Range Not Satisfiable";
+            last = std::min<unsigned long long>(last, it->second.size() - 1);
+            body = it->second.substr(first, last - first + 1);
+            return "206 Partial Content\r\nContent-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) +
+                   "/" + std::to_string(it->second.size());
+        }
+        if (method == "DELETE") {
+            return files.erase(path) ? "204 No Content" : "404 Not Found";
+        }
+        return "405 Method Not Allowed";
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[65536];
+        while (true) {
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+            std::string head = buffer.substr(0, headerEnd);
+            buffer.erase(0, headerEnd + 4);
+            std::string requestLine = head.substr(0, head.find("\r\n"));
+            std::string method = requestLine.substr(0, requestLine.find(' '));
+            size_t targetStart = requestLine.find(' ') + 1;
+            std::string target = requestLine.substr(targetStart, requestLine.find(' ', targetStart) - targetStart);
+            std::map<std::string, std::string> headers;
+            for (size_t pos = head.find("\r\n"); pos != std::string::npos;) {
+                size_t end = head.find("\r\n", pos + 2);
+                std::string line = head.substr(pos + 2, end == std::string::npos ? std::string::npos : end - pos - 2);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    std::string name = line.substr(0, colon);
+                    for (auto& c : name) c = (char)tolower(c);
+                    headers[name] = line.substr(line.find_first_not_of(' ', colon + 1));
+                }
+                pos = end;
+            }
+            size_t contentLength = headers.count("content-length") ? std::stoul(headers["content-length"]) : 0;
+            while (buffer.size() < contentLength) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                buffer.append(chunk, n);
+            }
+            buffer.erase(0, contentLength);
+
+            std::string body;
+            std::string status = handle(method, target, headers, body);
+            std::string reply = "HTTP/1.1 " + status + "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+            if (method == "PROPFIND") reply += "Content-Type: application/xml; charset=utf-8\r\n";
+            reply += "\r\n" + body;
+            for (size_t sent = 0; sent < reply.size();) {
+                ssize_t n = send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    close(fd);
+                    return;
+                }
+                sent += n;
+            }
+        }
+    }
+
+    int m_listen = -1;
+    std::thread m_acceptor;
+};
+
+static void testHelpers() {
+    bool https = false;
+    std::string host, path;
+    assert(isDavUrl("davs://cloud:8443/remote.php/webdav/a.txt"));
+    assert(isDavUrl("dav://nas/x") && !isDavUrl("ftp://nas/x") && !isDavUrl("/dav/x"));
+    assert(parseDavUrl("davs://cloud:8443/remote.php/webdav/a.txt", https, host, path));
+    assert(https && host == "cloud:8443" && path == "/remote.php/webdav/a.txt");
+    assert(parseDavUrl("dav://nas", https, host, path) && !https && host == "nas" && path == "/");
+    assert(davUrl(true, "cloud", "/a/b") == "davs://cloud/a/b");
+    assert(davUrlFromHttp("https://cloud.example.com/remote.php/dav/files/user/") == "davs://cloud.example.com/remote.php/dav/files/user");
+    assert(davUrlFromHttp("http://192.168.1.5:8080") == "dav://192.168.1.5:8080/");
+    assert(davEncodePath("/a b/ä&c.txt") == "/a%20b/%C3%A4%26c.txt");
+
+    assert(parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT") == 784111777);
+    assert(parseHttpDate("Tue, 15 Nov 1994 12:45:26 GMT") == 784903526);
+    assert(parseHttpDate("garbage") == 0);
+
+    assert(davEtagTag("") == 0);
+    assert(davEtagTag("\"abc\"") != 0 && davEtagTag("\"abc\"") == davEtagTag("\"abc\""));
+    assert(davEtagTag("\"abc\"") != davEtagTag("\"abd\""));
+}
+
+static void testMultistatusParser() {
+    // Apache mod_dav style: lp1/lp2 prefixes, absolute href, entities, a 404 propstat
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<D:multistatus xmlns:D=\"DAV:\" xmlns:ns0=\"DAV:\">\n"
+        "<D:response xmlns:lp1=\"DAV:\" xmlns:lp2=\"http://apache.org/dav/props/\">\n"
+        "<D:href>/dav/</D:href>\n"
+        "<D:propstat><D:prop><lp1:resourcetype><D:collection/></lp1:resourcetype></D:prop>\n"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat>\n"
+        "</D:response>\n"
+        "<D:response>\n"
+        "<D:href>http://host/dav/Tom%20%26%20Jerry.mkv</D:href>\n"
+        "<D:propstat><D:prop>\n"
+        "<lp1:resourcetype/>\n"
+        "<lp1:getcontentlength>123456789012</lp1:getcontentlength>\n"
+        "<lp1:getlastmodified>Sun, 06 Nov 1994 08:49:37 GMT</lp1:getlastmodified>\n"
+        "<lp1:getetag>&quot;1d2-5ab&quot;</lp1:getetag>\n"
+        "</D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat>\n"
+        "<D:propstat><D:prop><D:getcontentlength>999</D:getcontentlength></D:prop>\n"
+        "<D:status>HTTP/1.1 404 Not Found</D:status></D:propstat>\n"
+        "</D:response>\n"
+        "<!-- comment <D:response> -->\n"
+        "<d:response xmlns:d=\"DAV:\"><d:href>/dav/a&amp;b/</d:href><d:propstat><d:prop>"
+        "<d:resourcetype><d:collection /></d:resourcetype></d:prop><d:status>HTTP/1.1 200 OK</d:status></d:propstat></d:response>"
+        "</D:multistatus>";
+    std::vector<DavResource> resources;
+    assert(parseDavMultistatus(xml, resources));
+    assert(resources.size() == 3);
+    assert(resources[0].path == "/dav" && resources[0].isDir);
+    assert(resources[1].path == "/dav/Tom & Jerry.mkv" && !resources[1].isDir);
+    assert(resources[1].size == 123456789012ULL);
+    assert(resources[1].mtime == 784111777);
+    assert(resources[1].etag == "\"1d2-5ab\"");
+    assert(resources[2].path == "/dav/a&b" && resources[2].isDir);
+
+    std::vector<DavResource> none;
+    assert(!parseDavMultistatus("<html><body>Login</body></html>", none) && none.empty());
+}
+
+struct Listing {
+    std::map<std::string, NfsAsyncEngine::FileInfo> files;
+    std::set<std::string> dirs;
+};
+
+static Listing walkAll(NfsBackend& backend, const std::string& root) {
+    Listing listing;
+    NfsAsyncEngine engine(backend, 16);
+    bool ok = engine.walk(root, 99, [&](const NfsAsyncEngine::FileInfo& file) {
+        listing.files[file.path] = file;
+    }, nullptr, [&](const std::string& dir) { listing.dirs.insert(dir); });
+    assert(ok);
+    return listing;
+}
+
+static void testAgainstStandIn() {
+    DavStandIn server;
+    server.dirs = {"/", "/dav", "/dav/photos", "/dav/photos/2024", "/dav/empty", "/dav/a b & c", "/other"};
+    auto content = [](size_t size, int seed) {
+        std::string data(size, '\0');
+        for (size_t i = 0; i < size; i++) data[i] = (char)((i * 31 + seed * 7 + i / 1000) & 0xff);
+        return data;
+    };
+    server.files["/dav/small.txt"] = "hello webdav";
+    server.files["/dav/photos/img1.jpg"] = content(300000, 1);
+    server.files["/dav/photos/2024/img2.jpg"] = content(1000000, 2);
+    server.files["/dav/photos/2024/copy.jpg"] = content(1000000, 2);
+    server.files["/dav/a b & c/ümlaut.bin"] = content(65536, 3);
+    server.files["/other/outside.txt"] = "not below /dav";
+    int port = server.start();
+    std::string host = "127.0.0.1:" + std::to_string(port);
+
+    std::string error;
+    std::unique_ptr<NfsBackend> backend = createWebDavBackend(false, host, "", "", error, 4);
+    assert(backend);
+
+    // Depth: infinity - one PROPFIND for the whole tree
+    Listing listing = walkAll(*backend, "/dav");
+    assert(server.propfinds == 1);
+    assert(listing.files.size() == 5);
+    assert(!listing.files.count("/other/outside.txt"));
+    assert(listing.dirs.count("/dav/empty") && listing.dirs.count("/dav/photos/2024") && listing.dirs.count("/dav/a b & c"));
+    const auto& img2 = listing.files["/dav/photos/2024/img2.jpg"];
+    assert(img2.size == 1000000 && img2.mtime == 784111777 && img2.inode != 0);
+    assert(listing.files["/dav/a b & c/ümlaut.bin"].size == 65536);
+    assert(listing.files["/dav/small.txt"].inode == davEtagTag("\"" + md5Of("hello webdav").substr(0, 8) + "\""));
+
+    // Parallel range GETs; out-of-order completion is the engine's job
+    std::vector<NfsAsyncEngine::FileInfo> toHash;
+    for (const auto& [path, file] : listing.files) toHash.push_back(file);
+    toHash.push_back({"/dav/missing.bin", 5000, 0, 0});
+    std::map<std::string, std::string> hashes;
+    {
+        NfsAsyncEngine engine(*backend, 16, 64 * 1024, 4);
+        bool hashed = engine.hashFiles(toHash, [&](const NfsAsyncEngine::FileInfo& file, const std::string& hash) {
+            hashes[file.path] = hash;
+        });
+        assert(hashed);
+        (void)hashed;
+        assert(engine.stats().maxOutstanding > 4);
+    }
+    assert(hashes.size() == toHash.size());
+    for (const auto& [path, data] : server.files) {
+        if (path.compare(0, 5, "/dav/") == 0) assert(hashes[path] == md5Of(data));
+    }
+    assert(hashes["/dav/missing.bin"].empty());
+    assert(server.rangeGets >= 16 + 16 + 5 + 1 + 1);
+    assert(server.connections <= 4 + 1);    // maxConnections, plus one the missing file's 404 may cost
+
+    // Server refusing Depth: infinity -> level by level
+    server.refuseInfinity = true;
+    server.propfinds = 0;
+    std::unique_ptr<NfsBackend> finite = createWebDavBackend(false, host, "", "", error, 4);
+    Listing levelWise = walkAll(*finite, "/dav");
+    assert(levelWise.files.size() == 5 && levelWise.dirs == listing.dirs);
+    assert(server.propfinds == 1 + 5);    // Refused + /dav and its four directories
+    server.refuseInfinity = false;
+
+    // Server ignoring Range: the bytes are taken out of the full reply
+    server.ignoreRange = true;
+    std::unique_ptr<NfsBackend> noRange = createWebDavBackend(false, host, "", "", error, 4);
+    {
+        NfsAsyncEngine engine(*noRange, 8, 128 * 1024, 2);
+        std::vector<NfsAsyncEngine::FileInfo> one{listing.files["/dav/photos/img1.jpg"]};
+        std::string hash;
+        bool hashed = engine.hashFiles(one, [&](const NfsAsyncEngine::FileInfo&, const std::string& h) { hash = h; });
+        assert(hashed);
+        (void)hashed;
+        assert(hash == md5Of(server.files["/dav/photos/img1.jpg"]));
+    }
+    server.ignoreRange = false;
+
+    // DELETE
+    bool deleted = backend->unlink("/dav/photos/2024/copy.jpg", error);
+    assert(deleted && !server.files.count("/dav/photos/2024/copy.jpg"));
+    deleted = backend->unlink("/dav/photos/2024/copy.jpg", error);
+    assert(!deleted && error.find("404") != std::string::npos);
+    (void)deleted;
+
+    backend.reset();
+    finite.reset();
+    noRange.reset();
+    server.stop();
+}
+
+int main() {
+    curl_global_init(CURL_GLOBAL_ALL);
+    testHelpers();
+    testMultistatusParser();
+    testAgainstStandIn();
+    curl_global_cleanup();
+    std::cout << "webdav_client tests passed" << std::endl;
+    return 0;
+}